@@ -100,8 +100,10 @@ bool script_file_opt_setter(CLI::results_t res)
 
 void lint_opt_setter(int)
 {
-   if (sg_behavior == ExecMode::Standard) {
-      return;
+   if (sg_behavior != ExecMode::Standard) {
+      sg_exitStatus = 1;
+      sg_errorMsg = PARAM_MODE_CONFLICT;
+      throw CLI::ParseError(sg_errorMsg, sg_exitStatus);
    }
    sg_syntaxCheck = true;
    sg_behavior = ExecMode::Lint;
@@ -247,6 +249,7 @@ std::string PhpOptFormatter::make_usage(const CLI::App *, std::string name) cons
    out << "   " << name << " [options] [-B <begin_code>] -F <file> [-E <end_code>] [--] [args...]" << std::endl;
    out << "   " << name << " [options] -- [args...]" << std::endl;
    out << "   " << name << " [options] -a" << std::endl;
+   out << "   " << name << " -l [-j <n>] <file>|<dir>|<glob>..." << std::endl;
    return out.str();
 }
 
@@ -280,6 +283,7 @@ std::vector<std::string> PhpOptFormatter::sm_opsNames{
    "--help",
    "--ng-info",
    "--lint",
+   "--jobs",
    "--modules-info",
    "-r",
    "-B",
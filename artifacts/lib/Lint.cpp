@@ -0,0 +1,206 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "Lint.h"
+
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Parser.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/utils/Error.h"
+#include "polarphp/utils/GlobPattern.h"
+#include "polarphp/utils/MemoryBuffer.h"
+#include "polarphp/utils/ThreadPool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <set>
+#include <thread>
+
+namespace polar {
+
+namespace stdfs = std::filesystem;
+
+using polar::basic::StringRef;
+using polar::kernel::LangOptions;
+using polar::parser::Parser;
+using polar::parser::SourceManager;
+using polar::parser::TriviaRetentionMode;
+using polar::utils::GlobPattern;
+using polar::utils::MemoryBuffer;
+using polar::utils::ThreadPool;
+
+namespace {
+
+/// The files handed to one pool task, they share a SourceManager and a
+/// Parser that is reset for each of them. The SourceManager keeps its
+/// buffers, so a task must not grow too large either.
+constexpr size_t scg_lintChunkSize = 64;
+
+struct LintResult
+{
+   std::string report;
+   bool failed = false;
+};
+
+bool has_glob_wildcard(StringRef input)
+{
+   return input.findFirstOf("*?[") != StringRef::npos;
+}
+
+void collect_directory_files(const stdfs::path &dir, std::vector<std::string> &files)
+{
+   std::vector<std::string> found;
+   std::error_code errorCode;
+   for (stdfs::recursive_directory_iterator iter(dir, stdfs::directory_options::skip_permission_denied, errorCode), end;
+        !errorCode && iter != end; iter.increment(errorCode)) {
+      if (iter->is_regular_file(errorCode) && iter->path().extension() == ".php") {
+         found.push_back(iter->path().generic_string());
+      }
+   }
+   std::sort(found.begin(), found.end());
+   files.insert(files.end(), found.begin(), found.end());
+}
+
+bool collect_glob_files(const std::string &input, std::vector<std::string> &files, std::ostream &errorStream)
+{
+   utils::Expected<GlobPattern> pattern = GlobPattern::create(input);
+   if (!pattern) {
+      errorStream << "Invalid pattern " << input << ": " << utils::to_string(pattern.takeError()) << std::endl;
+      return false;
+   }
+   StringRef inputRef(input);
+   size_t baseEnd = inputRef.substr(0, inputRef.findFirstOf("*?[")).rfind('/');
+   // a relative pattern without a directory part is matched against paths
+   // relative to the working directory, without a leading "./"
+   bool relative = baseEnd == StringRef::npos;
+   stdfs::path base = relative ? stdfs::path(".") : stdfs::path(input.substr(0, baseEnd + 1));
+   std::vector<std::string> found;
+   std::error_code errorCode;
+   for (stdfs::recursive_directory_iterator iter(base, stdfs::directory_options::skip_permission_denied, errorCode), end;
+        !errorCode && iter != end; iter.increment(errorCode)) {
+      if (!iter->is_regular_file(errorCode)) {
+         continue;
+      }
+      std::string path = relative ? iter->path().lexically_relative(base).generic_string()
+                                  : iter->path().generic_string();
+      if (pattern->match(path)) {
+         found.push_back(std::move(path));
+      }
+   }
+   if (found.empty()) {
+      errorStream << "No files match " << input << std::endl;
+      return false;
+   }
+   std::sort(found.begin(), found.end());
+   files.insert(files.end(), found.begin(), found.end());
+   return true;
+}
+
+void lint_chunk(const std::vector<std::string> &files, size_t begin, size_t end,
+                std::vector<LintResult> &results)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   std::unique_ptr<Parser> parser;
+   const std::string *currentFile = nullptr;
+   LintResult *current = nullptr;
+   for (size_t i = begin; i < end; ++i) {
+      const std::string &file = files[i];
+      currentFile = &file;
+      current = &results[i];
+      auto bufferOrError = MemoryBuffer::getFile(file);
+      if (!bufferOrError) {
+         current->report = "Could not open input file: " + file + "\n";
+         current->failed = true;
+         continue;
+      }
+      unsigned bufferId = sourceMgr.addNewSourceBuffer(std::move(*bufferOrError));
+      if (!parser) {
+         // lint only needs to know whether the file parses, the compact
+         // AST is cheaper to build than the syntax tree
+         parser = std::make_unique<Parser>(langOpts, bufferId, sourceMgr, nullptr,
+                                           TriviaRetentionMode::WithoutTrivia);
+         parser->registerSyntaxErrorHandler([&currentFile, &current](StringRef msg, unsigned line, unsigned) {
+            current->report += "Parse error: " + msg.getStr() + " in " + *currentFile +
+                  " on line " + std::to_string(line) + "\n";
+         });
+      } else {
+         parser->reset(bufferId);
+      }
+      if (parser->parse() || !current->report.empty()) {
+         current->report += "Errors parsing " + file + "\n";
+         current->failed = true;
+      } else {
+         current->report = "No syntax errors detected in " + file + "\n";
+      }
+   }
+}
+
+} // anonymous namespace
+
+bool expand_lint_inputs(const std::vector<std::string> &inputs, std::vector<std::string> &files,
+                        std::ostream &errorStream)
+{
+   if (inputs.empty()) {
+      errorStream << "No input files" << std::endl;
+      return false;
+   }
+   std::vector<std::string> expanded;
+   bool succeeded = true;
+   for (const std::string &input : inputs) {
+      std::error_code errorCode;
+      if (stdfs::is_directory(input, errorCode)) {
+         collect_directory_files(input, expanded);
+      } else if (has_glob_wildcard(input) && !stdfs::exists(input, errorCode)) {
+         // keep going, every bad pattern is reported at once
+         succeeded &= collect_glob_files(input, expanded, errorStream);
+      } else {
+         // a missing file is reported by the lint run itself
+         expanded.push_back(input);
+      }
+   }
+   std::set<std::string> seen;
+   for (std::string &file : expanded) {
+      if (seen.insert(file).second) {
+         files.push_back(std::move(file));
+      }
+   }
+   return succeeded;
+}
+
+int lint_files(const std::vector<std::string> &files, unsigned jobs, std::ostream &outStream)
+{
+   std::vector<LintResult> results(files.size());
+   if (jobs == 1 || files.size() <= scg_lintChunkSize) {
+      lint_chunk(files, 0, files.size(), results);
+   } else {
+      // hardware_concurrency() may not know and return 0
+      ThreadPool pool(jobs == 0 ? std::max(1u, std::thread::hardware_concurrency()) : jobs);
+      for (size_t begin = 0; begin < files.size(); begin += scg_lintChunkSize) {
+         size_t end = std::min(begin + scg_lintChunkSize, files.size());
+         pool.async([&files, &results, begin, end] {
+            lint_chunk(files, begin, end, results);
+         });
+      }
+      pool.wait();
+   }
+   bool failed = false;
+   for (const LintResult &result : results) {
+      outStream << result.report;
+      failed |= result.failed;
+   }
+   outStream.flush();
+   return failed ? 255 : 0;
+}
+
+} // polar
@@ -0,0 +1,42 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_ARTIFACTS_LINT_H
+#define POLARPHP_ARTIFACTS_LINT_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace polar {
+
+/// Expand the inputs of a lint run into the files to check. A directory
+/// stands for the .php files below it, an input with * ? or [ is a glob
+/// matched against the files below its leading directory part, the
+/// wildcards match across directories. Anything else is taken as a file.
+/// Every file appears once, in the order of the inputs, the files of a
+/// directory or glob sorted by path.
+///
+/// \return false when there are no inputs, or a glob is invalid or matches
+/// nothing, the reason is printed to \p errorStream
+bool expand_lint_inputs(const std::vector<std::string> &inputs, std::vector<std::string> &files,
+                        std::ostream &errorStream);
+
+/// Syntax check \p files on \p jobs threads, all cores when it is 0. The
+/// report of every file is printed to \p outStream in the order of the
+/// files whatever thread checked them.
+///
+/// \return 0 when all files parsed, 255 like php -l otherwise
+int lint_files(const std::vector<std::string> &files, unsigned jobs, std::ostream &outStream);
+
+} // polar
+
+#endif // POLARPHP_ARTIFACTS_LINT_H
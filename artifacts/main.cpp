@@ -17,6 +17,7 @@
 #include "CLI/CLI.hpp"
 #include "lib/Defs.h"
 #include "lib/Commands.h"
+#include "lib/Lint.h"
 #include "lib/ProcessTitle.h"
 
 #include <vector>
@@ -48,6 +49,7 @@ std::vector<std::string> sg_zendExtensionFilenames{};
 std::vector<std::string> sg_scriptArgs{};
 std::vector<std::string> sg_defines{};
 std::string sg_reflectWhat{};
+unsigned sg_lintJobs = 0;
 
 int main(int argc, char *argv[])
 {
@@ -60,6 +62,18 @@ int main(int argc, char *argv[])
       std::cerr << sg_errorMsg << std::endl;
       exit(sg_exitStatus);
    }
+   if (sg_syntaxCheck) {
+      std::vector<std::string> inputs;
+      if (!sg_scriptFile.empty()) {
+         inputs.push_back(sg_scriptFile);
+      }
+      inputs.insert(inputs.end(), sg_scriptArgs.begin(), sg_scriptArgs.end());
+      std::vector<std::string> files;
+      if (!polar::expand_lint_inputs(inputs, files, std::cerr)) {
+         return 255;
+      }
+      return polar::lint_files(files, sg_lintJobs, std::cout);
+   }
    return 0;
 }
 
@@ -77,7 +91,8 @@ void setup_command_opts(CLI::App &parser)
    parser.add_flag("-a, --interactive", polar::interactive_opt_setter, "Run interactively PHP shell.");
    parser.add_option("-F", CLI::callback_t(polar::everyline_exec_script_filename_opt_setter), "Parse and execute <file> for every input line.")->type_name("<file>");
    parser.add_option("-f", CLI::callback_t(polar::script_file_opt_setter), "Parse and execute <file>.")->type_name("<file>");
-   parser.add_flag("-l, --lint", polar::lint_opt_setter, "Syntax check only (lint)");
+   parser.add_flag("-l, --lint", polar::lint_opt_setter, "Syntax check only (lint), takes files, directories and globs.");
+   parser.add_option("-j, --jobs", sg_lintJobs, "Lint on <n> threads, all cores by default.")->type_name("<n>");
    parser.add_option("-r",CLI::callback_t(polar::code_without_php_tags_opt_setter), "Run PHP <code> without using script tags <?..?>.")->type_name("<code>");
    parser.add_option("-R", CLI::callback_t(polar::everyline_code_opt_setter), "Run PHP <code> for every input line.")->type_name("<code>");
    parser.add_option("-B", CLI::callback_t(polar::begin_code_opt_setter), "Run PHP <begin_code> before processing input lines.")->type_name("<begin_code>");
@@ -0,0 +1,20 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/04.
+
+#include "polarphp/utils/Signals.h"
+#include "polarphp/basic/adt/StringRef.h"
+#include "BenchmarkSupport.h"
+
+int main(int argc, char **argv)
+{
+   polar::utils::print_stack_trace_on_error_signal(argv[0], true);
+   return polar::benchmark::run_benchmarks(argc, argv);
+}
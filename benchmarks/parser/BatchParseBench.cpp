@@ -0,0 +1,83 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Parser.h"
+#include "polarphp/parser/SourceMgr.h"
+
+#include <string>
+#include <vector>
+
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::kernel::LangOptions;
+using polar::parser::Parser;
+using polar::parser::SourceManager;
+
+namespace {
+
+constexpr size_t scg_batchFileCount = 500;
+
+/// Small files, the way a lint run over a project sees them: one short
+/// class each, so the setup of a parse is not buried under the parse
+/// itself.
+std::vector<unsigned> add_batch_files(SourceManager &sourceMgr)
+{
+   std::vector<unsigned> bufferIds;
+   for (size_t i = 0; i < scg_batchFileCount; ++i) {
+      std::string index = std::to_string(i);
+      std::string source = "class Model" + index + " extends Model\n"
+                           "{\n"
+                           "    protected $table = 'model_" + index + "';\n"
+                           "    public function getKey(): int\n"
+                           "    {\n"
+                           "        return $this->attributes['id'] ?? " + index + ";\n"
+                           "    }\n"
+                           "}\n";
+      bufferIds.push_back(sourceMgr.addMemBufferCopy(source));
+   }
+   return bufferIds;
+}
+
+} // anonymous namespace
+
+/// Items are files, a Parser with its Lexer, stacks and arenas is created
+/// for every one of them.
+POLAR_BENCHMARK(BatchParseFreshParser)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   std::vector<unsigned> bufferIds = add_batch_files(sourceMgr);
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (unsigned bufferId : bufferIds) {
+         Parser parser(langOpts, bufferId, sourceMgr, nullptr);
+         do_not_optimize(parser.parse());
+      }
+   }
+   state.setItemsProcessed(state.getIterations() * bufferIds.size());
+}
+
+/// One Parser is reset for every file.
+POLAR_BENCHMARK(BatchParseResetParser)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   std::vector<unsigned> bufferIds = add_batch_files(sourceMgr);
+   Parser parser(langOpts, bufferIds.front(), sourceMgr, nullptr);
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (unsigned bufferId : bufferIds) {
+         parser.reset(bufferId);
+         do_not_optimize(parser.parse());
+      }
+   }
+   state.setItemsProcessed(state.getIterations() * bufferIds.size());
+}
@@ -0,0 +1,146 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/04.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/internal/ScanKernels.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
+
+#include <string>
+
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::kernel::LangOptions;
+using polar::parser::CommentRetentionMode;
+using polar::parser::Lexer;
+using polar::parser::ParsedTrivia;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TriviaRetentionMode;
+using polar::parser::internal::advance_to_end_of_line;
+using polar::parser::internal::set_vector_scan_enabled;
+using polar::parser::internal::skip_to_end_of_slash_star_comment;
+
+namespace {
+
+/// A vendor style class file: every member carries a docblock and most
+/// statements a trailing line comment.
+const std::string &get_comment_dense_source()
+{
+   static std::string source = [] {
+      std::string result;
+      for (int i = 0; i < 2000; ++i) {
+         std::string index = std::to_string(i);
+         result += "    /**\n"
+                   "     * Returns the configured value for the given key, falling back to\n"
+                   "     * the default when the key has not been registered yet.\n"
+                   "     *\n"
+                   "     * @param string $key     the configuration key\n"
+                   "     * @param mixed  $default returned when the key is missing\n"
+                   "     * @return mixed\n"
+                   "     */\n"
+                   "    public function get" + index + "($key, $default = null)\n"
+                   "    {\n"
+                   "        // look the value up in the local cache first, the cache is\n"
+                   "        // invalidated whenever the configuration file changes\n"
+                   "        return $this->items[$key] ?? $default; // fallback\n"
+                   "    }\n\n";
+      }
+      return result;
+   }();
+   return source;
+}
+
+const unsigned char *get_source_start()
+{
+   return reinterpret_cast<const unsigned char *>(get_comment_dense_source().c_str());
+}
+
+const unsigned char *get_source_end()
+{
+   return get_source_start() + get_comment_dense_source().size();
+}
+
+/// Run the comment scanners over every comment in the source, the same
+/// entry points the lexer uses.
+void scan_comments(BenchmarkState &state, bool vector)
+{
+   set_vector_scan_enabled(vector);
+   const unsigned char *start = get_source_start();
+   const unsigned char *end = get_source_end();
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      const unsigned char *cur = start;
+      size_t comments = 0;
+      while (cur < end) {
+         if (cur[0] == '/' && cur[1] == '*') {
+            ++cur;
+            skip_to_end_of_slash_star_comment(cur, end);
+            ++comments;
+         } else if (cur[0] == '/' && cur[1] == '/') {
+            cur += 2;
+            advance_to_end_of_line(cur, end);
+            ++comments;
+         } else {
+            ++cur;
+         }
+      }
+      do_not_optimize(comments);
+   }
+   state.setBytesProcessed(state.getIterations() * get_comment_dense_source().size());
+   set_vector_scan_enabled(true);
+}
+
+void lex_comment_dense_source(BenchmarkState &state, bool vector)
+{
+   set_vector_scan_enabled(vector);
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(get_comment_dense_source());
+   size_t tokenCount = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr, CommentRetentionMode::AttachToNextToken,
+                  TriviaRetentionMode::WithTrivia);
+      Token token;
+      ParsedTrivia leadingTrivia;
+      ParsedTrivia trailingTrivia;
+      do {
+         lexer.lex(token, leadingTrivia, trailingTrivia);
+         ++tokenCount;
+      } while (token.isNot(polar::syntax::TokenKindType::END));
+   }
+   state.setBytesProcessed(state.getIterations() * get_comment_dense_source().size());
+   state.setItemsProcessed(tokenCount);
+   set_vector_scan_enabled(true);
+}
+
+} // anonymous namespace
+
+POLAR_BENCHMARK(CommentScanScalar)
+{
+   scan_comments(state, false);
+}
+
+POLAR_BENCHMARK(CommentScanVector)
+{
+   scan_comments(state, true);
+}
+
+POLAR_BENCHMARK(LexCommentDenseScalar)
+{
+   lex_comment_dense_source(state, false);
+}
+
+POLAR_BENCHMARK(LexCommentDenseVector)
+{
+   lex_comment_dense_source(state, true);
+}
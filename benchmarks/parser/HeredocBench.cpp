@@ -0,0 +1,115 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/basic/adt/IntrusiveRefCountPtr.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/parser/internal/ScanKernels.h"
+
+#include <string>
+
+using polar::basic::IntrusiveRefCountPtr;
+using polar::benchmark::BenchmarkState;
+using polar::kernel::LangOptions;
+using polar::parser::Lexer;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TokenValueArena;
+using polar::parser::internal::set_vector_scan_enabled;
+
+namespace {
+
+/// Template heavy code: every function returns an indented heredoc or
+/// nowdoc of a few dozen lines of markup, the interpolating ones with a
+/// variable every few lines.
+std::string build_template_source(bool nowdoc)
+{
+   std::string label = nowdoc ? "'HTML'" : "HTML";
+   std::string result = "<?php\n";
+   for (int i = 0; i < 200; ++i) {
+      std::string index = std::to_string(i);
+      result += "function render" + index + "($user, $items)\n"
+                "{\n"
+                "    return <<<" + label + "\n";
+      for (int line = 0; line < 40; ++line) {
+         result += "        <div class=\"row row-" + std::to_string(line) +
+               "\"><span class=\"label\">Generated content for the template engine</span>";
+         if (!nowdoc && line % 4 == 0) {
+            result += "<b>{$user->name}</b> $items";
+         }
+         result += "</div>\n";
+      }
+      result += "        HTML;\n"
+                "}\n";
+   }
+   return result;
+}
+
+const std::string &get_heredoc_source()
+{
+   static std::string source = build_template_source(false);
+   return source;
+}
+
+const std::string &get_nowdoc_source()
+{
+   static std::string source = build_template_source(true);
+   return source;
+}
+
+void lex_source(BenchmarkState &state, const std::string &source, bool vector)
+{
+   set_vector_scan_enabled(vector);
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   size_t tokenCount = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr);
+      lexer.setValueArena(valueArena);
+      // strip the closing marker indentation like the parser does
+      lexer.setCheckHeredocIndentation(true);
+      Token token;
+      do {
+         lexer.lex(token);
+         ++tokenCount;
+      } while (token.isNot(polar::syntax::TokenKindType::END));
+   }
+   state.setBytesProcessed(state.getIterations() * source.size());
+   state.setItemsProcessed(tokenCount);
+   set_vector_scan_enabled(true);
+}
+
+} // anonymous namespace
+
+POLAR_BENCHMARK(LexHeredocScalar)
+{
+   lex_source(state, get_heredoc_source(), false);
+}
+
+POLAR_BENCHMARK(LexHeredocVector)
+{
+   lex_source(state, get_heredoc_source(), true);
+}
+
+POLAR_BENCHMARK(LexNowdocScalar)
+{
+   lex_source(state, get_nowdoc_source(), false);
+}
+
+POLAR_BENCHMARK(LexNowdocVector)
+{
+   lex_source(state, get_nowdoc_source(), true);
+}
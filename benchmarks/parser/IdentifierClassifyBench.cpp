@@ -0,0 +1,161 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/basic/CharInfo.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
+
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+using polar::basic::StringRef;
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::parser::Lexer;
+using polar::parser::validate_utf8_character_and_advance;
+using polar::parser::internal::is_valid_identifier_continuation_code_point;
+using polar::parser::internal::is_valid_identifier_start_code_point;
+
+namespace {
+
+/// Identifiers of a localized code base: CJK, Hangul, kana and accented
+/// Latin words mixed with ASCII prefixes and digits.
+const std::vector<std::string> &get_identifiers()
+{
+   static std::vector<std::string> identifiers = [] {
+      const char *words[] = {
+         "\xE7\x94\xA8\xE6\x88\xB7", "\xE8\xAE\xA2\xE5\x8D\x95", "\xE9\x87\x91\xE9\xA2\x9D",
+         "\xE5\x9C\xB0\xE5\x9D\x80", "\xE3\x83\xA6\xE3\x83\xBC\xE3\x82\xB6",
+         "\xEC\x82\xAC\xEC\x9A\xA9\xEC\x9E\x90", "caf\xC3\xA9", "\xC3\xBC" "bersicht", "get", "_", "2"
+      };
+      std::mt19937 rng(20190713);
+      std::vector<std::string> result;
+      for (int i = 0; i < 20000; ++i) {
+         std::string identifier = words[rng() % 8];
+         for (unsigned count = rng() % 4; count > 0; --count) {
+            identifier += words[rng() % std::size(words)];
+         }
+         result.push_back(identifier);
+      }
+      return result;
+   }();
+   return identifiers;
+}
+
+/// The decoded code points of all the identifiers.
+const std::vector<uint32_t> &get_code_points()
+{
+   static std::vector<uint32_t> codePoints = [] {
+      std::vector<uint32_t> result;
+      for (const std::string &identifier : get_identifiers()) {
+         const unsigned char *cur = reinterpret_cast<const unsigned char *>(identifier.data());
+         const unsigned char *end = cur + identifier.size();
+         while (cur < end) {
+            result.push_back(validate_utf8_character_and_advance(cur, end));
+         }
+      }
+      return result;
+   }();
+   return codePoints;
+}
+
+/// The chain of range compares the classification used to be, kept as the
+/// baseline.
+bool is_continuation_in_range_chain(uint32_t c)
+{
+   if (c < 0x80) {
+      return polar::basic::is_identifier_body(c, true);
+   }
+   return c == 0x00A8 || c == 0x00AA || c == 0x00AD || c == 0x00AF
+         || (c >= 0x00B2 && c <= 0x00B5) || (c >= 0x00B7 && c <= 0x00BA)
+         || (c >= 0x00BC && c <= 0x00BE) || (c >= 0x00C0 && c <= 0x00D6)
+         || (c >= 0x00D8 && c <= 0x00F6) || (c >= 0x00F8 && c <= 0x00FF)
+         || (c >= 0x0100 && c <= 0x167F) || (c >= 0x1681 && c <= 0x180D)
+         || (c >= 0x180F && c <= 0x1FFF) || (c >= 0x200B && c <= 0x200D)
+         || (c >= 0x202A && c <= 0x202E) || (c >= 0x203F && c <= 0x2040)
+         || c == 0x2054 || (c >= 0x2060 && c <= 0x206F)
+         || (c >= 0x2070 && c <= 0x218F) || (c >= 0x2460 && c <= 0x24FF)
+         || (c >= 0x2776 && c <= 0x2793) || (c >= 0x2C00 && c <= 0x2DFF)
+         || (c >= 0x2E80 && c <= 0x2FFF) || (c >= 0x3004 && c <= 0x3007)
+         || (c >= 0x3021 && c <= 0x302F) || (c >= 0x3031 && c <= 0x303F)
+         || (c >= 0x3040 && c <= 0xD7FF) || (c >= 0xF900 && c <= 0xFD3D)
+         || (c >= 0xFD40 && c <= 0xFDCF) || (c >= 0xFDF0 && c <= 0xFE44)
+         || (c >= 0xFE47 && c <= 0xFFF8) || (c >= 0x10000 && c <= 0x1FFFD)
+         || (c >= 0x20000 && c <= 0x2FFFD) || (c >= 0x30000 && c <= 0x3FFFD)
+         || (c >= 0x40000 && c <= 0x4FFFD) || (c >= 0x50000 && c <= 0x5FFFD)
+         || (c >= 0x60000 && c <= 0x6FFFD) || (c >= 0x70000 && c <= 0x7FFFD)
+         || (c >= 0x80000 && c <= 0x8FFFD) || (c >= 0x90000 && c <= 0x9FFFD)
+         || (c >= 0xA0000 && c <= 0xAFFFD) || (c >= 0xB0000 && c <= 0xBFFFD)
+         || (c >= 0xC0000 && c <= 0xCFFFD) || (c >= 0xD0000 && c <= 0xDFFFD)
+         || (c >= 0xE0000 && c <= 0xEFFFD);
+}
+
+bool is_start_in_range_chain(uint32_t c)
+{
+   if (!is_continuation_in_range_chain(c)) {
+      return false;
+   }
+   if (c < 0x80 && (polar::basic::is_digit(static_cast<unsigned char>(c)) || c == '$')) {
+      return false;
+   }
+   return !((c >= 0x0300 && c <= 0x036F) || (c >= 0x1DC0 && c <= 0x1DFF) ||
+            (c >= 0x20D0 && c <= 0x20FF) || (c >= 0xFE20 && c <= 0xFE2F));
+}
+
+template <typename StartFunc, typename ContinuationFunc>
+void classify_code_points(BenchmarkState &state, StartFunc isStart, ContinuationFunc isContinuation)
+{
+   const std::vector<uint32_t> &codePoints = get_code_points();
+   size_t valid = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (uint32_t c : codePoints) {
+         valid += isStart(c) + isContinuation(c);
+      }
+   }
+   do_not_optimize(valid);
+   state.setItemsProcessed(state.getIterations() * codePoints.size());
+}
+
+} // anonymous namespace
+
+POLAR_BENCHMARK(ClassifyIdentifierCodePointsRangeChain)
+{
+   classify_code_points(state, is_start_in_range_chain, is_continuation_in_range_chain);
+}
+
+POLAR_BENCHMARK(ClassifyIdentifierCodePointsTable)
+{
+   classify_code_points(state, is_valid_identifier_start_code_point,
+                        is_valid_identifier_continuation_code_point);
+}
+
+/// Decoding included, what checking a name for a syntax node costs.
+POLAR_BENCHMARK(IsIdentifierNonAscii)
+{
+   const std::vector<std::string> &identifiers = get_identifiers();
+   size_t valid = 0;
+   size_t bytes = 0;
+   for (const std::string &identifier : identifiers) {
+      bytes += identifier.size();
+   }
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (const std::string &identifier : identifiers) {
+         valid += Lexer::isIdentifier(StringRef(identifier));
+      }
+   }
+   do_not_optimize(valid);
+   state.setBytesProcessed(state.getIterations() * bytes);
+   state.setItemsProcessed(state.getIterations() * identifiers.size());
+}
@@ -0,0 +1,107 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/basic/adt/IntrusiveRefCountPtr.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/parser/internal/ScanKernels.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
+
+#include <string>
+
+using polar::basic::IntrusiveRefCountPtr;
+using polar::benchmark::BenchmarkState;
+using polar::kernel::LangOptions;
+using polar::parser::Lexer;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TokenValueArena;
+using polar::parser::internal::set_lazy_escape_decoding_enabled;
+using polar::parser::internal::set_vector_scan_enabled;
+
+namespace {
+
+/// Template code without heredocs: markup built from double quoted strings
+/// that interpolate every few dozen bytes, escapes in most of them and a
+/// shell command in backquotes now and then.
+const std::string &get_interpolated_source()
+{
+   static std::string source = [] {
+      std::string result = "<?php\n";
+      for (int i = 0; i < 400; ++i) {
+         std::string index = std::to_string(i);
+         result += "function row" + index + "($user, $item)\n"
+                   "{\n"
+                   "    $html = \"<tr class=\\\"row-" + index + "\\\"><td class=\\\"name\\\">{$user->name}</td>"
+                   "<td class=\\\"price\\\">$item[price] EUR</td>\\n\";\n"
+                   "    $html .= \"<td colspan=\\\"3\\\">Generated content for the template engine, "
+                   "nothing to interpolate on this part of the line</td></tr>\\n\";\n"
+                   "    $title = \"Order #$item[id] placed by ${name} on {$item['date']}\";\n"
+                   "    $files = `ls -la /var/www/templates/$user/cache`;\n"
+                   "    return $html . $title;\n"
+                   "}\n";
+      }
+      return result;
+   }();
+   return source;
+}
+
+void lex_source(BenchmarkState &state, bool vector, bool lazy)
+{
+   const std::string &source = get_interpolated_source();
+   set_vector_scan_enabled(vector);
+   set_lazy_escape_decoding_enabled(lazy);
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   size_t tokenCount = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr);
+      lexer.setValueArena(valueArena);
+      Token token;
+      do {
+         lexer.lex(token);
+         ++tokenCount;
+      } while (token.isNot(polar::syntax::TokenKindType::END));
+   }
+   state.setBytesProcessed(state.getIterations() * source.size());
+   state.setItemsProcessed(tokenCount);
+   set_vector_scan_enabled(true);
+   set_lazy_escape_decoding_enabled(true);
+}
+
+} // anonymous namespace
+
+POLAR_BENCHMARK(LexInterpolatedStringsScalar)
+{
+   lex_source(state, false, true);
+}
+
+POLAR_BENCHMARK(LexInterpolatedStringsVector)
+{
+   lex_source(state, true, true);
+}
+
+/// The escapes are decoded while lexing, the plain runs between them are
+/// moved in one piece.
+POLAR_BENCHMARK(LexInterpolatedStringsEagerScalar)
+{
+   lex_source(state, false, false);
+}
+
+POLAR_BENCHMARK(LexInterpolatedStringsEagerVector)
+{
+   lex_source(state, true, false);
+}
@@ -0,0 +1,126 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "AllocationCounter.h"
+#include "BenchmarkSupport.h"
+#include "LexerCorpus.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/TokenValueArena.h"
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+using polar::basic::IntrusiveRefCountPtr;
+using polar::benchmark::AllocationScope;
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::LexerCorpusKind;
+using polar::benchmark::generate_lexer_corpus;
+using polar::benchmark::get_lexer_corpus_name;
+using polar::benchmark::register_benchmark;
+using polar::benchmark::scg_lexerCorpusKinds;
+using polar::kernel::LangOptions;
+using polar::parser::CommentRetentionMode;
+using polar::parser::Lexer;
+using polar::parser::ParsedTrivia;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TokenValueArena;
+using polar::parser::TriviaRetentionMode;
+using polar::parser::tokenize;
+using polar::syntax::TokenKindType;
+
+namespace {
+
+/// every corpus is about this large, big enough that the per file setup
+/// does not show up in the numbers
+constexpr size_t scg_corpusSize = 1 << 20;
+
+const std::string &get_corpus(LexerCorpusKind kind)
+{
+   static std::string corpora[std::size(scg_lexerCorpusKinds)];
+   std::string &corpus = corpora[static_cast<size_t>(kind)];
+   if (corpus.empty()) {
+      corpus = generate_lexer_corpus(kind, scg_corpusSize);
+   }
+   return corpus;
+}
+
+void report(BenchmarkState &state, const std::string &source, size_t tokenCount,
+            const AllocationScope &allocations)
+{
+   state.setBytesProcessed(state.getIterations() * source.size());
+   state.setItemsProcessed(tokenCount);
+   state.setCounter("allocs/token", tokenCount == 0 ? 0.0
+                                                    : static_cast<double>(allocations.getCount()) / tokenCount);
+}
+
+/// tokenize() the way tools call it, including building the token vector
+void run_tokenize(BenchmarkState &state, LexerCorpusKind kind)
+{
+   const std::string &source = get_corpus(kind);
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   size_t tokenCount = 0;
+   AllocationScope allocations;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+      std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+      tokenCount += tokens.size();
+   }
+   report(state, source, tokenCount, allocations);
+}
+
+/// Lexer::lex() in a loop the way the parser pulls tokens
+void run_lex(BenchmarkState &state, LexerCorpusKind kind, TriviaRetentionMode triviaRetention)
+{
+   const std::string &source = get_corpus(kind);
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   size_t tokenCount = 0;
+   AllocationScope allocations;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr, CommentRetentionMode::AttachToNextToken,
+                  triviaRetention);
+      Token token;
+      ParsedTrivia leadingTrivia;
+      ParsedTrivia trailingTrivia;
+      do {
+         lexer.lex(token, leadingTrivia, trailingTrivia);
+         ++tokenCount;
+      } while (token.isNot(TokenKindType::END));
+   }
+   report(state, source, tokenCount, allocations);
+}
+
+/// Tokenize<Corpus>, LexWithoutTrivia<Corpus> and LexWithTrivia<Corpus> for
+/// every corpus kind.
+const bool sg_lexerBenchmarksRegistered = [] {
+   for (LexerCorpusKind kind : scg_lexerCorpusKinds) {
+      std::string name = get_lexer_corpus_name(kind);
+      register_benchmark("Tokenize" + name, [kind](BenchmarkState &state) {
+         run_tokenize(state, kind);
+      });
+      register_benchmark("LexWithoutTrivia" + name, [kind](BenchmarkState &state) {
+         run_lex(state, kind, TriviaRetentionMode::WithoutTrivia);
+      });
+      register_benchmark("LexWithTrivia" + name, [kind](BenchmarkState &state) {
+         run_lex(state, kind, TriviaRetentionMode::WithTrivia);
+      });
+   }
+   return true;
+}();
+
+} // anonymous namespace
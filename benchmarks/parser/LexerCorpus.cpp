@@ -0,0 +1,277 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "LexerCorpus.h"
+
+#include <random>
+
+namespace polar::benchmark {
+
+namespace {
+
+/// std::mt19937 is specified bit for bit, unlike the distributions, so
+/// only its raw output is used.
+class CorpusBuilder
+{
+public:
+   explicit CorpusBuilder(unsigned seed)
+      : m_rng(seed)
+   {}
+
+   unsigned next(unsigned bound)
+   {
+      return static_cast<unsigned>(m_rng() % bound);
+   }
+
+   template <size_t N>
+   const char *pick(const char *const (&items)[N])
+   {
+      return items[next(N)];
+   }
+
+   std::string identifier()
+   {
+      static const char *const words[] = {
+         "user", "item", "value", "config", "request", "response", "cache", "entity",
+         "repository", "handler", "count", "total", "name", "key", "index", "result"
+      };
+      std::string name = pick(words);
+      if (next(3) == 0) {
+         std::string second = pick(words);
+         second[0] = static_cast<char>(second[0] - 'a' + 'A');
+         name += second;
+      }
+      return name;
+   }
+
+   std::string className()
+   {
+      std::string name = identifier();
+      name[0] = static_cast<char>(name[0] - 'a' + 'A');
+      return name + std::to_string(next(1000));
+   }
+
+   std::string number()
+   {
+      switch (next(8)) {
+      case 0:
+         return std::to_string(next(10));
+      case 1:
+         return std::to_string(m_rng());
+      case 2: {
+         static const char digits[] = "0123456789abcdefABCDEF";
+         std::string hex = "0x";
+         for (unsigned i = 0, count = 1 + next(12); i < count; ++i) {
+            hex += digits[next(22)];
+         }
+         return hex;
+      }
+      case 3: {
+         std::string bin = "0b";
+         for (unsigned i = 0, count = 1 + next(24); i < count; ++i) {
+            bin += static_cast<char>('0' + next(2));
+         }
+         return bin;
+      }
+      case 4:
+         return "0" + std::to_string(next(8)) + std::to_string(next(8)) + std::to_string(next(8));
+      case 5:
+         return std::to_string(next(100000)) + "." + std::to_string(next(1000000));
+      case 6:
+         return "." + std::to_string(next(1000)) + "e-" + std::to_string(next(300));
+      default:
+         return std::to_string(next(100)) + "E+" + std::to_string(next(30));
+      }
+   }
+
+   /// text for the inside of a single quoted string
+   std::string singleQuotedText()
+   {
+      static const char *const pieces[] = {
+         "plain text", " ", "it\\'s", "C:\\\\path\\\\to", "$notVariable", "{braces}", "\\n stays"
+      };
+      std::string text;
+      for (unsigned i = 0, count = next(6); i < count; ++i) {
+         text += pick(pieces);
+      }
+      return text;
+   }
+
+   /// text for the inside of a double quoted string or a heredoc body line,
+   /// \p quote is escaped
+   std::string interpolatedText(char quote)
+   {
+      static const char *const pieces[] = {
+         "hello world", " ", "\\n", "\\t", "\\\\", "\\x41", "\\101", "\\u{1F600}", "\\$",
+         "$user", "{$user->name}", "${value}", "$items[0]", "{$config['key']}", "$this->count"
+      };
+      std::string text;
+      for (unsigned i = 0, count = next(8); i < count; ++i) {
+         text += pick(pieces);
+         if (quote != 0 && next(8) == 0) {
+            text += '\\';
+            text += quote;
+         }
+      }
+      return text;
+   }
+
+   void appendClass(std::string &out)
+   {
+      static const char *const visibilities[] = {"public", "protected", "private"};
+      out += "namespace App\\" + className() + ";\n\n"
+             "use App\\Support\\" + className() + ";\n\n"
+             "final class " + className() + " extends " + className() +
+             " implements \\Countable, \\ArrayAccess\n{\n";
+      for (unsigned i = 0, count = 2 + next(4); i < count; ++i) {
+         out += std::string("    ") + pick(visibilities) + " $" + identifier() +
+               " = " + (next(2) ? "null" : "[]") + ";\n";
+      }
+      for (unsigned i = 0, count = 2 + next(5); i < count; ++i) {
+         std::string a = identifier();
+         std::string b = identifier() + "2";
+         out += std::string("\n    ") + pick(visibilities) +
+               (next(3) == 0 ? " static" : "") + " function " + identifier() +
+               "(array $" + a + ", ?" + className() + " $" + b + " = null): ?int\n"
+               "    {\n"
+               "        if ($" + a + " === null || !isset($this->" + identifier() + "[$" + b + "])) {\n"
+               "            return null;\n"
+               "        }\n"
+               "        foreach ($" + a + " as $key => &$value) {\n"
+               "            $value = $this->" + identifier() + "($key, $value) ?? static::" + identifier() + "();\n"
+               "        }\n"
+               "        return count($" + a + ") <=> $this->" + identifier() + "->" + identifier() + "();\n"
+               "    }\n";
+      }
+      out += "}\n\n";
+   }
+
+   void appendStrings(std::string &out)
+   {
+      for (unsigned i = 0, count = 4 + next(8); i < count; ++i) {
+         std::string var = "$" + identifier();
+         switch (next(4)) {
+         case 0:
+            out += var + " = '" + singleQuotedText() + "';\n";
+            break;
+         case 1:
+            out += var + " = \"" + interpolatedText('"') + "\";\n";
+            break;
+         case 2:
+            out += var + " = '" + singleQuotedText() + "' . \"" + interpolatedText('"') +
+                  "\" . '" + singleQuotedText() + "';\n";
+            break;
+         default:
+            out += var + " = `" + interpolatedText('`') + "`;\n";
+            break;
+         }
+      }
+   }
+
+   void appendHeredocs(std::string &out)
+   {
+      bool nowdoc = next(3) == 0;
+      std::string indent(next(3) * 4, ' ');
+      out += "$" + identifier() + " = <<<" + (nowdoc ? "'EOT'" : "EOT") + "\n";
+      for (unsigned i = 0, count = 2 + next(20); i < count; ++i) {
+         out += indent + "<li class=\"entry\">";
+         out += nowdoc ? singleQuotedText() : interpolatedText(0);
+         out += "</li>\n";
+      }
+      out += indent + "EOT;\n";
+   }
+
+   void appendComments(std::string &out)
+   {
+      std::string name = identifier();
+      out += "/**\n"
+             " * Returns the " + name + " for the given key, falling back to the default\n"
+             " * when nothing has been registered under the key yet.\n"
+             " *\n"
+             " * @param string $key\n"
+             " * @param mixed  $default\n"
+             " * @return mixed\n"
+             " */\n"
+             "function get_" + name + std::to_string(next(1000)) + "($key, $default = null)\n"
+             "{\n"
+             "    // look in the request local cache first\n"
+             "    # entries expire after a minute\n"
+             "    /* the cache is warmed up on boot */\n"
+             "    return $default; // fallback\n"
+             "}\n\n";
+   }
+
+   void appendNumbers(std::string &out)
+   {
+      out += "$" + identifier() + " = [";
+      for (unsigned i = 0, count = 8 + next(16); i < count; ++i) {
+         if (i != 0) {
+            out += ", ";
+         }
+         out += number();
+         if (next(4) == 0) {
+            out += " => " + number();
+         }
+      }
+      out += "];\n$" + identifier() + " = " + number() + " * " + number() + " - -" + number() + ";\n";
+   }
+
+private:
+   std::mt19937 m_rng;
+};
+
+} // anonymous namespace
+
+const char *get_lexer_corpus_name(LexerCorpusKind kind)
+{
+   switch (kind) {
+   case LexerCorpusKind::ClassHeavy:
+      return "ClassHeavy";
+   case LexerCorpusKind::StringHeavy:
+      return "StringHeavy";
+   case LexerCorpusKind::HeredocHeavy:
+      return "HeredocHeavy";
+   case LexerCorpusKind::CommentHeavy:
+      return "CommentHeavy";
+   case LexerCorpusKind::NumericHeavy:
+      return "NumericHeavy";
+   }
+   return "Unknown";
+}
+
+std::string generate_lexer_corpus(LexerCorpusKind kind, size_t targetSize, unsigned seed)
+{
+   CorpusBuilder builder(seed);
+   std::string result;
+   result.reserve(targetSize + 4096);
+   while (result.size() < targetSize) {
+      switch (kind) {
+      case LexerCorpusKind::ClassHeavy:
+         builder.appendClass(result);
+         break;
+      case LexerCorpusKind::StringHeavy:
+         builder.appendStrings(result);
+         break;
+      case LexerCorpusKind::HeredocHeavy:
+         builder.appendHeredocs(result);
+         break;
+      case LexerCorpusKind::CommentHeavy:
+         builder.appendComments(result);
+         break;
+      case LexerCorpusKind::NumericHeavy:
+         builder.appendNumbers(result);
+         break;
+      }
+   }
+   return result;
+}
+
+} // polar::benchmark
@@ -0,0 +1,50 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_BENCHMARKS_PARSER_LEXER_CORPUS_H
+#define POLARPHP_BENCHMARKS_PARSER_LEXER_CORPUS_H
+
+#include <cstddef>
+#include <string>
+
+namespace polar::benchmark {
+
+/// The shapes of source the lexer benchmarks run over, each one stresses a
+/// different group of lexer rules.
+enum class LexerCorpusKind
+{
+   /// namespaces, classes, methods, keywords and punctuators
+   ClassHeavy,
+   /// single and double quoted strings with escapes and interpolations
+   StringHeavy,
+   /// heredocs and nowdocs, indented and interpolated
+   HeredocHeavy,
+   /// docblocks, line and hash comments around little code
+   CommentHeavy,
+   /// decimal, hex, binary, float and exponent literals
+   NumericHeavy
+};
+
+constexpr LexerCorpusKind scg_lexerCorpusKinds[] = {
+   LexerCorpusKind::ClassHeavy, LexerCorpusKind::StringHeavy, LexerCorpusKind::HeredocHeavy,
+   LexerCorpusKind::CommentHeavy, LexerCorpusKind::NumericHeavy
+};
+
+const char *get_lexer_corpus_name(LexerCorpusKind kind);
+
+/// Generate about \p targetSize bytes of valid source of the given kind.
+/// The output only depends on the arguments, the same seed gives the same
+/// corpus on every platform and run, so numbers stay comparable.
+std::string generate_lexer_corpus(LexerCorpusKind kind, size_t targetSize, unsigned seed = 20190713);
+
+} // polar::benchmark
+
+#endif // POLARPHP_BENCHMARKS_PARSER_LEXER_CORPUS_H
@@ -0,0 +1,133 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Parser.h"
+#include "polarphp/parser/SourceMgr.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using polar::basic::StringRef;
+using polar::benchmark::BenchmarkState;
+using polar::kernel::LangOptions;
+using polar::parser::Parser;
+using polar::parser::SourceManager;
+
+namespace {
+
+constexpr size_t scg_malformedFileCount = 300;
+
+enum class Damage
+{
+   None,
+   /// Cut off at a random offset, the way an editor sees a file while it is
+   /// being typed.
+   Truncated,
+   /// A random bit flipped in about one of every hundred bytes.
+   ByteFlipped
+};
+
+std::string make_source(size_t index)
+{
+   std::string id = std::to_string(index);
+   return "class Service" + id + " extends BaseService\n"
+          "{\n"
+          "    private $cache = [];\n"
+          "    public function find(string $key, int $limit = " + id + "): ?array\n"
+          "    {\n"
+          "        if (!isset($this->cache[$key])) {\n"
+          "            $this->cache[$key] = $this->load($key, $limit * 2);\n"
+          "        }\n"
+          "        foreach ($this->cache[$key] as $name => $value) {\n"
+          "            echo \"$name: {$value}\\n\";\n"
+          "        }\n"
+          "        return $this->cache[$key] ?? null;\n"
+          "    }\n"
+          "}\n"
+          "$service = new Service" + id + "();\n"
+          "$service->find('key-" + id + "');\n";
+}
+
+/// The same sources for every kind of damage, so the valid files are the
+/// baseline of the damaged ones. The damage is seeded, runs are comparable.
+std::vector<unsigned> add_files(SourceManager &sourceMgr, Damage damage, size_t &totalBytes)
+{
+   std::mt19937 random(20190713);
+   std::vector<unsigned> bufferIds;
+   totalBytes = 0;
+   for (size_t i = 0; i < scg_malformedFileCount; ++i) {
+      std::string source = make_source(i);
+      if (damage == Damage::Truncated) {
+         source.resize(random() % source.size());
+      } else if (damage == Damage::ByteFlipped) {
+         for (size_t flips = source.size() / 100 + 1; flips != 0; --flips) {
+            source[random() % source.size()] ^= static_cast<char>(1 << (random() % 8));
+         }
+      }
+      totalBytes += source.size();
+      bufferIds.push_back(sourceMgr.addMemBufferCopy(source));
+   }
+   return bufferIds;
+}
+
+/// Items are files, one Parser is reset for every one of them. Errors are
+/// counted, not printed, SyntaxErrors is their number per run.
+void run_malformed_parse(BenchmarkState &state, Damage damage)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   size_t totalBytes = 0;
+   std::vector<unsigned> bufferIds = add_files(sourceMgr, damage, totalBytes);
+   Parser parser(langOpts, bufferIds.front(), sourceMgr, nullptr);
+   size_t errorCount = 0;
+   parser.registerSyntaxErrorHandler([&errorCount](StringRef, unsigned, unsigned) {
+      ++errorCount;
+   });
+   size_t failedCount = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (unsigned bufferId : bufferIds) {
+         parser.reset(bufferId);
+         // every file gets a tree, failed or not
+         if (parser.parse()) {
+            ++failedCount;
+         }
+      }
+   }
+   state.setItemsProcessed(state.getIterations() * bufferIds.size());
+   state.setBytesProcessed(state.getIterations() * totalBytes);
+   if (state.getIterations() != 0) {
+      state.setCounter("FailedFiles", static_cast<double>(failedCount) / state.getIterations());
+      state.setCounter("SyntaxErrors", static_cast<double>(errorCount) / state.getIterations());
+   }
+}
+
+} // anonymous namespace
+
+POLAR_BENCHMARK(MalformedInputValid)
+{
+   run_malformed_parse(state, Damage::None);
+}
+
+/// Most files end inside a class, the parser gives up at the end and the
+/// unparsed rest becomes an unknown statement.
+POLAR_BENCHMARK(MalformedInputTruncated)
+{
+   run_malformed_parse(state, Damage::Truncated);
+}
+
+/// The parser resynchronizes at the next semicolon after every error.
+POLAR_BENCHMARK(MalformedInputByteFlipped)
+{
+   run_malformed_parse(state, Damage::ByteFlipped);
+}
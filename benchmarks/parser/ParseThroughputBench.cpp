@@ -0,0 +1,120 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Parser.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/SyntaxTreeBuilder.h"
+
+#include <string>
+
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::kernel::LangOptions;
+using polar::parser::Parser;
+using polar::parser::SourceManager;
+using polar::parser::SyntaxTreeBuilder;
+using polar::parser::TriviaRetentionMode;
+
+namespace {
+
+/// Ordinary application code: classes with typed methods, control flow,
+/// calls, arrays and string concatenation.
+const std::string &get_parse_source()
+{
+   static std::string source = [] {
+      std::string result;
+      for (int i = 0; i < 200; ++i) {
+         std::string index = std::to_string(i);
+         result += "class Repository" + index + " extends BaseRepository implements Countable\n"
+                   "{\n"
+                   "    private $items = [];\n"
+                   "    const LIMIT = " + index + ";\n"
+                   "    public function add(string $key, $value = null): void\n"
+                   "    {\n"
+                   "        // replace the old value\n"
+                   "        if (isset($this->items[$key]) && $value === null) {\n"
+                   "            unset($this->items[$key]);\n"
+                   "        } elseif (count($this->items) < self::LIMIT * 2 + 1) {\n"
+                   "            $this->items[$key] = $value;\n"
+                   "        } else {\n"
+                   "            throw new OverflowException(\"repository $key is full\");\n"
+                   "        }\n"
+                   "    }\n"
+                   "    public function count(): int\n"
+                   "    {\n"
+                   "        $total = 0;\n"
+                   "        foreach ($this->items as $key => $item) {\n"
+                   "            $total += is_array($item) ? count($item) : 1;\n"
+                   "        }\n"
+                   "        return $total;\n"
+                   "    }\n"
+                   "}\n"
+                   "$repository = new Repository" + index + "();\n"
+                   "$repository->add('key-' . " + index + ", ['id' => " + index + ", 'name' => \"item\"]);\n";
+      }
+      return result;
+   }();
+   return source;
+}
+
+/// Parse \p source into the tree the trivia retention asks for, items are
+/// its nodes, tokens included. BytesPerNode is what the tree takes from its
+/// arena for each of them, TreeBytes what it takes in all.
+void run_parse_throughput(BenchmarkState &state, TriviaRetentionMode triviaRetention,
+                          bool skipFunctionBodies = false)
+{
+   const std::string &source = get_parse_source();
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   size_t nodeCount = 0;
+   size_t allocatedBytes = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      Parser parser(langOpts, bufferId, sourceMgr, nullptr, triviaRetention);
+      parser.setSkipFunctionBodies(skipFunctionBodies);
+      bool failed = parser.parse();
+      do_not_optimize(failed);
+      const SyntaxTreeBuilder &builder = parser.getSyntaxTreeBuilder();
+      nodeCount += builder.getNodeCount();
+      allocatedBytes += builder.getAllocatedBytes();
+   }
+   state.setBytesProcessed(state.getIterations() * source.size());
+   state.setItemsProcessed(nodeCount);
+   if (nodeCount != 0) {
+      state.setCounter("BytesPerNode", static_cast<double>(allocatedBytes) / nodeCount);
+      state.setCounter("TreeBytes", static_cast<double>(allocatedBytes) / state.getIterations());
+   }
+}
+
+} // anonymous namespace
+
+/// The full syntax tree: node headers, layouts, token text and comment
+/// trivia.
+POLAR_BENCHMARK(ParseThroughput)
+{
+   run_parse_throughput(state, TriviaRetentionMode::WithTrivia);
+}
+
+/// The same source into the compact AST, kinds, ranges and children only,
+/// the lexer skips the trivia.
+POLAR_BENCHMARK(ParseThroughputAst)
+{
+   run_parse_throughput(state, TriviaRetentionMode::WithoutTrivia);
+}
+
+/// Declarations only, the way an indexer parses a vendor tree: method
+/// bodies are skipped by brace matching, the statements are never parsed.
+POLAR_BENCHMARK(ParseThroughputSkipBodies)
+{
+   run_parse_throughput(state, TriviaRetentionMode::WithoutTrivia, true);
+}
@@ -0,0 +1,98 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/10.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
+
+#include <string>
+
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::kernel::LangOptions;
+using polar::parser::Lexer;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::internal::set_lazy_escape_decoding_enabled;
+using polar::syntax::TokenKindType;
+
+namespace {
+
+/// A translation table and a query builder, nearly every token is a string
+/// literal and only a few of them contain escapes.
+const std::string &get_string_heavy_source()
+{
+   static std::string source = [] {
+      std::string result = "return [\n";
+      for (int i = 0; i < 3000; ++i) {
+         std::string index = std::to_string(i);
+         result += "    'messages.validation.field_" + index + "' => 'The :attribute field " + index +
+               " must be a valid value.',\n"
+               "    'messages.hint_" + index + "' => \"Don't forget the :attribute field\",\n";
+         if (i % 10 == 0) {
+            result += "    'messages.multiline_" + index + "' => \"first line\\nsecond line\\t(" +
+                  index + ")\",\n"
+                  "    'messages.quoted_" + index + "' => 'it\\'s the :attribute field',\n";
+         }
+      }
+      result += "];\n";
+      for (int i = 0; i < 1000; ++i) {
+         result += "$query = \"SELECT id, name, email FROM users WHERE status = ? AND created_at > ?\";\n"
+                   "$query .= ' ORDER BY created_at DESC LIMIT 50';\n";
+      }
+      return result;
+   }();
+   return source;
+}
+
+void lex_string_heavy_source(BenchmarkState &state, bool lazy, bool readValues)
+{
+   set_lazy_escape_decoding_enabled(lazy);
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(get_string_heavy_source());
+   size_t tokenCount = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr);
+      Token token;
+      size_t valueBytes = 0;
+      do {
+         lexer.lex(token);
+         if (readValues && token.getValueType() == Token::ValueType::String) {
+            valueBytes += token.getStringValue().size();
+         }
+         ++tokenCount;
+      } while (token.isNot(TokenKindType::END));
+      do_not_optimize(valueBytes);
+   }
+   state.setBytesProcessed(state.getIterations() * get_string_heavy_source().size());
+   state.setItemsProcessed(tokenCount);
+   set_lazy_escape_decoding_enabled(true);
+}
+
+} // anonymous namespace
+
+POLAR_BENCHMARK(LexStringHeavyEager)
+{
+   lex_string_heavy_source(state, false, false);
+}
+
+POLAR_BENCHMARK(LexStringHeavyLazy)
+{
+   lex_string_heavy_source(state, true, false);
+}
+
+POLAR_BENCHMARK(LexStringHeavyLazyReadValues)
+{
+   lex_string_heavy_source(state, true, true);
+}
@@ -0,0 +1,117 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "AllocationCounter.h"
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+
+#include <string>
+
+using polar::benchmark::AllocationScope;
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::kernel::LangOptions;
+using polar::parser::CommentRetentionMode;
+using polar::parser::Lexer;
+using polar::parser::ParsedTrivia;
+using polar::parser::ParsedTriviaPiece;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TriviaRetentionMode;
+using polar::syntax::TokenKindType;
+
+namespace {
+
+/// Commented code, most statements have more trivia pieces than a
+/// ParsedTrivia keeps inline, so a copy of them goes to the heap.
+const std::string &get_handoff_source()
+{
+   static std::string source = [] {
+      std::string result;
+      for (int i = 0; i < 2000; ++i) {
+         std::string index = std::to_string(i);
+         result += "    // load the value of key " + index + "\n"
+                   "    /* cached */\n"
+                   "    $value" + index + " = $cache->get('key-" + index + "');   // may be null\n"
+                   "    if ($value" + index + " === null) {\n"
+                   "        /** @var int $count */\n"
+                   "        $count = $count + " + index + ";\n"
+                   "    }\n";
+      }
+      return result;
+   }();
+   return source;
+}
+
+/// Pull every token the way the parser does, \p copying repeats the copies
+/// of the handoff the parser used to make: the token into a local and into
+/// the parser, the trivia out of the lexer. Reports the allocations and the
+/// bytes copied for every token.
+void run_token_handoff(BenchmarkState &state, bool copying)
+{
+   const std::string &source = get_handoff_source();
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   size_t tokenCount = 0;
+   size_t copiedBytes = 0;
+   AllocationScope allocations;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr, CommentRetentionMode::AttachToNextToken,
+                  TriviaRetentionMode::WithTrivia);
+      ParsedTrivia leadingTrivia;
+      ParsedTrivia trailingTrivia;
+      Token parserToken;
+      const Token *token;
+      do {
+         token = &lexer.lexInPlace(leadingTrivia, trailingTrivia);
+         if (copying) {
+            Token local = *token;
+            parserToken = local;
+            ParsedTrivia leadingCopy = {leadingTrivia};
+            ParsedTrivia trailingCopy = {trailingTrivia};
+            do_not_optimize(parserToken);
+            do_not_optimize(leadingCopy);
+            do_not_optimize(trailingCopy);
+            copiedBytes += 2 * sizeof(Token) +
+                  (leadingTrivia.size() + trailingTrivia.size()) * sizeof(ParsedTriviaPiece);
+         } else {
+            do_not_optimize(*token);
+         }
+         ++tokenCount;
+      } while (token->isNot(TokenKindType::END));
+   }
+   state.setBytesProcessed(state.getIterations() * source.size());
+   state.setItemsProcessed(tokenCount);
+   if (tokenCount != 0) {
+      state.setCounter("allocs/token", static_cast<double>(allocations.getCount()) / tokenCount);
+      state.setCounter("CopiedBytes/token", static_cast<double>(copiedBytes) / tokenCount);
+   }
+}
+
+} // anonymous namespace
+
+/// The handoff before the parser read tokens in place: two token copies
+/// and a copy of each trivia vector for every token.
+POLAR_BENCHMARK(TokenHandoffCopying)
+{
+   run_token_handoff(state, true);
+}
+
+/// The parser's handoff: the token stays the lexer's, the trivia are
+/// swapped, nothing is copied and nothing allocated once the vectors have
+/// grown.
+POLAR_BENCHMARK(TokenHandoffInPlace)
+{
+   run_token_handoff(state, false);
+}
@@ -0,0 +1,157 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/12.
+
+#include "BenchmarkSupport.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/syntax/TokenKinds.h"
+#include "polarphp/utils/RawOutStream.h"
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using polar::basic::IntrusiveRefCountPtr;
+using polar::benchmark::BenchmarkState;
+using polar::benchmark::do_not_optimize;
+using polar::kernel::LangOptions;
+using polar::parser::Lexer;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TokenValueArena;
+using polar::syntax::TokenCategory;
+using polar::syntax::TokenDescItem;
+using polar::syntax::TokenKindType;
+using polar::utils::RawNullOutStream;
+
+namespace {
+
+/// The lexed tokens of a plain class heavy source, keywords, punctuators
+/// and identifiers in the mix a token dump usually sees.
+const std::vector<Token> &get_dump_tokens()
+{
+   static std::vector<Token> tokens = [] {
+      std::string source;
+      for (int i = 0; i < 500; ++i) {
+         std::string index = std::to_string(i);
+         source += "namespace App\\Model" + index + ";\n"
+                   "use App\\Support\\Collection;\n"
+                   "final class Entity" + index + " extends Base implements Countable\n"
+                   "{\n"
+                   "    private $items = [];\n"
+                   "    public function count(): int { return count($this->items) + " + index + "; }\n"
+                   "    public static function make(array $items = null) {\n"
+                   "        if ($items !== null && !empty($items)) { return new static($items); }\n"
+                   "        foreach ($items as $key => $value) { yield $key => $value * 2.5; }\n"
+                   "    }\n"
+                   "}\n";
+      }
+      static LangOptions langOpts;
+      static SourceManager sourceMgr;
+      unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+      // string values live in the value arena, it has to outlive the lexer
+      static IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+      Lexer lexer(langOpts, sourceMgr, bufferId, nullptr);
+      lexer.setValueArena(valueArena);
+      std::vector<Token> result;
+      Token token;
+      do {
+         lexer.lex(token);
+         result.push_back(token);
+      } while (token.isNot(TokenKindType::END));
+      return result;
+   }();
+   return tokens;
+}
+
+using ReferenceDescItem = std::tuple<const std::string, const std::string, TokenCategory>;
+
+/// The ordered map the token descriptions used to be kept in, rebuilt
+/// from the generated records to have a baseline to compare with.
+const std::map<TokenKindType, ReferenceDescItem> &get_reference_desc_map()
+{
+   static std::map<TokenKindType, ReferenceDescItem> descMap = [] {
+      std::map<TokenKindType, ReferenceDescItem> result;
+      for (std::size_t kind = 0; kind < polar::syntax::get_token_kind_count(); ++kind) {
+         const TokenDescItem *entry = polar::syntax::find_token_desc_entry(static_cast<TokenKindType>(kind));
+         if (entry != nullptr) {
+            result.emplace(entry->kind, ReferenceDescItem(entry->name.getStr(), entry->desc.getStr(),
+                                                          entry->category));
+         }
+      }
+      return result;
+   }();
+   return descMap;
+}
+
+bool is_reference_keyword_or_punctuator(TokenCategory category)
+{
+   return category == TokenCategory::Keyword || category == TokenCategory::DeclKeyword ||
+         category == TokenCategory::StmtKeyword || category == TokenCategory::ExprKeyword ||
+         category == TokenCategory::Punctuator;
+}
+
+} // anonymous namespace
+
+/// Print the kind name of every token and check whether its text would be
+/// printed too, the metadata part of Token::dump().
+POLAR_BENCHMARK(PrintTokenKindsMapLookup)
+{
+   const std::vector<Token> &tokens = get_dump_tokens();
+   const std::map<TokenKindType, ReferenceDescItem> &descMap = get_reference_desc_map();
+   RawNullOutStream outStream;
+   size_t withText = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (const Token &token : tokens) {
+         // the old code looked the kind up once for the name and once more
+         // for the category
+         outStream << std::get<0>(descMap.find(token.getKind())->second);
+         if (is_reference_keyword_or_punctuator(std::get<2>(descMap.at(token.getKind())))) {
+            ++withText;
+         }
+      }
+   }
+   do_not_optimize(withText);
+   state.setItemsProcessed(state.getIterations() * tokens.size());
+}
+
+POLAR_BENCHMARK(PrintTokenKindsDenseTable)
+{
+   const std::vector<Token> &tokens = get_dump_tokens();
+   RawNullOutStream outStream;
+   size_t withText = 0;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (const Token &token : tokens) {
+         polar::syntax::dump_token_kind(outStream, token.getKind());
+         if (polar::syntax::is_keyword_token(token.getKind()) ||
+             polar::syntax::is_punctuator_token(token.getKind())) {
+            ++withText;
+         }
+      }
+   }
+   do_not_optimize(withText);
+   state.setItemsProcessed(state.getIterations() * tokens.size());
+}
+
+POLAR_BENCHMARK(DumpTokens)
+{
+   const std::vector<Token> &tokens = get_dump_tokens();
+   RawNullOutStream outStream;
+   for (size_t i = 0; i < state.getIterations(); ++i) {
+      for (const Token &token : tokens) {
+         token.dump(outStream);
+      }
+   }
+   state.setItemsProcessed(state.getIterations() * tokens.size());
+}
@@ -0,0 +1,159 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace polar::benchmark {
+
+namespace {
+
+std::atomic<uint64_t> sg_allocationCount{0};
+
+void *counted_allocate(std::size_t size)
+{
+   sg_allocationCount.fetch_add(1, std::memory_order_relaxed);
+   // malloc(0) may return nullptr, operator new must not
+   return std::malloc(size == 0 ? 1 : size);
+}
+
+void *counted_allocate_or_throw(std::size_t size)
+{
+   void *ptr = counted_allocate(size);
+   if (ptr == nullptr) {
+      throw std::bad_alloc();
+   }
+   return ptr;
+}
+
+void *counted_allocate_aligned(std::size_t size, std::align_val_t align)
+{
+   sg_allocationCount.fetch_add(1, std::memory_order_relaxed);
+   std::size_t alignment = static_cast<std::size_t>(align);
+   if (alignment < sizeof(void *)) {
+      alignment = sizeof(void *);
+   }
+#if defined(_WIN32)
+   return _aligned_malloc(size == 0 ? 1 : size, alignment);
+#else
+   void *ptr = nullptr;
+   if (posix_memalign(&ptr, alignment, size == 0 ? 1 : size) != 0) {
+      return nullptr;
+   }
+   return ptr;
+#endif
+}
+
+void *counted_allocate_aligned_or_throw(std::size_t size, std::align_val_t align)
+{
+   void *ptr = counted_allocate_aligned(size, align);
+   if (ptr == nullptr) {
+      throw std::bad_alloc();
+   }
+   return ptr;
+}
+
+void free_aligned(void *ptr)
+{
+#if defined(_WIN32)
+   _aligned_free(ptr);
+#else
+   std::free(ptr);
+#endif
+}
+
+} // anonymous namespace
+
+uint64_t get_allocation_count()
+{
+   return sg_allocationCount.load(std::memory_order_relaxed);
+}
+
+} // polar::benchmark
+
+using polar::benchmark::counted_allocate;
+using polar::benchmark::counted_allocate_or_throw;
+using polar::benchmark::counted_allocate_aligned;
+using polar::benchmark::counted_allocate_aligned_or_throw;
+using polar::benchmark::free_aligned;
+
+void *operator new(std::size_t size)
+{
+   return counted_allocate_or_throw(size);
+}
+
+void *operator new[](std::size_t size)
+{
+   return counted_allocate_or_throw(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+   return counted_allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+   return counted_allocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+   return counted_allocate_aligned_or_throw(size, align);
+}
+
+void *operator new[](std::size_t size, std::align_val_t align)
+{
+   return counted_allocate_aligned_or_throw(size, align);
+}
+
+void operator delete(void *ptr) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+   free_aligned(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+   free_aligned(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+   free_aligned(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept
+{
+   free_aligned(ptr);
+}
@@ -0,0 +1,46 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_BENCHMARKS_SUPPORT_ALLOCATION_COUNTER_H
+#define POLARPHP_BENCHMARKS_SUPPORT_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace polar::benchmark {
+
+/// The number of heap allocations made through the global operator new so
+/// far, on all threads.
+///
+/// The counting operator new lives in the same object file as this
+/// function, so it is only linked into the benchmarks that call it and the
+/// others keep the plain allocator.
+uint64_t get_allocation_count();
+
+/// Counts the allocations made during its lifetime.
+class AllocationScope
+{
+public:
+   AllocationScope()
+      : m_start(get_allocation_count())
+   {}
+
+   uint64_t getCount() const
+   {
+      return get_allocation_count() - m_start;
+   }
+
+private:
+   uint64_t m_start;
+};
+
+} // polar::benchmark
+
+#endif // POLARPHP_BENCHMARKS_SUPPORT_ALLOCATION_COUNTER_H
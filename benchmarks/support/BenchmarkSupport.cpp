@@ -0,0 +1,137 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/04.
+
+#include "BenchmarkSupport.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace polar::benchmark {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct RegisteredBenchmark
+{
+   std::string name;
+   BenchmarkFunc func;
+};
+
+std::vector<RegisteredBenchmark> &get_benchmarks()
+{
+   static std::vector<RegisteredBenchmark> benchmarks;
+   return benchmarks;
+}
+
+double seconds_since(Clock::time_point start)
+{
+   return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void print_result(const std::string &name, const BenchmarkState &state, double seconds)
+{
+   size_t iterations = state.getIterations();
+   std::printf("%-48s %12zu %14.1f ns/iter", name.c_str(), iterations,
+               seconds * 1e9 / static_cast<double>(iterations));
+   if (state.getBytesProcessed() != 0) {
+      std::printf(" %10.1f MB/s", static_cast<double>(state.getBytesProcessed()) / seconds / (1024.0 * 1024.0));
+   }
+   if (state.getItemsProcessed() != 0) {
+      std::printf(" %12.0f items/s", static_cast<double>(state.getItemsProcessed()) / seconds);
+   }
+   for (auto &counter : state.getCounters()) {
+      std::printf(" %s=%g", counter.first.c_str(), counter.second);
+   }
+   std::printf("\n");
+}
+
+} // anonymous namespace
+
+BenchmarkState &BenchmarkState::setCounter(const std::string &name, double value)
+{
+   for (auto &counter : m_counters) {
+      if (counter.first == name) {
+         counter.second = value;
+         return *this;
+      }
+   }
+   m_counters.emplace_back(name, value);
+   return *this;
+}
+
+void BenchmarkState::pauseTiming(const std::function<void()> &callback)
+{
+   Clock::time_point start = Clock::now();
+   callback();
+   m_pausedSeconds += seconds_since(start);
+}
+
+bool register_benchmark(const std::string &name, BenchmarkFunc func)
+{
+   get_benchmarks().push_back({name, std::move(func)});
+   return true;
+}
+
+int run_benchmarks(int argc, char **argv)
+{
+   std::string filter;
+   double minTime = 0.5;
+   bool listOnly = false;
+   for (int i = 1; i < argc; ++i) {
+      const char *arg = argv[i];
+      if (std::strncmp(arg, "--filter=", 9) == 0) {
+         filter = arg + 9;
+      } else if (std::strncmp(arg, "--min-time=", 11) == 0) {
+         minTime = std::atof(arg + 11);
+      } else if (std::strcmp(arg, "--list") == 0) {
+         listOnly = true;
+      } else {
+         std::fprintf(stderr, "unknown option: %s\n", arg);
+         return 1;
+      }
+   }
+   std::vector<RegisteredBenchmark> benchmarks = get_benchmarks();
+   std::sort(benchmarks.begin(), benchmarks.end(),
+             [](const RegisteredBenchmark &lhs, const RegisteredBenchmark &rhs) {
+      return lhs.name < rhs.name;
+   });
+   for (RegisteredBenchmark &benchmark : benchmarks) {
+      if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+         continue;
+      }
+      if (listOnly) {
+         std::printf("%s\n", benchmark.name.c_str());
+         continue;
+      }
+      size_t iterations = 1;
+      while (true) {
+         BenchmarkState state(iterations);
+         Clock::time_point start = Clock::now();
+         benchmark.func(state);
+         double seconds = seconds_since(start) - state.getPausedSeconds();
+         if (seconds >= minTime || iterations >= (size_t(1) << 40)) {
+            print_result(benchmark.name, state, std::max(seconds, 1e-9));
+            break;
+         }
+         // aim a bit past the minimum time so the next round is the last one
+         double scale = seconds > 0 ? (minTime * 1.4) / seconds : 100.0;
+         scale = std::min(std::max(scale, 2.0), 100.0);
+         iterations = static_cast<size_t>(static_cast<double>(iterations) * scale);
+      }
+   }
+   return 0;
+}
+
+} // polar::benchmark
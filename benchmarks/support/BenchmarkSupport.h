@@ -0,0 +1,133 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/04.
+
+#ifndef POLARPHP_BENCHMARKS_SUPPORT_BENCHMARK_SUPPORT_H
+#define POLARPHP_BENCHMARKS_SUPPORT_BENCHMARK_SUPPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace polar::benchmark {
+
+/// Handed to every benchmark body. The body runs its workload
+/// getIterations() times and reports how much work that was, the runner
+/// takes care of timing and of picking an iteration count that runs long
+/// enough to be measured.
+class BenchmarkState
+{
+public:
+   explicit BenchmarkState(size_t iterations)
+      : m_iterations(iterations)
+   {}
+
+   size_t getIterations() const
+   {
+      return m_iterations;
+   }
+
+   /// total bytes processed over all iterations, reported as MB/s
+   BenchmarkState &setBytesProcessed(uint64_t bytes)
+   {
+      m_bytesProcessed = bytes;
+      return *this;
+   }
+
+   /// total items (tokens, files, ...) processed over all iterations,
+   /// reported as items/s
+   BenchmarkState &setItemsProcessed(uint64_t items)
+   {
+      m_itemsProcessed = items;
+      return *this;
+   }
+
+   /// extra value printed as is next to the timings, for example a
+   /// memory usage or an allocation count
+   BenchmarkState &setCounter(const std::string &name, double value);
+
+   /// Time spent in the callback is not counted, use it for per iteration
+   /// setup that should not show up in the numbers.
+   void pauseTiming(const std::function<void()> &callback);
+
+   uint64_t getBytesProcessed() const
+   {
+      return m_bytesProcessed;
+   }
+
+   uint64_t getItemsProcessed() const
+   {
+      return m_itemsProcessed;
+   }
+
+   const std::vector<std::pair<std::string, double>> &getCounters() const
+   {
+      return m_counters;
+   }
+
+   double getPausedSeconds() const
+   {
+      return m_pausedSeconds;
+   }
+
+private:
+   size_t m_iterations;
+   uint64_t m_bytesProcessed = 0;
+   uint64_t m_itemsProcessed = 0;
+   double m_pausedSeconds = 0;
+   std::vector<std::pair<std::string, double>> m_counters;
+};
+
+using BenchmarkFunc = std::function<void(BenchmarkState &)>;
+
+/// Add a benchmark to the process wide list, returns true so it can be
+/// used to initialize a static.
+bool register_benchmark(const std::string &name, BenchmarkFunc func);
+
+/// Run all registered benchmarks whose name contains the filter given on the
+/// command line. Understands:
+///   --filter=<substring>   only run matching benchmarks
+///   --min-time=<seconds>   minimum measured time per benchmark, default 0.5
+///   --list                 print the benchmark names and exit
+int run_benchmarks(int argc, char **argv);
+
+/// Keep the compiler from optimizing away a value that is otherwise unused.
+template <typename T>
+inline void do_not_optimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+   asm volatile("" : : "r,m"(value) : "memory");
+#else
+   static volatile const void *sink;
+   sink = &value;
+#endif
+}
+
+} // polar::benchmark
+
+#define POLAR_BENCHMARK_CONCAT_IMPL(lhs, rhs) lhs##rhs
+#define POLAR_BENCHMARK_CONCAT(lhs, rhs) POLAR_BENCHMARK_CONCAT_IMPL(lhs, rhs)
+
+/// Define and register a benchmark body:
+///
+///   POLAR_BENCHMARK(lexSmallFile)
+///   {
+///      for (size_t i = 0; i < state.getIterations(); ++i) { ... }
+///   }
+#define POLAR_BENCHMARK(name) \
+   static void name(::polar::benchmark::BenchmarkState &state); \
+   static const bool POLAR_BENCHMARK_CONCAT(sg_benchmarkRegistered_, name) = \
+      ::polar::benchmark::register_benchmark(#name, name); \
+   static void name(::polar::benchmark::BenchmarkState &state)
+
+#endif // POLARPHP_BENCHMARKS_SUPPORT_BENCHMARK_SUPPORT_H
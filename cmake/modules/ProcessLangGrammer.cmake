@@ -19,7 +19,6 @@ set(POLAR_GENERATED_LEX_HEADER_FILE ${POLAR_PARSER_INCLUDE_DIR}/internal/YYLexer
 
 set(POLAR_GENERATED_PARSER_IMPL_FILE ${POLAR_PARSER_SRC_DIR}/impl/YYParser.cpp)
 set(POLAR_GENERATED_PARSER_HEADER_FILE ${POLAR_PARSER_INCLUDE_DIR}/internal/YYParserDefs.h)
-set(POLAR_GENERATED_PARSER_LOC_HEADER_FILE ${POLAR_PARSER_INCLUDE_DIR}/internal/YYLocation.h)
 set(POLAR_GRAMMER_FILE ${POLAR_PARSER_INCLUDE_DIR}/LangGrammer.y)
 
 re2c_target(NAME PolarRe2cLangLexer
@@ -30,8 +29,7 @@ re2c_target(NAME PolarRe2cLangLexer
 file(MD5 ${POLAR_GRAMMER_FILE} grammerFileHash)
 
 if ((NOT EXISTS ${POLAR_GENERATED_PARSER_IMPL_FILE} OR
-      NOT EXISTS ${POLAR_GENERATED_PARSER_HEADER_FILE} OR
-      NOT EXISTS ${POLAR_GENERATED_PARSER_LOC_HEADER_FILE})
+      NOT EXISTS ${POLAR_GENERATED_PARSER_HEADER_FILE})
       OR (NOT (POLAR_GRAMMER_FILE_MD5 AND POLAR_GRAMMER_FILE_MD5 STREQUAL grammerFileHash)))
    execute_process(COMMAND ${BISON_EXECUTABLE}
       "-d" ${POLAR_PARSER_INCLUDE_DIR}/LangGrammer.y
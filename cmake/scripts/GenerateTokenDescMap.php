@@ -82,7 +82,7 @@ $tokenTypeMap = array(
 $tokenDescItems = array();
 foreach($tokenInfoMap as $type => $tokens) {
    foreach($tokens as $token) {
-      $tokenDescItems[] = "{TokenKindType::$token[0], {\"$token[0]\", \"$token[1]\", $tokenTypeMap[$type]}},";
+      $tokenDescItems[] = "{TokenKindType::$token[0], \"$token[0]\", \"$token[1]\", $tokenTypeMap[$type]},";
    }
 }
 
@@ -91,7 +91,7 @@ if (!file_exists($tokenDescMapTplFile)) {
 }
 
 $fileContent = file_get_contents($tokenDescMapTplFile);
-$fileContent = str_replace("__TOKEN_RECORDS__", implode("\n      ", $tokenDescItems), $fileContent);
+$fileContent = str_replace("__TOKEN_RECORDS__", implode("\n   ", $tokenDescItems), $fileContent);
 
 $oldMd5 = md5_file($tokenDescMapFile);
 $newMd5 = md5($fileContent);
@@ -0,0 +1,56 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_AST_AST_ARENA_H
+#define POLARPHP_AST_AST_ARENA_H
+
+#include "polarphp/basic/adt/IntrusiveRefCountPtr.h"
+#include "polarphp/utils/Allocator.h"
+
+namespace polar::ast {
+
+using polar::basic::ThreadSafeRefCountedBase;
+using polar::utils::BumpPtrAllocator;
+
+/// Memory manager for AstNode, the nodes are never destroyed one by one,
+/// the arena frees all of them at once.
+class AstArena : public ThreadSafeRefCountedBase<AstArena>
+{
+public:
+   AstArena()
+   {}
+
+   AstArena(const AstArena &) = delete;
+   AstArena &operator=(const AstArena &) = delete;
+
+   BumpPtrAllocator &getAllocator()
+   {
+      return m_allocator;
+   }
+
+   void *allocate(size_t size, size_t alignment)
+   {
+      return m_allocator.allocate(size, alignment);
+   }
+
+   /// Free all nodes but keep the first slab, no node may be used anymore.
+   void reset()
+   {
+      m_allocator.reset();
+   }
+
+private:
+   BumpPtrAllocator m_allocator;
+};
+
+} // polar::ast
+
+#endif // POLARPHP_AST_AST_ARENA_H
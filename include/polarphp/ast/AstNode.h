@@ -0,0 +1,136 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_AST_AST_NODE_H
+#define POLARPHP_AST_AST_NODE_H
+
+#include "polarphp/basic/adt/ArrayRef.h"
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/parser/SourceLoc.h"
+#include "polarphp/syntax/TokenKinds.h"
+#include "polarphp/utils/TrailingObjects.h"
+
+#include <cassert>
+#include <cstdint>
+
+namespace polar::ast {
+
+class AstArena;
+
+using polar::basic::ArrayRef;
+using polar::basic::StringRef;
+using polar::parser::CharSourceRange;
+using polar::parser::SourceLoc;
+using polar::syntax::TokenKindType;
+using polar::utils::TrailingObjects;
+
+enum class AstNodeKind : std::uint16_t
+{
+#define AST_NODE(Id, SyntaxKind) Id,
+#include "polarphp/ast/AstNodeKindDefs.h"
+};
+
+StringRef get_ast_node_kind_name(AstNodeKind kind);
+
+/// A node of the compact AST the parser builds when the lexer keeps no
+/// trivia: a kind, a source range and the children, 24 bytes and a pointer
+/// for every child. No text is copied, the text of a node is its range of
+/// the source buffer, which has to outlive the tree. Tokens are the leaves,
+/// of kind Token.
+///
+/// Nodes are allocated in an AstArena, which frees them all at once.
+class AstNode final : private TrailingObjects<AstNode, AstNode *>
+{
+public:
+   /// A node of the reduction of \p children, null children are missing
+   /// optional parts. Its range covers the ranges of the children.
+   static AstNode *make(AstArena &arena, AstNodeKind kind, ArrayRef<AstNode *> children);
+   static AstNode *makeToken(AstArena &arena, TokenKindType tokenKind, CharSourceRange range);
+   /// A node of source the parser skipped, \p range. It has one child, null
+   /// until the source is parsed, see setSkippedChild().
+   static AstNode *makeSkipped(AstArena &arena, AstNodeKind kind, CharSourceRange range);
+
+   AstNode(const AstNode &) = delete;
+   AstNode &operator=(const AstNode &) = delete;
+
+   AstNodeKind getKind() const
+   {
+      return m_kind;
+   }
+
+   bool isToken() const
+   {
+      return m_kind == AstNodeKind::Token;
+   }
+
+   TokenKindType getTokenKind() const
+   {
+      assert(isToken() && "not a token");
+      return static_cast<TokenKindType>(m_tokenKind);
+   }
+
+   /// Invalid for a node without tokens, an empty list for example.
+   CharSourceRange getRange() const
+   {
+      return CharSourceRange(m_start, m_length);
+   }
+
+   SourceLoc getStartLoc() const
+   {
+      return m_start;
+   }
+
+   /// The source text of the node, comments and whitespace between its
+   /// tokens included.
+   StringRef getText() const
+   {
+      return StringRef(static_cast<const char *>(m_start.getOpaquePointerValue()), m_length);
+   }
+
+   size_t getNumChildren() const
+   {
+      return m_numChildren;
+   }
+
+   ArrayRef<AstNode *> getChildren() const
+   {
+      return ArrayRef<AstNode *>(getTrailingObjects<AstNode *>(), m_numChildren);
+   }
+
+   AstNode *getChild(size_t index) const
+   {
+      assert(index < m_numChildren && "child index out of range");
+      return getTrailingObjects<AstNode *>()[index];
+   }
+
+   /// The node of the parsed source of a node made by makeSkipped().
+   void setSkippedChild(AstNode *child)
+   {
+      assert(!isToken() && m_numChildren == 1 && !getChild(0) && "not a skipped node");
+      getTrailingObjects<AstNode *>()[0] = child;
+   }
+
+private:
+   friend TrailingObjects;
+
+   AstNode(AstNodeKind kind, std::uint16_t tokenKind, SourceLoc start, std::uint32_t length,
+           ArrayRef<AstNode *> children);
+
+   AstNodeKind m_kind;
+   std::uint16_t m_tokenKind;
+   std::uint32_t m_numChildren;
+   std::uint32_t m_length;
+   SourceLoc m_start;
+};
+
+} // polar::ast
+
+#endif // POLARPHP_AST_AST_NODE_H
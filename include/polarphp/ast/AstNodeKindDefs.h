@@ -0,0 +1,334 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+//
+//===----------------------------------------------------------------------===//
+//
+// The kinds of the nodes of the compact AST, one for every kind of
+// reduction the grammar builds a node for.
+//
+// AST_NODE(Id, SyntaxKind)
+//   Id is the AstNodeKind, SyntaxKind the kind of the node the full syntax
+//   tree builds for the same reductions.
+//
+// The children of a node are the symbols of its rule in source order,
+// tokens included, a missing optional part is a null child. A syntax node
+// of a typed kind has the layout of its syntax node class instead, the
+// SyntaxTreeBuilder arranges the symbols into it. A reduction that does not
+// fit the layout becomes an unknown node of the same category.
+//
+// The comment before a kind gives the children of its AstNode, one layout
+// per rule: tokens by their spelling or token kind, expr, statement,
+// variable, name and type for a node of any kind of that category, an
+// AstNodeKind for a child of that kind, x|y for a child of either and [x]
+// for a child that is null when the part is missing. The layouts of rules
+// with different children are separated by a lone |. AstNodes.h names the
+// children of the common kinds.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef AST_NODE
+#  define AST_NODE(Id, SyntaxKind)
+#endif
+
+// no children, see AstNode::getTokenKind()
+AST_NODE(Token, Token)
+// TopStmtList
+AST_NODE(SourceFile, SourceFile)
+
+// declarations and their parts
+// Name \ { UseDeclList [,] } | \ Name \ { UseDeclList [,] }
+AST_NODE(GroupUseDecl, UnknownDecl)
+// function|const Name|UseDecl
+AST_NODE(TypedUseDecl, UnknownDecl)
+// Name as T_IDENTIFIER_STRING | \ Name|UseDecl
+AST_NODE(UseDecl, UnknownDecl)
+// function [&] T_IDENTIFIER_STRING ( ParameterList ) [ReturnTypeClause] {
+//   InnerStmtList|SkippedStmtList }
+AST_NODE(FunctionDecl, UnknownDecl)
+// ClassModifierList class T_IDENTIFIER_STRING [ExtendsClause] [ImplementsClause]
+//   { MemberDeclList }, without the ClassModifierList for a class without
+//   modifiers
+AST_NODE(ClassDecl, UnknownDecl)
+// trait T_IDENTIFIER_STRING [InterfaceExtendsClause] { MemberDeclList }
+AST_NODE(TraitDecl, UnknownDecl)
+// interface T_IDENTIFIER_STRING [InterfaceExtendsClause] { MemberDeclList }
+AST_NODE(InterfaceDecl, UnknownDecl)
+// extends name
+AST_NODE(ExtendsClause, UnknownDecl)
+// extends NameList
+AST_NODE(InterfaceExtendsClause, UnknownDecl)
+// implements NameList
+AST_NODE(ImplementsClause, UnknownDecl)
+// [type] [&] [...] T_VARIABLE | [type] [&] [...] T_VARIABLE = expr
+AST_NODE(ParameterDecl, UnknownDecl)
+// : type
+AST_NODE(ReturnTypeClause, UnknownDecl)
+// T_VARIABLE | T_VARIABLE = expr
+AST_NODE(StaticVariableDecl, UnknownDecl)
+// MemberModifierList|var [type] PropertyList ;
+AST_NODE(PropertyListDecl, UnknownDecl)
+// [MemberModifierList] const ClassConstList ;
+AST_NODE(ClassConstListDecl, UnknownDecl)
+// use NameList TraitAdaptationBlock
+AST_NODE(TraitUseDecl, UnknownDecl)
+// [MemberModifierList] function [&] identifier ( ParameterList ) [ReturnTypeClause]
+//   ;|CodeBlock
+AST_NODE(MethodDecl, UnknownDecl)
+// ; | { } | { TraitAdaptationList }
+AST_NODE(TraitAdaptationBlock, UnknownDecl)
+// TraitPrecedence|TraitAlias ;
+AST_NODE(TraitAdaptation, UnknownDecl)
+// TraitMethodReference insteadof NameList
+AST_NODE(TraitPrecedence, UnknownDecl)
+// identifier|TraitMethodReference as identifier|modifier
+//   | identifier|TraitMethodReference as modifier identifier
+AST_NODE(TraitAlias, UnknownDecl)
+// name :: identifier
+AST_NODE(TraitMethodReference, UnknownDecl)
+// T_VARIABLE | T_VARIABLE = expr
+AST_NODE(PropertyDecl, UnknownDecl)
+// identifier = expr
+AST_NODE(ClassConstDecl, UnknownDecl)
+// T_IDENTIFIER_STRING = expr
+AST_NODE(ConstDecl, UnknownDecl)
+// use ( LexicalVarList )
+AST_NODE(LexicalVarsClause, UnknownDecl)
+// T_VARIABLE | & T_VARIABLE
+AST_NODE(LexicalVarDecl, UnknownDecl)
+// the tokens skipped by error recovery
+AST_NODE(UnknownDecl, UnknownDecl)
+
+// statements
+// __halt_compiler ( ) ;
+AST_NODE(HaltCompilerStmt, UnknownStmt)
+// namespace Name ;
+AST_NODE(NamespaceStmt, UnknownStmt)
+// namespace Name { TopStmtList } | namespace { TopStmtList }
+AST_NODE(NamespaceBlockStmt, UnknownStmt)
+// use GroupUseDecl|UseDeclList ; | use function|const GroupUseDecl|UseDeclList ;
+AST_NODE(UseStmt, UnknownStmt)
+// const ConstDeclList ;
+AST_NODE(ConstStmt, UnknownStmt)
+// { InnerStmtList|SkippedStmtList }
+AST_NODE(CodeBlock, CodeBlock)
+// while ( expr ) statement
+AST_NODE(WhileStmt, WhileStmt)
+// do statement while ( expr ) ;
+AST_NODE(DoWhileStmt, DoWhileStmt)
+// for ( ForExprList ; ForExprList ; ForExprList ) statement
+AST_NODE(ForStmt, UnknownStmt)
+// switch ( expr ) SwitchCaseBlock
+AST_NODE(SwitchStmt, SwitchStmt)
+// break [expr] ;
+AST_NODE(BreakStmt, BreakStmt)
+// continue [expr] ;
+AST_NODE(ContinueStmt, ContinueStmt)
+// fallthrough ;
+AST_NODE(FallthroughStmt, FallthroughStmt)
+// return [expr] ;
+AST_NODE(ReturnStmt, ReturnStmt)
+// global GlobalVariableList ;
+AST_NODE(GlobalStmt, UnknownStmt)
+// static StaticVariableList ;
+AST_NODE(StaticStmt, UnknownStmt)
+// echo EchoExprList ;
+AST_NODE(EchoStmt, UnknownStmt)
+// expr ;
+AST_NODE(ExprStmt, ExpressionStmt)
+// unset ( UnsetVariableList [,] ) ;
+AST_NODE(UnsetStmt, UnknownStmt)
+// foreach ( expr as variable ) statement
+//   | foreach ( expr as variable => variable ) statement
+AST_NODE(ForeachStmt, UnknownStmt)
+// declare ( ConstDeclList ) statement
+AST_NODE(DeclareStmt, UnknownStmt)
+// ;
+AST_NODE(EmptyStmt, UnknownStmt)
+// try { InnerStmtList } CatchList [FinallyClause]
+AST_NODE(TryStmt, UnknownStmt)
+// throw expr ;
+AST_NODE(ThrowStmt, ThrowStmt)
+// goto T_IDENTIFIER_STRING ;
+AST_NODE(GotoStmt, UnknownStmt)
+// T_IDENTIFIER_STRING :
+AST_NODE(LabelStmt, UnknownStmt)
+// finally { InnerStmtList }
+AST_NODE(FinallyClause, UnknownStmt)
+// { SwitchCaseList } | { ; SwitchCaseList }
+AST_NODE(SwitchCaseBlock, UnknownStmt)
+// if ( expr ) statement, then elseif ( expr ) statement for every
+//   elseif clause, then else statement if there is an else clause
+AST_NODE(IfStmt, IfStmt)
+// the tokens skipped by error recovery
+AST_NODE(UnknownStmt, UnknownStmt)
+// a function body the parser skipped, its InnerStmtList is the child once
+// it is parsed
+AST_NODE(SkippedStmtList, InnerStmtList)
+
+// expressions
+// & variable
+AST_NODE(ReferenceExpr, UnknownExpr)
+// list ( ArrayPairList ) | [ ArrayPairList ]
+AST_NODE(ListExpr, UnknownExpr)
+// ... expr
+AST_NODE(SpreadExpr, Argument)
+// class [ArgumentClause] [ExtendsClause] [ImplementsClause] { MemberDeclList }
+AST_NODE(AnonymousClassExpr, UnknownExpr)
+// new name|expr [ArgumentClause] | new AnonymousClassExpr
+AST_NODE(NewExpr, UnknownExpr)
+// list ( ArrayPairList ) = expr | [ ArrayPairList ] = expr
+AST_NODE(ListAssignExpr, UnknownExpr)
+// variable = expr
+AST_NODE(AssignExpr, SequenceExpr)
+// variable = & variable
+AST_NODE(AssignRefExpr, UnknownExpr)
+// clone expr
+AST_NODE(CloneExpr, UnknownExpr)
+// variable operator expr, the operator is one of += -= *= **= /= .=
+//   %= &= |= ^= <<= >>= ??=
+AST_NODE(CompoundAssignExpr, SequenceExpr)
+// variable ++|--
+AST_NODE(PostfixOperatorExpr, PostfixOperatorExpr)
+// ++|-- variable | +|-|!|~ expr
+AST_NODE(PrefixOperatorExpr, PrefixOperatorExpr)
+// expr operator expr
+AST_NODE(BinaryOperatorExpr, SequenceExpr)
+// expr instanceof name|expr
+AST_NODE(InstanceofExpr, UnknownExpr)
+// ( expr ) | ( [expr] ) after exit
+AST_NODE(ParenExpr, ParenDecoratedExpr)
+// expr ? expr : expr
+AST_NODE(TernaryExpr, TernaryExpr)
+// expr ? : expr
+AST_NODE(ShortTernaryExpr, TernaryExpr)
+// cast expr, the cast is one of the T_*_CAST tokens
+AST_NODE(CastExpr, UnknownExpr)
+// exit [ParenExpr]
+AST_NODE(ExitExpr, UnknownExpr)
+// @ expr
+AST_NODE(ErrorSuppressExpr, UnknownExpr)
+// ` [EncapsText|EncapsList] `
+AST_NODE(ShellExecExpr, UnknownExpr)
+// print expr
+AST_NODE(PrintExpr, UnknownExpr)
+// yield | yield expr | yield expr => expr
+AST_NODE(YieldExpr, UnknownExpr)
+// yield from expr
+AST_NODE(YieldFromExpr, UnknownExpr)
+// static ClosureExpr|ArrowFunctionExpr
+AST_NODE(StaticClosureExpr, UnknownExpr)
+// function [&] ( ParameterList ) [LexicalVarsClause] [ReturnTypeClause] {
+//   InnerStmtList|SkippedStmtList }
+AST_NODE(ClosureExpr, UnknownExpr)
+// fn [&] ( ParameterList ) [ReturnTypeClause] => expr
+AST_NODE(ArrowFunctionExpr, UnknownExpr)
+// name|expr ArgumentClause
+AST_NODE(FunctionCallExpr, SimpleFunctionCallExpr)
+// name|expr :: identifier|DynamicMemberName|variable ArgumentClause
+AST_NODE(StaticMethodCallExpr, StaticMethodCallExpr)
+// array ( ArrayPairList ) | [ ArrayPairList ]
+AST_NODE(ArrayExpr, ArrayCreateExpr)
+// "|' T_CONSTANT_ENCAPSED_STRING "|'
+AST_NODE(StringLiteralExpr, StringLiteralExpr)
+// T_LNUMBER
+AST_NODE(IntegerLiteralExpr, IntegerLiteralExpr)
+// T_DNUMBER
+AST_NODE(FloatLiteralExpr, FloatLiteralExpr)
+// __LINE__|__FILE__|__DIR__|__TRAIT__|__METHOD__|__FUNCTION__|__NAMESPACE__
+//   |__CLASS__
+AST_NODE(MagicConstantExpr, UnknownExpr)
+// T_START_HEREDOC T_ENCAPSED_AND_WHITESPACE|EncapsList T_END_HEREDOC
+//   | T_START_HEREDOC T_END_HEREDOC
+AST_NODE(HeredocExpr, HeredocExpr)
+// " EncapsList "
+AST_NODE(InterpolatedStringExpr, EncapsListStringExpr)
+// name|expr :: identifier
+AST_NODE(ClassConstantExpr, ClassConstIdentifierExpr)
+// expr [ [expr] ] | expr { expr }
+AST_NODE(ArrayAccessExpr, ArrayAccessExpr)
+// expr -> MemberName|DynamicMemberName|variable ArgumentClause
+AST_NODE(MethodCallExpr, InstanceMethodCallExpr)
+// expr -> MemberName|DynamicMemberName|variable
+AST_NODE(PropertyAccessExpr, InstancePropertyExpr)
+// T_VARIABLE
+AST_NODE(VariableExpr, SimpleVariableExpr)
+// $ { expr } | $ variable
+AST_NODE(VariableVariableExpr, SimpleVariableExpr)
+// name|expr :: variable
+AST_NODE(StaticPropertyExpr, StaticPropertyExpr)
+// ${ expr } | ${ T_STRING_VARNAME } | ${ T_STRING_VARNAME [ expr ] }
+AST_NODE(DollarBraceExpr, UnknownExpr)
+// {$ variable }
+AST_NODE(CurlyBraceExpr, UnknownExpr)
+// isset ( IssetVariableList [,] )
+AST_NODE(IssetExpr, UnknownExpr)
+// empty ( expr )
+AST_NODE(EmptyExpr, UnknownExpr)
+// include|include_once|require|require_once expr
+AST_NODE(IncludeExpr, UnknownExpr)
+// eval ( expr )
+AST_NODE(EvalExpr, UnknownExpr)
+
+// names, types and the parts of expressions
+// ( ) | ( ArgumentList [,] )
+AST_NODE(ArgumentClause, ArgumentListClause)
+// T_IDENTIFIER_STRING, then \ T_IDENTIFIER_STRING for every further part
+AST_NODE(Name, Unknown)
+// namespace \ Name
+AST_NODE(RelativeName, Unknown)
+// \ Name
+AST_NODE(FullyQualifiedName, Unknown)
+// ? type
+AST_NODE(NullableType, UnknownDecl)
+// static
+AST_NODE(StaticClassName, UnknownExpr)
+// T_ENCAPSED_AND_WHITESPACE
+AST_NODE(EncapsText, UnknownExpr)
+// { expr }
+AST_NODE(DynamicMemberName, UnknownExpr)
+// T_IDENTIFIER_STRING
+AST_NODE(MemberName, PropertyNameClause)
+// expr => expr | expr => & variable | & variable | ... expr
+//   | expr => list ( ArrayPairList ) | list ( ArrayPairList )
+AST_NODE(ArrayPair, ArrayKeyValuePairItem)
+// - T_NUM_STRING
+AST_NODE(NegativeOffset, Unknown)
+
+// lists, the elements of a list are flattened into its children
+AST_NODE(TopStmtList, TopStmtList)
+AST_NODE(UseDeclList, Unknown)
+AST_NODE(ConstDeclList, Unknown)
+AST_NODE(InnerStmtList, InnerStmtList)
+AST_NODE(ForExprList, Unknown)
+AST_NODE(GlobalVariableList, Unknown)
+AST_NODE(StaticVariableList, Unknown)
+AST_NODE(EchoExprList, Unknown)
+AST_NODE(UnsetVariableList, Unknown)
+// catch ( CatchTypeList T_VARIABLE ) { InnerStmtList } for every catch
+AST_NODE(CatchList, Unknown)
+AST_NODE(CatchTypeList, Unknown)
+AST_NODE(ParameterList, Unknown)
+AST_NODE(MemberDeclList, MemberDeclList)
+AST_NODE(ClassModifierList, ClassModifierList)
+AST_NODE(NameList, Unknown)
+AST_NODE(ArrayPairList, ArrayPairItemList)
+// case expr : InnerStmtList or default : InnerStmtList for every case
+AST_NODE(SwitchCaseList, SwitchCaseList)
+AST_NODE(ArgumentList, ArgumentList)
+AST_NODE(PropertyList, Unknown)
+AST_NODE(ClassConstList, Unknown)
+AST_NODE(TraitAdaptationList, ClassTraitAdaptationList)
+AST_NODE(MemberModifierList, MemberModifierList)
+AST_NODE(LexicalVarList, Unknown)
+AST_NODE(EncapsList, EncapsList)
+AST_NODE(IssetVariableList, Unknown)
+
+#undef AST_NODE
@@ -0,0 +1,969 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+//===----------------------------------------------------------------------===//
+//
+// Typed views of the compact AST. A view is a pointer to an AstNode of its
+// kinds that names the children of their layout, see AstNodeKindDefs.h, it
+// adds nothing to the node and is passed by value.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef POLARPHP_AST_AST_NODES_H
+#define POLARPHP_AST_AST_NODES_H
+
+#include "polarphp/ast/AstNode.h"
+
+#include <optional>
+
+namespace polar::ast {
+
+/// The base of the views. A view of a node of the wrong kind asserts, see
+/// get_ast_node_as() for a checked one.
+class AstNodeView
+{
+public:
+   const AstNode *getNode() const
+   {
+      return m_node;
+   }
+
+   AstNodeKind getKind() const
+   {
+      return m_node->getKind();
+   }
+
+   CharSourceRange getRange() const
+   {
+      return m_node->getRange();
+   }
+
+   StringRef getText() const
+   {
+      return m_node->getText();
+   }
+
+protected:
+   explicit AstNodeView(const AstNode *node)
+      : m_node(node)
+   {}
+
+   AstNode *getChild(size_t index) const
+   {
+      return m_node->getChild(index);
+   }
+
+   size_t getNumChildren() const
+   {
+      return m_node->getNumChildren();
+   }
+
+   const AstNode *m_node;
+};
+
+/// The view of \p node, std::nullopt for a null node or a node of a kind
+/// the view does not cover.
+template <typename ViewType>
+std::optional<ViewType> get_ast_node_as(const AstNode *node)
+{
+   if (node && ViewType::kindOf(node->getKind())) {
+      return ViewType(node);
+   }
+   return std::nullopt;
+}
+
+/// The statements of a function body, its InnerStmtList, \p body is the
+/// InnerStmtList or the SkippedStmtList of a skipped body. Null for a
+/// skipped body that is not parsed yet.
+inline AstNode *get_function_body_statements(AstNode *body)
+{
+   if (body && body->getKind() == AstNodeKind::SkippedStmtList) {
+      return body->getChild(0);
+   }
+   return body;
+}
+
+// statements
+
+class CodeBlock final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      LeftBrace,
+      Statements,
+      RightBrace
+   };
+
+   explicit CodeBlock(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a code block");
+   }
+
+   /// The InnerStmtList, null for a skipped method body that is not parsed
+   /// yet.
+   AstNode *getStatements() const
+   {
+      return get_function_body_statements(getChild(Statements));
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::CodeBlock;
+   }
+};
+
+/// An if statement, its elseif clauses are numbered from 0.
+class IfStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      IfKeyword,
+      LeftParen,
+      Condition,
+      RightParen,
+      Body
+   };
+
+   explicit IfStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not an if statement");
+   }
+
+   AstNode *getCondition() const
+   {
+      return getChild(Condition);
+   }
+
+   AstNode *getBody() const
+   {
+      return getChild(Body);
+   }
+
+   size_t getNumElseIfClauses() const
+   {
+      return (getNumChildren() - CLAUSE_CHILDREN_COUNT) / CLAUSE_CHILDREN_COUNT;
+   }
+
+   AstNode *getElseIfCondition(size_t index) const
+   {
+      return getChild(getElseIfClauseStart(index) + Condition);
+   }
+
+   AstNode *getElseIfBody(size_t index) const
+   {
+      return getChild(getElseIfClauseStart(index) + Body);
+   }
+
+   bool hasElse() const
+   {
+      // an else clause is the else keyword and the statement
+      return getNumChildren() % CLAUSE_CHILDREN_COUNT == 2;
+   }
+
+   /// Null without an else clause.
+   AstNode *getElseBody() const
+   {
+      return hasElse() ? getChild(getNumChildren() - 1) : nullptr;
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::IfStmt;
+   }
+
+private:
+   constexpr static size_t CLAUSE_CHILDREN_COUNT = Body + 1;
+
+   size_t getElseIfClauseStart(size_t index) const
+   {
+      assert(index < getNumElseIfClauses() && "elseif clause index out of range");
+      return (index + 1) * CLAUSE_CHILDREN_COUNT;
+   }
+};
+
+class WhileStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      WhileKeyword,
+      LeftParen,
+      Condition,
+      RightParen,
+      Body
+   };
+
+   explicit WhileStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a while statement");
+   }
+
+   AstNode *getCondition() const
+   {
+      return getChild(Condition);
+   }
+
+   AstNode *getBody() const
+   {
+      return getChild(Body);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::WhileStmt;
+   }
+};
+
+class DoWhileStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      DoKeyword,
+      Body,
+      WhileKeyword,
+      LeftParen,
+      Condition,
+      RightParen,
+      Semicolon
+   };
+
+   explicit DoWhileStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a do while statement");
+   }
+
+   AstNode *getBody() const
+   {
+      return getChild(Body);
+   }
+
+   AstNode *getCondition() const
+   {
+      return getChild(Condition);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::DoWhileStmt;
+   }
+};
+
+class ForStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      ForKeyword,
+      LeftParen,
+      Initializers,
+      FirstSemicolon,
+      Conditions,
+      SecondSemicolon,
+      Steps,
+      RightParen,
+      Body
+   };
+
+   explicit ForStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a for statement");
+   }
+
+   /// The ForExprList of the initial expressions.
+   AstNode *getInitializers() const
+   {
+      return getChild(Initializers);
+   }
+
+   /// The ForExprList of the conditions.
+   AstNode *getConditions() const
+   {
+      return getChild(Conditions);
+   }
+
+   /// The ForExprList of the expressions run after every iteration.
+   AstNode *getSteps() const
+   {
+      return getChild(Steps);
+   }
+
+   AstNode *getBody() const
+   {
+      return getChild(Body);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ForStmt;
+   }
+};
+
+class ForeachStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      ForeachKeyword,
+      LeftParen,
+      Iterable,
+      AsKeyword
+   };
+
+   explicit ForeachStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a foreach statement");
+   }
+
+   AstNode *getIterable() const
+   {
+      return getChild(Iterable);
+   }
+
+   /// Null for a loop over the values only.
+   AstNode *getKey() const
+   {
+      return hasKey() ? getChild(AsKeyword + 1) : nullptr;
+   }
+
+   AstNode *getValue() const
+   {
+      return getChild(getNumChildren() - 3);
+   }
+
+   AstNode *getBody() const
+   {
+      return getChild(getNumChildren() - 1);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ForeachStmt;
+   }
+
+private:
+   bool hasKey() const
+   {
+      // the key and the => of a loop over the keys and values
+      return getNumChildren() == 9;
+   }
+};
+
+class SwitchStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      SwitchKeyword,
+      LeftParen,
+      Condition,
+      RightParen,
+      Cases
+   };
+
+   explicit SwitchStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a switch statement");
+   }
+
+   AstNode *getCondition() const
+   {
+      return getChild(Condition);
+   }
+
+   /// The SwitchCaseList.
+   AstNode *getCases() const
+   {
+      const AstNode *block = getChild(Cases);
+      return block->getChild(block->getNumChildren() - 2);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::SwitchStmt;
+   }
+};
+
+/// A return, break or continue statement.
+class JumpStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Keyword,
+      Value,
+      Semicolon
+   };
+
+   explicit JumpStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a return, break or continue statement");
+   }
+
+   /// The returned value or the number of loops to leave, null if there is
+   /// none.
+   AstNode *getValue() const
+   {
+      return getChild(Value);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ReturnStmt || kind == AstNodeKind::BreakStmt ||
+            kind == AstNodeKind::ContinueStmt;
+   }
+};
+
+class ExprStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Expr,
+      Semicolon
+   };
+
+   explicit ExprStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not an expression statement");
+   }
+
+   AstNode *getExpr() const
+   {
+      return getChild(Expr);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ExprStmt;
+   }
+};
+
+class EchoStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      EchoKeyword,
+      Exprs,
+      Semicolon
+   };
+
+   explicit EchoStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not an echo statement");
+   }
+
+   /// The EchoExprList.
+   AstNode *getExprs() const
+   {
+      return getChild(Exprs);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::EchoStmt;
+   }
+};
+
+class TryStmt final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      TryKeyword,
+      LeftBrace,
+      Statements,
+      RightBrace,
+      Catches,
+      Finally
+   };
+
+   explicit TryStmt(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a try statement");
+   }
+
+   /// The InnerStmtList of the try block.
+   AstNode *getStatements() const
+   {
+      return getChild(Statements);
+   }
+
+   /// The CatchList.
+   AstNode *getCatches() const
+   {
+      return getChild(Catches);
+   }
+
+   /// The FinallyClause, null if there is none.
+   AstNode *getFinally() const
+   {
+      return getChild(Finally);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::TryStmt;
+   }
+};
+
+// declarations
+
+class FunctionDecl final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      FunctionKeyword,
+      Ampersand,
+      Name,
+      LeftParen,
+      Parameters,
+      RightParen,
+      ReturnType,
+      LeftBrace,
+      Body,
+      RightBrace
+   };
+
+   explicit FunctionDecl(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a function declaration");
+   }
+
+   bool returnsReference() const
+   {
+      return getChild(Ampersand) != nullptr;
+   }
+
+   /// The name token.
+   AstNode *getName() const
+   {
+      return getChild(Name);
+   }
+
+   /// The ParameterList.
+   AstNode *getParameters() const
+   {
+      return getChild(Parameters);
+   }
+
+   /// The ReturnTypeClause, null if there is none.
+   AstNode *getReturnType() const
+   {
+      return getChild(ReturnType);
+   }
+
+   /// The InnerStmtList, or the SkippedStmtList of a skipped body.
+   AstNode *getBody() const
+   {
+      return getChild(Body);
+   }
+
+   /// The InnerStmtList, null for a skipped body that is not parsed yet.
+   AstNode *getStatements() const
+   {
+      return get_function_body_statements(getBody());
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::FunctionDecl;
+   }
+};
+
+class ParameterDecl final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Type,
+      Ampersand,
+      Ellipsis,
+      Variable,
+      Equal,
+      DefaultValue
+   };
+
+   explicit ParameterDecl(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a parameter declaration");
+   }
+
+   /// Null for an untyped parameter.
+   AstNode *getType() const
+   {
+      return getChild(Type);
+   }
+
+   bool isReference() const
+   {
+      return getChild(Ampersand) != nullptr;
+   }
+
+   bool isVariadic() const
+   {
+      return getChild(Ellipsis) != nullptr;
+   }
+
+   /// The T_VARIABLE token.
+   AstNode *getVariable() const
+   {
+      return getChild(Variable);
+   }
+
+   /// Null for a parameter without a default value.
+   AstNode *getDefaultValue() const
+   {
+      return getNumChildren() > DefaultValue ? getChild(DefaultValue) : nullptr;
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ParameterDecl;
+   }
+};
+
+class ClassDecl final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      ClassKeyword,
+      Name,
+      Extends,
+      Implements,
+      LeftBrace,
+      Members,
+      RightBrace
+   };
+
+   explicit ClassDecl(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a class declaration");
+   }
+
+   /// The ClassModifierList, null for a class without modifiers.
+   AstNode *getModifiers() const
+   {
+      return hasModifiers() ? getChild(0) : nullptr;
+   }
+
+   /// The name token.
+   AstNode *getName() const
+   {
+      return getMember(Name);
+   }
+
+   /// The ExtendsClause, null if there is none.
+   AstNode *getExtends() const
+   {
+      return getMember(Extends);
+   }
+
+   /// The ImplementsClause, null if there is none.
+   AstNode *getImplements() const
+   {
+      return getMember(Implements);
+   }
+
+   /// The MemberDeclList.
+   AstNode *getMembers() const
+   {
+      return getMember(Members);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ClassDecl;
+   }
+
+private:
+   bool hasModifiers() const
+   {
+      return getNumChildren() > RightBrace + 1;
+   }
+
+   // the cursors count from the class keyword, the modifiers come before it
+   AstNode *getMember(Cursor cursor) const
+   {
+      return getChild(hasModifiers() ? cursor + 1 : cursor);
+   }
+};
+
+class MethodDecl final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Modifiers,
+      FunctionKeyword,
+      Ampersand,
+      Name,
+      LeftParen,
+      Parameters,
+      RightParen,
+      ReturnType,
+      Body
+   };
+
+   explicit MethodDecl(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a method declaration");
+   }
+
+   /// The MemberModifierList, null for a method without modifiers.
+   AstNode *getModifiers() const
+   {
+      return getChild(Modifiers);
+   }
+
+   bool returnsReference() const
+   {
+      return getChild(Ampersand) != nullptr;
+   }
+
+   /// The name token.
+   AstNode *getName() const
+   {
+      return getChild(Name);
+   }
+
+   /// The ParameterList.
+   AstNode *getParameters() const
+   {
+      return getChild(Parameters);
+   }
+
+   /// The ReturnTypeClause, null if there is none.
+   AstNode *getReturnType() const
+   {
+      return getChild(ReturnType);
+   }
+
+   /// The CodeBlock, null for an abstract method.
+   AstNode *getBody() const
+   {
+      AstNode *body = getChild(Body);
+      return body->isToken() ? nullptr : body;
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::MethodDecl;
+   }
+};
+
+// expressions
+
+/// An assignment, compound or not, or a binary operator expression.
+class BinaryOperatorExpr final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      LeftOperand,
+      Operator,
+      RightOperand
+   };
+
+   explicit BinaryOperatorExpr(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a binary operator expression");
+   }
+
+   AstNode *getLeftOperand() const
+   {
+      return getChild(LeftOperand);
+   }
+
+   TokenKindType getOperator() const
+   {
+      return getChild(Operator)->getTokenKind();
+   }
+
+   AstNode *getRightOperand() const
+   {
+      return getChild(RightOperand);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::BinaryOperatorExpr || kind == AstNodeKind::AssignExpr ||
+            kind == AstNodeKind::CompoundAssignExpr;
+   }
+};
+
+class TernaryExpr final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Condition,
+      QuestionMark
+   };
+
+   explicit TernaryExpr(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a ternary expression");
+   }
+
+   AstNode *getCondition() const
+   {
+      return getChild(Condition);
+   }
+
+   /// Null for a short ternary, its condition is the value.
+   AstNode *getTrueExpr() const
+   {
+      return getKind() == AstNodeKind::TernaryExpr ? getChild(QuestionMark + 1) : nullptr;
+   }
+
+   AstNode *getFalseExpr() const
+   {
+      return getChild(getNumChildren() - 1);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::TernaryExpr || kind == AstNodeKind::ShortTernaryExpr;
+   }
+};
+
+class FunctionCallExpr final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Callee,
+      Arguments
+   };
+
+   explicit FunctionCallExpr(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a function call");
+   }
+
+   /// The name of the function or the expression of the callable.
+   AstNode *getCallee() const
+   {
+      return getChild(Callee);
+   }
+
+   /// The ArgumentClause.
+   AstNode *getArguments() const
+   {
+      return getChild(Arguments);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::FunctionCallExpr;
+   }
+};
+
+class MethodCallExpr final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Object,
+      Arrow,
+      Name,
+      Arguments
+   };
+
+   explicit MethodCallExpr(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not a method call");
+   }
+
+   AstNode *getObject() const
+   {
+      return getChild(Object);
+   }
+
+   /// The MemberName, the DynamicMemberName or the variable of the name.
+   AstNode *getName() const
+   {
+      return getChild(Name);
+   }
+
+   /// The ArgumentClause.
+   AstNode *getArguments() const
+   {
+      return getChild(Arguments);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::MethodCallExpr;
+   }
+};
+
+class ArrayAccessExpr final : public AstNodeView
+{
+public:
+   enum Cursor : std::uint32_t
+   {
+      Base,
+      LeftBracket,
+      Offset,
+      RightBracket
+   };
+
+   explicit ArrayAccessExpr(const AstNode *node)
+      : AstNodeView(node)
+   {
+      assert(kindOf(node->getKind()) && "not an array access");
+   }
+
+   AstNode *getBase() const
+   {
+      return getChild(Base);
+   }
+
+   /// Null for an append, $a[].
+   AstNode *getOffset() const
+   {
+      return getChild(Offset);
+   }
+
+   static bool kindOf(AstNodeKind kind)
+   {
+      return kind == AstNodeKind::ArrayAccessExpr;
+   }
+};
+
+} // polar::ast
+
+#endif // POLARPHP_AST_AST_NODES_H
@@ -96,6 +96,12 @@ public:
          delete static_cast<const Derived *>(this);
       }
    }
+
+   /// True when the caller holds the only reference.
+   bool hasOneRef() const
+   {
+      return m_refCount == 1;
+   }
 };
 
 /// A thread-safe version of \c RefCountedBase.
@@ -122,6 +128,13 @@ public:
          delete static_cast<const Derived *>(this);
       }
    }
+
+   /// True when the caller holds the only reference, no other thread can
+   /// take a new one then.
+   bool hasOneRef() const
+   {
+      return m_refCount.load(std::memory_order_acquire) == 1;
+   }
 };
 
 /// Class you can specialize to provide custom retain/release functionality for
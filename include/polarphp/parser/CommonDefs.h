@@ -14,9 +14,13 @@
 
 #include <string>
 
+namespace polar::ast {
+class AstNode;
+} // polar::ast
+
 namespace polar::parser {
 
-class AstNode;
+using polar::ast::AstNode;
 
 union ParserStackElement
 {
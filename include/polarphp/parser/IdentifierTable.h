@@ -0,0 +1,122 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_PARSER_IDENTIFIER_TABLE_H
+#define POLARPHP_PARSER_IDENTIFIER_TABLE_H
+
+#include "polarphp/basic/adt/IntrusiveRefCountPtr.h"
+#include "polarphp/basic/adt/StringMap.h"
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/utils/Allocator.h"
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace polar::parser {
+
+using polar::basic::StringMap;
+using polar::basic::StringRef;
+using polar::basic::ThreadSafeRefCountedBase;
+using polar::utils::BumpPtrAllocator;
+
+/// A 32 bit handle of an interned name, 0 is no symbol.
+using SymbolId = std::uint32_t;
+
+/// The names of one compilation, every distinct name is stored once and gets
+/// a dense SymbolId, so passes after the lexer compare and hash integers
+/// instead of strings.
+///
+/// Names are interned by their exact spelling, a token keeps the name it
+/// was written with. Function, class and namespace names are case
+/// insensitive in PHP, getFoldedSymbol() gives the symbol of the ASCII lower
+/// case spelling for comparing them, the way the engine folds them.
+/// Constant and variable names are case sensitive and compared by their own
+/// symbol. Names and variables never share a symbol.
+///
+/// The table is shared by a lexer and its sub lexers, only one of them may
+/// lex at a time.
+class IdentifierTable : public ThreadSafeRefCountedBase<IdentifierTable>
+{
+public:
+   static constexpr SymbolId InvalidSymbolId = 0;
+
+   IdentifierTable()
+   {}
+
+   /// The symbol of \p name as it is spelled, interned on first use. The
+   /// lower case spelling is interned along with it.
+   SymbolId internName(StringRef name);
+
+   /// The symbol of the variable \p name without the '$'.
+   SymbolId internVariable(StringRef name);
+
+   /// The symbol of the exact spelling \p name or InvalidSymbolId if it was
+   /// never interned.
+   SymbolId lookupName(StringRef name) const;
+
+   SymbolId lookupVariable(StringRef name) const;
+
+   /// The interned spelling.
+   StringRef getSymbolText(SymbolId id) const
+   {
+      assert(id != InvalidSymbolId && id <= m_symbols.size() && "unknown symbol");
+      return m_symbols[id - 1].text;
+   }
+
+   /// The symbol of the ASCII lower case spelling of name \p id, \p id
+   /// itself if it has no upper case letters and for variables.
+   SymbolId getFoldedSymbol(SymbolId id) const
+   {
+      assert(id != InvalidSymbolId && id <= m_symbols.size() && "unknown symbol");
+      return m_symbols[id - 1].folded;
+   }
+
+   bool isVariableSymbol(SymbolId id) const
+   {
+      assert(id != InvalidSymbolId && id <= m_symbols.size() && "unknown symbol");
+      return m_symbols[id - 1].isVariable;
+   }
+
+   size_t getSymbolCount() const
+   {
+      return m_symbols.size();
+   }
+
+   size_t getTotalMemory() const
+   {
+      return m_names.getAllocator().getTotalMemory() +
+            m_variables.getAllocator().getTotalMemory() +
+            m_symbols.capacity() * sizeof(SymbolEntry);
+   }
+
+private:
+   IdentifierTable(const IdentifierTable &) = delete;
+   void operator=(const IdentifierTable &) = delete;
+
+   struct SymbolEntry
+   {
+      /// The key of the map entry, it does not move when the map grows.
+      StringRef text;
+      SymbolId folded;
+      bool isVariable;
+   };
+
+   SymbolId intern(StringMap<SymbolId, BumpPtrAllocator> &map, StringRef key, bool isVariable);
+
+   StringMap<SymbolId, BumpPtrAllocator> m_names;
+   StringMap<SymbolId, BumpPtrAllocator> m_variables;
+   std::vector<SymbolEntry> m_symbols;
+};
+
+} // polar::parser
+
+#endif // POLARPHP_PARSER_IDENTIFIER_TABLE_H
@@ -8,32 +8,34 @@
 %define api.value.type variant
 %define api.token.constructor false
 %define api.parser.class {YYParser}
-%define api.location.file "../../../include/polarphp/parser/internal/YYLocation.h"
-%define api.location.include{"polarphp/parser/internal/YYLocation.h"}
+%define api.location.type {polar::parser::ParsedTokenRange}
 
 %parse-param {polar::parser::Parser *parser}
 %parse-param {polar::parser::Lexer *lexer}
+%parse-param {polar::parser::SyntaxTreeBuilder *builder}
 %lex-param {polar::parser::Lexer *lexer}
 %lex-param {polar::parser::Parser *parser}
 
 %code top {
 #include <cstdint>
+// errors are recovered from by the grammar, nothing throws syntax_error
+#define YY_EXCEPTIONS 0
 }
 
 %code requires {
 
-#include <memory>
-#include "polarphp/syntax/Syntax.h"
+#include "polarphp/parser/SyntaxTreeBuilder.h"
 
 #define YYERROR_VERBOSE
-#define polar_error polar::syntax::parse_error
 
 namespace polar::parser {
 class Parser;
 class Lexer;
 } // polar::parser
 
-using polar::syntax::Syntax;
+using polar::parser::ParsedNode;
+using polar::parser::ParsedTokenRange;
+using polar::parser::PendingSyntaxList;
 
 }
 
@@ -41,17 +43,14 @@ using polar::syntax::Syntax;
 #define polar_yy_lex polar::parser::internal::token_lex_wrapper
 namespace polar::parser::internal {
 using ParserSemantic = YYParser::semantic_type;
-int token_lex_wrapper(ParserSemantic *value, location *loc, Lexer *lexer, Parser *parser);
+int token_lex_wrapper(ParserSemantic *value, ParsedTokenRange *loc, Lexer *lexer, Parser *parser);
 } // polar::parser::internal
 }
 
 %code {
-using polar::syntax::Syntax;
+using polar::ast::AstNodeKind;
 }
 
-// %destructor { delete $$; } <std::shared_ptr<Syntax>>
-// %destructor { if ($$) delete $$; } <str>
-
 %precedence PREC_ARROW_FUNCTION
 %precedence T_INCLUDE T_INCLUDE_ONCE T_REQUIRE T_REQUIRE_ONCE
 %left T_LOGICAL_OR
@@ -264,14 +263,14 @@ using polar::syntax::Syntax;
 /* PUNCTUATOR_MARK_END */
 
 /* MISC_MARK_START */
-%token <std::int64_t> T_LNUMBER   "integer number (T_LNUMBER)"
-%token <double> T_DNUMBER   "floating-point number (T_DNUMBER)"
-%token <std::string> T_IDENTIFIER_STRING    "identifier (T_IDENTIFIER_STRING)"
-%token <std::string> T_VARIABLE  "variable (T_VARIABLE)"
-%token <std::string> T_ENCAPSED_AND_WHITESPACE  "quoted-string and whitespace (T_ENCAPSED_AND_WHITESPACE)"
-%token <std::string> T_CONSTANT_ENCAPSED_STRING "quoted-string (T_CONSTANT_ENCAPSED_STRING)"
-%token <std::string> T_STRING_VARNAME "variable name (T_STRING_VARNAME)"
-%token <std::string> T_NUM_STRING "number (T_NUM_STRING)"
+%token T_LNUMBER   "integer number (T_LNUMBER)"
+%token T_DNUMBER   "floating-point number (T_DNUMBER)"
+%token T_IDENTIFIER_STRING    "identifier (T_IDENTIFIER_STRING)"
+%token T_VARIABLE  "variable (T_VARIABLE)"
+%token T_ENCAPSED_AND_WHITESPACE  "quoted-string and whitespace (T_ENCAPSED_AND_WHITESPACE)"
+%token T_CONSTANT_ENCAPSED_STRING "quoted-string (T_CONSTANT_ENCAPSED_STRING)"
+%token T_STRING_VARNAME "variable name (T_STRING_VARNAME)"
+%token T_NUM_STRING "number (T_NUM_STRING)"
 
 %token T_WHITESPACE      "whitespace (T_WHITESPACE)"
 %token T_PREFIX_OPERATOR "prefix operator (T_PREFIX_OPERATOR)"
@@ -286,1648 +285,1603 @@ using polar::syntax::Syntax;
 %token T_END_HEREDOC     "heredoc end (T_END_HEREDOC)"
 
 /* Token used to force a parse error from the lexer */
-%token <std::string> T_ERROR          "error (T_ERROR)"
+%token T_ERROR          "error (T_ERROR)"
 %token T_UNKNOWN_MARK "unknown token (T_UNKNOWN_MARK)"
+/* Token the parser starts with to parse a skipped function body */
+%token T_FUNCTION_BODY_START "function body start (T_FUNCTION_BODY_START)"
 /* MISC_MARK_END */
 /* token define end */
 
-%type <std::shared_ptr<Syntax>> top_statement namespace_name name statement function_declaration_statement
-%type <std::shared_ptr<Syntax>> class_declaration_statement trait_declaration_statement
-%type <std::shared_ptr<Syntax>> interface_declaration_statement interface_extends_list
-%type <std::shared_ptr<Syntax>> group_use_declaration inline_use_declarations inline_use_declaration
-%type <std::shared_ptr<Syntax>> mixed_group_use_declaration use_declaration unprefixed_use_declaration
-%type <std::shared_ptr<Syntax>> unprefixed_use_declarations const_decl inner_statement
-%type <std::shared_ptr<Syntax>> expr optional_expr foreach_variable
-%type <std::shared_ptr<Syntax>> finally_statement unset_variable variable
-%type <std::shared_ptr<Syntax>> extends_from parameter optional_type argument global_var
-%type <std::shared_ptr<Syntax>> static_var class_statement trait_adaptation trait_precedence trait_alias
-%type <std::shared_ptr<Syntax>> absolute_trait_method_reference trait_method_reference property echo_expr
-%type <std::shared_ptr<Syntax>> new_expr anonymous_class class_name class_name_reference simple_variable
-%type <std::shared_ptr<Syntax>> internal_functions_in_bison
-%type <std::shared_ptr<Syntax>> exit_expr scalar backticks_expr lexical_var function_call member_name property_name
-%type <std::shared_ptr<Syntax>> variable_class_name dereferencable_scalar constant dereferencable
-%type <std::shared_ptr<Syntax>> callable_expr callable_variable static_member new_variable
-%type <std::shared_ptr<Syntax>> encaps_var encaps_var_offset isset_variables
-%type <std::shared_ptr<Syntax>> top_statement_list use_declarations const_list inner_statement_list if_stmt
-%type <std::shared_ptr<Syntax>> for_exprs switch_case_list global_var_list static_var_list
-%type <std::shared_ptr<Syntax>> echo_expr_list unset_variables catch_name_list catch_list parameter_list class_statement_list
-%type <std::shared_ptr<Syntax>> implements_list case_list if_stmt_without_else
-%type <std::shared_ptr<Syntax>> non_empty_parameter_list argument_list non_empty_argument_list property_list
-%type <std::shared_ptr<Syntax>> class_const_list class_const_decl name_list trait_adaptations method_body non_empty_for_exprs
-%type <std::shared_ptr<Syntax>> ctor_arguments trait_adaptation_list lexical_vars
-%type <std::shared_ptr<Syntax>> lexical_var_list encaps_list
-%type <std::shared_ptr<Syntax>> array_pair non_empty_array_pair_list array_pair_list possible_array_pair
-%type <std::shared_ptr<Syntax>> isset_variable type return_type type_expr
-%type <std::shared_ptr<Syntax>> identifier
-%type <std::shared_ptr<Syntax>> inline_function
-
-%type <std::uint64_t> returns_ref function fn is_reference is_variadic variable_modifiers
-%type <std::uint64_t> method_modifiers non_empty_member_modifiers member_modifier
-%type <std::uint64_t> class_modifiers class_modifier use_type backup_fn_flags
-
+/* every token carries its token node */
+%type <ParsedNode> END T_LINE T_FILE T_DIR T_CLASS_CONST T_TRAIT_CONST T_METHOD_CONST
+%type <ParsedNode> T_FUNC_CONST T_NS_CONST T_NAMESPACE T_CLASS T_TRAIT T_INTERFACE
+%type <ParsedNode> T_EXTENDS T_IMPLEMENTS T_FUNCTION T_FN T_CONST T_VAR T_USE
+%type <ParsedNode> T_INSTEADOF T_AS T_GLOBAL T_STATIC T_ABSTRACT T_FINAL T_PRIVATE
+%type <ParsedNode> T_PROTECTED T_PUBLIC T_LIST T_ARRAY T_CALLABLE T_THREAD_LOCAL
+%type <ParsedNode> T_MODULE T_PACKAGE T_ASYNC T_EXPORT T_DEFER T_IF T_ELSEIF T_ELSE
+%type <ParsedNode> T_ECHO T_DO T_WHILE T_FOR T_FOREACH T_SWITCH T_CASE T_DEFAULT T_BREAK
+%type <ParsedNode> T_CONTINUE T_FALLTHROUGH T_GOTO T_RETURN T_TRY T_CATCH T_FINALLY
+%type <ParsedNode> T_THROW T_UNSET T_ISSET T_EMPTY T_HALT_COMPILER T_EVAL T_INCLUDE
+%type <ParsedNode> T_INCLUDE_ONCE T_REQUIRE T_REQUIRE_ONCE T_LOGICAL_OR T_LOGICAL_XOR
+%type <ParsedNode> T_LOGICAL_AND T_PRINT T_YIELD T_YIELD_FROM T_INSTANCEOF T_INT_CAST
+%type <ParsedNode> T_DOUBLE_CAST T_STRING_CAST T_ARRAY_CAST T_OBJECT_CAST T_BOOL_CAST
+%type <ParsedNode> T_UNSET_CAST T_NEW T_CLONE T_EXIT T_DECLARE T_ENDDECLARE
+%type <ParsedNode> T_CLASS_REF_STATIC T_CLASS_REF_SELF T_CLASS_REF_PARENT T_OBJ_REF
+%type <ParsedNode> T_TRUE T_FALSE T_NULL T_AWAIT T_PLUS_SIGN T_MINUS_SIGN T_MUL_SIGN
+%type <ParsedNode> T_DIV_SIGN T_MOD_SIGN T_EQUAL T_STR_CONCAT T_PLUS_EQUAL T_MINUS_EQUAL
+%type <ParsedNode> T_MUL_EQUAL T_DIV_EQUAL T_STR_CONCAT_EQUAL T_MOD_EQUAL T_AND_EQUAL
+%type <ParsedNode> T_OR_EQUAL T_XOR_EQUAL T_SL_EQUAL T_SR_EQUAL T_COALESCE_EQUAL
+%type <ParsedNode> T_BOOLEAN_OR T_BOOLEAN_AND T_IS_EQUAL T_IS_NOT_EQUAL T_IS_IDENTICAL
+%type <ParsedNode> T_IS_NOT_IDENTICAL T_IS_SMALLER T_IS_SMALLER_OR_EQUAL
+%type <ParsedNode> T_IS_GREATER_OR_EQUAL T_IS_GREATER T_SPACESHIP T_SL T_SR T_INC T_DEC
+%type <ParsedNode> T_NS_SEPARATOR T_ELLIPSIS T_COALESCE T_POW T_POW_EQUAL
+%type <ParsedNode> T_OBJECT_OPERATOR T_DOUBLE_ARROW T_DOLLAR_OPEN_CURLY_BRACES
+%type <ParsedNode> T_CURLY_OPEN T_PAAMAYIM_NEKUDOTAYIM T_LEFT_PAREN T_RIGHT_PAREN
+%type <ParsedNode> T_LEFT_BRACE T_RIGHT_BRACE T_LEFT_SQUARE_BRACKET
+%type <ParsedNode> T_RIGHT_SQUARE_BRACKET T_LEFT_ANGLE T_RIGHT_ANGLE T_COMMA T_COLON
+%type <ParsedNode> T_SEMICOLON T_BACKTICK T_SINGLE_QUOTE T_DOUBLE_QUOTE T_VBAR T_CARET
+%type <ParsedNode> T_EXCLAMATION_MARK T_TILDE T_DOLLAR_SIGN T_QUESTION_MARK
+%type <ParsedNode> T_ERROR_SUPPRESS_SIGN T_AMPERSAND T_LNUMBER T_DNUMBER
+%type <ParsedNode> T_IDENTIFIER_STRING T_VARIABLE T_ENCAPSED_AND_WHITESPACE
+%type <ParsedNode> T_CONSTANT_ENCAPSED_STRING T_STRING_VARNAME T_NUM_STRING T_WHITESPACE
+%type <ParsedNode> T_PREFIX_OPERATOR T_POSTFIX_OPERATOR T_BINARY_OPERATOR T_COMMENT
+%type <ParsedNode> T_DOC_COMMENT T_OPEN_TAG T_OPEN_TAG_WITH_ECHO T_CLOSE_TAG
+%type <ParsedNode> T_START_HEREDOC T_END_HEREDOC T_ERROR T_UNKNOWN_MARK
+
+%type <ParsedNode> reserved_non_modifiers semi_reserved identifier name top_statement
+%type <ParsedNode> use_type group_use_declaration mixed_group_use_declaration
+%type <ParsedNode> possible_comma inline_use_declaration unprefixed_use_declaration
+%type <ParsedNode> use_declaration inner_statement statement finally_statement
+%type <ParsedNode> unset_variable function_declaration_statement is_reference
+%type <ParsedNode> is_variadic class_declaration_statement class_modifier
+%type <ParsedNode> trait_declaration_statement interface_declaration_statement
+%type <ParsedNode> extends_from interface_extends_list implements_list foreach_variable
+%type <ParsedNode> switch_case_list case_separator if_stmt parameter optional_type
+%type <ParsedNode> type_expr type return_type argument_list argument global_var
+%type <ParsedNode> static_var class_statement trait_adaptations trait_adaptation
+%type <ParsedNode> trait_precedence trait_alias trait_method_reference
+%type <ParsedNode> absolute_trait_method_reference method_body variable_modifiers
+%type <ParsedNode> method_modifiers member_modifier property class_const_decl const_decl
+%type <ParsedNode> echo_expr anonymous_class new_expr expr inline_function fn function
+%type <ParsedNode> returns_ref lexical_vars lexical_var function_call class_name
+%type <ParsedNode> class_name_reference exit_expr backticks_expr ctor_arguments
+%type <ParsedNode> dereferencable_scalar scalar constant optional_expr
+%type <ParsedNode> variable_class_name dereferencable callable_expr callable_variable
+%type <ParsedNode> variable simple_variable static_member new_variable member_name
+%type <ParsedNode> property_name possible_array_pair array_pair encaps_var
+%type <ParsedNode> encaps_var_offset internal_functions_in_bison isset_variable
+
+%type <PendingSyntaxList> top_statement_list namespace_name inline_use_declarations
+%type <PendingSyntaxList> unprefixed_use_declarations use_declarations const_list
+%type <PendingSyntaxList> inner_statement_list catch_list catch_name_list unset_variables
+%type <PendingSyntaxList> class_modifiers case_list if_stmt_without_else parameter_list
+%type <PendingSyntaxList> non_empty_parameter_list non_empty_argument_list global_var_list
+%type <PendingSyntaxList> static_var_list class_statement_list name_list trait_adaptation_list
+%type <PendingSyntaxList> non_empty_member_modifiers property_list class_const_list echo_expr_list
+%type <PendingSyntaxList> for_exprs non_empty_for_exprs lexical_var_list array_pair_list
+%type <PendingSyntaxList> non_empty_array_pair_list encaps_list isset_variables
+
+%type <std::uint64_t> backup_fn_flags
 %type <unsigned char *> backup_lex_pos
 %type <std::string> backup_doc_comment
-
 %% /* Rules */
 
 start:
    top_statement_list {
-
-	}
+      builder->finishSourceFile($1);
+   }
+|  T_FUNCTION_BODY_START inner_statement_list {
+      builder->finishSkippedBody($2);
+   }
 ;
 
 reserved_non_modifiers:
-	  T_INCLUDE | T_INCLUDE_ONCE | T_EVAL | T_REQUIRE | T_REQUIRE_ONCE | T_LOGICAL_OR | T_LOGICAL_XOR | T_LOGICAL_AND
-	| T_INSTANCEOF | T_NEW | T_CLONE | T_EXIT | T_IF | T_ELSEIF | T_ELSE | T_ECHO | T_DO | T_WHILE
-	| T_FOR | T_FOREACH | T_DECLARE | T_ENDDECLARE | T_AS | T_TRY | T_CATCH | T_FINALLY
-	| T_THROW | T_USE | T_INSTEADOF | T_GLOBAL | T_VAR | T_UNSET | T_ISSET | T_EMPTY | T_CONTINUE | T_GOTO
-	| T_FUNCTION | T_CONST | T_RETURN | T_PRINT | T_YIELD | T_LIST | T_SWITCH | T_CASE | T_DEFAULT | T_BREAK
-	| T_ARRAY | T_CALLABLE | T_EXTENDS | T_IMPLEMENTS | T_NAMESPACE | T_TRAIT | T_INTERFACE | T_CLASS
-	| T_CLASS_CONST | T_TRAIT_CONST | T_FUNC_CONST | T_METHOD_CONST | T_LINE | T_FILE | T_DIR | T_NS_CONST | T_FN
+   T_INCLUDE { $$ = std::move($1); }
+|  T_INCLUDE_ONCE { $$ = std::move($1); }
+|  T_EVAL { $$ = std::move($1); }
+|  T_REQUIRE { $$ = std::move($1); }
+|  T_REQUIRE_ONCE { $$ = std::move($1); }
+|  T_LOGICAL_OR { $$ = std::move($1); }
+|  T_LOGICAL_XOR { $$ = std::move($1); }
+|  T_LOGICAL_AND { $$ = std::move($1); }
+|  T_INSTANCEOF { $$ = std::move($1); }
+|  T_NEW { $$ = std::move($1); }
+|  T_CLONE { $$ = std::move($1); }
+|  T_EXIT { $$ = std::move($1); }
+|  T_IF { $$ = std::move($1); }
+|  T_ELSEIF { $$ = std::move($1); }
+|  T_ELSE { $$ = std::move($1); }
+|  T_ECHO { $$ = std::move($1); }
+|  T_DO { $$ = std::move($1); }
+|  T_WHILE { $$ = std::move($1); }
+|  T_FOR { $$ = std::move($1); }
+|  T_FOREACH { $$ = std::move($1); }
+|  T_DECLARE { $$ = std::move($1); }
+|  T_ENDDECLARE { $$ = std::move($1); }
+|  T_AS { $$ = std::move($1); }
+|  T_TRY { $$ = std::move($1); }
+|  T_CATCH { $$ = std::move($1); }
+|  T_FINALLY { $$ = std::move($1); }
+|  T_THROW { $$ = std::move($1); }
+|  T_USE { $$ = std::move($1); }
+|  T_INSTEADOF { $$ = std::move($1); }
+|  T_GLOBAL { $$ = std::move($1); }
+|  T_VAR { $$ = std::move($1); }
+|  T_UNSET { $$ = std::move($1); }
+|  T_ISSET { $$ = std::move($1); }
+|  T_EMPTY { $$ = std::move($1); }
+|  T_CONTINUE { $$ = std::move($1); }
+|  T_GOTO { $$ = std::move($1); }
+|  T_FUNCTION { $$ = std::move($1); }
+|  T_CONST { $$ = std::move($1); }
+|  T_RETURN { $$ = std::move($1); }
+|  T_PRINT { $$ = std::move($1); }
+|  T_YIELD { $$ = std::move($1); }
+|  T_LIST { $$ = std::move($1); }
+|  T_SWITCH { $$ = std::move($1); }
+|  T_CASE { $$ = std::move($1); }
+|  T_DEFAULT { $$ = std::move($1); }
+|  T_BREAK { $$ = std::move($1); }
+|  T_ARRAY { $$ = std::move($1); }
+|  T_CALLABLE { $$ = std::move($1); }
+|  T_EXTENDS { $$ = std::move($1); }
+|  T_IMPLEMENTS { $$ = std::move($1); }
+|  T_NAMESPACE { $$ = std::move($1); }
+|  T_TRAIT { $$ = std::move($1); }
+|  T_INTERFACE { $$ = std::move($1); }
+|  T_CLASS { $$ = std::move($1); }
+|  T_CLASS_CONST { $$ = std::move($1); }
+|  T_TRAIT_CONST { $$ = std::move($1); }
+|  T_FUNC_CONST { $$ = std::move($1); }
+|  T_METHOD_CONST { $$ = std::move($1); }
+|  T_LINE { $$ = std::move($1); }
+|  T_FILE { $$ = std::move($1); }
+|  T_DIR { $$ = std::move($1); }
+|  T_NS_CONST { $$ = std::move($1); }
+|  T_FN { $$ = std::move($1); }
 ;
 
 semi_reserved:
-	   reserved_non_modifiers
-   |  T_STATIC | T_ABSTRACT | T_FINAL | T_PRIVATE | T_PROTECTED | T_PUBLIC
+   reserved_non_modifiers { $$ = std::move($1); }
+|  T_STATIC { $$ = std::move($1); }
+|  T_ABSTRACT { $$ = std::move($1); }
+|  T_FINAL { $$ = std::move($1); }
+|  T_PRIVATE { $$ = std::move($1); }
+|  T_PROTECTED { $$ = std::move($1); }
+|  T_PUBLIC { $$ = std::move($1); }
 ;
 
 identifier:
-	T_IDENTIFIER_STRING {
-
-	}
-|	semi_reserved {
-
-	}
+   T_IDENTIFIER_STRING { $$ = std::move($1); }
+|  semi_reserved { $$ = std::move($1); }
 ;
 
 top_statement_list:
    top_statement_list top_statement {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
+      builder->commitTopStatements($$, @$);
    }
-|  %empty {
-
+|  top_statement_list error T_SEMICOLON {
+      $$ = $1;
+      builder->recoverList($$, AstNodeKind::UnknownStmt, {@2.begin, @3.end});
+      builder->commitTopStatements($$, @$);
+      yyerrok;
    }
+|  %empty { $$ = builder->beginList(); }
 ;
 
 namespace_name:
    T_IDENTIFIER_STRING {
-
+      $$ = builder->beginList({$1});
    }
 |  namespace_name T_NS_SEPARATOR T_IDENTIFIER_STRING {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 name:
    namespace_name {
-
+      $$ = builder->finishList($1, AstNodeKind::Name);
    }
 |  T_NAMESPACE T_NS_SEPARATOR namespace_name {
-
+      $$ = builder->makeNode(AstNodeKind::RelativeName, {$1, $2, builder->finishList($3, AstNodeKind::Name)});
    }
 |  T_NS_SEPARATOR namespace_name {
-
+      $$ = builder->makeNode(AstNodeKind::FullyQualifiedName, {$1, builder->finishList($2, AstNodeKind::Name)});
    }
 ;
 
 top_statement:
-   statement {
-      
-   }
-|  function_declaration_statement {
-
-   }
-|  class_declaration_statement {
-
-   }
-|  trait_declaration_statement {
-
-   }
-|  interface_declaration_statement {
-
-   }
+   statement { $$ = std::move($1); }
+|  function_declaration_statement { $$ = std::move($1); }
+|  class_declaration_statement { $$ = std::move($1); }
+|  trait_declaration_statement { $$ = std::move($1); }
+|  interface_declaration_statement { $$ = std::move($1); }
 |  T_HALT_COMPILER T_LEFT_PAREN T_RIGHT_PAREN T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::HaltCompilerStmt, {$1, $2, $3, $4});
    }
 |  T_NAMESPACE namespace_name T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::NamespaceStmt, {$1, builder->finishList($2, AstNodeKind::Name), $3});
    }
-|  T_NAMESPACE namespace_name {}
-   T_LEFT_BRACE top_statement_list T_RIGHT_BRACE {
-
+|  T_NAMESPACE namespace_name {} T_LEFT_BRACE top_statement_list T_RIGHT_BRACE {
+      ParsedNode topStatementList = builder->finishList($5, AstNodeKind::TopStmtList);
+      ParsedNode namespaceName = builder->finishList($2, AstNodeKind::Name);
+      $$ = builder->makeNode(AstNodeKind::NamespaceBlockStmt, {$1, namespaceName, $4, topStatementList, $6});
    }
-|  T_NAMESPACE {}
-   T_LEFT_BRACE top_statement_list T_RIGHT_BRACE {
+|  T_NAMESPACE {} T_LEFT_BRACE top_statement_list T_RIGHT_BRACE {
+      $$ = builder->makeNode(AstNodeKind::NamespaceBlockStmt, {$1, $3, builder->finishList($4, AstNodeKind::TopStmtList), $5});
    }
 |  T_USE mixed_group_use_declaration T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::UseStmt, {$1, $2, $3});
    }
 |  T_USE use_type group_use_declaration T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::UseStmt, {$1, $2, $3, $4});
    }
 |  T_USE use_declarations T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::UseStmt, {$1, builder->finishList($2, AstNodeKind::UseDeclList), $3});
    }
 |  T_USE use_type use_declarations T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::UseStmt, {$1, $2, builder->finishList($3, AstNodeKind::UseDeclList), $4});
    }
 |  T_CONST const_list T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::ConstStmt, {$1, builder->finishList($2, AstNodeKind::ConstDeclList), $3});
    }
 ;
 
 use_type:
-   T_FUNCTION {
-
-   }
-|  T_CONST {
-
-   }
+   T_FUNCTION { $$ = std::move($1); }
+|  T_CONST { $$ = std::move($1); }
 ;
 
 group_use_declaration:
    namespace_name T_NS_SEPARATOR T_LEFT_BRACE unprefixed_use_declarations possible_comma T_RIGHT_BRACE {
-
+      ParsedNode unprefixedUseDeclarations = builder->finishList($4, AstNodeKind::UseDeclList);
+      ParsedNode namespaceName = builder->finishList($1, AstNodeKind::Name);
+      $$ = builder->makeNode(AstNodeKind::GroupUseDecl, {namespaceName, $2, $3, unprefixedUseDeclarations, $5, $6});
    }
 |  T_NS_SEPARATOR namespace_name T_NS_SEPARATOR T_LEFT_BRACE unprefixed_use_declarations possible_comma T_RIGHT_BRACE {
-
+      ParsedNode unprefixedUseDeclarations = builder->finishList($5, AstNodeKind::UseDeclList);
+      ParsedNode namespaceName = builder->finishList($2, AstNodeKind::Name);
+      $$ = builder->makeNode(AstNodeKind::GroupUseDecl, {$1, namespaceName, $3, $4, unprefixedUseDeclarations, $6, $7});
    }
 ;
 
 mixed_group_use_declaration:
    namespace_name T_NS_SEPARATOR T_LEFT_BRACE inline_use_declarations possible_comma T_RIGHT_BRACE {
-
+      ParsedNode inlineUseDeclarations = builder->finishList($4, AstNodeKind::UseDeclList);
+      ParsedNode namespaceName = builder->finishList($1, AstNodeKind::Name);
+      $$ = builder->makeNode(AstNodeKind::GroupUseDecl, {namespaceName, $2, $3, inlineUseDeclarations, $5, $6});
    }
 |  T_NS_SEPARATOR namespace_name T_NS_SEPARATOR T_LEFT_BRACE inline_use_declarations possible_comma T_RIGHT_BRACE {
-
+      ParsedNode inlineUseDeclarations = builder->finishList($5, AstNodeKind::UseDeclList);
+      ParsedNode namespaceName = builder->finishList($2, AstNodeKind::Name);
+      $$ = builder->makeNode(AstNodeKind::GroupUseDecl, {$1, namespaceName, $3, $4, inlineUseDeclarations, $6, $7});
    }
 ;
 
 possible_comma:
-   %empty 
-|  T_COMMA
+   %empty { $$ = nullptr; }
+|  T_COMMA { $$ = std::move($1); }
 ;
 
 inline_use_declarations:
    inline_use_declarations T_COMMA inline_use_declaration {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  inline_use_declaration {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 unprefixed_use_declarations:
    unprefixed_use_declarations T_COMMA unprefixed_use_declaration {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  unprefixed_use_declaration {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 use_declarations:
    use_declarations T_COMMA use_declaration {
-      
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  use_declaration {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 inline_use_declaration:
-   unprefixed_use_declaration {
-
-   }
+   unprefixed_use_declaration { $$ = std::move($1); }
 |  use_type unprefixed_use_declaration {
+      $$ = builder->makeNode(AstNodeKind::TypedUseDecl, {$1, $2});
    }
 ;
 
 unprefixed_use_declaration:
    namespace_name {
-
+      $$ = builder->finishList($1, AstNodeKind::Name);
    }
 |  namespace_name T_AS T_IDENTIFIER_STRING {
-
+      $$ = builder->makeNode(AstNodeKind::UseDecl, {builder->finishList($1, AstNodeKind::Name), $2, $3});
    }
 ;
 
 use_declaration:
-   unprefixed_use_declaration {
-
-   }
+   unprefixed_use_declaration { $$ = std::move($1); }
 |  T_NS_SEPARATOR unprefixed_use_declaration {
-
+      $$ = builder->makeNode(AstNodeKind::UseDecl, {$1, $2});
    }
 ;
 
 const_list:
    const_list T_COMMA const_decl {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  const_decl {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 inner_statement_list:
    inner_statement_list inner_statement {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
-|  %empty {
-
+|  inner_statement_list error T_SEMICOLON {
+      $$ = $1;
+      builder->recoverList($$, AstNodeKind::UnknownStmt, {@2.begin, @3.end});
+      yyerrok;
    }
+|  %empty { $$ = builder->beginList(); }
 ;
 
 inner_statement:
-   statement {
-
-   }
-|  function_declaration_statement {
-
-   }
-|  class_declaration_statement {
-
-   }
-|  trait_declaration_statement {
-
-   }
-|  interface_declaration_statement {
-
-   }
+   statement { $$ = std::move($1); }
+|  function_declaration_statement { $$ = std::move($1); }
+|  class_declaration_statement { $$ = std::move($1); }
+|  trait_declaration_statement { $$ = std::move($1); }
+|  interface_declaration_statement { $$ = std::move($1); }
 |  T_HALT_COMPILER T_LEFT_PAREN T_RIGHT_PAREN T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::HaltCompilerStmt, {$1, $2, $3, $4});
    }
 ;
 
 statement:
    T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE {
-
-   }
-|  if_stmt {
-
+      $$ = builder->makeNode(AstNodeKind::CodeBlock, {$1, builder->finishList($2, AstNodeKind::InnerStmtList), $3});
    }
+|  if_stmt { $$ = std::move($1); }
 |  T_WHILE T_LEFT_PAREN expr T_RIGHT_PAREN statement {
-
+      $$ = builder->makeNode(AstNodeKind::WhileStmt, {$1, $2, $3, $4, $5});
    }
 |  T_DO statement T_WHILE T_LEFT_PAREN expr T_RIGHT_PAREN T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::DoWhileStmt, {$1, $2, $3, $4, $5, $6, $7});
    }
 |  T_FOR T_LEFT_PAREN for_exprs T_SEMICOLON for_exprs T_SEMICOLON for_exprs T_RIGHT_PAREN statement {
-
+      ParsedNode forExprs7 = builder->finishList($7, AstNodeKind::ForExprList);
+      ParsedNode forExprs5 = builder->finishList($5, AstNodeKind::ForExprList);
+      ParsedNode forExprs3 = builder->finishList($3, AstNodeKind::ForExprList);
+      $$ = builder->makeNode(AstNodeKind::ForStmt, {$1, $2, forExprs3, $4, forExprs5, $6, forExprs7, $8, $9});
    }
 |  T_SWITCH T_LEFT_PAREN expr T_RIGHT_PAREN switch_case_list {
-
+      $$ = builder->makeNode(AstNodeKind::SwitchStmt, {$1, $2, $3, $4, $5});
    }
 |  T_BREAK optional_expr T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::BreakStmt, {$1, $2, $3});
    }
 |  T_CONTINUE optional_expr T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::ContinueStmt, {$1, $2, $3});
    }
 |  T_FALLTHROUGH T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::FallthroughStmt, {$1, $2});
    }
 |  T_RETURN optional_expr T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::ReturnStmt, {$1, $2, $3});
    }
 |  T_GLOBAL global_var_list T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::GlobalStmt, {$1, builder->finishList($2, AstNodeKind::GlobalVariableList), $3});
    }
 |  T_STATIC static_var_list T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::StaticStmt, {$1, builder->finishList($2, AstNodeKind::StaticVariableList), $3});
    }
 |  T_ECHO echo_expr_list T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::EchoStmt, {$1, builder->finishList($2, AstNodeKind::EchoExprList), $3});
    }
 |  expr T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::ExprStmt, {$1, $2});
    }
 |  T_UNSET T_LEFT_PAREN unset_variables possible_comma T_RIGHT_PAREN T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::UnsetStmt, {$1, $2, builder->finishList($3, AstNodeKind::UnsetVariableList), $4, $5, $6});
    }
 |  T_FOREACH T_LEFT_PAREN expr T_AS foreach_variable T_RIGHT_PAREN statement {
-
+      $$ = builder->makeNode(AstNodeKind::ForeachStmt, {$1, $2, $3, $4, $5, $6, $7});
    }
 |  T_FOREACH T_LEFT_PAREN expr T_AS foreach_variable T_DOUBLE_ARROW foreach_variable T_RIGHT_PAREN statement {
-
+      $$ = builder->makeNode(AstNodeKind::ForeachStmt, {$1, $2, $3, $4, $5, $6, $7, $8, $9});
    }
-|  T_DECLARE T_LEFT_PAREN const_list T_RIGHT_PAREN {}
-   statement {
-
+|  T_DECLARE T_LEFT_PAREN const_list T_RIGHT_PAREN {} statement {
+      $$ = builder->makeNode(AstNodeKind::DeclareStmt, {$1, $2, builder->finishList($3, AstNodeKind::ConstDeclList), $4, $6});
    }
 |  T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::EmptyStmt, {$1});
    }
 |  T_TRY T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE catch_list finally_statement {
-
+      ParsedNode catchList = builder->finishList($5, AstNodeKind::CatchList);
+      ParsedNode innerStatementList = builder->finishList($3, AstNodeKind::InnerStmtList);
+      $$ = builder->makeNode(AstNodeKind::TryStmt, {$1, $2, innerStatementList, $4, catchList, $6});
    }
 |  T_THROW expr T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::ThrowStmt, {$1, $2, $3});
    }
 |  T_GOTO T_IDENTIFIER_STRING T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::GotoStmt, {$1, $2, $3});
    }
 |  T_IDENTIFIER_STRING T_COLON {
-
+      $$ = builder->makeNode(AstNodeKind::LabelStmt, {$1, $2});
    }
 ;
 
 catch_list:
-   %empty {
-
-   }
+   %empty { $$ = builder->beginList(); }
 |  catch_list T_CATCH T_LEFT_PAREN catch_name_list T_VARIABLE T_RIGHT_PAREN T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE {
-
+      ParsedNode innerStatementList = builder->finishList($8, AstNodeKind::InnerStmtList);
+      ParsedNode catchNameList = builder->finishList($4, AstNodeKind::CatchTypeList);
+      $$ = $1;
+      builder->appendToList($$, {$2, $3, catchNameList, $5, $6, $7, innerStatementList, $9});
    }
 ;
 
 catch_name_list:
    name {
-
+      $$ = builder->beginList({$1});
    }
 |  catch_name_list T_VBAR name {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 finally_statement:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_FINALLY T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::FinallyClause, {$1, $2, builder->finishList($3, AstNodeKind::InnerStmtList), $4});
    }
 ;
 
 unset_variables:
    unset_variable {
-
+      $$ = builder->beginList({$1});
    }
 |  unset_variables T_COMMA unset_variable {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 unset_variable:
-   variable {
-      
-   }
+   variable { $$ = std::move($1); }
 ;
 
 function_declaration_statement:
-   function returns_ref T_IDENTIFIER_STRING backup_doc_comment T_LEFT_PAREN parameter_list T_RIGHT_PAREN return_type
-   backup_fn_flags T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE backup_fn_flags {
-
+   function returns_ref T_IDENTIFIER_STRING backup_doc_comment T_LEFT_PAREN parameter_list T_RIGHT_PAREN return_type backup_fn_flags T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE backup_fn_flags {
+      ParsedNode innerStatementList = builder->finishFunctionBody($11, @10.begin);
+      ParsedNode parameterList = builder->finishList($6, AstNodeKind::ParameterList);
+      $$ = builder->makeNode(AstNodeKind::FunctionDecl, {$1, $2, $3, $5, parameterList, $7, $8, $10, innerStatementList, $12});
    }
 ;
 
 is_reference:
-   %empty {
-
-   }
-|  T_AMPERSAND {
-
-   }
+   %empty { $$ = nullptr; }
+|  T_AMPERSAND { $$ = std::move($1); }
 ;
 
 is_variadic:
-   %empty {
-
-   }
-|  T_ELLIPSIS {
-
-   }
+   %empty { $$ = nullptr; }
+|  T_ELLIPSIS { $$ = std::move($1); }
 ;
 
 class_declaration_statement:
-   class_modifiers T_CLASS  {}
-   T_IDENTIFIER_STRING extends_from implements_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
-
+   class_modifiers T_CLASS {} T_IDENTIFIER_STRING extends_from implements_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
+      ParsedNode classStatementList = builder->finishList($9, AstNodeKind::MemberDeclList);
+      ParsedNode classModifiers = builder->finishList($1, AstNodeKind::ClassModifierList);
+      $$ = builder->makeNode(AstNodeKind::ClassDecl, {classModifiers, $2, $4, $5, $6, $8, classStatementList, $10});
    }
-|  T_CLASS {}
-   T_IDENTIFIER_STRING extends_from implements_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
-
+|  T_CLASS {} T_IDENTIFIER_STRING extends_from implements_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
+      $$ = builder->makeNode(AstNodeKind::ClassDecl, {$1, $3, $4, $5, $7, builder->finishList($8, AstNodeKind::MemberDeclList), $9});
    }
 ;
 
 class_modifiers:
    class_modifier {
-
+      $$ = builder->beginList({$1});
    }
 |  class_modifiers class_modifier {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
 ;
 
 class_modifier:
-   T_ABSTRACT {
-
-   }
-|  T_FINAL {
-
-   }
+   T_ABSTRACT { $$ = std::move($1); }
+|  T_FINAL { $$ = std::move($1); }
 ;
 
 trait_declaration_statement:
-   T_TRAIT {}
-   T_IDENTIFIER_STRING interface_extends_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
-
+   T_TRAIT {} T_IDENTIFIER_STRING interface_extends_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
+      $$ = builder->makeNode(AstNodeKind::TraitDecl, {$1, $3, $4, $6, builder->finishList($7, AstNodeKind::MemberDeclList), $8});
    }
 ;
 
-interface_declaration_statement: 
-   T_INTERFACE {}
-   T_IDENTIFIER_STRING interface_extends_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
-
+interface_declaration_statement:
+   T_INTERFACE {} T_IDENTIFIER_STRING interface_extends_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
+      $$ = builder->makeNode(AstNodeKind::InterfaceDecl, {$1, $3, $4, $6, builder->finishList($7, AstNodeKind::MemberDeclList), $8});
    }
 ;
 
 extends_from:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_EXTENDS name {
-
+      $$ = builder->makeNode(AstNodeKind::ExtendsClause, {$1, $2});
    }
 ;
 
 interface_extends_list:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_EXTENDS name_list {
-
+      $$ = builder->makeNode(AstNodeKind::InterfaceExtendsClause, {$1, builder->finishList($2, AstNodeKind::NameList)});
    }
 ;
 
 implements_list:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_IMPLEMENTS name_list {
-
+      $$ = builder->makeNode(AstNodeKind::ImplementsClause, {$1, builder->finishList($2, AstNodeKind::NameList)});
    }
 ;
 
 foreach_variable:
-   variable {
-      
-   }
+   variable { $$ = std::move($1); }
 |  T_AMPERSAND variable {
-
+      $$ = builder->makeNode(AstNodeKind::ReferenceExpr, {$1, $2});
    }
 |  T_LIST T_LEFT_PAREN array_pair_list T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ListExpr, {$1, $2, builder->finishList($3, AstNodeKind::ArrayPairList), $4});
    }
 |  T_LEFT_SQUARE_BRACKET array_pair_list T_RIGHT_SQUARE_BRACKET {
-
+      $$ = builder->makeNode(AstNodeKind::ListExpr, {$1, builder->finishList($2, AstNodeKind::ArrayPairList), $3});
    }
 ;
 
 switch_case_list:
    T_LEFT_BRACE case_list T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::SwitchCaseBlock, {$1, builder->finishList($2, AstNodeKind::SwitchCaseList), $3});
    }
 |  T_LEFT_BRACE T_SEMICOLON case_list T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::SwitchCaseBlock, {$1, $2, builder->finishList($3, AstNodeKind::SwitchCaseList), $4});
    }
 ;
 
 case_list:
-   %empty {
-
-   }
+   %empty { $$ = builder->beginList(); }
 |  case_list T_CASE expr case_separator inner_statement_list {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3, $4, builder->finishList($5, AstNodeKind::InnerStmtList)});
    }
 |  case_list T_DEFAULT case_separator inner_statement_list {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3, builder->finishList($4, AstNodeKind::InnerStmtList)});
    }
 ;
 
 case_separator:
-   T_COLON
+   T_COLON { $$ = std::move($1); }
 ;
 
 if_stmt_without_else:
    T_IF T_LEFT_PAREN expr T_RIGHT_PAREN statement {
-
+      $$ = builder->beginList({$1, $2, $3, $4, $5});
    }
 |  if_stmt_without_else T_ELSEIF T_LEFT_PAREN expr T_RIGHT_PAREN statement {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3, $4, $5, $6});
    }
 ;
 
 if_stmt:
    if_stmt_without_else %prec T_NOELSE {
-
+      $$ = builder->finishList($1, AstNodeKind::IfStmt);
    }
 |  if_stmt_without_else T_ELSE statement {
-
+      builder->appendToList($1, {$2, $3});
+      $$ = builder->finishList($1, AstNodeKind::IfStmt);
    }
 ;
 
 parameter_list:
-   non_empty_parameter_list {
-
-   }
-|  %empty {
-
-   }
+   non_empty_parameter_list { $$ = $1; }
+|  %empty { $$ = builder->beginList(); }
 ;
 
 non_empty_parameter_list:
    parameter {
-
+      $$ = builder->beginList({$1});
    }
 |  non_empty_parameter_list T_COMMA parameter {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 parameter:
    optional_type is_reference is_variadic T_VARIABLE {
-
+      $$ = builder->makeNode(AstNodeKind::ParameterDecl, {$1, $2, $3, $4});
    }
 |  optional_type is_reference is_variadic T_VARIABLE T_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::ParameterDecl, {$1, $2, $3, $4, $5, $6});
    }
 ;
 
 optional_type:
-   %empty {
-
-   }
-|  type_expr {
-
-   }
+   %empty { $$ = nullptr; }
+|  type_expr { $$ = std::move($1); }
 ;
 
 type_expr:
-   type {
-
-   }
+   type { $$ = std::move($1); }
 |  T_QUESTION_MARK type {
-
+      $$ = builder->makeNode(AstNodeKind::NullableType, {$1, $2});
    }
 ;
 
 type:
-   T_ARRAY {
-
-   }
-|  T_CALLABLE {
-
-   }
-|  name {
-
-   }
+   T_ARRAY { $$ = std::move($1); }
+|  T_CALLABLE { $$ = std::move($1); }
+|  name { $$ = std::move($1); }
 ;
 
 return_type:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_COLON type_expr {
-
+      $$ = builder->makeNode(AstNodeKind::ReturnTypeClause, {$1, $2});
    }
 ;
 
 argument_list:
    T_LEFT_PAREN T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ArgumentClause, {$1, $2});
    }
 |  T_LEFT_PAREN non_empty_argument_list possible_comma T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ArgumentClause, {$1, builder->finishList($2, AstNodeKind::ArgumentList), $3, $4});
    }
 ;
 
 non_empty_argument_list:
    argument {
-
+      $$ = builder->beginList({$1});
    }
 |  non_empty_argument_list T_COMMA argument {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 argument:
-   expr {
-
-   }
+   expr { $$ = std::move($1); }
 |  T_ELLIPSIS expr {
-
+      $$ = builder->makeNode(AstNodeKind::SpreadExpr, {$1, $2});
    }
 ;
 
 global_var_list:
    global_var_list T_COMMA global_var {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  global_var {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 global_var:
-   simple_variable {
-
-   }
+   simple_variable { $$ = std::move($1); }
 ;
 
 static_var_list:
    static_var_list T_COMMA static_var {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  static_var {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 static_var:
    T_VARIABLE {
-
+      $$ = builder->makeNode(AstNodeKind::StaticVariableDecl, {$1});
    }
 |  T_VARIABLE T_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::StaticVariableDecl, {$1, $2, $3});
    }
 ;
 
 class_statement_list:
    class_statement_list class_statement {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
-|  %empty {
-
+|  class_statement_list error T_SEMICOLON {
+      $$ = $1;
+      builder->recoverList($$, AstNodeKind::UnknownDecl, {@2.begin, @3.end});
+      yyerrok;
    }
+|  %empty { $$ = builder->beginList(); }
 ;
 
 class_statement:
    variable_modifiers optional_type property_list T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::PropertyListDecl, {$1, $2, builder->finishList($3, AstNodeKind::PropertyList), $4});
    }
 |  method_modifiers T_CONST class_const_list T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::ClassConstListDecl, {$1, $2, builder->finishList($3, AstNodeKind::ClassConstList), $4});
    }
 |  T_USE name_list trait_adaptations {
-
+      $$ = builder->makeNode(AstNodeKind::TraitUseDecl, {$1, builder->finishList($2, AstNodeKind::NameList), $3});
    }
-|  method_modifiers function returns_ref identifier backup_doc_comment T_LEFT_PAREN parameter_list T_RIGHT_PAREN
-   return_type backup_fn_flags method_body backup_fn_flags {
-
+|  method_modifiers function returns_ref identifier backup_doc_comment T_LEFT_PAREN parameter_list T_RIGHT_PAREN return_type backup_fn_flags method_body backup_fn_flags {
+      $$ = builder->makeNode(AstNodeKind::MethodDecl, {$1, $2, $3, $4, $6, builder->finishList($7, AstNodeKind::ParameterList), $8, $9, $11});
    }
 ;
 
 name_list:
    name {
-
+      $$ = builder->beginList({$1});
    }
 |  name_list T_COMMA name {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 trait_adaptations:
    T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAdaptationBlock, {$1});
    }
 |  T_LEFT_BRACE T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAdaptationBlock, {$1, $2});
    }
 |  T_LEFT_BRACE trait_adaptation_list T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAdaptationBlock, {$1, builder->finishList($2, AstNodeKind::TraitAdaptationList), $3});
    }
 ;
 
 trait_adaptation_list:
    trait_adaptation {
-
+      $$ = builder->beginList({$1});
    }
 |  trait_adaptation_list trait_adaptation {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
 ;
 
 trait_adaptation:
    trait_precedence T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAdaptation, {$1, $2});
    }
 |  trait_alias T_SEMICOLON {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAdaptation, {$1, $2});
    }
 ;
 
 trait_precedence:
    absolute_trait_method_reference T_INSTEADOF name_list {
-      
+      $$ = builder->makeNode(AstNodeKind::TraitPrecedence, {$1, $2, builder->finishList($3, AstNodeKind::NameList)});
    }
 ;
 
 trait_alias:
    trait_method_reference T_AS T_IDENTIFIER_STRING {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAlias, {$1, $2, $3});
    }
 |  trait_method_reference T_AS reserved_non_modifiers {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAlias, {$1, $2, $3});
    }
 |  trait_method_reference T_AS member_modifier identifier {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAlias, {$1, $2, $3, $4});
    }
 |  trait_method_reference T_AS member_modifier {
-
+      $$ = builder->makeNode(AstNodeKind::TraitAlias, {$1, $2, $3});
    }
 ;
 
 trait_method_reference:
-   identifier {
-
-   }
-|  absolute_trait_method_reference {
-   }
+   identifier { $$ = std::move($1); }
+|  absolute_trait_method_reference { $$ = std::move($1); }
 ;
 
 absolute_trait_method_reference:
    name T_PAAMAYIM_NEKUDOTAYIM identifier {
-
+      $$ = builder->makeNode(AstNodeKind::TraitMethodReference, {$1, $2, $3});
    }
 ;
 
 method_body:
-   T_SEMICOLON {
-
-   }
+   T_SEMICOLON { $$ = std::move($1); }
 |  T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::CodeBlock, {$1, builder->finishFunctionBody($2, @1.begin), $3});
    }
 ;
 
 variable_modifiers:
    non_empty_member_modifiers {
-
-   }
-|  T_VAR {
-
+      $$ = builder->finishList($1, AstNodeKind::MemberModifierList);
    }
+|  T_VAR { $$ = std::move($1); }
 ;
 
 method_modifiers:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  non_empty_member_modifiers {
-
+      $$ = builder->finishList($1, AstNodeKind::MemberModifierList);
    }
 ;
 
 non_empty_member_modifiers:
    member_modifier {
-
+      $$ = builder->beginList({$1});
    }
 |  non_empty_member_modifiers member_modifier {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
 ;
 
 member_modifier:
-   T_PUBLIC {
-
-   }
-|  T_PROTECTED {
-
-   }
-|  T_PRIVATE {
-
-   }
-|  T_STATIC {
-
-   }
-|  T_ABSTRACT {
-
-   }
-|  T_FINAL {
-
-   }
+   T_PUBLIC { $$ = std::move($1); }
+|  T_PROTECTED { $$ = std::move($1); }
+|  T_PRIVATE { $$ = std::move($1); }
+|  T_STATIC { $$ = std::move($1); }
+|  T_ABSTRACT { $$ = std::move($1); }
+|  T_FINAL { $$ = std::move($1); }
 ;
 
 property_list:
    property_list T_COMMA property {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  property {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 property:
    T_VARIABLE backup_doc_comment {
-
+      $$ = builder->makeNode(AstNodeKind::PropertyDecl, {$1});
    }
 |  T_VARIABLE T_EQUAL expr backup_doc_comment {
-
+      $$ = builder->makeNode(AstNodeKind::PropertyDecl, {$1, $2, $3});
    }
 ;
 
 class_const_list:
    class_const_list T_COMMA class_const_decl {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  class_const_decl {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 class_const_decl:
    identifier T_EQUAL expr backup_doc_comment {
-
+      $$ = builder->makeNode(AstNodeKind::ClassConstDecl, {$1, $2, $3});
    }
 ;
 
 const_decl:
    T_IDENTIFIER_STRING T_EQUAL expr backup_doc_comment {
-
+      $$ = builder->makeNode(AstNodeKind::ConstDecl, {$1, $2, $3});
    }
 ;
 
 echo_expr_list:
    echo_expr_list T_COMMA echo_expr {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  echo_expr {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 echo_expr:
-   expr {
-
-   }
+   expr { $$ = std::move($1); }
 ;
 
 for_exprs:
-   %empty {
-   }
-|  non_empty_for_exprs {
-
-   }
+   %empty { $$ = builder->beginList(); }
+|  non_empty_for_exprs { $$ = $1; }
 ;
 
 non_empty_for_exprs:
    non_empty_for_exprs T_COMMA expr {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  expr {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 anonymous_class:
-   T_CLASS {} ctor_arguments
-   extends_from implements_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
-
+   T_CLASS {} ctor_arguments extends_from implements_list backup_doc_comment T_LEFT_BRACE class_statement_list T_RIGHT_BRACE {
+      $$ = builder->makeNode(AstNodeKind::AnonymousClassExpr, {$1, $3, $4, $5, $7, builder->finishList($8, AstNodeKind::MemberDeclList), $9});
    }
 ;
 
 new_expr:
    T_NEW class_name_reference ctor_arguments {
-
+      $$ = builder->makeNode(AstNodeKind::NewExpr, {$1, $2, $3});
    }
 |  T_NEW anonymous_class {
-
+      $$ = builder->makeNode(AstNodeKind::NewExpr, {$1, $2});
    }
 ;
 
 expr:
-   variable {
-
-   }
+   variable { $$ = std::move($1); }
 |  T_LIST T_LEFT_PAREN array_pair_list T_RIGHT_PAREN T_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::ListAssignExpr, {$1, $2, builder->finishList($3, AstNodeKind::ArrayPairList), $4, $5, $6});
    }
 |  T_LEFT_SQUARE_BRACKET array_pair_list T_RIGHT_SQUARE_BRACKET T_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::ListAssignExpr, {$1, builder->finishList($2, AstNodeKind::ArrayPairList), $3, $4, $5});
    }
 |  variable T_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::AssignExpr, {$1, $2, $3});
    }
 |  variable T_EQUAL T_AMPERSAND variable {
-
+      $$ = builder->makeNode(AstNodeKind::AssignRefExpr, {$1, $2, $3, $4});
    }
 |  T_CLONE expr {
-
+      $$ = builder->makeNode(AstNodeKind::CloneExpr, {$1, $2});
    }
 |  variable T_PLUS_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_MINUS_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_MUL_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_POW_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_DIV_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_STR_CONCAT_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_MOD_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_AND_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_OR_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_XOR_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_SL_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_SR_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_COALESCE_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::CompoundAssignExpr, {$1, $2, $3});
    }
 |  variable T_INC {
-
+      $$ = builder->makeNode(AstNodeKind::PostfixOperatorExpr, {$1, $2});
    }
 |  T_INC variable {
-
+      $$ = builder->makeNode(AstNodeKind::PrefixOperatorExpr, {$1, $2});
    }
 |  variable T_DEC {
-
+      $$ = builder->makeNode(AstNodeKind::PostfixOperatorExpr, {$1, $2});
    }
 |  T_DEC variable {
-
+      $$ = builder->makeNode(AstNodeKind::PrefixOperatorExpr, {$1, $2});
    }
 |  expr T_BOOLEAN_OR expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_BOOLEAN_AND expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_LOGICAL_OR expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_LOGICAL_AND expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_LOGICAL_XOR expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_VBAR expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_AMPERSAND expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_CARET expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_STR_CONCAT expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_PLUS_SIGN expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_MINUS_SIGN expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_MUL_SIGN expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_POW expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_DIV_SIGN expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_MOD_SIGN expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_SL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_SR expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  T_PLUS_SIGN expr %prec T_INC {
-
+      $$ = builder->makeNode(AstNodeKind::PrefixOperatorExpr, {$1, $2});
    }
 |  T_MINUS_SIGN expr %prec T_INC {
-
+      $$ = builder->makeNode(AstNodeKind::PrefixOperatorExpr, {$1, $2});
    }
 |  T_EXCLAMATION_MARK expr {
-
+      $$ = builder->makeNode(AstNodeKind::PrefixOperatorExpr, {$1, $2});
    }
 |  T_TILDE expr {
-
+      $$ = builder->makeNode(AstNodeKind::PrefixOperatorExpr, {$1, $2});
    }
 |  expr T_IS_IDENTICAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_NOT_IDENTICAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_NOT_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_SMALLER expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_SMALLER_OR_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_GREATER expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_IS_GREATER_OR_EQUAL expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_SPACESHIP expr {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
 |  expr T_INSTANCEOF class_name_reference {
-
+      $$ = builder->makeNode(AstNodeKind::InstanceofExpr, {$1, $2, $3});
    }
 |  T_LEFT_PAREN expr T_RIGHT_PAREN {
-
-   }
-|  new_expr {
-
+      $$ = builder->makeNode(AstNodeKind::ParenExpr, {$1, $2, $3});
    }
+|  new_expr { $$ = std::move($1); }
 |  expr T_QUESTION_MARK expr T_COLON expr {
-
+      $$ = builder->makeNode(AstNodeKind::TernaryExpr, {$1, $2, $3, $4, $5});
    }
 |  expr T_QUESTION_MARK T_COLON expr {
-
+      $$ = builder->makeNode(AstNodeKind::ShortTernaryExpr, {$1, $2, $3, $4});
    }
 |  expr T_COALESCE expr {
-
-   }
-|  internal_functions_in_bison {
-
+      $$ = builder->makeNode(AstNodeKind::BinaryOperatorExpr, {$1, $2, $3});
    }
+|  internal_functions_in_bison { $$ = std::move($1); }
 |  T_INT_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_DOUBLE_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_STRING_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_ARRAY_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_OBJECT_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_BOOL_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_UNSET_CAST expr {
-
+      $$ = builder->makeNode(AstNodeKind::CastExpr, {$1, $2});
    }
 |  T_EXIT exit_expr {
-
+      $$ = builder->makeNode(AstNodeKind::ExitExpr, {$1, $2});
    }
 |  T_ERROR_SUPPRESS_SIGN expr {
-
-   }
-|  scalar {
-
+      $$ = builder->makeNode(AstNodeKind::ErrorSuppressExpr, {$1, $2});
    }
+|  scalar { $$ = std::move($1); }
 |  T_BACKTICK backticks_expr T_BACKTICK {
-
+      $$ = builder->makeNode(AstNodeKind::ShellExecExpr, {$1, $2, $3});
    }
 |  T_PRINT expr {
-
+      $$ = builder->makeNode(AstNodeKind::PrintExpr, {$1, $2});
    }
 |  T_YIELD {
-
+      $$ = builder->makeNode(AstNodeKind::YieldExpr, {$1});
    }
 |  T_YIELD expr {
-
+      $$ = builder->makeNode(AstNodeKind::YieldExpr, {$1, $2});
    }
 |  T_YIELD expr T_DOUBLE_ARROW expr {
-
+      $$ = builder->makeNode(AstNodeKind::YieldExpr, {$1, $2, $3, $4});
    }
 |  T_YIELD_FROM expr {
-
-   }
-|  inline_function {
-
+      $$ = builder->makeNode(AstNodeKind::YieldFromExpr, {$1, $2});
    }
+|  inline_function { $$ = std::move($1); }
 |  T_STATIC inline_function {
-
+      $$ = builder->makeNode(AstNodeKind::StaticClosureExpr, {$1, $2});
    }
 ;
 
 inline_function:
-   function returns_ref backup_doc_comment T_LEFT_PAREN parameter_list T_RIGHT_PAREN lexical_vars return_type
-   backup_fn_flags T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE backup_fn_flags {
-
+   function returns_ref backup_doc_comment T_LEFT_PAREN parameter_list T_RIGHT_PAREN lexical_vars return_type backup_fn_flags T_LEFT_BRACE inner_statement_list T_RIGHT_BRACE backup_fn_flags {
+      ParsedNode innerStatementList = builder->finishFunctionBody($11, @10.begin);
+      ParsedNode parameterList = builder->finishList($5, AstNodeKind::ParameterList);
+      $$ = builder->makeNode(AstNodeKind::ClosureExpr, {$1, $2, $4, parameterList, $6, $7, $8, $10, innerStatementList, $12});
    }
-|  fn returns_ref T_LEFT_PAREN parameter_list T_RIGHT_PAREN return_type backup_doc_comment T_DOUBLE_ARROW 
-   backup_fn_flags backup_lex_pos expr backup_fn_flags {
-
+|  fn returns_ref T_LEFT_PAREN parameter_list T_RIGHT_PAREN return_type backup_doc_comment T_DOUBLE_ARROW backup_fn_flags backup_lex_pos expr backup_fn_flags {
+      $$ = builder->makeNode(AstNodeKind::ArrowFunctionExpr, {$1, $2, $3, builder->finishList($4, AstNodeKind::ParameterList), $5, $6, $8, $11});
    }
 ;
 
 fn:
-   T_FN {
-
-   }
+   T_FN { $$ = std::move($1); }
 ;
 
 function:
-   T_FUNCTION {
-
-   }
+   T_FUNCTION { $$ = std::move($1); }
 ;
 
 backup_doc_comment:
-   %empty {
-
-   }
+   %empty {}
 ;
 
 backup_fn_flags:
-   %empty %prec PREC_ARROW_FUNCTION {
-
-   }
+   %empty %prec PREC_ARROW_FUNCTION {}
 ;
 
 backup_lex_pos:
-   %empty {
-
-   }
+   %empty {}
 ;
 
 returns_ref:
-   %empty {
-
-   }
-|  T_AMPERSAND {
-
-   }
+   %empty { $$ = nullptr; }
+|  T_AMPERSAND { $$ = std::move($1); }
 ;
 
 lexical_vars:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_USE T_LEFT_PAREN lexical_var_list T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::LexicalVarsClause, {$1, $2, builder->finishList($3, AstNodeKind::LexicalVarList), $4});
    }
 ;
 
 lexical_var_list:
    lexical_var_list T_COMMA lexical_var {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  lexical_var {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 lexical_var:
    T_VARIABLE {
-      
+      $$ = builder->makeNode(AstNodeKind::LexicalVarDecl, {$1});
    }
 |  T_AMPERSAND T_VARIABLE {
-
+      $$ = builder->makeNode(AstNodeKind::LexicalVarDecl, {$1, $2});
    }
 ;
 
 function_call:
    name argument_list {
-
+      $$ = builder->makeNode(AstNodeKind::FunctionCallExpr, {$1, $2});
    }
 |  class_name T_PAAMAYIM_NEKUDOTAYIM member_name argument_list {
-
+      $$ = builder->makeNode(AstNodeKind::StaticMethodCallExpr, {$1, $2, $3, $4});
    }
 |  variable_class_name T_PAAMAYIM_NEKUDOTAYIM member_name argument_list {
-
+      $$ = builder->makeNode(AstNodeKind::StaticMethodCallExpr, {$1, $2, $3, $4});
    }
 |  callable_expr argument_list {
-
+      $$ = builder->makeNode(AstNodeKind::FunctionCallExpr, {$1, $2});
    }
 ;
 
 class_name:
    T_STATIC {
-
-   }
-|  name {
-
+      $$ = builder->makeNode(AstNodeKind::StaticClassName, {$1});
    }
+|  name { $$ = std::move($1); }
 ;
 
 class_name_reference:
-   class_name {
-
-   }
-|  new_variable {
-
-   }
+   class_name { $$ = std::move($1); }
+|  new_variable { $$ = std::move($1); }
 ;
 
 exit_expr:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_LEFT_PAREN optional_expr T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ParenExpr, {$1, $2, $3});
    }
 ;
 
 backticks_expr:
-   %empty {
-
-   }
+   %empty { $$ = nullptr; }
 |  T_ENCAPSED_AND_WHITESPACE {
-
+      $$ = builder->makeNode(AstNodeKind::EncapsText, {$1});
    }
 |  encaps_list {
-
+      $$ = builder->finishList($1, AstNodeKind::EncapsList);
    }
 ;
 
 ctor_arguments:
-   %empty {
-
-   }
-|  argument_list {
-
-   }
+   %empty { $$ = nullptr; }
+|  argument_list { $$ = std::move($1); }
 ;
 
 dereferencable_scalar:
    T_ARRAY T_LEFT_PAREN array_pair_list T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayExpr, {$1, $2, builder->finishList($3, AstNodeKind::ArrayPairList), $4});
    }
 |  T_LEFT_SQUARE_BRACKET array_pair_list T_RIGHT_SQUARE_BRACKET {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayExpr, {$1, builder->finishList($2, AstNodeKind::ArrayPairList), $3});
    }
 |  T_DOUBLE_QUOTE T_CONSTANT_ENCAPSED_STRING T_DOUBLE_QUOTE {
-
+      $$ = builder->makeNode(AstNodeKind::StringLiteralExpr, {$1, $2, $3});
    }
 |  T_SINGLE_QUOTE T_CONSTANT_ENCAPSED_STRING T_SINGLE_QUOTE {
-
+      $$ = builder->makeNode(AstNodeKind::StringLiteralExpr, {$1, $2, $3});
    }
 ;
 
 scalar:
    T_LNUMBER {
-
+      $$ = builder->makeNode(AstNodeKind::IntegerLiteralExpr, {$1});
    }
 |  T_DNUMBER {
-   
+      $$ = builder->makeNode(AstNodeKind::FloatLiteralExpr, {$1});
    }
 |  T_LINE {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_FILE {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_DIR {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_TRAIT_CONST {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_METHOD_CONST {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_FUNC_CONST {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_NS_CONST {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_CLASS_CONST {
-
+      $$ = builder->makeNode(AstNodeKind::MagicConstantExpr, {$1});
    }
 |  T_START_HEREDOC T_ENCAPSED_AND_WHITESPACE T_END_HEREDOC {
-
+      $$ = builder->makeNode(AstNodeKind::HeredocExpr, {$1, $2, $3});
    }
 |  T_START_HEREDOC T_END_HEREDOC {
-
+      $$ = builder->makeNode(AstNodeKind::HeredocExpr, {$1, $2});
    }
 |  T_DOUBLE_QUOTE encaps_list T_DOUBLE_QUOTE {
-
+      $$ = builder->makeNode(AstNodeKind::InterpolatedStringExpr, {$1, builder->finishList($2, AstNodeKind::EncapsList), $3});
    }
 |  T_START_HEREDOC encaps_list T_END_HEREDOC {
-
-   }
-|  dereferencable_scalar {
-
-   }
-|  constant {
-
+      $$ = builder->makeNode(AstNodeKind::HeredocExpr, {$1, builder->finishList($2, AstNodeKind::EncapsList), $3});
    }
+|  dereferencable_scalar { $$ = std::move($1); }
+|  constant { $$ = std::move($1); }
 ;
 
 constant:
-   name {
-
-   }
+   name { $$ = std::move($1); }
 |  class_name T_PAAMAYIM_NEKUDOTAYIM identifier {
-
+      $$ = builder->makeNode(AstNodeKind::ClassConstantExpr, {$1, $2, $3});
    }
 |  variable_class_name T_PAAMAYIM_NEKUDOTAYIM identifier {
-
+      $$ = builder->makeNode(AstNodeKind::ClassConstantExpr, {$1, $2, $3});
    }
 ;
 
 optional_expr:
-   %empty {
-
-   }
-|  expr {
-
-   }
+   %empty { $$ = nullptr; }
+|  expr { $$ = std::move($1); }
 ;
 
 variable_class_name:
-   dereferencable {
-
-   }
+   dereferencable { $$ = std::move($1); }
 ;
 
 dereferencable:
-   variable {
-
-   }
+   variable { $$ = std::move($1); }
 |  T_LEFT_PAREN expr T_RIGHT_PAREN {
-
-   }
-|  dereferencable_scalar {
-
+      $$ = builder->makeNode(AstNodeKind::ParenExpr, {$1, $2, $3});
    }
+|  dereferencable_scalar { $$ = std::move($1); }
 ;
 
 callable_expr:
-   callable_variable {
-
-   }
+   callable_variable { $$ = std::move($1); }
 |  T_LEFT_PAREN expr T_RIGHT_PAREN {
-
-   }
-|  dereferencable_scalar {
-
+      $$ = builder->makeNode(AstNodeKind::ParenExpr, {$1, $2, $3});
    }
+|  dereferencable_scalar { $$ = std::move($1); }
 ;
 
 callable_variable:
-   simple_variable {
-
-   }
+   simple_variable { $$ = std::move($1); }
 |  dereferencable T_LEFT_SQUARE_BRACKET optional_expr T_RIGHT_SQUARE_BRACKET {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayAccessExpr, {$1, $2, $3, $4});
    }
 |  constant T_LEFT_SQUARE_BRACKET optional_expr T_RIGHT_SQUARE_BRACKET {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayAccessExpr, {$1, $2, $3, $4});
    }
 |  dereferencable T_LEFT_BRACE expr T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayAccessExpr, {$1, $2, $3, $4});
    }
 |  dereferencable T_OBJECT_OPERATOR property_name argument_list {
-
-   }
-|  function_call {
-
+      $$ = builder->makeNode(AstNodeKind::MethodCallExpr, {$1, $2, $3, $4});
    }
+|  function_call { $$ = std::move($1); }
 ;
 
 variable:
-   callable_variable {
-
-   }
-|  static_member {
-
-   }
+   callable_variable { $$ = std::move($1); }
+|  static_member { $$ = std::move($1); }
 |  dereferencable T_OBJECT_OPERATOR property_name {
-
+      $$ = builder->makeNode(AstNodeKind::PropertyAccessExpr, {$1, $2, $3});
    }
 ;
 
 simple_variable:
    T_VARIABLE {
-
+      $$ = builder->makeNode(AstNodeKind::VariableExpr, {$1});
    }
 |  T_DOLLAR_SIGN T_LEFT_BRACE expr T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::VariableVariableExpr, {$1, $2, $3, $4});
    }
 |  T_DOLLAR_SIGN simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::VariableVariableExpr, {$1, $2});
    }
 ;
 
 static_member:
    class_name T_PAAMAYIM_NEKUDOTAYIM simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::StaticPropertyExpr, {$1, $2, $3});
    }
 |  variable_class_name T_PAAMAYIM_NEKUDOTAYIM simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::StaticPropertyExpr, {$1, $2, $3});
    }
 ;
 
 new_variable:
-   simple_variable {
-
-   }
+   simple_variable { $$ = std::move($1); }
 |  new_variable T_LEFT_SQUARE_BRACKET optional_expr T_RIGHT_SQUARE_BRACKET {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayAccessExpr, {$1, $2, $3, $4});
    }
 |  new_variable T_LEFT_BRACE expr T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayAccessExpr, {$1, $2, $3, $4});
    }
 |  new_variable T_OBJECT_OPERATOR property_name {
-
+      $$ = builder->makeNode(AstNodeKind::PropertyAccessExpr, {$1, $2, $3});
    }
 |  class_name T_PAAMAYIM_NEKUDOTAYIM simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::StaticPropertyExpr, {$1, $2, $3});
    }
 |  new_variable T_PAAMAYIM_NEKUDOTAYIM simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::StaticPropertyExpr, {$1, $2, $3});
    }
 ;
 
 member_name:
-   identifier {
-
-   }
+   identifier { $$ = std::move($1); }
 |  T_LEFT_BRACE expr T_RIGHT_BRACE {
-
-   }
-|  simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::DynamicMemberName, {$1, $2, $3});
    }
+|  simple_variable { $$ = std::move($1); }
 ;
 
 property_name:
    T_IDENTIFIER_STRING {
-      
+      $$ = builder->makeNode(AstNodeKind::MemberName, {$1});
    }
 |  T_LEFT_BRACE expr T_RIGHT_BRACE {
-
-   }
-|  simple_variable {
-
+      $$ = builder->makeNode(AstNodeKind::DynamicMemberName, {$1, $2, $3});
    }
+|  simple_variable { $$ = std::move($1); }
 ;
 
 array_pair_list:
-   non_empty_array_pair_list {
-      
-   }
+   non_empty_array_pair_list { $$ = $1; }
 ;
 
 possible_array_pair:
-   %empty {
-
-   }
-|  array_pair {
-
-}
+   %empty { $$ = nullptr; }
+|  array_pair { $$ = std::move($1); }
 ;
 
 non_empty_array_pair_list:
    non_empty_array_pair_list T_COMMA possible_array_pair {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 |  possible_array_pair {
-
+      $$ = builder->beginList({$1});
    }
 ;
 
 array_pair:
    expr T_DOUBLE_ARROW expr {
-
-   }
-|  expr {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayPair, {$1, $2, $3});
    }
+|  expr { $$ = std::move($1); }
 |  expr T_DOUBLE_ARROW T_AMPERSAND variable {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayPair, {$1, $2, $3, $4});
    }
 |  T_AMPERSAND variable {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayPair, {$1, $2});
    }
 |  T_ELLIPSIS expr {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayPair, {$1, $2});
    }
 |  expr T_DOUBLE_ARROW T_LIST T_LEFT_PAREN array_pair_list T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayPair, {$1, $2, $3, $4, builder->finishList($5, AstNodeKind::ArrayPairList), $6});
    }
 |  T_LIST T_LEFT_PAREN array_pair_list T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayPair, {$1, $2, builder->finishList($3, AstNodeKind::ArrayPairList), $4});
    }
 ;
 
 encaps_list:
    encaps_list encaps_var {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
 |  encaps_list T_ENCAPSED_AND_WHITESPACE {
-
+      $$ = $1;
+      builder->appendToList($$, {$2});
    }
 |  encaps_var {
-
+      $$ = builder->beginList({$1});
    }
 |  T_ENCAPSED_AND_WHITESPACE encaps_var {
-
+      $$ = builder->beginList({$1, $2});
    }
 ;
 
 encaps_var:
    T_VARIABLE {
-
+      $$ = builder->makeNode(AstNodeKind::VariableExpr, {$1});
    }
 |  T_VARIABLE T_LEFT_SQUARE_BRACKET encaps_var_offset T_RIGHT_SQUARE_BRACKET {
-
+      $$ = builder->makeNode(AstNodeKind::ArrayAccessExpr, {$1, $2, $3, $4});
    }
 |  T_VARIABLE T_OBJECT_OPERATOR T_IDENTIFIER_STRING {
-
+      $$ = builder->makeNode(AstNodeKind::PropertyAccessExpr, {$1, $2, $3});
    }
 |  T_DOLLAR_OPEN_CURLY_BRACES expr T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::DollarBraceExpr, {$1, $2, $3});
    }
 |  T_DOLLAR_OPEN_CURLY_BRACES T_STRING_VARNAME T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::DollarBraceExpr, {$1, $2, $3});
    }
 |  T_DOLLAR_OPEN_CURLY_BRACES T_STRING_VARNAME T_LEFT_SQUARE_BRACKET expr T_RIGHT_SQUARE_BRACKET T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::DollarBraceExpr, {$1, $2, $3, $4, $5, $6});
    }
 |  T_CURLY_OPEN variable T_RIGHT_BRACE {
-
+      $$ = builder->makeNode(AstNodeKind::CurlyBraceExpr, {$1, $2, $3});
    }
 ;
 
 encaps_var_offset:
-   T_STRING_VARNAME {
-
-   }
-|  T_NUM_STRING {
-
-   }
+   T_STRING_VARNAME { $$ = std::move($1); }
+|  T_NUM_STRING { $$ = std::move($1); }
 |  T_MINUS_SIGN T_NUM_STRING {
-
-   }
-|  T_VARIABLE {
-
+      $$ = builder->makeNode(AstNodeKind::NegativeOffset, {$1, $2});
    }
+|  T_VARIABLE { $$ = std::move($1); }
 ;
 
 internal_functions_in_bison:
    T_ISSET T_LEFT_PAREN isset_variables possible_comma T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::IssetExpr, {$1, $2, builder->finishList($3, AstNodeKind::IssetVariableList), $4, $5});
    }
 |  T_EMPTY T_LEFT_PAREN expr T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::EmptyExpr, {$1, $2, $3, $4});
    }
 |  T_INCLUDE expr {
-
+      $$ = builder->makeNode(AstNodeKind::IncludeExpr, {$1, $2});
    }
 |  T_INCLUDE_ONCE expr {
-
+      $$ = builder->makeNode(AstNodeKind::IncludeExpr, {$1, $2});
    }
 |  T_EVAL T_LEFT_PAREN expr T_RIGHT_PAREN {
-
+      $$ = builder->makeNode(AstNodeKind::EvalExpr, {$1, $2, $3, $4});
    }
 |  T_REQUIRE expr {
-
+      $$ = builder->makeNode(AstNodeKind::IncludeExpr, {$1, $2});
    }
 |  T_REQUIRE_ONCE expr {
-
+      $$ = builder->makeNode(AstNodeKind::IncludeExpr, {$1, $2});
    }
 ;
 
 isset_variables:
    isset_variable {
-
+      $$ = builder->beginList({$1});
    }
 |  isset_variables T_COMMA isset_variable {
-
+      $$ = $1;
+      builder->appendToList($$, {$2, $3});
    }
 ;
 
 isset_variable:
-   expr {
-
-   }
+   expr { $$ = std::move($1); }
 ;
 %%
@@ -17,20 +17,24 @@
 #include "polarphp/parser/SourceLoc.h"
 #include "polarphp/parser/SourceMgr.h"
 #include "polarphp/parser/Token.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/parser/IdentifierTable.h"
 #include "polarphp/parser/ParsedTrivia.h"
 #include "polarphp/parser/LexerState.h"
+#include "polarphp/parser/LexerCheckpoint.h"
 #include "polarphp/utils/SaveAndRestore.h"
 #include "polarphp/parser/internal/YYLexerDefs.h"
 #include "polarphp/parser/LexerFlags.h"
 #include "polarphp/kernel/LangOptions.h"
 
-#include <stack>
 
 namespace polar::parser {
 
 namespace internal {
-bool strip_multiline_string_indentation(Lexer &lexer, std::string &str, int indentation, bool usingSpaces,
-                                        bool newlineAtStart, bool newlineAtEnd);
+bool strip_multiline_string_indentation(Lexer &lexer, const char *cursor, const char *end,
+                                        ArrayRef<const char *> lineEnds, char *dest, size_t &length,
+                                        int indentation, bool usingSpaces, bool newlineAtStart,
+                                        bool newlineAtEnd, bool decodeEscapes);
 bool convert_double_quote_str_escape_sequences(std::string &filteredStr, char quoteType, const char *iter,
                                                const char *endMark, Lexer &lexer);
 }
@@ -43,6 +47,7 @@ using polar::kernel::LangOptions;
 union ParserStackElement;
 
 class Parser;
+class StreamingSource;
 
 /// Given a pointer to the starting byte of a UTF8 character, validate it and
 /// advance the lexer past it.  This returns the encoded character or ~0U if
@@ -87,6 +92,13 @@ public:
          TriviaRetentionMode triviaRetention, unsigned offset,
          unsigned endOffset);
 
+   /// Create a lexer for the current line of \p source. The line is lexed
+   /// in place, its NUL terminator is the end of the buffer for the lexer.
+   Lexer(const LangOptions &options, const StreamingSource &source,
+         DiagnosticEngine *diags,
+         CommentRetentionMode commentRetention = CommentRetentionMode::None,
+         TriviaRetentionMode triviaRetention = TriviaRetentionMode::WithoutTrivia);
+
    /// Create a sub-lexer that lexes from the same buffer, but scans
    /// a subrange of the buffer.
    ///
@@ -103,14 +115,29 @@ public:
 
    /// Lex a token. If \c TriviaRetentionMode is \c WithTrivia, passed pointers
    /// to trivias are populated.
-   void lex(Token &result, ParsedTrivia &leadingTriviaResult, ParsedTrivia &trailingTrivialResult);
+   void lex(Token &result, ParsedTrivia &leadingTriviaResult, ParsedTrivia &trailingTrivialResult)
+   {
+      result = lexInPlace(leadingTriviaResult, trailingTrivialResult);
+   }
    void lex(Token &result)
    {
-      ParsedTrivia leadingTrivia;
-      ParsedTrivia trailingTrivia;
-      lex(result, leadingTrivia, trailingTrivia);
+      result = lexInPlace();
    }
 
+   /// Lex a token without copying it out, the result is peekNextToken() and
+   /// is overwritten by the next call. The trivia are swapped with the
+   /// passed ones, the lexer clears and reuses their storage.
+   const Token &lexInPlace(ParsedTrivia &leadingTriviaResult, ParsedTrivia &trailingTrivialResult);
+   /// Lex a token in place, its trivia are not handed out.
+   const Token &lexInPlace();
+
+   /// Start lexing the whole of \p bufferId as if the lexer was just
+   /// created for it. The options, handlers and the identifier table are
+   /// kept, so are the capacities of the internal stacks. The value arena
+   /// is reused when no token with a value in it is left, otherwise the
+   /// lexer starts a new one.
+   void reset(unsigned bufferId);
+
    /// Reset the lexer's buffer pointer to \p Offset bytes after the buffer
    /// start.
    void resetToOffset(size_t offset)
@@ -125,6 +152,11 @@ public:
       return m_commentRetention == CommentRetentionMode::ReturnAsTokens;
    }
 
+   TriviaRetentionMode getTriviaRetention() const
+   {
+      return m_triviaRetention;
+   }
+
    const LexerFlags &getFlags() const
    {
       return m_flags;
@@ -152,6 +184,19 @@ public:
       return m_flags.isCheckHeredocIndentation();
    }
 
+   /// Record the offsets of the '\n' characters while lexing and hand them
+   /// to the SourceManager at the end of the buffer, for a client that looks
+   /// up the lines of many locations. Otherwise the SourceManager scans the
+   /// buffer on its first lookup. Only a lexer over a whole buffer without
+   /// offsets records them, and only when it is set before the first token.
+   /// It stays set across reset().
+   Lexer &setRecordLineOffsets(bool value);
+
+   bool isRecordLineOffsets() const
+   {
+      return m_recordLineOffsets;
+   }
+
    unsigned int getBufferId() const
    {
       return m_bufferId;
@@ -218,6 +263,15 @@ public:
    Lexer &saveYYState();
    Lexer &restoreYYState();
 
+   /// Take a snapshot of the complete scanning state, restoreCheckpoint()
+   /// brings the lexer back to it. Neither allocates unless the condition or
+   /// heredoc stacks are deeper than their inline capacity.
+   LexerCheckpoint getCheckpoint() const;
+
+   /// Restore a checkpoint taken from this lexer. The same checkpoint can be
+   /// restored any number of times.
+   void restoreCheckpoint(const LexerCheckpoint &checkpoint);
+
    /// Restore the lexer LexerState to a given LexerState that is located before
    /// current position.
    void backtrackToState(LexerState LexerState)
@@ -376,16 +430,14 @@ public:
 
    Lexer &pushYYCondition(YYLexerCondType cond)
    {
-      m_yyConditionStack.push(m_yyCondition);
+      m_yyConditionStack.push_back(m_yyCondition);
       m_yyCondition = cond;
       return *this;
    }
 
    Lexer &popYYCondtion()
    {
-      YYLexerCondType cond = m_yyConditionStack.top();
-      m_yyCondition = cond;
-      m_yyConditionStack.pop();
+      m_yyCondition = m_yyConditionStack.popBackValue();
       return *this;
    }
 
@@ -394,18 +446,33 @@ public:
       return m_yyConditionStack.empty();
    }
 
+   /// Whether the lexer is in the same state as a fresh lexer, i.e. in
+   /// ST_IN_SCRIPTING with empty condition and heredoc stacks and nothing
+   /// pending. A new lexer started at the current position would lex the
+   /// rest of the buffer the same way.
+   bool isAtSafeRestartPoint() const;
+
+   /// Points to the first invalid UTF-8 sequence from the cursor on, or to
+   /// the end of the lexed range if the rest is valid UTF-8. The comment
+   /// scanners skip the valid part like ASCII, the identifier and unknown
+   /// character paths decode it without checking it again. The range is
+   /// validated on the first call, a lexer that meets no non-ASCII outside
+   /// of comments and has no diagnostics never makes one.
+   const unsigned char *getValidUtf8End()
+   {
+      return getValidUtf8End(m_yyCursor);
+   }
+
    Lexer &pushHeredocLabel(std::shared_ptr<HereDocLabel> label)
    {
-      m_heredocLabelStack.push(label);
+      m_heredocLabelStack.push_back(std::move(label));
       return *this;
    }
 
    std::shared_ptr<HereDocLabel> popHeredocLabel()
    {
       assert(!m_heredocLabelStack.empty() && "heredoc stack is empty");
-      std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.top();
-      m_heredocLabelStack.pop();
-      return label;
+      return m_heredocLabelStack.popBackValue();
    }
 
    Lexer &setParser(Parser *parser)
@@ -451,6 +518,33 @@ public:
       return m_currentExceptionMsg;
    }
 
+   /// The arena that keeps the decoded string values of the lexed tokens,
+   /// the tokens with such a value hold a reference to it.
+   const IntrusiveRefCountPtr<TokenValueArena> &getValueArena() const
+   {
+      return m_valueArena;
+   }
+
+   Lexer &setValueArena(IntrusiveRefCountPtr<TokenValueArena> arena)
+   {
+      assert(arena && "lexer needs a value arena");
+      m_valueArena = std::move(arena);
+      return *this;
+   }
+
+   /// The table identifier and variable names are interned into, tokens
+   /// only get a symbol id when there is one.
+   const IntrusiveRefCountPtr<IdentifierTable> &getIdentifierTable() const
+   {
+      return m_identifierTable;
+   }
+
+   Lexer &setIdentifierTable(IntrusiveRefCountPtr<IdentifierTable> table)
+   {
+      m_identifierTable = std::move(table);
+      return *this;
+   }
+
 private:
    Lexer(const Lexer&) = delete;
    void operator=(const Lexer&) = delete;
@@ -462,6 +556,10 @@ private:
          DiagnosticEngine *diags, CommentRetentionMode commentRetention,
          TriviaRetentionMode triviaRetention);
    void initialize(unsigned offset, unsigned endOffset);
+   const unsigned char *getValidUtf8End(const unsigned char *from);
+   void scanValidUtf8(const unsigned char *begin, const unsigned char *end);
+   bool canRecordLineOffsets() const;
+   void recordLineOffsets(const unsigned char *end);
    void lexImpl();
 
    /// For a source location in the current buffer, returns the corresponding
@@ -501,6 +599,7 @@ private:
    void lexHexNumber();
    void lexLongNumber();
    void lexDoubleNumber();
+   void lexInvalidNumber();
    void lexSingleQuoteString();
    void lexDoubleQuoteString();
    void lexBackquote();
@@ -509,6 +608,9 @@ private:
    void lexNowdocBody();
    void lexHereAndNowDocEnd();
    void lexTrivia(ParsedTrivia &trivia, bool isForTrailingTrivia);
+   /// Consume the rest of a run of \p ch whose first byte was already eaten,
+   /// the whole run goes into \p trivia as a single piece.
+   void lexTriviaRun(ParsedTrivia &trivia, syntax::TriviaKind kind, unsigned char ch);
    void lexEscapedIdentifier();
 
    /// Returns it should be tokenize.
@@ -542,15 +644,18 @@ private:
 
 private:
    friend void internal::yy_token_lex(Lexer &lexer);
-   friend bool internal::strip_multiline_string_indentation(Lexer &lexer, std::string &str, int indentation, bool usingSpaces,
-                                                            bool newlineAtStart, bool newlineAtEnd);
+   friend bool internal::strip_multiline_string_indentation(Lexer &lexer, const char *cursor, const char *end,
+                                                            ArrayRef<const char *> lineEnds, char *dest,
+                                                            size_t &length, int indentation, bool usingSpaces,
+                                                            bool newlineAtStart, bool newlineAtEnd,
+                                                            bool decodeEscapes);
    friend bool internal::convert_double_quote_str_escape_sequences(std::string &filteredStr, char quoteType, const char *iter,
                                                                    const char *endMark, Lexer &lexer);
 private:
    LexerFlags m_flags;
    const LangOptions &m_langOpts;
    const SourceManager &m_sourceMgr;
-   const unsigned int m_bufferId;
+   unsigned int m_bufferId;
    DiagnosticEngine *m_diags;
    Parser *m_parser = nullptr;
 
@@ -560,9 +665,14 @@ private:
 
    /// Pointer to one past the end character of the buffer, even in a lexer
    /// that scans a subrange of the buffer.  Because the buffer is always
-   /// NUL-terminated, this points to the NUL terminator.
+   /// NUL-terminated, this points to the NUL terminator. For a line of a
+   /// StreamingSource it points to the NUL that ends the line.
    const unsigned char *m_bufferEnd;
 
+   /// The range ends in a NUL that is lexed as the end of the buffer, set for
+   /// the lines of a StreamingSource.
+   bool m_rangeEndsBuffer = false;
+
    /// Pointer to the artificial EOF that is located before BufferEnd.  Useful
    /// for lexing subranges of a buffer.
    const unsigned char *m_artificialEof = nullptr;
@@ -574,6 +684,23 @@ private:
    /// Points to BufferStart or past the end of UTF-8 BOM sequence if it exists.
    const unsigned char *m_contentStart;
 
+   /// The range getValidUtf8End() validated last.
+   const unsigned char *m_utf8ScanStart = nullptr;
+   const unsigned char *m_utf8ScanEnd = nullptr;
+
+   /// The first invalid UTF-8 sequence in the scanned range, UTF-8 in front
+   /// of it does not have to be validated again.
+   const unsigned char *m_validUtf8End = nullptr;
+
+   /// The offsets of the '\n' characters in [m_bufferStart,
+   /// m_lineOffsetsEnd), recorded token by token. They are handed to the
+   /// SourceManager when the lexer reaches the end of the buffer.
+   /// m_lineOffsetsEnd is nullptr when the lexer does not record them, see
+   /// setRecordLineOffsets().
+   std::vector<uint32_t> m_lineOffsets;
+   const unsigned char *m_lineOffsetsEnd = nullptr;
+   bool m_recordLineOffsets = false;
+
    /// current token text
    const unsigned char *m_yyText = nullptr;
 
@@ -587,7 +714,7 @@ private:
    ParserSemantic *m_valueContainer = nullptr;
 
    YYLexerCondType m_yyCondition = COND_NAME(ST_IN_SCRIPTING);
-   unsigned m_heredocIndentation;
+   unsigned m_heredocIndentation = 0;
    /// current token length
    std::size_t m_yyLength;
    unsigned int m_lineNumber;
@@ -596,6 +723,8 @@ private:
    LexicalExceptionHandler m_lexicalExceptionHandler = nullptr;
 
    Token m_nextToken;
+   IntrusiveRefCountPtr<TokenValueArena> m_valueArena;
+   IntrusiveRefCountPtr<IdentifierTable> m_identifierTable;
 
    const CommentRetentionMode m_commentRetention;
    const TriviaRetentionMode m_triviaRetention;
@@ -612,9 +741,17 @@ private:
    /// `TriviaRetentionMode::WithTrivia`.
    ParsedTrivia m_trailingTrivia;
    std::string m_currentExceptionMsg;
-   std::stack<YYLexerCondType> m_yyConditionStack;
-   std::stack<std::shared_ptr<HereDocLabel>> m_heredocLabelStack;
-   std::stack<LexerState> m_yyStateStack;
+   LexerConditionStack m_yyConditionStack;
+   HeredocLabelStack m_heredocLabelStack;
+
+   /// what saveYYState() pushes, the handlers are not part of a checkpoint
+   struct SavedYYState
+   {
+      LexerCheckpoint checkpoint;
+      LexicalEventHandler eventHandler;
+      LexicalExceptionHandler exceptionHandler;
+   };
+   SmallVector<SavedYYState, 1> m_yyStateStack;
 };
 
 /// Given an ordered token \param Array , get the iterator pointing to the first
@@ -663,11 +800,32 @@ void tokenize(const LangOptions &langOpts, const SourceManager &sourceMgr,
 }
 
 /// Lex and return a vector of tokens for the given buffer.
+///
+/// String values that are not a slice of the buffer are saved in
+/// \p valueArena, or in an arena of the lexer without one. The tokens with
+/// such a value keep their arena alive.
 std::vector<Token> tokenize(const LangOptions &langOpts,
                             const SourceManager &sourceMgr, unsigned bufferId,
                             unsigned offset = 0, unsigned endOffset = 0,
                             DiagnosticEngine *diags = nullptr,
-                            bool keepComments = true);
+                            bool keepComments = true,
+                            IntrusiveRefCountPtr<TokenValueArena> valueArena = nullptr);
+
+/// Lex the given buffer on several threads, the tokens are the same as the
+/// ones of tokenize() with keepComments = false.
+///
+/// The buffer is cut into chunks at line starts that look like top level
+/// statements. A chunk is only used when the lexer of the previous chunk
+/// reaches its first token at a safe restart point, otherwise that lexer
+/// goes on over the chunk. Buffers smaller than two chunks are lexed
+/// serially.
+///
+/// Every chunk lexes into its own value arena, the tokens with a value in
+/// one keep it alive. \p valueArena, when passed, adopts them all.
+std::vector<Token> tokenize_in_parallel(const LangOptions &langOpts,
+                                        const SourceManager &sourceMgr, unsigned bufferId,
+                                        IntrusiveRefCountPtr<TokenValueArena> valueArena = nullptr,
+                                        size_t minChunkSize = 256 * 1024);
 
 } // polar::parser
 
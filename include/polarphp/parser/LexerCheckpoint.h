@@ -0,0 +1,92 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/12.
+
+#ifndef POLARPHP_PARSER_LEXER_CHECKPOINT_H
+#define POLARPHP_PARSER_LEXER_CHECKPOINT_H
+
+#include "polarphp/basic/adt/SmallVector.h"
+#include "polarphp/parser/LexerFlags.h"
+#include "polarphp/parser/Token.h"
+#include "polarphp/parser/internal/YYLexerDefs.h"
+
+#include <memory>
+
+namespace polar::parser {
+
+class Lexer;
+using polar::basic::SmallVector;
+
+/// The lexer condition and heredoc label stacks. Real code rarely nests
+/// deeper than the inline capacity, so saving and restoring them is a copy of
+/// a few words that never touches the heap.
+using LexerConditionStack = SmallVector<YYLexerCondType, 16>;
+using HeredocLabelStack = SmallVector<std::shared_ptr<HereDocLabel>, 4>;
+
+/// LexerCheckpoint - a snapshot of the whole scanning state of a Lexer:
+/// cursor, current token, condition, condition and heredoc label stacks and
+/// flags.
+///
+/// Unlike LexerState, which only records a source location and has to
+/// re-lex from a point where the lexer is in its initial condition, a
+/// checkpoint can be taken anywhere, inside of strings, heredocs and nested
+/// interpolations included. Lexer::restoreCheckpoint() puts the lexer back
+/// so that it produces exactly the same tokens again, which is what
+/// speculative parsing and re-lexing from a cached state need.
+///
+/// Trivia is not part of a checkpoint, the lexer rebuilds it for every token.
+class LexerCheckpoint
+{
+public:
+   LexerCheckpoint()
+   {}
+
+   bool isValid() const
+   {
+      return m_yyCursor != nullptr;
+   }
+
+   /// The position the lexer continues from after a restore.
+   const unsigned char *getYYCursor() const
+   {
+      return m_yyCursor;
+   }
+
+   YYLexerCondType getCondition() const
+   {
+      return m_yyCondition;
+   }
+
+   /// The token peekNextToken() returns after a restore.
+   const Token &getNextToken() const
+   {
+      return m_nextToken;
+   }
+
+private:
+   const unsigned char *m_yyText = nullptr;
+   const unsigned char *m_yyCursor = nullptr;
+   const unsigned char *m_yyMarker = nullptr;
+   const unsigned char *m_artificialEof = nullptr;
+   std::size_t m_yyLength = 0;
+   unsigned int m_lineNumber = 0;
+   unsigned m_heredocIndentation = 0;
+   YYLexerCondType m_yyCondition = COND_NAME(ST_IN_SCRIPTING);
+   LexerFlags m_flags;
+   Token m_nextToken;
+   LexerConditionStack m_yyConditionStack;
+   HeredocLabelStack m_heredocLabelStack;
+
+   friend class Lexer;
+};
+
+} // polar::parser
+
+#endif // POLARPHP_PARSER_LEXER_CHECKPOINT_H
@@ -12,14 +12,21 @@
 #ifndef POLARPHP_PARSER_PARSER_H
 #define POLARPHP_PARSER_PARSER_H
 
+#include <cassert>
+#include <cstdint>
+#include <functional>
 #include <list>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "polarphp/basic/adt/StringRef.h"
 #include "polarphp/parser/CommonDefs.h"
+#include "polarphp/parser/LexerCheckpoint.h"
 #include "polarphp/parser/Token.h"
 #include "polarphp/parser/ParsedTrivia.h"
+#include "polarphp/parser/SyntaxTreeBuilder.h"
+#include "polarphp/parser/internal/YYLexerDefs.h"
 
 namespace polar::ast {
 class DiagnosticEngine;
@@ -37,7 +44,7 @@ namespace polar::parser {
 
 namespace internal {
 class YYParser;
-using YYLocation = location;
+using YYLocation = ParsedTokenRange;
 int token_lex_wrapper(ParserSemantic *value, YYLocation *loc,
                       Lexer *lexer, Parser *parser);
 } // internal
@@ -50,20 +57,64 @@ using polar::syntax::Syntax;
 class SourceManager;
 class Lexer;
 
-void parse_error(StringRef msg);
-
 class Parser
 {
 public:
+   /// Receives the syntax errors of a parse with the line and column of the
+   /// token the parser stopped at.
+   using SyntaxErrorHandler = std::function<void(StringRef msg, unsigned line, unsigned column)>;
+
+   /// With \p triviaRetention WithoutTrivia the parser builds the compact
+   /// AST instead of the syntax tree, see SyntaxTreeBuilder::getAstRoot().
    Parser(const LangOptions &langOpts, unsigned bufferId, SourceManager &sourceMgr,
-          std::shared_ptr<DiagnosticEngine> diags);
+          std::shared_ptr<DiagnosticEngine> diags,
+          TriviaRetentionMode triviaRetention = TriviaRetentionMode::WithTrivia);
+   /// The tree the parser builds follows the trivia retention of \p lexer.
    Parser(SourceManager &sourceMgr, std::shared_ptr<DiagnosticEngine> diags, std::unique_ptr<Lexer> lexer);
    Parser(const Parser &) = delete;
    Parser &operator =(const Parser &) = delete;
 
+   /// Returns true when the input had errors. Malformed input still gets a
+   /// tree, the parts the parser had to skip are unknown nodes.
    bool parse();
    std::shared_ptr<Syntax> getSyntaxTree();
 
+   /// Prepare the parser for \p bufferId of the same SourceManager, the
+   /// lexer, the parser stacks and the arenas of the last parse are reused.
+   /// Trees of earlier parses stay valid while they are referenced.
+   void reset(unsigned bufferId);
+
+   /// Without a handler syntax errors are printed to the standard output.
+   Parser &registerSyntaxErrorHandler(SyntaxErrorHandler handler)
+   {
+      m_syntaxErrorHandler = std::move(handler);
+      return *this;
+   }
+
+   /// Skip the bodies of functions, methods and closures, for queries that
+   /// only need declarations. The lexer matches the braces of a body, its
+   /// statements are not parsed, the AST has a SkippedStmtList node of their
+   /// source instead. Only an AST skips bodies, a syntax tree has to
+   /// reproduce the source.
+   Parser &setSkipFunctionBodies(bool skip)
+   {
+      assert((!skip || m_treeBuilder.isBuildingAst()) && "only an AST skips function bodies");
+      m_skipFunctionBodies = skip;
+      return *this;
+   }
+
+   /// The statements of a body the last parse skipped, \p body is its
+   /// SkippedStmtList node. They are parsed on first access and become the
+   /// child of \p body. Valid until the parser is reset. Null when \p body
+   /// is not from the last parse of this parser.
+   const AstNode *parseSkippedBody(const AstNode *body);
+
+   /// The builder of the last parse, it owns the arena of the syntax tree.
+   const SyntaxTreeBuilder &getSyntaxTreeBuilder() const
+   {
+      return m_treeBuilder;
+   }
+
    ///
    /// TODO
    /// state manage methods
@@ -71,17 +122,57 @@ public:
    ~Parser();
 
 protected:
+   /// The token the grammar saw last. It is the lexer's, the parser keeps
+   /// no copy of it.
    const Token &peekToken();
    SourceLoc getEndOfPreviousLoc();
+   void reportSyntaxError(StringRef msg);
+   /// Lex the next token for the grammar, a skipped body is left out. The
+   /// token is peekToken(), the returned kind is the one the grammar gets.
+   TokenKindType lexToken();
+   /// Whether \p token is the opening brace of a function body, it follows
+   /// the tokens of a function header.
+   bool opensFunctionBody(const Token &token);
+   /// Lex the tokens of the body whose brace was just returned, the lexer's
+   /// token is the closing brace then. An unterminated body is not skipped,
+   /// the lexer is put back after the brace and false returned.
+   bool skipFunctionBody();
 
 private:
+   friend class internal::YYParser;
    friend int internal::token_lex_wrapper(ParserSemantic *value, internal::YYLocation *loc,
                                           Lexer *lexer, Parser *parser);
 private:
 
+   /// Where a function header is when bodies are skipped.
+   enum class FunctionHeaderScan : std::uint8_t
+   {
+      None,
+      Name,
+      Parameters,
+      Tail
+   };
+
+   /// The start of the statements of a skipped body and the lexer state
+   /// to parse them from.
+   struct SkippedBody
+   {
+      SourceLoc start;
+      LexerCheckpoint checkpoint;
+   };
+
    /// info properties
    bool m_parserError = false;
    bool m_inCompilation = false;
+   bool m_skipFunctionBodies = false;
+   bool m_skipNextBody = false;
+   bool m_startingSkippedBody = false;
+   FunctionHeaderScan m_headerScan = FunctionHeaderScan::None;
+   unsigned m_headerParenDepth = 0;
+   /// The braces open in the skipped body being parsed, 0 otherwise.
+   unsigned m_bodyBraceDepth = 0;
+   /// In source order.
+   std::vector<SkippedBody> m_skippedBodies;
 
    SourceManager &m_sourceMgr;
    Lexer *m_lexer;
@@ -90,9 +181,8 @@ private:
    /// The location of the previous token.
    SourceLoc m_previousLoc;
 
-   Token m_token;
-
-   /// leading trivias for \c Token.
+   /// leading trivias for \c Token, swapped with the lexer's for every
+   /// token, so their storage goes back and forth instead of being copied.
    /// Always empty if not shouldBuildSyntaxTree.
    ParsedTrivia m_leadingTrivia;
 
@@ -101,8 +191,10 @@ private:
    ParsedTrivia m_trailingTrivia;
 
    std::string m_docComment;
+   SyntaxTreeBuilder m_treeBuilder;
    std::shared_ptr<Syntax> m_ast;
    std::shared_ptr<DiagnosticEngine> m_diags;
+   SyntaxErrorHandler m_syntaxErrorHandler;
    std::list<std::string> m_openFiles;
 
 };
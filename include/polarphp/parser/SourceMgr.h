@@ -239,6 +239,26 @@ public:
       return m_sourceMgr.findLineNumber(loc.m_loc, bufferID);
    }
 
+   /// Hand over the offsets of all the '\n' characters of a buffer, the
+   /// lexer records them as it goes. Line and column lookups then never scan
+   /// the buffer themselves.
+   void setLineOffsets(unsigned bufferID, std::vector<uint32_t> &&offsets) const
+   {
+      m_sourceMgr.setLineOffsets(bufferID, std::move(offsets));
+   }
+
+   bool hasLineOffsets(unsigned bufferID) const
+   {
+      return m_sourceMgr.hasLineOffsets(bufferID);
+   }
+
+   /// Forget the line offsets of a buffer whose contents were changed in
+   /// place, they are computed again on the next lookup.
+   void clearLineOffsets(unsigned bufferID) const
+   {
+      m_sourceMgr.clearLineOffsets(bufferID);
+   }
+
    StringRef getEntireTextForBuffer(unsigned bufferID) const;
 
    StringRef extractText(CharSourceRange range,
@@ -0,0 +1,141 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_PARSER_STREAMING_SOURCE_H
+#define POLARPHP_PARSER_STREAMING_SOURCE_H
+
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/parser/SourceLoc.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace polar::parser {
+
+class SourceManager;
+using polar::basic::StringRef;
+
+/// StreamingSource - line oriented input that is read from a stream in
+/// chunks into one window buffer, for the -B/-R/-F/-E modes and other
+/// consumers of unbounded input.
+///
+/// The window is owned by the source, the SourceManager gets one buffer
+/// that views it, for the whole input. Every line is handed out in place: a
+/// Lexer built for the source lexes the current line right in the window,
+/// no per line buffer is copied or registered. The line terminator is
+/// replaced with a NUL, so that lexer sees the line as a buffer of its own.
+///
+/// Consumed lines are dropped by moving the unread rest to the front of the
+/// window when it fills up, memory use stays at about the longest line. A
+/// line that doesn't fit doubles the window, the buffer then views the new
+/// one and the old one is freed. The line offsets the SourceManager caches
+/// for the buffer are dropped on every readLine(). The text, tokens and
+/// source locations of a line are only valid until the next readLine().
+///
+/// The SourceManager can't tell the line and column of a location in the
+/// window: the terminators of the lines before it are NULs and the lines
+/// read before the window was compacted are gone. Diagnostics on a line get
+/// them from getLineAndColumn() instead.
+class StreamingSource
+{
+public:
+   /// Reads at most \p size bytes into \p dest and returns how many were
+   /// read, 0 at the end of the input.
+   using ReadFunc = std::function<size_t(char *dest, size_t size)>;
+
+   StreamingSource(SourceManager &sourceMgr, ReadFunc reader, size_t windowSize = 64 * 1024,
+                   StringRef bufferName = "<stdin>");
+
+   /// Reads from a stdio stream, e.g. stdin.
+   StreamingSource(SourceManager &sourceMgr, std::FILE *stream, size_t windowSize = 64 * 1024,
+                   StringRef bufferName = "<stdin>");
+
+   StreamingSource(const StreamingSource &) = delete;
+   StreamingSource &operator=(const StreamingSource &) = delete;
+
+   /// Move on to the next line, false at the end of the input. A last line
+   /// without a line terminator is returned too.
+   bool readLine();
+
+   /// The current line without its line terminator.
+   StringRef getLine() const;
+
+   SourceManager &getSourceManager() const
+   {
+      return m_sourceMgr;
+   }
+
+   /// The buffer the current line lives in, the same for every line.
+   unsigned getBufferId() const
+   {
+      return m_bufferId;
+   }
+
+   unsigned getLineOffset() const
+   {
+      return static_cast<unsigned>(m_lineStart);
+   }
+
+   unsigned getLineEndOffset() const
+   {
+      return static_cast<unsigned>(m_lineEnd);
+   }
+
+   /// 1 based number of the current line in the input.
+   size_t getLineNumber() const
+   {
+      return m_lineNumber;
+   }
+
+   /// The 1 based line and column in the input of \p loc, a location in
+   /// the current line or at its end.
+   std::pair<unsigned, unsigned> getLineAndColumn(SourceLoc loc) const;
+
+   /// The size of the window, it only changes for lines longer than it.
+   size_t getWindowSize() const
+   {
+      return m_windowSize;
+   }
+
+private:
+   class WindowBuffer;
+
+   void allocateWindow(size_t size);
+   char *getWindowStart() const
+   {
+      return m_window.get();
+   }
+
+   SourceManager &m_sourceMgr;
+   ReadFunc m_reader;
+   /// m_windowSize bytes and a NUL
+   std::unique_ptr<char[]> m_window;
+   /// the view of m_window, owned by the source manager
+   WindowBuffer *m_windowBuffer = nullptr;
+   unsigned m_bufferId = 0;
+   size_t m_windowSize = 0;
+   /// [m_lineStart, m_lineEnd) is the current line, the unconsumed input
+   /// starts at m_nextLineStart and what has been read ends at m_dataEnd
+   size_t m_lineStart = 0;
+   size_t m_lineEnd = 0;
+   size_t m_nextLineStart = 0;
+   size_t m_dataEnd = 0;
+   size_t m_lineNumber = 0;
+   bool m_atEndOfInput = false;
+};
+
+} // polar::parser
+
+#endif // POLARPHP_PARSER_STREAMING_SOURCE_H
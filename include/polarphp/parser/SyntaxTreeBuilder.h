@@ -0,0 +1,360 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_PARSER_SYNTAX_TREE_BUILDER_H
+#define POLARPHP_PARSER_SYNTAX_TREE_BUILDER_H
+
+#include "polarphp/ast/AstArena.h"
+#include "polarphp/ast/AstNode.h"
+#include "polarphp/basic/adt/ArrayRef.h"
+#include "polarphp/basic/adt/DenseMap.h"
+#include "polarphp/basic/adt/SmallVector.h"
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/parser/ParsedTrivia.h"
+#include "polarphp/syntax/RawSyntax.h"
+#include "polarphp/syntax/SyntaxArena.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+
+namespace polar::parser {
+
+class Token;
+
+using polar::ast::AstArena;
+using polar::ast::AstNode;
+using polar::ast::AstNodeKind;
+using polar::basic::ArrayRef;
+using polar::basic::DenseMap;
+using polar::basic::SmallVector;
+using polar::basic::SmallVectorImpl;
+using polar::basic::StringRef;
+using polar::syntax::RawSyntax;
+using polar::syntax::RefCountPtr;
+using polar::syntax::SyntaxArena;
+using polar::syntax::SyntaxKind;
+using polar::syntax::TokenKindType;
+
+/// What the builder makes of the grammar's reductions.
+enum class ParsedTreeKind
+{
+   /// RawSyntax nodes with token text and trivia, the source can be
+   /// reproduced from them.
+   SyntaxTree,
+   /// AstNode nodes with source ranges only, for lint and analysis.
+   Ast
+};
+
+/// The semantic value of a token or a node nonterminal, the node the
+/// builder made for it. Missing optional parts are null.
+class ParsedNode
+{
+public:
+   ParsedNode() = default;
+
+   ParsedNode(std::nullptr_t)
+   {}
+
+   ParsedNode(RefCountPtr<RawSyntax> syntax)
+      : m_syntax(std::move(syntax))
+   {}
+
+   ParsedNode(AstNode *astNode)
+      : m_astNode(astNode)
+   {}
+
+   explicit operator bool() const
+   {
+      return m_syntax || m_astNode;
+   }
+
+   const RefCountPtr<RawSyntax> &getSyntax() const
+   {
+      return m_syntax;
+   }
+
+   AstNode *getAstNode() const
+   {
+      return m_astNode;
+   }
+
+private:
+   RefCountPtr<RawSyntax> m_syntax;
+   AstNode *m_astNode = nullptr;
+};
+
+/// A list nonterminal whose elements are still being reduced, the offset
+/// of its first element on the builder's element stack and the number of
+/// elements appended so far.
+struct PendingSyntaxList
+{
+   std::uint32_t start = 0;
+   std::uint32_t size = 0;
+};
+
+/// The location the grammar tracks for a symbol: the indexes of its tokens
+/// in the builder's token log, end exclusive. An empty symbol is empty at
+/// the index of the next token.
+struct ParsedTokenRange
+{
+   std::uint32_t begin = 0;
+   std::uint32_t end = 0;
+};
+
+/// Builds the nodes of the grammar's reductions, a full syntax tree or a
+/// compact AST. All nodes of one parse are bump allocated in one arena, a
+/// reduction allocates nothing else on the heap.
+///
+/// The syntax tree copies token text and comment trivia into its
+/// SyntaxArena, which the nodes keep alive. The AST only records the kind,
+/// the source range and the children of a node, its nodes live until the
+/// next parse unless the AstArena is retained, see getAstArena(). The grammar
+/// names the kind of every node by its AstNodeKind, the syntax tree takes
+/// the SyntaxKind AstNodeKindDefs.h maps it to. The statements and
+/// expressions of a syntax tree have the layouts of their syntax node
+/// classes, the ones the *SyntaxNodeFactory functions build. They are made
+/// as RawSyntax nodes in the arena, a reduction makes no SyntaxData. A
+/// statement that ends in a semicolon is the item of a CodeBlockItem, which
+/// holds the semicolon.
+///
+/// A list nonterminal is left recursive, rebuilding its node on every
+/// reduction would copy the elements over and over. Its elements are pushed
+/// on a stack instead and copied into one node when the enclosing rule is
+/// reduced. Lists nest like the rules do: when an element is appended, the
+/// lists of the rule being reduced have to be finished first, right to
+/// left, so the appended list is on top again.
+///
+/// Malformed input never unwinds the parse. The grammar resynchronizes
+/// statement lists at the next semicolon, and recoverList() turns the
+/// tokens it skipped into an unknown node of the list. Every token of the
+/// parse is logged for that, the grammar's locations are token ranges of
+/// the log. When the input ends before the parser could resynchronize,
+/// finishAbortedSourceFile() still makes a root: the complete top
+/// statements and an unknown statement of the tokens after them.
+///
+/// An AST can leave out function bodies, see Parser::setSkipFunctionBodies().
+/// The body of a skipped function is a SkippedStmtList node of its source,
+/// its InnerStmtList is parsed into it later, between startSkippedBody() and
+/// attachSkippedBody().
+class SyntaxTreeBuilder
+{
+public:
+   explicit SyntaxTreeBuilder(ParsedTreeKind treeKind = ParsedTreeKind::SyntaxTree);
+   SyntaxTreeBuilder(const SyntaxTreeBuilder &) = delete;
+   SyntaxTreeBuilder &operator=(const SyntaxTreeBuilder &) = delete;
+
+   ParsedTreeKind getTreeKind() const
+   {
+      return m_treeKind;
+   }
+
+   bool isBuildingAst() const
+   {
+      return m_treeKind == ParsedTreeKind::Ast;
+   }
+
+   /// Start the tree of a new parse. The nodes of the previous tree stay
+   /// valid while they, or the AstArena of an AST, are referenced, otherwise
+   /// their arena is reused.
+   void startTree();
+
+   /// A token node, a syntax token keeps the trivia the lexer found around
+   /// the raw text of \p token, an AST token only its range. The node is
+   /// of \p kind, the kind the grammar gets for \p token, END for the
+   /// closing brace of a skipped body. It is logged at index
+   /// getTokenCount() - 1.
+   ParsedNode makeToken(TokenKindType kind, const Token &token, const ParsedTrivia &leadingTrivia,
+                        const ParsedTrivia &trailingTrivia);
+
+   /// The tokens made since startTree().
+   std::uint32_t getTokenCount() const
+   {
+      return static_cast<std::uint32_t>(m_tokens.size());
+   }
+
+   /// A layout node, the children are copied into the node.
+   ParsedNode makeNode(AstNodeKind kind, std::initializer_list<ParsedNode> layout)
+   {
+      return makeNode(kind, ArrayRef<ParsedNode>(layout.begin(), layout.end()));
+   }
+
+   ParsedNode makeNode(AstNodeKind kind, ArrayRef<ParsedNode> layout);
+
+   PendingSyntaxList beginList()
+   {
+      return PendingSyntaxList{static_cast<std::uint32_t>(m_listElements.size()), 0};
+   }
+
+   PendingSyntaxList beginList(std::initializer_list<ParsedNode> elements)
+   {
+      PendingSyntaxList list = beginList();
+      appendToList(list, elements);
+      return list;
+   }
+
+   void appendToList(PendingSyntaxList &list, std::initializer_list<ParsedNode> elements)
+   {
+      assert(list.start + list.size == m_listElements.size() && "list is not the innermost one");
+      m_listElements.append(elements.begin(), elements.end());
+      list.size += static_cast<std::uint32_t>(elements.size());
+   }
+
+   /// The node of \p list, it has to be the innermost pending list.
+   ParsedNode finishList(PendingSyntaxList list, AstNodeKind kind);
+
+   /// Append an unknown node of \p kind of the tokens in \p skipped to
+   /// \p list, after an error the parser recovered from. The elements of
+   /// the lists the recovery popped are dropped, \p list is the innermost
+   /// one again.
+   void recoverList(PendingSyntaxList &list, AstNodeKind kind, ParsedTokenRange skipped);
+
+   /// Record \p statements as the complete top statements, they cover the
+   /// tokens up to \p range.
+   void commitTopStatements(PendingSyntaxList statements, ParsedTokenRange range)
+   {
+      m_topStatements = statements;
+      m_topStatementsEnd = range.end;
+   }
+
+   /// The root SourceFile node of the top statements and the END token.
+   void finishSourceFile(PendingSyntaxList statements);
+
+   /// The root of a parse the parser had to abort, the committed top
+   /// statements and an unknown statement of the tokens after them.
+   void finishAbortedSourceFile();
+
+   /// The body whose opening brace is the last token made was skipped, its
+   /// statements are the source of \p range.
+   void skipFunctionBody(CharSourceRange range)
+   {
+      assert(isBuildingAst() && "only an AST skips function bodies");
+      assert(getTokenCount() != 0 && "no opening brace");
+      m_skippedBody = range;
+      m_skippedBodyBrace = getTokenCount() - 1;
+   }
+
+   /// The body of a function, method or closure: the InnerStmtList of
+   /// \p statements, or a SkippedStmtList when the body whose opening
+   /// brace is the token at \p openBrace was skipped.
+   ParsedNode finishFunctionBody(PendingSyntaxList statements, std::uint32_t openBrace);
+
+   /// Start the statements of a skipped body, their nodes are added to the
+   /// arena of the current AST.
+   void startSkippedBody();
+
+   /// The InnerStmtList of the skipped body being parsed.
+   void finishSkippedBody(PendingSyntaxList statements);
+
+   /// The statements of a skipped body the parser had to abort, one unknown
+   /// statement.
+   void finishAbortedSkippedBody();
+
+   /// Make the statements of the skipped body just parsed the child of
+   /// \p skipped, its SkippedStmtList node, and return them.
+   const AstNode *attachSkippedBody(const AstNode *skipped);
+
+   /// The root of the syntax tree, null when the builder builds an AST or
+   /// the parse failed.
+   const RefCountPtr<RawSyntax> &getRoot() const
+   {
+      return m_root.getSyntax();
+   }
+
+   /// The root of the AST, null when the builder builds a syntax tree or
+   /// the parse failed.
+   const AstNode *getAstRoot() const
+   {
+      return m_root.getAstNode();
+   }
+
+   /// Null when the builder builds an AST.
+   const RefCountPtr<SyntaxArena> &getArena() const
+   {
+      return m_arena;
+   }
+
+   /// Null when the builder builds a syntax tree. Holding on to the arena
+   /// keeps the AST alive across parses.
+   const RefCountPtr<AstArena> &getAstArena() const
+   {
+      return m_astArena;
+   }
+
+   /// The nodes built since startTree(), tokens included.
+   size_t getNodeCount() const
+   {
+      return m_nodeCount;
+   }
+
+   /// The value the lexer read for \p literal, an IntegerLiteralExpr node of
+   /// the current parse or its T_LNUMBER token. None for other nodes and for
+   /// a literal the lexer could not read.
+   std::optional<std::int64_t> getIntegerValue(const RawSyntax *literal) const;
+   std::optional<std::int64_t> getIntegerValue(const AstNode *literal) const;
+
+   /// The value the lexer read for \p literal, a FloatLiteralExpr node of
+   /// the current parse or its T_DNUMBER token.
+   std::optional<double> getFloatValue(const RawSyntax *literal) const;
+   std::optional<double> getFloatValue(const AstNode *literal) const;
+
+   /// The bytes the tree of the current parse took from its arena.
+   size_t getAllocatedBytes() const
+   {
+      return isBuildingAst() ? m_astArena->getAllocator().getBytesAllocated()
+                             : m_arena->getAllocator().getBytesAllocated();
+   }
+
+private:
+   StringRef copyText(StringRef text);
+   void appendTrivia(const ParsedTrivia &trivia, const char *start,
+                     SmallVectorImpl<syntax::TriviaPiece> &pieces);
+   /// The logged tokens from \p begin on, END excluded.
+   ParsedTokenRange getUnparsedTokens(std::uint32_t begin) const;
+   RefCountPtr<RawSyntax> makeRaw(SyntaxKind kind, ArrayRef<RefCountPtr<RawSyntax>> layout);
+   /// The syntax node of a reduction of \p kind, \p symbols are the children
+   /// of its rule.
+   RefCountPtr<RawSyntax> makeSyntax(AstNodeKind kind, ArrayRef<RefCountPtr<RawSyntax>> symbols);
+   /// A CodeBlockItem of a statement of \p kind and its \p semicolon.
+   RefCountPtr<RawSyntax> makeStatementItem(SyntaxKind kind, ArrayRef<RefCountPtr<RawSyntax>> layout,
+                                            const RefCountPtr<RawSyntax> &semicolon);
+   RefCountPtr<RawSyntax> makeIfStmt(ArrayRef<RefCountPtr<RawSyntax>> symbols);
+   RefCountPtr<RawSyntax> makeSwitchCaseList(ArrayRef<RefCountPtr<RawSyntax>> symbols);
+   RefCountPtr<RawSyntax> makeArgumentList(ArrayRef<RefCountPtr<RawSyntax>> symbols);
+   RefCountPtr<RawSyntax> makeArrayPairItemList(ArrayRef<RefCountPtr<RawSyntax>> symbols);
+
+   const ParsedTreeKind m_treeKind;
+   RefCountPtr<SyntaxArena> m_arena;
+   RefCountPtr<AstArena> m_astArena;
+   ParsedNode m_root;
+   ParsedNode m_endToken;
+   SmallVector<ParsedNode, 64> m_listElements;
+   SmallVector<ParsedNode, 64> m_tokens;
+   PendingSyntaxList m_topStatements;
+   std::uint32_t m_topStatementsEnd = 0;
+   CharSourceRange m_skippedBody;
+   /// The token index of the opening brace of m_skippedBody, error
+   /// recovery may throw its function away.
+   std::uint32_t m_skippedBodyBrace = 0;
+   ParsedNode m_parsedBody;
+   size_t m_nodeCount = 0;
+   /// The values of the number tokens by their nodes, the tokens only keep
+   /// the text.
+   DenseMap<const void *, std::int64_t> m_integerValues;
+   DenseMap<const void *, double> m_floatValues;
+};
+
+} // polar::parser
+
+#endif // POLARPHP_PARSER_SYNTAX_TREE_BUILDER_H
@@ -22,10 +22,13 @@
 #include "polarphp/basic/FlagSet.h"
 #include "polarphp/utils/SourceLocation.h"
 #include "polarphp/parser/SourceLoc.h"
+#include "polarphp/parser/TokenValueArena.h"
 #include "polarphp/syntax/TokenKinds.h"
 #include "polarphp/parser/internal/YYParserDefs.h"
 
-#include <any>
+#include <cstdint>
+#include <string>
+#include <type_traits>
 
 /// forward declare class with namespace
 namespace polar::utils {
@@ -34,6 +37,7 @@ class RawOutStream;
 
 namespace polar::parser {
 
+using polar::basic::IntrusiveRefCountPtr;
 using polar::basic::StringRef;
 using polar::basic::FlagSet;
 using polar::utils::RawOutStream;
@@ -86,7 +90,8 @@ public:
         m_kind(kind),
         m_commentLength(commentLength),
         m_valueType(ValueType::Unknown),
-        m_text(text)
+        m_text(text),
+        m_value()
    {}
 
    Token()
@@ -231,7 +236,7 @@ public:
 
    bool hasValue() const
    {
-      return m_value.has_value();
+      return m_valueType != ValueType::Unknown;
    }
 
    /// getLoc - Return a source location identifier for the specified
@@ -268,6 +273,22 @@ public:
       return m_commentLength != 0;
    }
 
+   unsigned getCommentLength() const
+   {
+      return m_commentLength;
+   }
+
+   TokenFlags getFlags() const
+   {
+      return m_flags;
+   }
+
+   Token &setFlags(TokenFlags flags)
+   {
+      m_flags = flags;
+      return *this;
+   }
+
    CharSourceRange getCommentRange() const
    {
       if (m_commentLength == 0) {
@@ -310,35 +331,109 @@ public:
       return *this;
    }
 
+   /// The token does not own string values, \p value must outlive it. The
+   /// lexer only passes slices of the source buffer or string literals
+   /// here, strings saved in its TokenValueArena go to the overload below.
    Token &setValue(StringRef value)
    {
       m_valueType = ValueType::String;
-      m_value.emplace<std::string>(value.data(), value.getSize());
+      m_valueQuoteType = 0;
+      m_value.stringValue.data = value.data();
+      m_value.stringValue.length = value.size();
+      m_valueArena.reset();
       return *this;
    }
 
+   /// A string value saved in \p arena, the token and its copies keep
+   /// \p arena alive.
+   Token &setValue(StringRef value, TokenValueArena *arena)
+   {
+      setValue(value);
+      m_valueArena = arena;
+      return *this;
+   }
+
+   /// Set a string value whose escape sequences are decoded on first
+   /// request, \p rawValue is the literal body in the source buffer and
+   /// \p quoteType the quote that selects the escape rules. The decoded
+   /// string is saved in \p arena, which the token keeps alive.
+   Token &setEscapedValue(StringRef rawValue, char quoteType, TokenValueArena *arena)
+   {
+      assert(quoteType != 0 && arena && "escaped value needs a quote type and an arena");
+      setValue(rawValue);
+      m_valueQuoteType = quoteType;
+      m_valueArena = arena;
+      return *this;
+   }
+
+   /// Whether the string value still has undecoded escape sequences.
+   bool hasPendingEscapes() const
+   {
+      return m_valueQuoteType != 0;
+   }
+
+   /// The string value as it was set, without decoding pending escapes.
+   StringRef getRawStringValue() const
+   {
+      assert(m_valueType == ValueType::String && "token value is not a string");
+      return StringRef(m_value.stringValue.data, m_value.stringValue.length);
+   }
+
+   Token &setValue(const char *value)
+   {
+      return setValue(StringRef(value));
+   }
+
+   /// Temporaries would dangle, save them in a TokenValueArena first.
+   Token &setValue(const std::string &value) = delete;
+
    Token &setValue(std::int64_t value)
    {
       m_valueType = ValueType::LongLong;
-      m_value.emplace<std::int64_t>(value);
+      m_value.longValue = value;
+      m_valueArena.reset();
       return *this;
    }
 
    Token &setValue(double value)
    {
       m_valueType = ValueType::Double;
-      m_value.emplace<double>(value);
+      m_value.doubleValue = value;
+      m_valueArena.reset();
       return *this;
    }
 
+   /// getValue<StringRef>() does not copy, getValue<std::string>() makes an
+   /// owned copy of the string value.
    template <typename T,
              typename std::enable_if<std::is_same<T, std::string>::value ||
+                                     std::is_same<T, StringRef>::value ||
                                      std::is_same<T, double>::value ||
                                      std::is_same<T, std::int64_t>::value, void *>::type = nullptr>
-   const T &getValue() const
+   T getValue() const
+   {
+      assert(hasValue());
+      if constexpr (std::is_same<T, std::int64_t>::value) {
+         assert(m_valueType == ValueType::LongLong && "token value is not an integer");
+         return m_value.longValue;
+      } else if constexpr (std::is_same<T, double>::value) {
+         assert(m_valueType == ValueType::Double && "token value is not a double");
+         return m_value.doubleValue;
+      } else {
+         StringRef value = getStringValue();
+         return T(value.data(), value.size());
+      }
+   }
+
+   /// Decodes pending escapes on first call, so this is not safe to call on
+   /// the same token from several threads. Copies of the token share the
+   /// decoded string, it is looked up in the arena.
+   StringRef getStringValue() const
    {
-      assert(m_value.has_value());
-      return std::any_cast<const T &>(m_value);
+      if (hasPendingEscapes()) {
+         decodeStringValue();
+      }
+      return getRawStringValue();
    }
 
    ValueType getValueType() const
@@ -349,14 +444,33 @@ public:
    Token &setValueType(ValueType type)
    {
       m_valueType = type;
-      m_value.reset();
+      m_valueQuoteType = 0;
+      m_value.stringValue = {nullptr, 0};
+      m_valueArena.reset();
       return *this;
    }
 
    Token &resetValueType()
    {
-      m_valueType = ValueType::Unknown;
-      m_value.reset();
+      return setValueType(ValueType::Unknown);
+   }
+
+   /// The interned name of an identifier or variable token as it is spelled,
+   /// 0 if the lexer had no IdentifierTable. Case insensitive names are
+   /// compared through IdentifierTable::getFoldedSymbol().
+   std::uint32_t getSymbolId() const
+   {
+      return m_symbolId;
+   }
+
+   bool hasSymbolId() const
+   {
+      return m_symbolId != 0;
+   }
+
+   Token &setSymbolId(std::uint32_t id)
+   {
+      m_symbolId = id;
       return *this;
    }
 
@@ -366,6 +480,7 @@ public:
       m_kind = kind;
       m_text = text;
       m_commentLength = commentLength;
+      m_symbolId = 0;
       m_flags.setEscapedIdentifier(false);
       return *this;
    }
@@ -375,6 +490,8 @@ public:
    /// Dump this piece of syntax recursively.
    void dump(RawOutStream &outStream) const;
 private:
+   void decodeStringValue() const;
+
    StringRef trimComment() const
    {
       assert(hasComment() && "Has no comment to trim.");
@@ -393,13 +510,36 @@ private:
 
    ValueType m_valueType;
 
+   /// The quote type of a string value whose escapes are not decoded yet,
+   /// 0 once there is nothing left to decode.
+   mutable char m_valueQuoteType = 0;
+
+   /// See getSymbolId(), it fits in the padding before m_text.
+   std::uint32_t m_symbolId = 0;
+
    /// Text - The actual string covered by the token in the source buffer.
    StringRef m_text;
 
-   /// The token value
-   std::any m_value;
+   /// The token value, tagged by m_valueType. Strings are not owned, see
+   /// setValue(StringRef), so copying a token never allocates.
+   mutable union {
+      std::int64_t longValue;
+      double doubleValue;
+      struct {
+         const char *data;
+         size_t length;
+      } stringValue;
+   } m_value;
+
+   /// The arena of a string value saved in one and where pending escapes
+   /// are decoded to, see setEscapedValue(). Null for every other value, so
+   /// only these tokens touch a reference count when they are copied.
+   IntrusiveRefCountPtr<TokenValueArena> m_valueArena;
 };
 
+// tokens are copied and buffered in bulk, one fits a cache line
+static_assert(sizeof(void *) != 8 || sizeof(Token) == 64, "Token does not fit a cache line");
+
 } // polar::syntax
 
 #endif // POLAR_PARSER_TOKEN_H
@@ -0,0 +1,210 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/08.
+
+#ifndef POLARPHP_PARSER_TOKEN_BUFFER_H
+#define POLARPHP_PARSER_TOKEN_BUFFER_H
+
+#include "polarphp/basic/adt/ArrayRef.h"
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/parser/SourceLoc.h"
+#include "polarphp/parser/Token.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace polar::kernel {
+class LangOptions;
+} // polar::kernel
+
+namespace polar::ast {
+class DiagnosticEngine;
+} // polar::ast
+
+namespace polar::parser {
+
+class SourceManager;
+using polar::basic::ArrayRef;
+using polar::kernel::LangOptions;
+using polar::ast::DiagnosticEngine;
+
+/// TokenBuffer - A compact, structure of arrays store for the tokens of one
+/// source buffer.
+///
+/// Kind, offset, length and flags live in parallel packed arrays, so bulk
+/// consumers (highlighters, strip mode, indexers) that only look at one of
+/// them touch as little memory as possible. Literal values and comment
+/// lengths are rare, they are kept in side tables ordered by token index.
+/// Use getToken() to get a full Token back when needed.
+class TokenBuffer
+{
+public:
+   /// \p bufferText is the whole text of the source buffer the tokens come
+   /// from, token offsets are relative to its start.
+   explicit TokenBuffer(StringRef bufferText)
+      : m_bufferText(bufferText)
+   {}
+
+   void append(const Token &token);
+   void reserve(size_t tokenCount);
+   void clear();
+
+   size_t size() const
+   {
+      return m_kinds.size();
+   }
+
+   bool empty() const
+   {
+      return m_kinds.empty();
+   }
+
+   StringRef getBufferText() const
+   {
+      return m_bufferText;
+   }
+
+   TokenKindType getKind(size_t index) const
+   {
+      return static_cast<TokenKindType>(m_kinds[index]);
+   }
+
+   /// Byte offset of the token text in the source buffer.
+   unsigned getOffset(size_t index) const
+   {
+      return m_offsets[index];
+   }
+
+   unsigned getLength(size_t index) const
+   {
+      return m_lengths[index];
+   }
+
+   TokenFlags getFlags(size_t index) const
+   {
+      return TokenFlags(m_flags[index] & TokenFlagsMask);
+   }
+
+   StringRef getText(size_t index) const
+   {
+      return m_bufferText.substr(m_offsets[index], m_lengths[index]);
+   }
+
+   SourceLoc getLoc(size_t index) const
+   {
+      return SourceLoc(polar::utils::SMLocation::getFromPointer(m_bufferText.data() + m_offsets[index]));
+   }
+
+   unsigned getCommentLength(size_t index) const;
+
+   Token::ValueType getValueType(size_t index) const;
+   bool hasValue(size_t index) const
+   {
+      return getValueType(index) != Token::ValueType::Unknown;
+   }
+
+   std::int64_t getLongLongValue(size_t index) const;
+   double getDoubleValue(size_t index) const;
+   StringRef getStringValue(size_t index) const;
+
+   /// Materialize the full Token at \p index.
+   Token getToken(size_t index) const;
+
+   ArrayRef<std::uint16_t> getKinds() const
+   {
+      return m_kinds;
+   }
+
+   ArrayRef<std::uint32_t> getOffsets() const
+   {
+      return m_offsets;
+   }
+
+   ArrayRef<std::uint32_t> getLengths() const
+   {
+      return m_lengths;
+   }
+
+   /// Index of the first token that does not start before \p offset, or
+   /// size() if there is none. Only the offsets array is searched.
+   size_t lowerBound(unsigned offset) const;
+
+   /// Same as token_lower_bound() for Token arrays, \p loc must point into
+   /// the source buffer of this TokenBuffer.
+   size_t lowerBound(SourceLoc loc) const;
+
+   /// Bytes allocated for the token data, including the side tables.
+   size_t getMemoryUsage() const;
+
+   /// Release the spare capacity of the arrays, for buffers that are done
+   /// growing and will be kept around.
+   void shrinkToFit();
+
+private:
+   /// The low bits of each m_flags byte hold the TokenFlags, the high bits
+   /// record string values that are just a slice of the token text
+   /// (identifiers, variables, quoted strings without escapes), these never
+   /// get a ValueEntry.
+   enum : std::uint8_t
+   {
+      TokenFlagsMask = 0x1F,
+      StringValueIsText = 1 << 5,
+      StringValueSkipsFirst = 1 << 6,
+      StringValueSkipsLast = 1 << 7
+   };
+
+   struct ValueEntry
+   {
+      std::uint32_t tokenIndex;
+      Token::ValueType type;
+      union {
+         std::int64_t longValue;
+         double doubleValue;
+         struct {
+            std::uint32_t offset;
+            std::uint32_t length;
+         } stringRange;
+      };
+   };
+
+   struct CommentEntry
+   {
+      std::uint32_t tokenIndex;
+      std::uint32_t length;
+   };
+
+   const ValueEntry *findValue(size_t index) const;
+
+private:
+   StringRef m_bufferText;
+   std::vector<std::uint16_t> m_kinds;
+   std::vector<std::uint32_t> m_offsets;
+   std::vector<std::uint32_t> m_lengths;
+   std::vector<std::uint8_t> m_flags;
+   /// sorted by token index, only tokens with a value that is not a slice of
+   /// their own text have an entry
+   std::vector<ValueEntry> m_values;
+   /// decoded string values, referenced by ValueEntry::stringRange
+   std::string m_stringPool;
+   /// sorted by token index, only tokens with a comment have an entry
+   std::vector<CommentEntry> m_comments;
+};
+
+/// Lex the given buffer into a TokenBuffer, the END token is not stored.
+TokenBuffer tokenize_to_buffer(const LangOptions &langOpts,
+                               const SourceManager &sourceMgr, unsigned bufferId,
+                               unsigned offset = 0, unsigned endOffset = 0,
+                               DiagnosticEngine *diags = nullptr,
+                               bool keepComments = true);
+
+} // polar::parser
+
+#endif // POLARPHP_PARSER_TOKEN_BUFFER_H
@@ -0,0 +1,117 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/10.
+
+#ifndef POLARPHP_PARSER_TOKEN_VALUE_ARENA_H
+#define POLARPHP_PARSER_TOKEN_VALUE_ARENA_H
+
+#include "polarphp/basic/adt/DenseMap.h"
+#include "polarphp/basic/adt/IntrusiveRefCountPtr.h"
+#include "polarphp/basic/adt/StringRef.h"
+#include "polarphp/utils/Allocator.h"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+namespace polar::parser {
+
+using polar::basic::DenseMap;
+using polar::basic::IntrusiveRefCountPtr;
+using polar::basic::StringRef;
+using polar::basic::ThreadSafeRefCountedBase;
+using polar::utils::BumpPtrAllocator;
+
+/// Storage for the token string values that are not a slice of the source
+/// buffer, e.g. literals with escape sequences or stripped heredoc bodies.
+///
+/// Tokens only reference their string values, they stay valid as long as
+/// the arena does. The arena is shared by a lexer and its sub lexers, only
+/// one of them may lex at a time.
+class TokenValueArena : public ThreadSafeRefCountedBase<TokenValueArena>
+{
+public:
+   TokenValueArena()
+   {}
+
+   /// Copy \p str into the arena.
+   StringRef copyString(StringRef str)
+   {
+      if (str.empty()) {
+         return StringRef("", 0);
+      }
+      char *data = allocate(str.size());
+      std::memcpy(data, str.data(), str.size());
+      return StringRef(data, str.size());
+   }
+
+   /// Uninitialized room for \p size chars.
+   char *allocate(size_t size)
+   {
+      return static_cast<char *>(m_allocator.allocate(std::max<size_t>(size, 1), alignof(char)));
+   }
+
+   /// The string an escaped value starting at \p raw was decoded to, by any
+   /// copy of its token. Empty if it was not decoded yet.
+   std::optional<StringRef> findDecodedValue(const char *raw) const
+   {
+      auto iter = m_decodedValues.find(raw);
+      if (iter == m_decodedValues.end()) {
+         return std::nullopt;
+      }
+      return iter->second;
+   }
+
+   void addDecodedValue(const char *raw, StringRef decoded)
+   {
+      m_decodedValues[raw] = decoded;
+   }
+
+   /// Keep \p other alive as long as this arena, for tokens lexed into
+   /// another arena, e.g. on another thread, that are handed over.
+   void adoptArena(IntrusiveRefCountPtr<TokenValueArena> other)
+   {
+      if (other && other != this) {
+         m_adoptedArenas.push_back(std::move(other));
+      }
+   }
+
+   /// Forget all values and adopted arenas, the first slab is kept for the
+   /// next buffer. No token may reference the values any more.
+   void reset()
+   {
+      m_allocator.reset();
+      m_decodedValues.clear();
+      m_adoptedArenas.clear();
+   }
+
+   size_t getTotalMemory() const
+   {
+      size_t total = m_allocator.getTotalMemory();
+      for (const IntrusiveRefCountPtr<TokenValueArena> &arena : m_adoptedArenas) {
+         total += arena->getTotalMemory();
+      }
+      return total;
+   }
+
+private:
+   TokenValueArena(const TokenValueArena &) = delete;
+   void operator=(const TokenValueArena &) = delete;
+   BumpPtrAllocator m_allocator;
+   /// Decoded escaped values by the start of their raw value, copies of a
+   /// token decode it once.
+   DenseMap<const char *, StringRef> m_decodedValues;
+   std::vector<IntrusiveRefCountPtr<TokenValueArena>> m_adoptedArenas;
+};
+
+} // polar::parser
+
+#endif // POLARPHP_PARSER_TOKEN_VALUE_ARENA_H
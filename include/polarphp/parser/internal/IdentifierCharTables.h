@@ -0,0 +1,222 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_PARSER_INTERNAL_IDENTIFIER_CHAR_TABLES_H
+#define POLARPHP_PARSER_INTERNAL_IDENTIFIER_CHAR_TABLES_H
+
+#include "polarphp/utils/UnicodeCharRanges.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace polar::parser::internal {
+
+using polar::sys::UnicodeCharRange;
+
+/// The code points allowed in identifiers, ASCII letters, digits, '_' and
+/// '$' and the ranges of N1518 Annex X.1: Ranges of characters allowed.
+constexpr UnicodeCharRange scg_identifierContinuationRanges[] = {
+   {0x0024, 0x0024}, {0x0030, 0x0039}, {0x0041, 0x005A}, {0x005F, 0x005F},
+   {0x0061, 0x007A}, {0x00A8, 0x00A8}, {0x00AA, 0x00AA}, {0x00AD, 0x00AD},
+   {0x00AF, 0x00AF}, {0x00B2, 0x00B5}, {0x00B7, 0x00BA}, {0x00BC, 0x00BE},
+   {0x00C0, 0x00D6}, {0x00D8, 0x00F6}, {0x00F8, 0x00FF}, {0x0100, 0x167F},
+   {0x1681, 0x180D}, {0x180F, 0x1FFF}, {0x200B, 0x200D}, {0x202A, 0x202E},
+   {0x203F, 0x2040}, {0x2054, 0x2054}, {0x2060, 0x206F}, {0x2070, 0x218F},
+   {0x2460, 0x24FF}, {0x2776, 0x2793}, {0x2C00, 0x2DFF}, {0x2E80, 0x2FFF},
+   {0x3004, 0x3007}, {0x3021, 0x302F}, {0x3031, 0x303F}, {0x3040, 0xD7FF},
+   {0xF900, 0xFD3D}, {0xFD40, 0xFDCF}, {0xFDF0, 0xFE44}, {0xFE47, 0xFFF8},
+   {0x10000, 0x1FFFD}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}, {0x40000, 0x4FFFD},
+   {0x50000, 0x5FFFD}, {0x60000, 0x6FFFD}, {0x70000, 0x7FFFD}, {0x80000, 0x8FFFD},
+   {0x90000, 0x9FFFD}, {0xA0000, 0xAFFFD}, {0xB0000, 0xBFFFD}, {0xC0000, 0xCFFFD},
+   {0xD0000, 0xDFFFD}, {0xE0000, 0xEFFFD}
+};
+
+/// The identifier code points that cannot start one, '$', the digits and
+/// N1518 Annex X.2: Ranges of characters disallowed initially.
+constexpr UnicodeCharRange scg_identifierStartExcludedRanges[] = {
+   {0x0024, 0x0024}, {0x0030, 0x0039}, {0x0300, 0x036F}, {0x1DC0, 0x1DFF},
+   {0x20D0, 0x20FF}, {0xFE20, 0xFE2F}
+};
+
+/// A set of code points below \c Limit as a two stage bitmap: the first stage
+/// maps every block of 256 code points to one of the distinct blocks of the
+/// second stage, which are 256 bit bitmaps. Identical blocks, mostly all set
+/// or all clear ones, are only stored once. A lookup is two loads and a bit
+/// test.
+template <std::uint32_t Limit, std::size_t BlockCount>
+struct TwoStageBitmap
+{
+   static constexpr std::uint32_t blockShift = 8;
+   static constexpr std::size_t stageCount = (Limit + 255) >> blockShift;
+   using Block = std::array<std::uint64_t, 4>;
+
+   std::array<std::uint8_t, stageCount> stage1{};
+   std::array<Block, BlockCount> stage2{};
+
+   constexpr bool contains(std::uint32_t c) const
+   {
+      if (c >= Limit) {
+         return false;
+      }
+      return (stage2[stage1[c >> blockShift]][(c >> 6) & 3] >> (c & 63)) & 1;
+   }
+};
+
+namespace tables {
+
+/// The bits of the 64 code points at \p wordStart that are in \p range.
+constexpr std::uint64_t get_range_bits(UnicodeCharRange range, std::uint32_t wordStart)
+{
+   if (range.m_upper < wordStart || range.m_lower > wordStart + 63) {
+      return 0;
+   }
+   std::uint32_t low = (range.m_lower > wordStart ? range.m_lower : wordStart) - wordStart;
+   std::uint32_t high = (range.m_upper < wordStart + 63 ? range.m_upper : wordStart + 63) - wordStart;
+   std::uint64_t mask = high == 63 ? ~std::uint64_t(0) : (std::uint64_t(1) << (high + 1)) - 1;
+   return mask & ~((std::uint64_t(1) << low) - 1);
+}
+
+/// Walks the blocks of code points in order and yields their bits, the
+/// ranges are sorted so only the ones that overlap the current block are
+/// looked at.
+template <std::size_t IncludeCount, std::size_t ExcludeCount>
+class BlockBuilder
+{
+public:
+   using Block = std::array<std::uint64_t, 4>;
+
+   constexpr BlockBuilder(const UnicodeCharRange (&include)[IncludeCount],
+                          const UnicodeCharRange (&exclude)[ExcludeCount])
+      : m_include(include),
+        m_exclude(exclude)
+   {}
+
+   constexpr Block getBlock(std::uint32_t blockStart)
+   {
+      Block block{};
+      std::uint32_t blockEnd = blockStart + 255;
+      while (m_includeIndex < IncludeCount && m_include[m_includeIndex].m_upper < blockStart) {
+         ++m_includeIndex;
+      }
+      while (m_excludeIndex < ExcludeCount && m_exclude[m_excludeIndex].m_upper < blockStart) {
+         ++m_excludeIndex;
+      }
+      for (std::size_t i = m_includeIndex; i < IncludeCount && m_include[i].m_lower <= blockEnd; ++i) {
+         for (std::uint32_t word = 0; word < 4; ++word) {
+            block[word] |= get_range_bits(m_include[i], blockStart + word * 64);
+         }
+      }
+      for (std::size_t i = m_excludeIndex; i < ExcludeCount && m_exclude[i].m_lower <= blockEnd; ++i) {
+         for (std::uint32_t word = 0; word < 4; ++word) {
+            block[word] &= ~get_range_bits(m_exclude[i], blockStart + word * 64);
+         }
+      }
+      return block;
+   }
+
+private:
+   const UnicodeCharRange (&m_include)[IncludeCount];
+   const UnicodeCharRange (&m_exclude)[ExcludeCount];
+   std::size_t m_includeIndex = 0;
+   std::size_t m_excludeIndex = 0;
+};
+
+constexpr bool is_same_block(const std::array<std::uint64_t, 4> &lhs, const std::array<std::uint64_t, 4> &rhs)
+{
+   return lhs[0] == rhs[0] && lhs[1] == rhs[1] && lhs[2] == rhs[2] && lhs[3] == rhs[3];
+}
+
+/// Fill \p stage1 and \p stage2 for the code points in \p include but not in
+/// \p exclude, returns the number of distinct blocks. Runs at compile time,
+/// \p stage2 can be too small to count the blocks first.
+template <std::uint32_t Limit, std::size_t IncludeCount, std::size_t ExcludeCount,
+          std::size_t StageCount, std::size_t BlockCount>
+constexpr std::size_t build_stages(const UnicodeCharRange (&include)[IncludeCount],
+                                   const UnicodeCharRange (&exclude)[ExcludeCount],
+                                   std::array<std::uint8_t, StageCount> &stage1,
+                                   std::array<std::array<std::uint64_t, 4>, BlockCount> &stage2)
+{
+   BlockBuilder<IncludeCount, ExcludeCount> builder(include, exclude);
+   std::size_t count = 0;
+   std::size_t previous = 0;
+   for (std::size_t index = 0; index < StageCount; ++index) {
+      std::array<std::uint64_t, 4> block = builder.getBlock(static_cast<std::uint32_t>(index << 8));
+      // runs of the same block are the common case, only search on a change
+      std::size_t found = count;
+      if (count > 0 && previous < BlockCount && is_same_block(stage2[previous], block)) {
+         found = previous;
+      } else {
+         for (std::size_t i = 0; i < count && i < BlockCount; ++i) {
+            if (is_same_block(stage2[i], block)) {
+               found = i;
+               break;
+            }
+         }
+      }
+      if (found == count) {
+         if (count < BlockCount) {
+            stage2[count] = block;
+         }
+         ++count;
+      }
+      stage1[index] = static_cast<std::uint8_t>(found);
+      previous = found;
+   }
+   return count;
+}
+
+template <std::uint32_t Limit, std::size_t IncludeCount, std::size_t ExcludeCount>
+constexpr std::size_t count_distinct_blocks(const UnicodeCharRange (&include)[IncludeCount],
+                                            const UnicodeCharRange (&exclude)[ExcludeCount])
+{
+   std::array<std::uint8_t, ((Limit + 255) >> 8)> stage1{};
+   std::array<std::array<std::uint64_t, 4>, 256> stage2{};
+   return build_stages<Limit>(include, exclude, stage1, stage2);
+}
+
+template <std::uint32_t Limit, std::size_t BlockCount, std::size_t IncludeCount, std::size_t ExcludeCount>
+constexpr TwoStageBitmap<Limit, BlockCount> build_two_stage_bitmap(const UnicodeCharRange (&include)[IncludeCount],
+                                                                   const UnicodeCharRange (&exclude)[ExcludeCount])
+{
+   TwoStageBitmap<Limit, BlockCount> bitmap{};
+   build_stages<Limit>(include, exclude, bitmap.stage1, bitmap.stage2);
+   return bitmap;
+}
+
+/// The highest identifier code point is U+EFFFD.
+constexpr std::uint32_t sg_identifierCodePointLimit = 0xF0000;
+
+constexpr UnicodeCharRange scg_noRanges[] = {{0x110000, 0x110000}};
+
+constexpr std::size_t sg_continuationBlockCount =
+      count_distinct_blocks<sg_identifierCodePointLimit>(scg_identifierContinuationRanges, scg_noRanges);
+constexpr std::size_t sg_startBlockCount =
+      count_distinct_blocks<sg_identifierCodePointLimit>(scg_identifierContinuationRanges,
+                                                        scg_identifierStartExcludedRanges);
+static_assert(sg_continuationBlockCount <= 256 && sg_startBlockCount <= 256,
+              "the first stage indexes blocks with a byte");
+
+} // tables
+
+/// The tables are built by the compiler from the ranges above, there is no
+/// generated source to keep in sync.
+inline constexpr TwoStageBitmap<tables::sg_identifierCodePointLimit, tables::sg_continuationBlockCount>
+scg_identifierContinuationTable = tables::build_two_stage_bitmap<tables::sg_identifierCodePointLimit,
+tables::sg_continuationBlockCount>(scg_identifierContinuationRanges, tables::scg_noRanges);
+
+inline constexpr TwoStageBitmap<tables::sg_identifierCodePointLimit, tables::sg_startBlockCount>
+scg_identifierStartTable = tables::build_two_stage_bitmap<tables::sg_identifierCodePointLimit,
+tables::sg_startBlockCount>(scg_identifierContinuationRanges, scg_identifierStartExcludedRanges);
+
+} // polar::parser::internal
+
+#endif // POLARPHP_PARSER_INTERNAL_IDENTIFIER_CHAR_TABLES_H
@@ -0,0 +1,62 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#ifndef POLARPHP_PARSER_INTERNAL_NUMERIC_LITERALS_H
+#define POLARPHP_PARSER_INTERNAL_NUMERIC_LITERALS_H
+
+#include <cstdint>
+
+namespace polar::parser::internal {
+
+/// Conversion of the numeric literal tokens to their values.
+///
+/// The text is read in one pass straight from the source buffer, it is
+/// neither copied nor has to be NUL terminated. Decimal digits are consumed
+/// eight at a time where possible and doubles are correctly rounded, the
+/// results are the same as the ones of strtoll() and strtod().
+
+/// The significant digits of a decimal literal: the value is
+/// mantissa * 10^exponent. Only the first 19 significant digits are kept,
+/// they always fit in the mantissa.
+struct DecimalDigits
+{
+   std::uint64_t mantissa = 0;
+   std::int64_t exponent = 0;
+   /// A non zero digit was dropped, the value is slightly more than what
+   /// mantissa and exponent say.
+   bool truncated = false;
+};
+
+/// Parse [\p begin, \p end) that matches LNUM, DNUM or EXPONENT_DNUM into
+/// \p digits. An integer literal fits in an int64_t exactly when the exponent
+/// is 0 and the mantissa is not greater than INT64_MAX.
+void parse_decimal_digits(const unsigned char *begin, const unsigned char *end,
+                          DecimalDigits &digits);
+
+/// Correctly rounded conversion of \p digits to a double. Returns false in
+/// the rare case truncated digits make the rounding ambiguous.
+bool decimal_digits_to_double(const DecimalDigits &digits, double &value);
+
+/// The value of the decimal literal [\p begin, \p end) as strtod() computes
+/// it, \p digits has to be what parse_decimal_digits() produced for it.
+double decimal_literal_to_double(const unsigned char *begin, const unsigned char *end,
+                                 const DecimalDigits &digits);
+
+/// Parse the digits [\p begin, \p end) of a binary, octal or hexadecimal
+/// literal, \p log2Radix is 1, 3 or 4. Returns false if there is a digit the
+/// radix does not have, \p value and \p overflow then describe the digits in
+/// front of it. \p overflow is set if the value does not fit in 64 bits.
+bool parse_radix_digits(const unsigned char *begin, const unsigned char *end, unsigned log2Radix,
+                        std::uint64_t &value, bool &overflow);
+
+} // polar::parser::internal
+
+#endif // POLARPHP_PARSER_INTERNAL_NUMERIC_LITERALS_H
@@ -0,0 +1,82 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/02.
+
+#ifndef POLARPHP_PARSER_INTERNAL_SCAN_KERNELS_H
+#define POLARPHP_PARSER_INTERNAL_SCAN_KERNELS_H
+
+#include <cstddef>
+
+namespace polar::parser::internal {
+
+/// Byte scanning kernels used by the lexer hot loops.
+///
+/// Every kernel has a vectorized implementation (SSE2, or AVX2 when the
+/// compiler targets it) and a scalar one, the scalar version is always
+/// available and is what non x86 builds use. Kernels never read at or beyond
+/// \p end, so they are safe on buffers that are not padded.
+
+/// Returns a pointer to the first byte in [\p cur, \p end) that is not equal
+/// to \p ch, or \p end if the whole range consists of \p ch.
+const unsigned char *skip_byte_run(const unsigned char *cur, const unsigned char *end,
+                                   unsigned char ch);
+const unsigned char *skip_byte_run_scalar(const unsigned char *cur, const unsigned char *end,
+                                          unsigned char ch);
+
+/// Returns a pointer to the first byte in [\p cur, \p end) that ends the body
+/// of a // or # comment: a newline, a NUL (embedded, code completion or the
+/// buffer terminator), and when \p stopAtNonAscii is set, any byte >= 0x80 so
+/// the caller can validate UTF-8. Returns \p end if there is none.
+const unsigned char *find_line_comment_stop(const unsigned char *cur, const unsigned char *end,
+                                            bool stopAtNonAscii);
+const unsigned char *find_line_comment_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                   bool stopAtNonAscii);
+
+/// Returns a pointer to the first byte in [\p cur, \p end) that a /* */
+/// comment scanner has to look at: a '/' (every open and close marker has
+/// one), a NUL, and when \p stopAtNonAscii is set, any byte >= 0x80.
+/// \p sawNewline is set if a newline was skipped over, it is never cleared.
+const unsigned char *find_block_comment_stop(const unsigned char *cur, const unsigned char *end,
+                                             bool stopAtNonAscii, bool &sawNewline);
+const unsigned char *find_block_comment_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                    bool stopAtNonAscii, bool &sawNewline);
+
+/// Returns a pointer to the first byte in [\p cur, \p end) a heredoc or
+/// nowdoc body scanner has to look at: a newline, and when \p interpolating
+/// is set (heredoc), the bytes that can start an interpolation or an escape:
+/// '$', '{' and '\\'. Returns \p end if there is none.
+const unsigned char *find_heredoc_body_stop(const unsigned char *cur, const unsigned char *end,
+                                            bool interpolating);
+const unsigned char *find_heredoc_body_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                   bool interpolating);
+
+/// Returns a pointer to the first byte in [\p cur, \p end) a double quoted
+/// string or backquote body scanner has to look at: the closing \p quote
+/// and the bytes that can start an interpolation or an escape: '$', '{' and
+/// '\\'. Returns \p end if there is none.
+const unsigned char *find_interpolated_string_stop(const unsigned char *cur, const unsigned char *end,
+                                                   unsigned char quote);
+const unsigned char *find_interpolated_string_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                          unsigned char quote);
+
+/// Returns a pointer to the first byte in [\p cur, \p end) that is not
+/// ASCII (>= 0x80), or \p end if the range is plain ASCII.
+const unsigned char *find_non_ascii(const unsigned char *cur, const unsigned char *end);
+const unsigned char *find_non_ascii_scalar(const unsigned char *cur, const unsigned char *end);
+
+/// Turn the vectorized kernels on or off for the whole process, when off
+/// every kernel takes its scalar path. This is intended for differential
+/// tests and benchmarks, the default is on.
+void set_vector_scan_enabled(bool enabled);
+bool is_vector_scan_enabled();
+
+} // polar::parser::internal
+
+#endif // POLARPHP_PARSER_INTERNAL_SCAN_KERNELS_H
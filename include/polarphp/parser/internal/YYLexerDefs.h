@@ -13,7 +13,6 @@
 #define POLARPHP_PARSER_INTERNAL_YY_LEXER_DEFS_H
 
 #include "polarphp/parser/internal/YYLexerConditionDefs.h"
-#include "polarphp/parser/internal/YYLocation.h"
 #include "polarphp/parser/internal/YYParserDefs.h"
 #include "polarphp/parser/internal/YYLexerDefs.h"
 
@@ -29,7 +28,7 @@ using YYLexerCondType = YYCONDTYPE;
 using polar::basic::StringRef;
 
 namespace internal {
-using YYLocation = location;
+using YYLocation = ParsedTokenRange;
 /// bison -> polar lexer
 int token_lex_wrapper(ParserSemantic *value, YYLocation *loc, Lexer *lexer, Parser *parser);
 /// polar lexer -> yy lexer
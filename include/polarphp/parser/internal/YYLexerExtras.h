@@ -16,6 +16,7 @@
 #include <string>
 
 #include "polarphp/syntax/internal/TokenEnumDefs.h"
+#include "polarphp/basic/adt/ArrayRef.h"
 #include "polarphp/basic/adt/SmallVector.h"
 
 /// forward declare class
@@ -35,6 +36,7 @@ class DiagnosticEngine;
 namespace polar::parser::internal {
 
 using polar::syntax::internal::TokenKindType;
+using polar::basic::ArrayRef;
 using polar::basic::SmallVectorImpl;
 using polar::basic::StringRef;
 using polar::ast::DiagnosticEngine;
@@ -51,29 +53,70 @@ TokenKindType token_kind_map(unsigned char c);
 size_t convert_single_quote_str_escape_sequences(char *iter, char *endMark, Lexer &lexer);
 bool convert_double_quote_str_escape_sequences(std::string &filteredStr, char quoteType, const char *iter,
                                                const char *endMark, Lexer &lexer);
+/// Whether the escape after the backslash before \p iter can raise a
+/// lexical exception, \u{} and octal escapes above \377 can.
+bool is_checked_escape(const char *iter, const char *endMark);
+/// Whether the escapes in [iter, endMark) can be decoded after lexing, i.e.
+/// none of them can raise a lexical exception.
+bool can_decode_escapes_lazily(const char *iter, const char *endMark);
+/// Decode the escapes of a literal body into \p dest, which needs room for
+/// endMark - iter chars. \p quoteType is '\'' for single quoted literals,
+/// '"' or '`' otherwise. Returns the decoded length, decoding never grows
+/// the text so \p dest may be \p iter.
+size_t decode_escape_sequences(const char *iter, const char *endMark, char quoteType, char *dest);
+/// Lexing defers escape decoding by default, the eager path is kept for
+/// differential testing and benchmarks.
+void set_lazy_escape_decoding_enabled(bool enabled);
+bool is_lazy_escape_decoding_enabled();
 void diagnose_embedded_null(DiagnosticEngine *diags, const unsigned char *ptr);
+/// The comment scanners validate the UTF-8 they skip when there is a
+/// \p diags to report to. UTF-8 in front of \p validUtf8End is known to be
+/// valid already and is skipped like ASCII.
 bool advance_to_end_of_line(const unsigned char *&m_yyCursor, const unsigned char *bufferEnd,
                             const unsigned char *codeCompletionPtr = nullptr,
-                            DiagnosticEngine *diags = nullptr);
+                            DiagnosticEngine *diags = nullptr,
+                            const unsigned char *validUtf8End = nullptr);
 bool skip_to_end_of_slash_star_comment(const unsigned char *&m_yyCursor,
                                        const unsigned char *bufferEnd,
                                        const unsigned char *codeCompletionPtr = nullptr,
-                                       DiagnosticEngine *diags = nullptr);
+                                       DiagnosticEngine *diags = nullptr,
+                                       const unsigned char *validUtf8End = nullptr);
 bool is_valid_identifier_continuation_code_point(uint32_t c);
 bool is_valid_identifier_start_code_point(uint32_t c);
+/// Whether the character at \p ptr starts in front of \p validUtf8End, the
+/// end of UTF-8 that was validated already, nullptr if there is none.
+inline bool is_in_valid_utf8(const unsigned char *ptr, const unsigned char *validUtf8End)
+{
+   return validUtf8End != nullptr && ptr < validUtf8End && (*ptr & 0xC0) != 0x80;
+}
+/// Decode the character at \p ptr and advance past it, it has to be known
+/// to be valid UTF-8 and is not checked again.
+uint32_t decode_valid_utf8_character_and_advance(const unsigned char *&ptr);
+/// The predicates decode the characters in front of \p validUtf8End without
+/// validating them.
 bool advance_if(const unsigned char *&ptr, const unsigned char *end,
-                bool (*predicate)(uint32_t));
+                bool (*predicate)(uint32_t), const unsigned char *validUtf8End = nullptr);
 bool advance_if_valid_start_of_identifier(const unsigned char *&ptr,
-                                          const unsigned char *end);
+                                          const unsigned char *end,
+                                          const unsigned char *validUtf8End = nullptr);
 bool advance_if_valid_continuation_of_identifier(const unsigned char *&ptr,
-                                                 const unsigned char *end);
+                                                 const unsigned char *end,
+                                                 const unsigned char *validUtf8End = nullptr);
 bool advance_if_valid_start_of_operator(const unsigned char *&ptr,
                                         const unsigned char *end);
 bool advance_if_valid_continuation_of_operator(const unsigned char *&ptr,
                                                const unsigned char *end);
 const char *next_newline(const char *str, const char *end, size_t &newlineLen);
-bool strip_multiline_string_indentation(Lexer &lexer, std::string &str, int indentation, bool usingSpaces,
-                                        bool newlineAtStart, bool newlineAtEnd);
+/// Copy the heredoc or nowdoc body [cursor, end) to \p dest and remove
+/// \p indentation columns of whitespace from the start of every line on the
+/// way, \p length is set to the copied length. \p lineEnds are the '\n' of
+/// the body, the body scan collects them. With \p decodeEscapes the escapes
+/// are decoded by the same copy, none of them may be checked ones. \p dest
+/// needs room for end - cursor chars and may be \p cursor itself.
+bool strip_multiline_string_indentation(Lexer &lexer, const char *cursor, const char *end,
+                                        ArrayRef<const char *> lineEnds, char *dest, size_t &length,
+                                        int indentation, bool usingSpaces, bool newlineAtStart,
+                                        bool newlineAtEnd, bool decodeEscapes);
 } // polar::parser::internal
 
 #endif // POLARPHP_PARSER_INTERNAL_YY_LEXER_EXTRAS_H
@@ -578,9 +578,16 @@ public:
 private:
    friend class TrailingObjects;
 
-   /// The id that shall be used for the next node that is created and does not
-   /// have a manually specified id
-   static SyntaxNodeId sm_nextFreeNodeId;
+   /// The id for a node that has no manually specified id, unique across
+   /// all threads.
+   static SyntaxNodeId allocateNodeId();
+
+   /// Make sure no node gets \p nodeId from allocateNodeId() any more.
+   static void reserveNodeId(SyntaxNodeId nodeId);
+
+   /// The start of the next block of ids a thread reserves for the nodes
+   /// that do not have a manually specified id
+   static std::atomic<SyntaxNodeId> sm_nextFreeNodeId;
 
    /// An id of this node that is stable across incremental parses
    SyntaxNodeId m_nodeId;
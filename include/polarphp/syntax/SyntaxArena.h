@@ -54,6 +54,12 @@ public:
       return m_allocator.allocate(size, alignment);
    }
 
+   /// Free all nodes but keep the first slab, no node may be alive.
+   void reset()
+   {
+      m_allocator.reset();
+   }
+
 private:
    SyntaxArena(const SyntaxArena &) = delete;
    void operator=(const SyntaxArena &) = delete;
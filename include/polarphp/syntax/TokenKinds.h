@@ -14,7 +14,8 @@
 
 #include "polarphp/basic/adt/StringRef.h"
 #include "polarphp/syntax/internal/TokenEnumDefs.h"
-#include <map>
+
+#include <cstddef>
 
 namespace polar::utils {
 class RawOutStream;
@@ -36,8 +37,17 @@ enum class TokenCategory
 using internal::TokenKindType;
 using polar::basic::StringRef;
 using polar::utils::RawOutStream;
-using TokenDescItemType = const std::tuple<const std::string, const std::string, TokenCategory>;
-using TokenDescMap = const std::map<TokenKindType, TokenDescItemType>;
+using polar::basic::StringLiteral;
+
+/// One record of the token description table generated from the grammar
+/// file, see TokenDescMap.cpp.in.
+struct TokenDescItem
+{
+   TokenKindType kind;
+   StringLiteral name;
+   StringLiteral desc;
+   TokenCategory category;
+};
 
 /// Check whether a token kind is known to have any specific text content.
 /// e.g., tol::l_paren has determined text however tok::identifier doesn't.
@@ -45,9 +55,13 @@ bool is_token_text_determined(TokenKindType kind);
 /// If a token kind has determined text, return the text; otherwise assert.
 StringRef get_token_text(TokenKindType kind);
 void dump_token_kind(RawOutStream &outStream, TokenKindType kind);
-TokenDescItemType retrieve_token_desc_entry(TokenKindType kind);
-TokenDescMap::const_iterator find_token_desc_entry(TokenKindType kind);
-TokenDescMap::const_iterator token_desc_map_end();
+/// Return the description of \p kind, or the one of T_UNKNOWN_MARK if the
+/// kind has none.
+const TokenDescItem &retrieve_token_desc_entry(TokenKindType kind);
+/// Return the description of \p kind, nullptr if the kind has none.
+const TokenDescItem *find_token_desc_entry(TokenKindType kind);
+/// Return one past the largest token kind of the grammar.
+std::size_t get_token_kind_count();
 bool is_internal_token(TokenKindType kind);
 bool is_keyword_token(TokenKindType kind);
 bool is_decl_keyword_token(TokenKindType kind);
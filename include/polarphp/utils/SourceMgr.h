@@ -73,19 +73,37 @@ private:
       std::vector<uint64_t> *>;
 
       /// Vector of offsets into Buffer at which there are line-endings
-      /// (lazily populated). Once populated, the '\n' that marks the end of
-      /// line number N from [1..] is at Buffer[OffsetCache[N-1]]. Since
+      /// (lazily populated, or handed over by the lexer). Once populated,
+      /// the '\n' that marks the end of line number N from [1..] is at
+      /// Buffer[OffsetCache[N-1]]. Since
       /// these offsets are in sorted (ascending) order, they can be
       /// binary-searched for the first one after any given offset (eg. an
       /// offset corresponding to a particular SMLoc).
       mutable VariableSizeOffsets m_offsetCache;
 
+      /// Populate \c OffsetCache if it is not yet and return it.
+      template<typename T>
+      const std::vector<T> &getOffsets() const;
+
       /// Populate \c OffsetCache and look up a given \p Ptr in it, assuming
       /// it points somewhere into \c Buffer. The static type parameter \p T
       /// must be an unsigned integer type from uint{8,16,32,64}_t large
       /// enough to store offsets inside \c Buffer.
       template<typename T>
       unsigned getLineNumber(const char *ptr) const;
+
+      /// Return a pointer to the first character of line \p lineNo, nullptr
+      /// if the buffer has fewer lines.
+      template<typename T>
+      const char *getPointerForLineNumber(unsigned lineNo) const;
+
+      /// Install \p offsets as \c OffsetCache unless it is populated
+      /// already.
+      void setOffsets(std::vector<uint32_t> &&offsets) const;
+
+      /// Drop \c OffsetCache, it is computed again on the next lookup.
+      void clearOffsets() const;
+
       /// This is the location of the parent include, or null if at the top level.
       SMLocation m_includeLoc;
       SrcBuffer() = default;
@@ -205,6 +223,33 @@ public:
    std::pair<unsigned, unsigned> getLineAndColumn(SMLocation location,
                                                   unsigned bufferID = 0) const;
 
+   /// Return a pointer to the first character of line \p lineNo of the
+   /// specified file, nullptr if the file has fewer lines.
+   const char *getPointerForLineNumber(unsigned lineNo, unsigned bufferID) const;
+
+   /// Hand over the offsets of all the '\n' characters of a buffer, in
+   /// ascending order, for a client that found them anyway, the lexer does.
+   /// Line lookups then don't need to scan the buffer. Ignored if the
+   /// offsets are known already.
+   void setLineOffsets(unsigned bufferID, std::vector<uint32_t> &&offsets) const
+   {
+      getBufferInfo(bufferID).setOffsets(std::move(offsets));
+   }
+
+   /// Whether the line offsets of a buffer are known, either from a line
+   /// lookup or from setLineOffsets().
+   bool hasLineOffsets(unsigned bufferID) const
+   {
+      return !getBufferInfo(bufferID).m_offsetCache.isNull();
+   }
+
+   /// Forget the line offsets of a buffer whose contents were changed in
+   /// place.
+   void clearLineOffsets(unsigned bufferID) const
+   {
+      getBufferInfo(bufferID).clearOffsets();
+   }
+
    /// Emit a message about the specified location with the specified string.
    ///
    /// \param ShowColors Display colored messages if output is a terminal and
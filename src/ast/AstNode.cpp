@@ -0,0 +1,76 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "polarphp/ast/AstNode.h"
+#include "polarphp/ast/AstArena.h"
+#include "polarphp/utils/ErrorHandling.h"
+
+#include <memory>
+
+namespace polar::ast {
+
+StringRef get_ast_node_kind_name(AstNodeKind kind)
+{
+   switch (kind) {
+#define AST_NODE(Id, SyntaxKind) \
+   case AstNodeKind::Id: \
+      return #Id;
+#include "polarphp/ast/AstNodeKindDefs.h"
+   }
+   polar_unreachable("unknown ast node kind");
+}
+
+AstNode::AstNode(AstNodeKind kind, std::uint16_t tokenKind, SourceLoc start, std::uint32_t length,
+                 ArrayRef<AstNode *> children)
+   : m_kind(kind),
+     m_tokenKind(tokenKind),
+     m_numChildren(static_cast<std::uint32_t>(children.size())),
+     m_length(length),
+     m_start(start)
+{
+   std::uninitialized_copy(children.begin(), children.end(), getTrailingObjects<AstNode *>());
+}
+
+AstNode *AstNode::make(AstArena &arena, AstNodeKind kind, ArrayRef<AstNode *> children)
+{
+   // the children are in source order, empty lists have no range
+   SourceLoc start;
+   const char *end = nullptr;
+   for (AstNode *child : children) {
+      if (child && child->m_start.isValid()) {
+         if (start.isInvalid()) {
+            start = child->m_start;
+         }
+         end = static_cast<const char *>(child->m_start.getOpaquePointerValue()) + child->m_length;
+      }
+   }
+   std::uint32_t length = start.isValid()
+         ? static_cast<std::uint32_t>(end - static_cast<const char *>(start.getOpaquePointerValue()))
+         : 0;
+   void *memory = arena.allocate(totalSizeToAlloc<AstNode *>(children.size()), alignof(AstNode));
+   return ::new (memory) AstNode(kind, 0, start, length, children);
+}
+
+AstNode *AstNode::makeToken(AstArena &arena, TokenKindType tokenKind, CharSourceRange range)
+{
+   void *memory = arena.allocate(totalSizeToAlloc<AstNode *>(0), alignof(AstNode));
+   return ::new (memory) AstNode(AstNodeKind::Token, static_cast<std::uint16_t>(tokenKind),
+                                 range.getStart(), range.getByteLength(), {});
+}
+
+AstNode *AstNode::makeSkipped(AstArena &arena, AstNodeKind kind, CharSourceRange range)
+{
+   AstNode *parsed = nullptr;
+   void *memory = arena.allocate(totalSizeToAlloc<AstNode *>(1), alignof(AstNode));
+   return ::new (memory) AstNode(kind, 0, range.getStart(), range.getByteLength(), parsed);
+}
+
+} // polar::ast
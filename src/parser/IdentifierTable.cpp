@@ -0,0 +1,92 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "polarphp/parser/IdentifierTable.h"
+#include "polarphp/basic/adt/SmallString.h"
+
+#include <limits>
+
+namespace polar::parser {
+
+using polar::basic::SmallString;
+
+namespace {
+
+/// Most names are already lower case, they are looked up without a copy.
+bool has_ascii_upper(StringRef name)
+{
+   for (char c : name) {
+      if (c >= 'A' && c <= 'Z') {
+         return true;
+      }
+   }
+   return false;
+}
+
+/// Only ASCII letters are folded, like zend_str_tolower(), bytes of multi
+/// byte characters stay as they are.
+StringRef fold_ascii_case(StringRef name, SmallString<64> &storage)
+{
+   if (!has_ascii_upper(name)) {
+      return name;
+   }
+   storage.resize(name.size());
+   for (size_t i = 0; i < name.size(); ++i) {
+      char c = name[i];
+      storage[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+   }
+   return storage.getStr();
+}
+
+} // anonymous namespace
+
+SymbolId IdentifierTable::intern(StringMap<SymbolId, BumpPtrAllocator> &map, StringRef key,
+                                 bool isVariable)
+{
+   auto result = map.tryEmplace(key, InvalidSymbolId);
+   if (!result.second) {
+      return result.first->getValue();
+   }
+   assert(m_symbols.size() < std::numeric_limits<SymbolId>::max() && "too many symbols");
+   SymbolId id = static_cast<SymbolId>(m_symbols.size() + 1);
+   result.first->getValue() = id;
+   m_symbols.push_back({result.first->getKey(), id, isVariable});
+   return id;
+}
+
+SymbolId IdentifierTable::internName(StringRef name)
+{
+   SymbolId id = intern(m_names, name, false);
+   // a new name with upper case letters still folds to itself
+   if (m_symbols[id - 1].folded == id && has_ascii_upper(name)) {
+      SmallString<64> storage;
+      SymbolId folded = internName(fold_ascii_case(name, storage));
+      m_symbols[id - 1].folded = folded;
+   }
+   return id;
+}
+
+SymbolId IdentifierTable::internVariable(StringRef name)
+{
+   return intern(m_variables, name, true);
+}
+
+SymbolId IdentifierTable::lookupName(StringRef name) const
+{
+   return m_names.lookup(name);
+}
+
+SymbolId IdentifierTable::lookupVariable(StringRef name) const
+{
+   return m_variables.lookup(name);
+}
+
+} // polar::parser
@@ -11,9 +11,12 @@
 
 #include "polarphp/parser/Lexer.h"
 #include "polarphp/parser/Parser.h"
+#include "polarphp/parser/StreamingSource.h"
 #include "polarphp/parser/CommonDefs.h"
 #include "polarphp/parser/internal/YYLexerDefs.h"
 #include "polarphp/parser/internal/YYLexerExtras.h"
+#include "polarphp/parser/internal/NumericLiterals.h"
+#include "polarphp/parser/internal/ScanKernels.h"
 #include "polarphp/parser/Confusables.h"
 #include "polarphp/basic/adt/SmallString.h"
 #include "polarphp/basic/CharInfo.h"
@@ -25,6 +28,8 @@
 #include <set>
 #include <string>
 #include <cstdint>
+#include <cstring>
+#include <limits>
 #include <iostream>
 
 namespace polar::parser {
@@ -37,7 +42,10 @@ using namespace polar::basic;
 
 #define HEREDOC_USING_SPACES 1
 #define HEREDOC_USING_TABS 2
-#define MAX_LENGTH_OF_INT64 19
+
+/// The magnitude of INT64_MIN, the integer literal that is only valid with
+/// a minus sign in front of it.
+static constexpr std::uint64_t sg_int64MinMagnitude = std::uint64_t(1) << 63;
 
 Lexer::Lexer(const PrincipalTag &, const LangOptions &langOpts,
              const SourceManager &sourceMgr, unsigned bufferId,
@@ -47,6 +55,7 @@ Lexer::Lexer(const PrincipalTag &, const LangOptions &langOpts,
      m_sourceMgr(sourceMgr),
      m_bufferId(bufferId),
      m_diags(diags),
+     m_valueArena(new TokenValueArena),
      m_commentRetention(commentRetention),
      m_triviaRetention(triviaRetention)
 {}
@@ -70,6 +79,15 @@ Lexer::Lexer(const LangOptions &options, const SourceManager &sourceMgr,
    initialize(offset, endOffset);
 }
 
+Lexer::Lexer(const LangOptions &options, const StreamingSource &source, DiagnosticEngine *diags,
+             CommentRetentionMode commentRetain, TriviaRetentionMode triviaRetention)
+   : Lexer(PrincipalTag(), options, source.getSourceManager(), source.getBufferId(), diags,
+           commentRetain, triviaRetention)
+{
+   m_rangeEndsBuffer = true;
+   initialize(source.getLineOffset(), source.getLineEndOffset());
+}
+
 Lexer::Lexer(Lexer &parent, LexerState beginState, LexerState endState)
    : Lexer(PrincipalTag(), parent.m_langOpts, parent.m_sourceMgr,
            parent.m_bufferId, parent.m_diags, parent.m_commentRetention,
@@ -80,6 +98,14 @@ Lexer::Lexer(Lexer &parent, LexerState beginState, LexerState endState)
    assert(m_bufferId == m_sourceMgr.findBufferContainingLoc(endState.m_loc) &&
           "LexerState for the wrong buffer");
 
+   // tokens of the sub lexer keep their string values in the parent arena
+   m_valueArena = parent.m_valueArena;
+   m_identifierTable = parent.m_identifierTable;
+   // the parent has usually validated our range already
+   m_utf8ScanStart = parent.m_utf8ScanStart;
+   m_utf8ScanEnd = parent.m_utf8ScanEnd;
+   m_validUtf8End = parent.m_validUtf8End;
+   m_rangeEndsBuffer = parent.m_rangeEndsBuffer;
    unsigned offset = m_sourceMgr.getLocOffsetInBuffer(beginState.m_loc, m_bufferId);
    unsigned endOffset = m_sourceMgr.getLocOffsetInBuffer(endState.m_loc, m_bufferId);
    initialize(offset, endOffset);
@@ -110,21 +136,137 @@ void Lexer::initialize(unsigned offset, unsigned endOffset)
    }
    m_artificialEof = m_bufferStart + endOffset;
    m_yyCursor = m_bufferStart + offset;
-
+   if (canRecordLineOffsets()) {
+      m_lineOffsetsEnd = m_bufferStart;
+   }
+   if (m_rangeEndsBuffer) {
+      assert(*m_artificialEof == 0 && "the line is not NUL terminated");
+      m_bufferEnd = m_artificialEof;
+   }
    assert(m_nextToken.is(TokenKindType::T_UNKNOWN_MARK));
 }
 
-void Lexer::lex(Token &result, ParsedTrivia &leadingTriviaResult, ParsedTrivia &trailingTrivialResult)
+void Lexer::reset(unsigned bufferId)
+{
+   assert(m_yyStateStack.empty() && "reset while a state is saved");
+   m_bufferId = bufferId;
+   m_rangeEndsBuffer = false;
+   m_flags = LexerFlags();
+   m_codeCompletionPtr = nullptr;
+   m_utf8ScanStart = nullptr;
+   m_utf8ScanEnd = nullptr;
+   m_validUtf8End = nullptr;
+   m_lineOffsets.clear();
+   m_lineOffsetsEnd = nullptr;
+   m_yyText = nullptr;
+   m_yyMarker = nullptr;
+   m_valueContainer = nullptr;
+   m_yyCondition = COND_NAME(ST_IN_SCRIPTING);
+   m_heredocIndentation = 0;
+   m_yyLength = 0;
+   m_nextToken = Token();
+   m_leadingTrivia.clear();
+   m_trailingTrivia.clear();
+   m_currentExceptionMsg.clear();
+   m_yyConditionStack.clear();
+   m_heredocLabelStack.clear();
+   // every token with a value in the arena holds a reference, ours is the
+   // only one once the caller dropped them
+   if (m_valueArena->hasOneRef()) {
+      m_valueArena->reset();
+   } else {
+      m_valueArena = new TokenValueArena;
+   }
+   unsigned endOffset = m_sourceMgr.getRangeForBuffer(bufferId).getByteLength();
+   initialize(/*offset=*/0, endOffset);
+}
+
+Lexer &Lexer::setRecordLineOffsets(bool value)
+{
+   m_recordLineOffsets = value;
+   m_lineOffsets.clear();
+   m_lineOffsetsEnd = canRecordLineOffsets() ? m_bufferStart : nullptr;
+   return *this;
+}
+
+bool Lexer::canRecordLineOffsets() const
+{
+   // nothing lexed yet and the lexer ends where the buffer does
+   return m_recordLineOffsets && m_yyCursor == m_bufferStart && m_artificialEof == m_bufferEnd &&
+         !m_sourceMgr.hasLineOffsets(m_bufferId) &&
+         static_cast<size_t>(m_bufferEnd - m_bufferStart) <= std::numeric_limits<uint32_t>::max();
+}
+
+void Lexer::recordLineOffsets(const unsigned char *end)
+{
+   // tokens are formed in source order, anything before m_lineOffsetsEnd was
+   // recorded already, also when the lexer backtracks
+   if (end <= m_lineOffsetsEnd) {
+      return;
+   }
+   const unsigned char *cur = m_lineOffsetsEnd;
+   while (const void *newline = std::memchr(cur, '\n', end - cur)) {
+      cur = static_cast<const unsigned char *>(newline);
+      m_lineOffsets.push_back(static_cast<uint32_t>(cur - m_bufferStart));
+      ++cur;
+   }
+   m_lineOffsetsEnd = end;
+   if (end == m_bufferEnd) {
+      m_sourceMgr.setLineOffsets(m_bufferId, std::move(m_lineOffsets));
+      m_lineOffsets.clear();
+      m_lineOffsetsEnd = nullptr;
+   }
+}
+
+const unsigned char *Lexer::getValidUtf8End(const unsigned char *from)
+{
+   // the scan stops at the first invalid sequence, once \p from is past it
+   // the rest is scanned from there
+   if (m_utf8ScanStart == nullptr || from < m_utf8ScanStart || from > m_validUtf8End ||
+       m_artificialEof > m_utf8ScanEnd) {
+      scanValidUtf8(from, m_artificialEof);
+   }
+   return m_validUtf8End;
+}
+
+void Lexer::scanValidUtf8(const unsigned char *begin, const unsigned char *end)
+{
+   m_utf8ScanStart = begin;
+   m_utf8ScanEnd = end;
+   m_validUtf8End = end;
+   const unsigned char *cur = find_non_ascii(begin, end);
+   while (cur < end) {
+      // step through the characters like the comment scanners do, so the
+      // invalid sequence is found where they would diagnose it
+      const unsigned char *charStart = cur;
+      if (validate_utf8_character_and_advance(cur, m_bufferEnd) == ~0U) {
+         m_validUtf8End = charStart;
+         return;
+      }
+      cur = find_non_ascii(cur, end);
+   }
+}
+
+const Token &Lexer::lexInPlace()
 {
    lexImpl();
    assert((m_nextToken.isAtStartOfLine() || m_yyCursor != m_bufferStart) &&
           "The token should be at the beginning of the line, "
           "or we should be lexing from the middle of the buffer");
-   result = m_nextToken;
+   return m_nextToken;
+}
+
+const Token &Lexer::lexInPlace(ParsedTrivia &leadingTriviaResult, ParsedTrivia &trailingTrivialResult)
+{
+   lexInPlace();
    if (m_triviaRetention == TriviaRetentionMode::WithTrivia) {
-      leadingTriviaResult = {m_leadingTrivia};
-      trailingTrivialResult = {m_trailingTrivia};
+      // lexImpl() clears both before it lexes, the pieces left over from
+      // the caller's last token are dropped there and their heap storage,
+      // if any, is used again
+      leadingTriviaResult.pieces.swap(m_leadingTrivia.pieces);
+      trailingTrivialResult.pieces.swap(m_trailingTrivia.pieces);
    }
+   return m_nextToken;
 }
 
 InFlightDiagnostic Lexer::diagnose(const unsigned char *loc, ast::Diagnostic diag)
@@ -179,31 +321,46 @@ void Lexer::formToken(syntax::TokenKindType kind, const unsigned char *tokenStar
       lexTrivia(m_trailingTrivia, /* IsForTrailingTrivia */ true);
    }
    m_nextToken.setToken(kind, tokenText, commentLength);
+   if (m_lineOffsetsEnd != nullptr) {
+      recordLineOffsets(kind == TokenKindType::END ? m_bufferEnd : m_yyCursor);
+   }
 }
 
 void Lexer::formVariableToken(const unsigned char *tokenStart)
 {
    formToken(TokenKindType::T_VARIABLE, tokenStart);
-   m_nextToken.setValue(StringRef(reinterpret_cast<const char *>(tokenStart + 1), m_yyLength - 1));
+   StringRef name(reinterpret_cast<const char *>(tokenStart + 1), m_yyLength - 1);
+   m_nextToken.setValue(name);
+   if (m_identifierTable) {
+      m_nextToken.setSymbolId(m_identifierTable->internVariable(name));
+   }
 }
 
 void Lexer::formIdentifierToken(const unsigned char *tokenStart)
 {
    formToken(TokenKindType::T_IDENTIFIER_STRING, tokenStart);
-   m_nextToken.setValue(StringRef(reinterpret_cast<const char *>(tokenStart), m_yyLength));
+   StringRef name(reinterpret_cast<const char *>(tokenStart), m_yyLength);
+   m_nextToken.setValue(name);
+   if (m_identifierTable) {
+      m_nextToken.setSymbolId(m_identifierTable->internName(name));
+   }
 }
 
 void Lexer::formStringVariableToken(const unsigned char *tokenStart)
 {
    formToken(TokenKindType::T_STRING_VARNAME, tokenStart);
-   m_nextToken.setValue(StringRef(reinterpret_cast<const char *>(tokenStart), m_yyLength));
+   StringRef name(reinterpret_cast<const char *>(tokenStart), m_yyLength);
+   m_nextToken.setValue(name);
+   if (m_identifierTable) {
+      m_nextToken.setSymbolId(m_identifierTable->internVariable(name));
+   }
 }
 
 void Lexer::formErrorToken(const unsigned char *tokenStart)
 {
    formToken(TokenKindType::T_ERROR, tokenStart);
    if (!m_currentExceptionMsg.empty()) {
-      m_nextToken.setValue(m_currentExceptionMsg);
+      m_nextToken.setValue(m_valueArena->copyString(m_currentExceptionMsg), m_valueArena.get());
    }
 }
 
@@ -217,7 +374,7 @@ restart:
          break;
       }
       m_nextToken.setAtStartOfLine(true);
-      trivia.appendOrSquash(TriviaKind::Newline, 1);
+      lexTriviaRun(trivia, TriviaKind::Newline, '\n');
       goto restart;
    case '\r':
       if (isForTrailingTrivia) {
@@ -232,10 +389,10 @@ restart:
       }
       goto restart;
    case ' ':
-      trivia.appendOrSquash(TriviaKind::Space, 1);
+      lexTriviaRun(trivia, TriviaKind::Space, ' ');
       goto restart;
    case '\t':
-      trivia.appendOrSquash(TriviaKind::Tab, 1);
+      lexTriviaRun(trivia, TriviaKind::Tab, '\t');
       goto restart;
    case '\v':
       trivia.appendOrSquash(TriviaKind::VerticalTab, 1);
@@ -313,7 +470,8 @@ restart:
       break;
    default:
       const unsigned char *temp = m_yyCursor - 1;
-      if (advance_if_valid_start_of_identifier(temp, m_bufferEnd)) {
+      const unsigned char *validUtf8End = *temp >= 0x80 ? getValidUtf8End(temp) : nullptr;
+      if (advance_if_valid_start_of_identifier(temp, m_bufferEnd, validUtf8End)) {
          break;
       }
       if (advance_if_valid_start_of_operator(temp, m_bufferEnd)) {
@@ -332,21 +490,31 @@ restart:
    --m_yyCursor;
 }
 
+void Lexer::lexTriviaRun(ParsedTrivia &trivia, TriviaKind kind, unsigned char ch)
+{
+   // the first byte of the run has already been consumed by lexTrivia
+   const unsigned char *runEnd = skip_byte_run(m_yyCursor, m_bufferEnd, ch);
+   trivia.appendOrSquash(kind, 1 + static_cast<unsigned>(runEnd - m_yyCursor));
+   m_yyCursor = runEnd;
+}
+
 bool Lexer::lexUnknown(bool emitDiagnosticsIfToken)
 {
    const unsigned char *temp = m_yyCursor - 1;
-   if (advance_if_valid_continuation_of_identifier(temp, m_bufferEnd)) {
+   const unsigned char *validUtf8End = *temp >= 0x80 ? getValidUtf8End(temp) : nullptr;
+   if (advance_if_valid_continuation_of_identifier(temp, m_bufferEnd, validUtf8End)) {
       // If this is a valid identifier continuation, but not a valid identifier
       // start, attempt to recover by eating more continuation characters.
       if (emitDiagnosticsIfToken) {
          //         diagnose(m_yyCursor - 1, diag::lex_invalid_identifier_start_character);
       }
-      while (advance_if_valid_continuation_of_identifier(temp, m_bufferEnd));
+      while (advance_if_valid_continuation_of_identifier(temp, m_bufferEnd, validUtf8End));
       m_yyCursor = temp;
       return true;
    }
    // This character isn't allowed in polarphp source.
-   uint32_t codepoint = validate_utf8_character_and_advance(temp, m_bufferEnd);
+   uint32_t codepoint = is_in_valid_utf8(temp, validUtf8End) ? decode_valid_utf8_character_and_advance(temp)
+                                                              : validate_utf8_character_and_advance(temp, m_bufferEnd);
    if (codepoint == ~0U) {
       //      diagnose(m_yyCursor - 1, diag::lex_invalid_utf8)
       //            .fixItReplaceChars(getSourceLoc(m_yyCursor - 1), getSourceLoc(temp), " ");
@@ -415,7 +583,7 @@ bool Lexer::nextLineHasHeredocEndMarker()
    const unsigned char *savedCursor = m_yyCursor;
    const unsigned char *&cursor = m_yyCursor;
    const unsigned char *yylimit = m_artificialEof;
-   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.top();
+   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.back();
    /// trim
    while (cursor < yylimit) {
       switch (*cursor++) {
@@ -446,6 +614,19 @@ void Lexer::notifyLexicalException(StringRef msg, int code)
    }
 }
 
+bool Lexer::isAtSafeRestartPoint() const
+{
+   return m_yyCondition == COND_NAME(ST_IN_SCRIPTING) &&
+         m_yyConditionStack.empty() &&
+         m_heredocLabelStack.empty() &&
+         m_yyStateStack.empty() &&
+         !m_flags.isLexingBinaryString() &&
+         !m_flags.isHeredocScanAhead() &&
+         !m_flags.isIncrementLineNumber() &&
+         !m_flags.isReserveHeredocSpaces() &&
+         !m_flags.isLexExceptionOccurred();
+}
+
 LexerState Lexer::getStateForBeginningOfTokenLoc(SourceLoc sourceLoc) const
 {
    const unsigned char *ptr = getBufferPtrForSourceLoc(sourceLoc);
@@ -477,7 +658,9 @@ LexerState Lexer::getStateForBeginningOfTokenLoc(SourceLoc sourceLoc) const
 
 void Lexer::skipToEndOfLine(bool eatNewline)
 {
-   bool isEOL = advance_to_end_of_line(m_yyCursor, m_bufferEnd, m_codeCompletionPtr, m_diags);
+   // only UTF-8 that is diagnosed has to be validated
+   bool isEOL = advance_to_end_of_line(m_yyCursor, m_bufferEnd, m_codeCompletionPtr, m_diags,
+                                       m_diags ? getValidUtf8End() : nullptr);
    if (eatNewline && isEOL) {
       ++m_yyCursor;
       m_nextToken.setAtStartOfLine(true);
@@ -495,7 +678,8 @@ void Lexer::skipSlashSlashComment(bool eatNewline)
 void Lexer::skipSlashStarComment()
 {
    bool isMultiline =
-         skip_to_end_of_slash_star_comment(m_yyCursor, m_bufferEnd, m_codeCompletionPtr, m_diags);
+         skip_to_end_of_slash_star_comment(m_yyCursor, m_bufferEnd, m_codeCompletionPtr, m_diags,
+                                           m_diags ? getValidUtf8End() : nullptr);
    if (isMultiline) {
       m_nextToken.setAtStartOfLine(true);
    }
@@ -510,31 +694,18 @@ void Lexer::skipHashbang(bool eatNewline)
 
 void Lexer::lexBinaryNumber()
 {
-   /// The +/- 2 skips "0b"
-   char *yytext = reinterpret_cast<char *>(const_cast<unsigned char *>(m_yyText));
-   char *bnumStr = yytext + 2;
-   char *bnumStrEnd = nullptr;
-   size_t numLength = m_yyLength - 2;
-   /// Skip any leading 0s
-   while (*bnumStr == '0') {
-      ++bnumStr;
-      --numLength;
-   }
-   if (numLength < sizeof(std::int64_t) * CHAR_BIT) {
-      std::int64_t numValue = 0;
-      if (numLength > 0) {
-         errno = 0;
-         numValue = std::strtoll(bnumStr, &bnumStrEnd, 2);
-         assert(!errno && bnumStrEnd == yytext + m_yyLength);
-      }
+   /// The + 2 skips "0b"
+   std::uint64_t value = 0;
+   bool overflow = false;
+   parse_radix_digits(m_yyText + 2, m_yyText + m_yyLength, 1, value, overflow);
+   if (!overflow && value <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
       formToken(TokenKindType::T_LNUMBER, m_yyText);
-      m_nextToken.setValue(numValue);
+      m_nextToken.setValue(static_cast<std::int64_t>(value));
    } else {
-      double numValue = 0;
-      const char *tempPtr = reinterpret_cast<const char *>(bnumStrEnd);
-      numValue = polar::utils::bstr_to_double(bnumStr, &tempPtr);
+      const char *tempPtr = nullptr;
+      double numValue = polar::utils::bstr_to_double(reinterpret_cast<const char *>(m_yyText), &tempPtr);
       /// errno isn't checked since we allow HUGE_VAL/INF overflow
-      assert(tempPtr == yytext + m_yyLength);
+      assert(tempPtr == reinterpret_cast<const char *>(m_yyText + m_yyLength));
       formToken(TokenKindType::T_DNUMBER, m_yyText);
       m_nextToken.setValue(numValue);
    }
@@ -542,39 +713,21 @@ void Lexer::lexBinaryNumber()
 
 void Lexer::lexHexNumber()
 {
-   /// Skip "0x"
-   char *yytext = reinterpret_cast<char *>(const_cast<unsigned char *>(m_yyText));
-   char *hexStr = yytext + 2;
-   int length = m_yyLength - 2;
-   std::int64_t lvalue = 0;
-   while (*hexStr == '0') {
-      ++hexStr;
-      --length;
-   }
-   constexpr int maxWidth = sizeof(std::int64_t) * 2;
-   if (length < maxWidth || (length == maxWidth && *hexStr <= '7')) {
-      char *end = nullptr;
-      if (length > 0) {
-         errno = 0;
-         lvalue = std::strtoll(yytext, &end, 16);
-         assert(!errno && end == hexStr + length);
-      }
+   /// The + 2 skips "0x"
+   std::uint64_t value = 0;
+   bool overflow = false;
+   parse_radix_digits(m_yyText + 2, m_yyText + m_yyLength, 4, value, overflow);
+   if (!overflow && value <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
       formToken(TokenKindType::T_LNUMBER, m_yyText);
-      m_nextToken.setValue(lvalue);
+      m_nextToken.setValue(static_cast<std::int64_t>(value));
    } else {
-      /// overflow
-      bool needCorrectOverflow = false;
-      if (m_nextToken.getKind() == TokenKindType::T_MINUS_SIGN) {
-         char buff[maxWidth];
-         std::sprintf(buff, "%llx\n ", std::numeric_limits<std::int64_t>::min());
-         if (StringRef(buff, maxWidth) == StringRef(hexStr, length)) {
-            needCorrectOverflow = true;
-         }
-      }
+      /// overflow, -0x8000000000000000 is still an integer
+      bool needCorrectOverflow = !overflow && value == sg_int64MinMagnitude &&
+            m_nextToken.getKind() == TokenKindType::T_MINUS_SIGN;
       const char *tempPtr = nullptr;
-      double dvalue = polar::utils::hexstr_to_double(yytext, &tempPtr);
+      double dvalue = polar::utils::hexstr_to_double(reinterpret_cast<const char *>(m_yyText), &tempPtr);
       /// errno isn't checked since we allow HUGE_VAL/INF overflow
-      assert(tempPtr == hexStr + length);
+      assert(tempPtr == reinterpret_cast<const char *>(m_yyText + m_yyLength));
       formToken(TokenKindType::T_DNUMBER, m_yyText);
       m_nextToken.setNeedCorrectLNumberOverflow(needCorrectOverflow);
       m_nextToken.setValue(dvalue);
@@ -583,104 +736,78 @@ void Lexer::lexHexNumber()
 
 void Lexer::lexLongNumber()
 {
-   char *end = nullptr;
-   char *yytext = reinterpret_cast<char *>(const_cast<unsigned char *>(m_yyText));
-   std::int64_t lvalue = 0;
-   if (m_yyLength < MAX_LENGTH_OF_INT64) {
-      /// Won't overflow
-      errno = 0;
-      /// base must be passed explicitly for correct parse error on Windows
-      lvalue = std::strtoll(yytext, &end, yytext[0] == '0' ? 8 : 10);
-      /// This isn't an assert, we need to ensure 019 isn't valid octal
-      /// Because the lexing itself doesn't do that for us
-      if (end != yytext + m_yyLength) {
-         notifyLexicalException("Invalid numeric literal", 0);
-         if (isInParseMode()) {
-            formToken(TokenKindType::T_ERROR, m_yyText);
+   const unsigned char *end = m_yyText + m_yyLength;
+   if (m_yyText[0] == '0' && m_yyLength > 1) {
+      std::uint64_t value = 0;
+      bool overflow = false;
+      /// This isn't done by the lexing itself, we need to ensure 019 isn't
+      /// valid octal
+      bool valid = parse_radix_digits(m_yyText + 1, end, 3, value, overflow);
+      /// the digits in front of an invalid one decide whether it overflows
+      if (!overflow && value <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+         if (!valid) {
+            lexInvalidNumber();
             return;
          }
-         /// here we does not set semantic value
          formToken(TokenKindType::T_LNUMBER, m_yyText);
-         m_nextToken.setInvalidLexValue(true);
-         return;
-      }
-   } else {
-      errno = 0;
-      const char *numStr = yytext;
-      int numLength = m_yyLength;
-      int base = 10;
-      if (numStr[0] == '0') {
-         base = 8;
-         int numWide = m_yyLength;
-         while (numWide-- > 0 && *(numStr + 1) == '0') {
-            ++numStr;
-            --numLength;
-         }
-      }
-      lvalue = std::strtoll(numStr, &end, base);
-      /// overflow is undefined behavior
-      /// we just handle -9223372036854775808
-      if (errno == ERANGE) {
-         bool needCorrectOverflow = false;
-         if (m_nextToken.getKind() == TokenKindType::T_MINUS_SIGN) {
-            std::string minStr;
-            if (numStr[0] == '0') {
-               char buff[24];
-               std::sprintf(buff, "-0%llo", std::numeric_limits<std::int64_t>::min());
-               minStr.append(buff, 24);
-            } else {
-               minStr = std::to_string(std::numeric_limits<std::int64_t>::min());
-            }
-            if (StringRef(minStr.data() + 1, minStr.size() - 1) == StringRef(reinterpret_cast<const char *>(numStr), numLength)) {
-               needCorrectOverflow = true;
-            }
-         }
-         double dvalue = 0.0;
-         if (yytext[0] == '0') {
-            /// octal overflow
-            const char *tempPtr = reinterpret_cast<const char *>(end);
-            dvalue = polar::utils::octstr_to_double(numStr, &tempPtr);
-         } else {
-            dvalue = std::strtod(numStr, &end);
-         }
-         /// handle double literal format error
-         /// Also not an assert for the same reason
-         if (end != yytext + m_yyLength) {
-            notifyLexicalException("Invalid numeric literal", 0);
-            if (isInParseMode()) {
-               formToken(TokenKindType::T_ERROR, m_yyText);
-               return;
-            }
-         }
-         formToken(TokenKindType::T_DNUMBER, m_yyText);
-         m_nextToken.setValue(dvalue);
-         m_nextToken.setNeedCorrectLNumberOverflow(needCorrectOverflow);
+         m_nextToken.setValue(static_cast<std::int64_t>(value));
          return;
       }
-      /// handle integer literal format error
-      if (end != yytext + m_yyLength) {
+      bool needCorrectOverflow = valid && !overflow && value == sg_int64MinMagnitude &&
+            m_nextToken.getKind() == TokenKindType::T_MINUS_SIGN;
+      double dvalue = polar::utils::octstr_to_double(reinterpret_cast<const char *>(m_yyText), nullptr);
+      /// handle double literal format error
+      if (!valid) {
          notifyLexicalException("Invalid numeric literal", 0);
          if (isInParseMode()) {
             formToken(TokenKindType::T_ERROR, m_yyText);
             return;
          }
-         formToken(TokenKindType::T_LNUMBER, m_yyText);
-         m_nextToken.setInvalidLexValue(true);
-         return;
       }
+      formToken(TokenKindType::T_DNUMBER, m_yyText);
+      m_nextToken.setValue(dvalue);
+      m_nextToken.setNeedCorrectLNumberOverflow(needCorrectOverflow);
+      return;
    }
-   assert(!errno);
+   /// the digits are read once, an integer that overflows is converted to
+   /// a double from what was read
+   DecimalDigits digits;
+   parse_decimal_digits(m_yyText, end, digits);
+   if (digits.exponent == 0 &&
+       digits.mantissa <= static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())) {
+      formToken(TokenKindType::T_LNUMBER, m_yyText);
+      m_nextToken.setValue(static_cast<std::int64_t>(digits.mantissa));
+      return;
+   }
+   /// overflow is undefined behavior
+   /// we just handle -9223372036854775808
+   bool needCorrectOverflow = digits.exponent == 0 && digits.mantissa == sg_int64MinMagnitude &&
+         m_nextToken.getKind() == TokenKindType::T_MINUS_SIGN;
+   double dvalue = decimal_literal_to_double(m_yyText, end, digits);
+   formToken(TokenKindType::T_DNUMBER, m_yyText);
+   m_nextToken.setValue(dvalue);
+   m_nextToken.setNeedCorrectLNumberOverflow(needCorrectOverflow);
+}
+
+void Lexer::lexInvalidNumber()
+{
+   notifyLexicalException("Invalid numeric literal", 0);
+   if (isInParseMode()) {
+      formToken(TokenKindType::T_ERROR, m_yyText);
+      return;
+   }
+   /// here we does not set semantic value
    formToken(TokenKindType::T_LNUMBER, m_yyText);
-   m_nextToken.setValue(lvalue);
+   m_nextToken.setInvalidLexValue(true);
 }
 
 void Lexer::lexDoubleNumber()
 {
-   char *end = nullptr;
-   char *yytext = reinterpret_cast<char *>(const_cast<unsigned char *>(m_yyText));
-   double dvalue = std::strtod(yytext, &end);
-   /// errno isn't checked since we allow HUGE_VAL/INF overflow
-   assert(end == yytext + m_yyLength);
+   const unsigned char *end = m_yyText + m_yyLength;
+   DecimalDigits digits;
+   parse_decimal_digits(m_yyText, end, digits);
+   /// HUGE_VAL/INF overflow is allowed
+   double dvalue = decimal_literal_to_double(m_yyText, end, digits);
    formToken(TokenKindType::T_DNUMBER, m_yyText);
    m_nextToken.setValue(dvalue);
 }
@@ -712,24 +839,24 @@ void Lexer::lexSingleQuoteString()
          return;
       }
    }
-   std::string strValue;
-   if (m_yyLength - bprefix - 2 <= 1) {
-      if (m_yyLength - bprefix - 2 == 1) {
-         unsigned char c = *(yytext + bprefix + 1);
-         if (c == '\n' || c == '\r') {
-            incLineNumber();
-         }
-         /// TODO
-         /// ZVAL_INTERNED_STR(zendlval, ZSTR_CHAR(c));
-         strValue.push_back(c);
+   StringRef body(reinterpret_cast<const char *>(m_yyText + bprefix + 1), m_yyLength - bprefix - 2);
+   formToken(TokenKindType::T_CONSTANT_ENCAPSED_STRING, m_yyText);
+   bool hasEscapes = body.find('\\') != StringRef::npos;
+   if (!hasEscapes || is_lazy_escape_decoding_enabled()) {
+      /// the value is the body itself, escapes are decoded when the value
+      /// is asked for
+      handle_newlines(*this, m_yyText + bprefix + 1, body.size());
+      if (hasEscapes) {
+         m_nextToken.setEscapedValue(body, '\'', m_valueArena.get());
+      } else {
+         m_nextToken.setValue(body);
       }
-   } else {
-      strValue.append(reinterpret_cast<const char *>(m_yyText + bprefix + 1), m_yyLength - bprefix - 2);
-      size_t filteredLength = convert_single_quote_str_escape_sequences(strValue.data(), strValue.data() + strValue.length(), *this);
-      strValue.resize(filteredLength);
+      return;
    }
-   formToken(TokenKindType::T_CONSTANT_ENCAPSED_STRING, m_yyText);
-   m_nextToken.setValue(strValue);
+   std::string strValue(body.data(), body.size());
+   size_t filteredLength = convert_single_quote_str_escape_sequences(strValue.data(), strValue.data() + strValue.length(), *this);
+   strValue.resize(filteredLength);
+   m_nextToken.setValue(m_valueArena->copyString(strValue), m_valueArena.get());
    return;
 }
 
@@ -745,10 +872,17 @@ void Lexer::lexDoubleQuoteString()
       formToken(TokenKindType::T_ERROR, yytext);
       return;
    }
-   if (yytext[0] == '\\' && yycursor < yylimit) {
+   bool hasEscapes = yytext[0] == '\\';
+   if (hasEscapes && yycursor < yylimit) {
       ++yycursor;
    }
    while (yycursor < yylimit) {
+      /// jump over plain text, only the closing quote, interpolations and
+      /// escapes need a closer look
+      yycursor = find_interpolated_string_stop(yycursor, yylimit, '"');
+      if (yycursor == yylimit) {
+         break;
+      }
       switch (*yycursor++) {
       case '"':
          break;
@@ -763,6 +897,7 @@ void Lexer::lexDoubleQuoteString()
          }
          continue;
       case '\\':
+         hasEscapes = true;
          if (yycursor < yylimit) {
             ++yycursor;
          }
@@ -774,12 +909,24 @@ void Lexer::lexDoubleQuoteString()
       break;
    }
    m_yyLength = yycursor - yytext;
-   std::string filteredStr(reinterpret_cast<const char *>(yytext), m_yyLength);
+   StringRef body(reinterpret_cast<const char *>(yytext), m_yyLength);
+   if (!hasEscapes || (is_lazy_escape_decoding_enabled() &&
+                       can_decode_escapes_lazily(body.begin(), body.end()))) {
+      handle_newlines(*this, yytext, m_yyLength);
+      formToken(TokenKindType::T_CONSTANT_ENCAPSED_STRING, yytext);
+      if (hasEscapes) {
+         m_nextToken.setEscapedValue(body, '"', m_valueArena.get());
+      } else {
+         m_nextToken.setValue(body);
+      }
+      return;
+   }
+   std::string filteredStr(body.data(), body.size());
    if (convert_double_quote_str_escape_sequences(filteredStr, '"', filteredStr.data(),
                                                  filteredStr.data() + m_yyLength, *this) ||
        !isInParseMode()) {
       formToken(TokenKindType::T_CONSTANT_ENCAPSED_STRING, yytext);
-      m_nextToken.setValue(filteredStr);
+      m_nextToken.setValue(m_valueArena->copyString(filteredStr), m_valueArena.get());
    } else {
       formToken(TokenKindType::T_ERROR, yytext);
    }
@@ -799,10 +946,17 @@ void Lexer::lexBackquote()
       formToken(TokenKindType::END, yytext);
       return;
    }
-   if (yytext[0] == '\\' && yycursor < yylimit) {
+   bool hasEscapes = yytext[0] == '\\';
+   if (hasEscapes && yycursor < yylimit) {
       ++yycursor;
    }
    while (yycursor < yylimit) {
+      /// jump over plain text, only the closing quote, interpolations and
+      /// escapes need a closer look
+      yycursor = find_interpolated_string_stop(yycursor, yylimit, '`');
+      if (yycursor == yylimit) {
+         break;
+      }
       switch (*yycursor++) {
       case '`':
          break;
@@ -817,6 +971,7 @@ void Lexer::lexBackquote()
          }
          continue;
       case '\\':
+         hasEscapes = true;
          if (yycursor < yylimit) {
             ++yycursor;
          }
@@ -829,11 +984,23 @@ void Lexer::lexBackquote()
    }
 
    m_yyLength = yycursor - yytext;
-   std::string filteredStr(reinterpret_cast<const char *>(yytext), m_yyLength);
+   StringRef body(reinterpret_cast<const char *>(yytext), m_yyLength);
+   if (!hasEscapes || (is_lazy_escape_decoding_enabled() &&
+                       can_decode_escapes_lazily(body.begin(), body.end()))) {
+      handle_newlines(*this, yytext, m_yyLength);
+      formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
+      if (hasEscapes) {
+         m_nextToken.setEscapedValue(body, '`', m_valueArena.get());
+      } else {
+         m_nextToken.setValue(body);
+      }
+      return;
+   }
+   std::string filteredStr(body.data(), body.size());
    if (convert_double_quote_str_escape_sequences(filteredStr, '`', filteredStr.data(), filteredStr.data() + m_yyLength, *this) ||
        !isInParseMode()) {
       formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
-      m_nextToken.setValue(filteredStr);
+      m_nextToken.setValue(m_valueArena->copyString(filteredStr), m_valueArena.get());
    } else {
       formToken(TokenKindType::T_ERROR, yytext);
    }
@@ -893,7 +1060,7 @@ void Lexer::lexHeredocHeader()
    /// if we found end marker, we use this point to restore yycursor
    /// and goto ST_END_HEREDOC condition
    savedCursor = yycursor;
-   m_heredocLabelStack.push(label);
+   m_heredocLabelStack.push_back(label);
 
    /// calculate indentation and space char type
    while (yycursor < yylimit && (*yycursor == ' ' || *yycursor == '\t')) {
@@ -1003,11 +1170,19 @@ void Lexer::lexHeredocBody()
    const unsigned char *&yycursor = m_yyCursor;
    const unsigned char *yylimit = m_artificialEof;
    std::size_t &yylength = m_yyLength;
-   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.top();
+   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.back();
    int newlineLength = 0;
    int indentation = 0;
    int spacing = 0;
    bool foundEndMarker = false;
+   /// the value is made right after the scan, what it needs is collected
+   /// on the way so the body is not walked again
+   bool makesValue = !m_flags.isHeredocScanAhead() && (isInParseMode() || m_flags.isCheckHeredocIndentation());
+   bool stripsIndentation = makesValue && label->indentation != 0;
+   int newlineCount = 0;
+   bool hasEscapes = false;
+   bool hasCheckedEscapes = false;
+   SmallVector<const char *, 32> lineEnds;
    /// lex until we meet end mark or '${' or '{$'
    if (yycursor > yylimit) {
       yycursor = yylimit;
@@ -1017,6 +1192,12 @@ void Lexer::lexHeredocBody()
    /// before control get here, re2c already increment yycursor
    --yycursor;
    while (yycursor < yylimit) {
+      /// jump over plain text, only newlines, interpolations and escapes
+      /// need a closer look
+      yycursor = find_heredoc_body_stop(yycursor, yylimit, true);
+      if (yycursor == yylimit) {
+         break;
+      }
       switch (*yycursor++) {
       case '\r':
          if (*yycursor == '\n') {
@@ -1024,6 +1205,10 @@ void Lexer::lexHeredocBody()
          }
          [[fallthrough]];
       case '\n':
+         ++newlineCount;
+         if (stripsIndentation && yycursor[-1] == '\n') {
+            lineEnds.push_back(reinterpret_cast<const char *>(yycursor) - 1);
+         }
          /// check wehther this line have end marker
          indentation = spacing = 0;
          while (yycursor < yylimit && (*yycursor == ' ' || *yycursor == '\t')) {
@@ -1038,7 +1223,7 @@ void Lexer::lexHeredocBody()
 
          if (yycursor == yylimit) {
             yylength = yycursor - yytext;
-            handle_newlines(*this, yytext, yylength);
+            incLineNumber(newlineCount);
             formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
             /// save unclosed string into token
             m_nextToken.setValue(StringRef(reinterpret_cast<const char *>(yytext), yylength));
@@ -1062,6 +1247,10 @@ void Lexer::lexHeredocBody()
             }
             /// For newline before label
             m_flags.setIncrementLineNumber(true);
+            --newlineCount;
+            if (!lineEnds.empty() && lineEnds.back() == reinterpret_cast<const char *>(yycursor) - indentation - 1) {
+               lineEnds.pop_back();
+            }
 
             if (m_flags.isHeredocScanAhead()) {
                /// in scan ahead mode, we don't care about indentation
@@ -1088,7 +1277,12 @@ void Lexer::lexHeredocBody()
          }
          continue;
       case '\\':
+         hasEscapes = true;
          if (yycursor < yylimit && *yycursor != '\n' && *yycursor != '\r') {
+            if (makesValue && is_checked_escape(reinterpret_cast<const char *>(yycursor),
+                                                reinterpret_cast<const char *>(yylimit))) {
+               hasCheckedEscapes = true;
+            }
             ++yycursor;
          }
          [[fallthrough]];
@@ -1102,27 +1296,58 @@ void Lexer::lexHeredocBody()
    }
    yylength = yycursor - yytext;
    /// scan ahead and normal mode both need exclude newline
-   std::string filteredStr(reinterpret_cast<const char *>(yytext), yylength - newlineLength);
-   if (!m_flags.isHeredocScanAhead() && !m_flags.isLexExceptionOccurred() && (isInParseMode() || m_flags.isCheckHeredocIndentation())) {
-      /// TODO
-      /// need review here
-      bool newlineAtStart = *(yytext - 1) == '\n' || *(yytext - 1) == '\r';
-      if (!strip_multiline_string_indentation(*this, filteredStr, label->indentation, label->intentationUseSpaces,
-                                              newlineAtStart, newlineLength != 0)) {
-         formErrorToken(yytext);
+   const char *body = reinterpret_cast<const char *>(yytext);
+   size_t bodyLength = yylength - newlineLength;
+   if (makesValue && !m_flags.isLexExceptionOccurred()) {
+      if (!stripsIndentation && !hasEscapes) {
+         /// nothing to strip and nothing to decode, the value is the body
+         incLineNumber(newlineCount);
+         formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
+         m_nextToken.setValue(StringRef(body, bodyLength));
+         return;
+      }
+      bool decodesEscapes = hasEscapes && !hasCheckedEscapes;
+      const char *text = body;
+      size_t textLength = bodyLength;
+      if (stripsIndentation || decodesEscapes) {
+         /// the value is never longer than the body, the indentation is
+         /// stripped and the escapes decoded by one copy into the arena
+         char *value = m_valueArena->allocate(bodyLength);
+         if (stripsIndentation) {
+            bool newlineAtStart = *(yytext - 1) == '\n' || *(yytext - 1) == '\r';
+            if (!strip_multiline_string_indentation(*this, body, body + bodyLength, lineEnds, value, textLength,
+                                                    label->indentation, label->intentationUseSpaces,
+                                                    newlineAtStart, newlineLength != 0, decodesEscapes)) {
+               formErrorToken(yytext);
+               return;
+            }
+         } else {
+            textLength = decode_escape_sequences(body, body + bodyLength, 0, value);
+         }
+         text = value;
+      }
+      if (!hasCheckedEscapes) {
+         incLineNumber(newlineCount);
+         formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
+         m_nextToken.setValue(StringRef(text, textLength), m_valueArena.get());
          return;
       }
+      /// \u{} and octal overflow escapes may raise an exception, the
+      /// conversion counts the newlines itself
+      std::string filteredStr(text, textLength);
       if (!convert_double_quote_str_escape_sequences(filteredStr, 0, filteredStr.data(),
                                                      filteredStr.data() + filteredStr.size(), *this)) {
          formToken(TokenKindType::T_ERROR, yytext);
          return;
       }
-   } else {
-      /// just handle newline
-      handle_newlines(*this, yytext, yylength - newlineLength);
+      formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
+      m_nextToken.setValue(m_valueArena->copyString(filteredStr), m_valueArena.get());
+      return;
    }
+   /// just handle newline, the value is the raw body
+   incLineNumber(newlineCount);
    formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
-   m_nextToken.setValue(filteredStr);
+   m_nextToken.setValue(StringRef(body, bodyLength));
 }
 
 void Lexer::lexNowdocBody()
@@ -1131,11 +1356,16 @@ void Lexer::lexNowdocBody()
    const unsigned char *&yycursor = m_yyCursor;
    const unsigned char *yylimit = m_artificialEof;
    std::size_t &yylength = m_yyLength;
-   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.top();
+   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.back();
    int newlineLength = 0;
    int indentation = 0;
    int spacing = 0;
    bool foundEndMarker = false;
+   /// the indentation is known at the end marker, the lines are collected
+   /// on the way to strip it without walking the body again
+   bool makesValue = isInParseMode() || m_flags.isCheckHeredocIndentation();
+   int newlineCount = 0;
+   SmallVector<const char *, 32> lineEnds;
    if (yycursor > yylimit) {
       yycursor = yylimit;
       formToken(TokenKindType::END, yytext);
@@ -1143,6 +1373,10 @@ void Lexer::lexNowdocBody()
    }
    --yycursor;
    while (yycursor < yylimit) {
+      yycursor = find_heredoc_body_stop(yycursor, yylimit, false);
+      if (yycursor == yylimit) {
+         break;
+      }
       switch (*yycursor++) {
       case '\r':
          if (*yycursor == '\n') {
@@ -1150,6 +1384,10 @@ void Lexer::lexNowdocBody()
          }
          [[fallthrough]];
       case '\n':
+         ++newlineCount;
+         if (makesValue && yycursor[-1] == '\n') {
+            lineEnds.push_back(reinterpret_cast<const char *>(yycursor) - 1);
+         }
          indentation = spacing = 0;
          while (yycursor < yylimit && (*yycursor == ' ' || *yycursor == '\t')) {
             if (*yycursor == '\t') {
@@ -1162,7 +1400,7 @@ void Lexer::lexNowdocBody()
          }
          if (yycursor == yylimit) {
             m_yyLength = yycursor - yytext;
-            handle_newlines(*this, yytext, m_yyLength);
+            incLineNumber(newlineCount);
             formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
             m_nextToken.setValue(StringRef(reinterpret_cast<const char *>(yytext), yylength));
             return;
@@ -1184,6 +1422,10 @@ void Lexer::lexNowdocBody()
             }
             /// For newline before label
             m_flags.setIncrementLineNumber(true);
+            --newlineCount;
+            if (!lineEnds.empty() && lineEnds.back() == reinterpret_cast<const char *>(yycursor) - indentation - 1) {
+               lineEnds.pop_back();
+            }
             m_flags.setReserveHeredocSpaces(true);
             yycursor -= indentation;
             label->indentation = indentation;
@@ -1200,18 +1442,28 @@ void Lexer::lexNowdocBody()
       }
    }
    yylength = yycursor - yytext;
-   std::string filteredStr(reinterpret_cast<const char *>(yytext), yylength - newlineLength);
-   if (!m_flags.isLexExceptionOccurred() && spacing != 0 && (isInParseMode() || m_flags.isCheckHeredocIndentation())) {
+   const char *body = reinterpret_cast<const char *>(yytext);
+   size_t bodyLength = yylength - newlineLength;
+   StringRef value(body, bodyLength);
+   if (!m_flags.isLexExceptionOccurred() && spacing != 0 && makesValue) {
       bool newlineAtStart = *(yytext - 1) == '\n' || *(yytext - 1) == '\r';
-      if (!strip_multiline_string_indentation(*this, filteredStr, indentation, spacing == HEREDOC_USING_SPACES,
-                                              newlineAtStart, newlineLength != 0)) {
+      char *stripped = m_valueArena->allocate(bodyLength);
+      size_t strippedLength;
+      if (!strip_multiline_string_indentation(*this, body, body + bodyLength, lineEnds, stripped, strippedLength,
+                                              indentation, spacing == HEREDOC_USING_SPACES,
+                                              newlineAtStart, newlineLength != 0, false)) {
          formErrorToken(yytext);
          return;
       }
+      value = StringRef(stripped, strippedLength);
    }
-   handle_newlines(*this, yytext, yylength - newlineLength);
+   incLineNumber(newlineCount);
    formToken(TokenKindType::T_ENCAPSED_AND_WHITESPACE, yytext);
-   m_nextToken.setValue(filteredStr);
+   if (value.data() == body) {
+      m_nextToken.setValue(value);
+   } else {
+      m_nextToken.setValue(value, m_valueArena.get());
+   }
 }
 
 void Lexer::lexHereAndNowDocEnd()
@@ -1226,8 +1478,7 @@ void Lexer::lexHereAndNowDocEnd()
       setYYCursor(getYYText());
       return;
    }
-   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.top();
-   m_heredocLabelStack.pop();
+   std::shared_ptr<HereDocLabel> label = m_heredocLabelStack.popBackValue();
    m_yyLength = label->indentation + label->name.size();
    m_yyCursor += m_yyLength - 1;
    m_yyCondition = COND_NAME(ST_IN_SCRIPTING);
@@ -1368,61 +1619,60 @@ SourceLoc get_loc_for_start_of_token_in_buffer(
 
 Lexer &Lexer::saveYYState()
 {
-   LexerState state;
-   state.setYYLength(m_yyLength);
-   state.setBufferStart(m_bufferStart);
-   state.setBufferEnd(m_bufferEnd);
-   state.setContentStart(m_contentStart);
-   state.setYYText(m_yyText);
-   state.setYYCursor(m_yyCursor);
-   state.setYYMarker(m_yyMarker);
-   state.setYYLimit(m_artificialEof);
-
-   state.setCondition(m_yyCondition);
-   state.setLineNumber(m_lineNumber);
-   state.setLexerFlags(m_flags);
-   state.setLexicalEventHandler(m_eventHandler);
-   state.setLexicalExceptionHandler(m_lexicalExceptionHandler);
-
-   state.setHeredocLabelStack(m_heredocLabelStack);
-
-   std::stack<YYLexerCondType> condState;
-   m_yyConditionStack.swap(condState);
-   state.setConditionStack(std::move(condState));
-
-   m_yyStateStack.push(std::move(state));
+   m_yyStateStack.push_back({getCheckpoint(), m_eventHandler, m_lexicalExceptionHandler});
+   // the saved state continues with a fresh condition stack
+   m_yyConditionStack.clear();
    return *this;
 }
 
 Lexer &Lexer::restoreYYState()
 {
-   LexerState &state = m_yyStateStack.top();
-   m_yyLength = state.getYYLength();
-   m_bufferStart = state.getBufferStart();
-   m_bufferEnd = state.getBufferEnd();
-   m_contentStart = state.getContentStart();
-   m_yyText = state.getYYText();
-   m_yyCursor = state.getYYCursor();
-   m_yyMarker = state.getYYMarker();
-   m_artificialEof = state.getYYLimit();
-
-   m_yyCondition = state.getCondition();
-   m_lineNumber = state.getLineNumber();
-   m_flags = state.getLexerFlags();
-   m_eventHandler = state.getLexicalEventHandler();
-   m_lexicalExceptionHandler = state.getLexicalExceptionHandler();
-
-   std::stack<std::shared_ptr<HereDocLabel>> &heredocLabelStack = state.getHeredocLabelStack();
-   m_heredocLabelStack.swap(heredocLabelStack);
-
-   std::stack<YYLexerCondType> &condState = state.getConditionStack();
-   m_yyConditionStack.swap(condState);
-
-   m_yyStateStack.pop();
-
+   assert(!m_yyStateStack.empty() && "yy state stack is empty");
+   SavedYYState &state = m_yyStateStack.back();
+   restoreCheckpoint(state.checkpoint);
+   m_eventHandler = std::move(state.eventHandler);
+   m_lexicalExceptionHandler = std::move(state.exceptionHandler);
+   m_yyStateStack.pop_back();
    return *this;
 }
 
+LexerCheckpoint Lexer::getCheckpoint() const
+{
+   LexerCheckpoint checkpoint;
+   checkpoint.m_yyText = m_yyText;
+   checkpoint.m_yyCursor = m_yyCursor;
+   checkpoint.m_yyMarker = m_yyMarker;
+   checkpoint.m_artificialEof = m_artificialEof;
+   checkpoint.m_yyLength = m_yyLength;
+   checkpoint.m_lineNumber = m_lineNumber;
+   checkpoint.m_heredocIndentation = m_heredocIndentation;
+   checkpoint.m_yyCondition = m_yyCondition;
+   checkpoint.m_flags = m_flags;
+   checkpoint.m_nextToken = m_nextToken;
+   checkpoint.m_yyConditionStack = m_yyConditionStack;
+   checkpoint.m_heredocLabelStack = m_heredocLabelStack;
+   return checkpoint;
+}
+
+void Lexer::restoreCheckpoint(const LexerCheckpoint &checkpoint)
+{
+   assert(checkpoint.isValid() && "restoring an empty checkpoint");
+   assert(checkpoint.m_yyCursor >= m_bufferStart && checkpoint.m_yyCursor <= m_bufferEnd &&
+          "checkpoint of another buffer");
+   m_yyText = checkpoint.m_yyText;
+   m_yyCursor = checkpoint.m_yyCursor;
+   m_yyMarker = checkpoint.m_yyMarker;
+   m_artificialEof = checkpoint.m_artificialEof;
+   m_yyLength = checkpoint.m_yyLength;
+   m_lineNumber = checkpoint.m_lineNumber;
+   m_heredocIndentation = checkpoint.m_heredocIndentation;
+   m_yyCondition = checkpoint.m_yyCondition;
+   m_flags = checkpoint.m_flags;
+   m_nextToken = checkpoint.m_nextToken;
+   m_yyConditionStack = checkpoint.m_yyConditionStack;
+   m_heredocLabelStack = checkpoint.m_heredocLabelStack;
+}
+
 Token Lexer::getTokenAtLocation(const SourceManager &sourceMgr, SourceLoc loc)
 {
    // Don't try to do anything with an invalid location.
@@ -1582,7 +1832,8 @@ std::vector<Token> tokenize(const LangOptions &langOpts,
                             const SourceManager &sourceMgr, unsigned bufferId,
                             unsigned offset, unsigned endOffset,
                             DiagnosticEngine *diags,
-                            bool keepComments)
+                            bool keepComments,
+                            IntrusiveRefCountPtr<TokenValueArena> valueArena)
 {
    std::vector<Token> tokens;
    tokenize(langOpts, sourceMgr, bufferId, offset, endOffset,
@@ -1591,7 +1842,12 @@ std::vector<Token> tokenize(const LangOptions &langOpts,
                          : CommentRetentionMode::AttachToNextToken,
             TriviaRetentionMode::WithoutTrivia,
             [&](const Lexer &lexer, const Token &token, const ParsedTrivia &leadingTrivia,
-            const ParsedTrivia &trailingTrivia) { tokens.push_back(token); });
+            const ParsedTrivia &trailingTrivia) { tokens.push_back(token); },
+            [&](Lexer &lexer) {
+      if (valueArena) {
+         lexer.setValueArena(valueArena);
+      }
+   });
    assert(tokens.back().is(TokenKindType::END));
    tokens.pop_back(); // Remove EOF.
    return tokens;
@@ -0,0 +1,148 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/11.
+
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/utils/Parallel.h"
+
+#include <iterator>
+#include <memory>
+#include <thread>
+
+namespace polar::parser {
+
+namespace {
+
+struct LexedChunk
+{
+   const unsigned char *begin;
+   const unsigned char *end;
+   std::unique_ptr<Lexer> lexer;
+   std::vector<Token> tokens;
+   /// whether the lexer was at a safe restart point right before it lexed
+   /// the last token of the chunk
+   bool safeBeforeLast = true;
+};
+
+const unsigned char *get_token_start(const Token &token)
+{
+   return reinterpret_cast<const unsigned char *>(token.getLoc().getOpaquePointerValue());
+}
+
+/// Find a line start at or after \p from that looks like the start of a top
+/// level statement, nullptr if there is none before \p limit. This is only a
+/// guess, a wrong one is caught when the chunks are stitched together.
+const unsigned char *find_chunk_boundary(const unsigned char *from, const unsigned char *limit)
+{
+   for (const unsigned char *iter = from; iter + 1 < limit; ++iter) {
+      if (*iter != '\n') {
+         continue;
+      }
+      unsigned char next = iter[1];
+      if ((next >= 'a' && next <= 'z') || (next >= 'A' && next <= 'Z') ||
+          next == '_' || next == '$' || next == '}') {
+         return iter + 1;
+      }
+   }
+   return nullptr;
+}
+
+/// Lex tokens into \p tokens until one starts at or after \p end, that
+/// token is kept as the last one.
+void lex_until(Lexer &lexer, const unsigned char *end, std::vector<Token> &tokens,
+               bool &safeBeforeLast)
+{
+   Token token;
+   do {
+      safeBeforeLast = lexer.isAtSafeRestartPoint();
+      lexer.lex(token);
+      tokens.push_back(token);
+   } while (token.isNot(TokenKindType::END) && get_token_start(token) < end);
+}
+
+} // anonymous namespace
+
+std::vector<Token> tokenize_in_parallel(const LangOptions &langOpts,
+                                        const SourceManager &sourceMgr, unsigned bufferId,
+                                        IntrusiveRefCountPtr<TokenValueArena> valueArena,
+                                        size_t minChunkSize)
+{
+   StringRef text = sourceMgr.getEntireTextForBuffer(bufferId);
+   size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+   size_t chunkCount = std::min(threadCount * 2, text.size() / std::max<size_t>(minChunkSize, 1));
+   if (chunkCount < 2) {
+      return tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+   }
+   Lexer parent(langOpts, sourceMgr, bufferId, nullptr, CommentRetentionMode::AttachToNextToken);
+   const unsigned char *bufferStart = reinterpret_cast<const unsigned char *>(text.data());
+   const unsigned char *bufferEnd = bufferStart + text.size();
+   std::vector<LexedChunk> chunks;
+   chunks.emplace_back();
+   chunks.back().begin = bufferStart;
+   for (size_t i = 1; i < chunkCount; ++i) {
+      const unsigned char *target = bufferStart + text.size() * i / chunkCount;
+      const unsigned char *limit = bufferStart + text.size() * (i + 1) / chunkCount;
+      if (target <= chunks.back().begin) {
+         continue;
+      }
+      if (const unsigned char *boundary = find_chunk_boundary(target, limit)) {
+         chunks.back().end = boundary;
+         chunks.emplace_back();
+         chunks.back().begin = boundary;
+      }
+   }
+   chunks.back().end = bufferEnd;
+   LexerState startState = parent.getStateForBeginningOfTokenLoc(Lexer::getSourceLoc(bufferStart));
+   LexerState endState = startState.advance(text.size());
+   for (LexedChunk &chunk : chunks) {
+      chunk.lexer.reset(new Lexer(parent, startState.advance(chunk.begin - bufferStart), endState));
+      // the arena is not thread safe, every chunk lexes into its own one
+      chunk.lexer->setValueArena(new TokenValueArena);
+   }
+   utils::parallel::for_each(utils::parallel::par, chunks.begin(), chunks.end(),
+                             [](LexedChunk &chunk) {
+      lex_until(*chunk.lexer, chunk.end, chunk.tokens, chunk.safeBeforeLast);
+   });
+   // stitch the chunks, the last token of a chunk is the first token at or
+   // after the start of the next chunk
+   std::vector<Token> tokens = std::move(chunks.front().tokens);
+   Lexer *current = chunks.front().lexer.get();
+   bool safeBeforeLast = chunks.front().safeBeforeLast;
+   for (size_t i = 1; i < chunks.size() && tokens.back().isNot(TokenKindType::END); ++i) {
+      LexedChunk &chunk = chunks[i];
+      const Token &last = tokens.back();
+      const Token &first = chunk.tokens.front();
+      if (safeBeforeLast && get_token_start(last) == get_token_start(first) &&
+          last.getKind() == first.getKind() && last.getLength() == first.getLength()) {
+         // keep our own copy of the first token, its leading trivia started
+         // before the chunk
+         tokens.insert(tokens.end(), std::make_move_iterator(chunk.tokens.begin() + 1),
+                       std::make_move_iterator(chunk.tokens.end()));
+         current = chunk.lexer.get();
+         safeBeforeLast = chunk.safeBeforeLast;
+      } else {
+         lex_until(*current, chunk.end, tokens, safeBeforeLast);
+      }
+   }
+   // the tokens hold their chunk arena already, the caller's arena adopts
+   // them for its memory accounting and for values read through it
+   if (valueArena) {
+      for (LexedChunk &chunk : chunks) {
+         valueArena->adoptArena(chunk.lexer->getValueArena());
+      }
+   }
+   assert(tokens.back().is(TokenKindType::END));
+   tokens.pop_back(); // Remove EOF.
+   return tokens;
+}
+
+} // polar::parser
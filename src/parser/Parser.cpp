@@ -14,38 +14,225 @@
 #include "polarphp/parser/Lexer.h"
 #include "polarphp/syntax/Syntax.h"
 
+#include <algorithm>
+#include <iostream>
+
 namespace polar::parser {
 
 Parser::Parser(const LangOptions &langOpts, unsigned bufferId,
-               SourceManager &sourceMgr, std::shared_ptr<DiagnosticEngine> diags)
+               SourceManager &sourceMgr, std::shared_ptr<DiagnosticEngine> diags,
+               TriviaRetentionMode triviaRetention)
    : Parser(sourceMgr, diags,
             std::unique_ptr<Lexer>(new Lexer(langOpts, sourceMgr, bufferId,
                                              diags.get(), langOpts.attachCommentsToDecls ?
                                                 CommentRetentionMode::AttachToNextToken : CommentRetentionMode::None,
-                                             TriviaRetentionMode::WithTrivia)))
+                                             triviaRetention)))
 {}
 
 Parser::Parser(SourceManager &sourceMgr, std::shared_ptr<DiagnosticEngine> diags,
                std::unique_ptr<Lexer> lexer)
    : m_sourceMgr(sourceMgr),
      m_lexer(lexer.release()),
+     // without trivia the source can't be reproduced anyway, build the AST
+     m_treeBuilder(m_lexer->getTriviaRetention() == TriviaRetentionMode::WithTrivia
+                   ? ParsedTreeKind::SyntaxTree : ParsedTreeKind::Ast),
      m_diags(diags)
 {
-   m_yyParser = std::make_unique<internal::YYParser>(this, m_lexer);
-   m_token.setKind(TokenKindType::T_UNKNOWN_MARK);
+   m_yyParser = std::make_unique<internal::YYParser>(this, m_lexer, &m_treeBuilder);
 }
 
 bool Parser::parse()
 {
    m_inCompilation = true;
+   m_parserError = false;
+   m_skipNextBody = false;
+   m_headerScan = FunctionHeaderScan::None;
+   m_skippedBodies.clear();
+   // drop our reference first, the builder can reuse the arena then
+   m_ast.reset();
+   m_treeBuilder.startTree();
    int status = m_yyParser->parse();
    m_inCompilation = false;
-   return status;
+   // the input ended before the grammar could recover from an error, the
+   // unparsed rest becomes an unknown statement
+   if (status != 0) {
+      m_treeBuilder.finishAbortedSourceFile();
+   }
+   if (m_treeBuilder.getRoot()) {
+      m_ast = std::make_shared<Syntax>(polar::syntax::make<Syntax>(m_treeBuilder.getRoot()));
+   }
+   return status != 0 || m_parserError;
+}
+
+void Parser::reset(unsigned bufferId)
+{
+   assert(!m_inCompilation && "reset while parsing");
+   m_ast.reset();
+   // the checkpoints hold tokens of the value arena, drop them first so the
+   // lexer can reuse it
+   m_skippedBodies.clear();
+   m_lexer->reset(bufferId);
+   m_parserError = false;
+   m_previousLoc = SourceLoc();
+   m_leadingTrivia.clear();
+   m_trailingTrivia.clear();
+   m_docComment.clear();
+}
+
+const AstNode *Parser::parseSkippedBody(const AstNode *body)
+{
+   assert(body->getKind() == AstNodeKind::SkippedStmtList && "not a skipped body");
+   if (const AstNode *statements = body->getChild(0)) {
+      return statements;
+   }
+   const char *start = static_cast<const char *>(body->getStartLoc().getOpaquePointerValue());
+   auto iter = std::lower_bound(m_skippedBodies.begin(), m_skippedBodies.end(), start,
+                                [](const SkippedBody &skipped, const char *start) {
+      return static_cast<const char *>(skipped.start.getOpaquePointerValue()) < start;
+   });
+   if (iter == m_skippedBodies.end() || iter->start != body->getStartLoc()) {
+      // a body of another parse
+      return nullptr;
+   }
+   m_inCompilation = true;
+   m_lexer->restoreCheckpoint(iter->checkpoint);
+   // the grammar starts with the statements, the closing brace of the
+   // body ends them
+   m_startingSkippedBody = true;
+   m_bodyBraceDepth = 1;
+   m_treeBuilder.startSkippedBody();
+   int status = m_yyParser->parse();
+   m_inCompilation = false;
+   m_bodyBraceDepth = 0;
+   if (status != 0) {
+      m_treeBuilder.finishAbortedSkippedBody();
+   }
+   return m_treeBuilder.attachSkippedBody(body);
+}
+
+const Token &Parser::peekToken()
+{
+   return m_lexer->peekNextToken();
+}
+
+TokenKindType Parser::lexToken()
+{
+   if (m_skipNextBody && skipFunctionBody()) {
+      return peekToken().getKind();
+   }
+   const Token &token = m_lexer->lexInPlace(m_leadingTrivia, m_trailingTrivia);
+   if (m_bodyBraceDepth != 0) {
+      if (token.isAny(TokenKindType::T_LEFT_BRACE, TokenKindType::T_CURLY_OPEN,
+                      TokenKindType::T_DOLLAR_OPEN_CURLY_BRACES)) {
+         ++m_bodyBraceDepth;
+      } else if (token.is(TokenKindType::T_RIGHT_BRACE) && --m_bodyBraceDepth == 0) {
+         // the token stays a brace, only the grammar sees the end
+         return TokenKindType::END;
+      }
+   } else if (m_skipFunctionBodies) {
+      m_skipNextBody = opensFunctionBody(token);
+   }
+   return token.getKind();
+}
+
+bool Parser::opensFunctionBody(const Token &token)
+{
+   switch (m_headerScan) {
+   case FunctionHeaderScan::None:
+      if (token.is(TokenKindType::T_FUNCTION)) {
+         m_headerScan = FunctionHeaderScan::Name;
+      }
+      return false;
+   case FunctionHeaderScan::Name:
+      // `use function a\b;` and `use function a\{b, c};` have no parameters
+      if (token.is(TokenKindType::T_LEFT_PAREN)) {
+         m_headerScan = FunctionHeaderScan::Parameters;
+         m_headerParenDepth = 1;
+      } else if (token.isAny(TokenKindType::T_SEMICOLON, TokenKindType::T_COMMA,
+                             TokenKindType::T_LEFT_BRACE, TokenKindType::END)) {
+         m_headerScan = FunctionHeaderScan::None;
+      }
+      return false;
+   case FunctionHeaderScan::Parameters:
+      if (token.is(TokenKindType::T_LEFT_PAREN)) {
+         ++m_headerParenDepth;
+      } else if (token.is(TokenKindType::T_RIGHT_PAREN) && --m_headerParenDepth == 0) {
+         m_headerScan = FunctionHeaderScan::Tail;
+      } else if (token.is(TokenKindType::END)) {
+         m_headerScan = FunctionHeaderScan::None;
+      }
+      return false;
+   case FunctionHeaderScan::Tail:
+      // the lexical variables of a closure and the return type
+      if (token.is(TokenKindType::T_LEFT_PAREN)) {
+         m_headerScan = FunctionHeaderScan::Parameters;
+         m_headerParenDepth = 1;
+         return false;
+      }
+      if (token.isAny(TokenKindType::T_USE, TokenKindType::T_COLON, TokenKindType::T_QUESTION_MARK,
+                      TokenKindType::T_IDENTIFIER_STRING, TokenKindType::T_NS_SEPARATOR,
+                      TokenKindType::T_NAMESPACE, TokenKindType::T_ARRAY, TokenKindType::T_CALLABLE)) {
+         return false;
+      }
+      // a body, or the semicolon of an abstract method
+      m_headerScan = FunctionHeaderScan::None;
+      return token.is(TokenKindType::T_LEFT_BRACE);
+   }
+   return false;
+}
+
+bool Parser::skipFunctionBody()
+{
+   m_skipNextBody = false;
+   LexerCheckpoint checkpoint = m_lexer->getCheckpoint();
+   // only an AST skips bodies, there are no trivia to keep
+   const Token *token = &m_lexer->lexInPlace();
+   SourceLoc start = token->getLoc();
+   SourceLoc end;
+   unsigned depth = 1;
+   while (token->isNot(TokenKindType::END)) {
+      if (token->isAny(TokenKindType::T_LEFT_BRACE, TokenKindType::T_CURLY_OPEN,
+                       TokenKindType::T_DOLLAR_OPEN_CURLY_BRACES)) {
+         ++depth;
+      } else if (token->is(TokenKindType::T_RIGHT_BRACE) && --depth == 0) {
+         break;
+      }
+      end = token->getRange().getEnd();
+      token = &m_lexer->lexInPlace();
+   }
+   if (token->is(TokenKindType::END)) {
+      // the tokens of an unterminated body go to the grammar, its error
+      // recovery reports the missing brace
+      m_lexer->restoreCheckpoint(checkpoint);
+      return false;
+   }
+   // an empty body is parsed as it is, its closing brace is the token
+   if (end.isValid()) {
+      m_skippedBodies.push_back({start, checkpoint});
+      m_treeBuilder.skipFunctionBody(CharSourceRange(m_sourceMgr, start, end));
+   }
+   return true;
+}
+
+void Parser::reportSyntaxError(StringRef msg)
+{
+   m_parserError = true;
+   if (!m_syntaxErrorHandler) {
+      std::cout << msg.getStr() << std::endl;
+      return;
+   }
+   unsigned line = 0;
+   unsigned column = 0;
+   SourceLoc loc = peekToken().getLoc();
+   if (loc.isValid()) {
+      std::tie(line, column) = m_sourceMgr.getLineAndColumn(loc, m_lexer->getBufferId());
+   }
+   m_syntaxErrorHandler(msg, line, column);
 }
 
 std::shared_ptr<Syntax> Parser::getSyntaxTree()
 {
-   assert(m_token.is(TokenKindType::END) && "not done parsing yet");
+   assert(!m_inCompilation && "not done parsing yet");
    return m_ast;
 }
 
@@ -270,20 +270,11 @@ std::optional<unsigned> SourceManager::resolveFromLineCol(unsigned bufferId,
       return std::nullopt;
    }
    auto inputBuf = getBasicSourceMgr().getMemoryBuffer(bufferId);
-   const char *ptr = inputBuf->getBufferStart();
+   const char *ptr = getBasicSourceMgr().getPointerForLineNumber(line, bufferId);
    const char *end = inputBuf->getBufferEnd();
-   const char *lineStart = ptr;
-   --line;
-   for (; line && (ptr < end); ++ptr) {
-      if (*ptr == '\n') {
-         --line;
-         lineStart = ptr+1;
-      }
-   }
-   if (line != 0) {
+   if (ptr == nullptr) {
       return std::nullopt;
    }
-   ptr = lineStart;
 
    // The <= here is to allow for non-inclusive range end positions at EOF
    for (; ptr <= end; ++ptr) {
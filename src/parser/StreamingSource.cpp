@@ -0,0 +1,156 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "polarphp/parser/StreamingSource.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/utils/MemoryBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace polar::parser {
+
+using polar::utils::MemoryBuffer;
+
+/// The buffer the source manager has for the window, it follows the window
+/// when it is reallocated.
+class StreamingSource::WindowBuffer : public MemoryBuffer
+{
+public:
+   explicit WindowBuffer(StringRef name)
+      : m_name(name.getStr())
+   {}
+
+   void setWindow(const char *start, size_t size)
+   {
+      init(start, start + size, /*requiresNullTerminator=*/true);
+   }
+
+   StringRef getBufferIdentifier() const override
+   {
+      return m_name;
+   }
+
+   BufferKind getBufferKind() const override
+   {
+      return BufferKind::MemoryBuffer_Malloc;
+   }
+
+private:
+   std::string m_name;
+};
+
+StreamingSource::StreamingSource(SourceManager &sourceMgr, ReadFunc reader, size_t windowSize,
+                                 StringRef bufferName)
+   : m_sourceMgr(sourceMgr),
+     m_reader(std::move(reader))
+{
+   allocateWindow(std::max<size_t>(windowSize, 16));
+   std::unique_ptr<WindowBuffer> buffer = std::make_unique<WindowBuffer>(bufferName);
+   buffer->setWindow(getWindowStart(), m_windowSize);
+   m_windowBuffer = buffer.get();
+   m_bufferId = m_sourceMgr.addNewSourceBuffer(std::move(buffer));
+}
+
+StreamingSource::StreamingSource(SourceManager &sourceMgr, std::FILE *stream, size_t windowSize,
+                                 StringRef bufferName)
+   : StreamingSource(sourceMgr, [stream](char *dest, size_t size) {
+        return std::fread(dest, 1, size, stream);
+     }, windowSize, bufferName)
+{}
+
+void StreamingSource::allocateWindow(size_t size)
+{
+   std::unique_ptr<char[]> window(new char[size + 1]);
+   window[size] = 0;
+   size_t pending = m_dataEnd - m_nextLineStart;
+   if (m_window != nullptr) {
+      std::memcpy(window.get(), getWindowStart() + m_nextLineStart, pending);
+   }
+   m_window = std::move(window);
+   if (m_windowBuffer != nullptr) {
+      m_windowBuffer->setWindow(getWindowStart(), size);
+   }
+   m_windowSize = size;
+   m_lineStart = 0;
+   m_lineEnd = 0;
+   m_nextLineStart = 0;
+   m_dataEnd = pending;
+}
+
+bool StreamingSource::readLine()
+{
+   // the window is written to below, line lookups must not use the line
+   // ends of what was in it before
+   m_sourceMgr.clearLineOffsets(m_bufferId);
+   char *window = getWindowStart();
+   size_t scanFrom = m_nextLineStart;
+   while (true) {
+      if (const void *newline = std::memchr(window + scanFrom, '\n', m_dataEnd - scanFrom)) {
+         size_t newlinePos = static_cast<const char *>(newline) - window;
+         m_lineStart = m_nextLineStart;
+         m_lineEnd = newlinePos;
+         if (m_lineEnd > m_lineStart && window[m_lineEnd - 1] == '\r') {
+            --m_lineEnd;
+         }
+         window[m_lineEnd] = 0;
+         m_nextLineStart = newlinePos + 1;
+         ++m_lineNumber;
+         return true;
+      }
+      if (m_atEndOfInput) {
+         m_lineStart = m_nextLineStart;
+         m_lineEnd = m_dataEnd;
+         if (m_lineStart == m_lineEnd) {
+            return false;
+         }
+         // the window has a NUL one past its end, so there is always room
+         window[m_lineEnd] = 0;
+         m_nextLineStart = m_dataEnd;
+         ++m_lineNumber;
+         return true;
+      }
+      if (m_dataEnd == m_windowSize) {
+         if (m_nextLineStart != 0) {
+            // drop the lines that have been handed out already
+            size_t pending = m_dataEnd - m_nextLineStart;
+            std::memmove(window, window + m_nextLineStart, pending);
+            m_nextLineStart = 0;
+            m_dataEnd = pending;
+         } else {
+            // the line is longer than the window
+            allocateWindow(m_windowSize * 2);
+            window = getWindowStart();
+         }
+      }
+      scanFrom = m_dataEnd;
+      size_t count = m_reader(window + m_dataEnd, m_windowSize - m_dataEnd);
+      if (count == 0) {
+         m_atEndOfInput = true;
+      }
+      m_dataEnd += count;
+   }
+}
+
+std::pair<unsigned, unsigned> StreamingSource::getLineAndColumn(SourceLoc loc) const
+{
+   unsigned offset = m_sourceMgr.getLocOffsetInBuffer(loc, m_bufferId);
+   assert(offset >= m_lineStart && offset <= m_lineEnd && "not a location of the current line");
+   return {static_cast<unsigned>(m_lineNumber), static_cast<unsigned>(offset - m_lineStart + 1)};
+}
+
+StringRef StreamingSource::getLine() const
+{
+   return StringRef(getWindowStart() + m_lineStart, m_lineEnd - m_lineStart);
+}
+
+} // polar::parser
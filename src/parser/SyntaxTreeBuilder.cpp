@@ -0,0 +1,597 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "polarphp/parser/SyntaxTreeBuilder.h"
+#include "polarphp/parser/Token.h"
+#include "polarphp/syntax/Trivia.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace polar::parser {
+
+using polar::basic::OwnedString;
+using polar::syntax::get_unknown_kind;
+using polar::syntax::SourcePresence;
+using polar::syntax::TokenKindType;
+using polar::syntax::TriviaPiece;
+
+namespace {
+
+const SyntaxKind scg_syntaxKinds[] = {
+#define AST_NODE(Id, Kind) SyntaxKind::Kind,
+#include "polarphp/ast/AstNodeKindDefs.h"
+};
+
+SyntaxKind get_syntax_kind(AstNodeKind kind)
+{
+   return scg_syntaxKinds[static_cast<size_t>(kind)];
+}
+
+/// A literal node has its number token as only child.
+const RawSyntax *get_number_token(const RawSyntax *literal)
+{
+   if (!literal->isToken() && literal->getNumChildren() == 1) {
+      return literal->getChild(0).get();
+   }
+   return literal;
+}
+
+const AstNode *get_number_token(const AstNode *literal)
+{
+   if (!literal->isToken() && literal->getNumChildren() == 1) {
+      return literal->getChild(0);
+   }
+   return literal;
+}
+
+template <typename ValueType>
+std::optional<ValueType> find_number_value(const DenseMap<const void *, ValueType> &values,
+                                           const void *token)
+{
+   auto iter = values.find(token);
+   if (iter == values.end()) {
+      return std::nullopt;
+   }
+   return iter->second;
+}
+
+} // anonymous namespace
+
+SyntaxTreeBuilder::SyntaxTreeBuilder(ParsedTreeKind treeKind)
+   : m_treeKind(treeKind)
+{
+   if (isBuildingAst()) {
+      m_astArena = new AstArena;
+   } else {
+      m_arena = new SyntaxArena;
+   }
+}
+
+void SyntaxTreeBuilder::startTree()
+{
+   m_root = nullptr;
+   m_endToken = nullptr;
+   m_listElements.clear();
+   m_tokens.clear();
+   m_topStatements = PendingSyntaxList();
+   m_topStatementsEnd = 0;
+   m_skippedBody = CharSourceRange();
+   m_parsedBody = nullptr;
+   m_nodeCount = 0;
+   m_integerValues.clear();
+   m_floatValues.clear();
+   if (isBuildingAst()) {
+      // the AST is gone with the arena, unless someone retained it
+      if (m_astArena->hasOneRef()) {
+         m_astArena->reset();
+      } else {
+         m_astArena = new AstArena;
+      }
+      return;
+   }
+   // every node retains the arena, when nobody holds on to the previous
+   // tree its slab can be reused
+   if (m_arena->hasOneRef()) {
+      m_arena->reset();
+   } else {
+      m_arena = new SyntaxArena;
+   }
+}
+
+StringRef SyntaxTreeBuilder::copyText(StringRef text)
+{
+   if (text.empty()) {
+      return StringRef();
+   }
+   char *copy = static_cast<char *>(m_arena->allocate(text.size(), alignof(char)));
+   std::memcpy(copy, text.data(), text.size());
+   return StringRef(copy, text.size());
+}
+
+void SyntaxTreeBuilder::appendTrivia(const ParsedTrivia &trivia, const char *start,
+                                     SmallVectorImpl<TriviaPiece> &pieces)
+{
+   for (const ParsedTriviaPiece &piece : trivia) {
+      StringRef text(start, piece.getLength());
+      start += piece.getLength();
+      switch (piece.getKind()) {
+      case TriviaKind::LineComment:
+         pieces.push_back(TriviaPiece::getLineComment(OwnedString::makeUnowned(copyText(text))));
+         break;
+      case TriviaKind::BlockComment:
+         pieces.push_back(TriviaPiece::getBlockComment(OwnedString::makeUnowned(copyText(text))));
+         break;
+      case TriviaKind::DocLineComment:
+         pieces.push_back(TriviaPiece::getDocLineComment(OwnedString::makeUnowned(copyText(text))));
+         break;
+      case TriviaKind::DocBlockComment:
+         pieces.push_back(TriviaPiece::getDocBlockComment(OwnedString::makeUnowned(copyText(text))));
+         break;
+      case TriviaKind::GarbageText:
+         pieces.push_back(TriviaPiece::getGarbageText(OwnedString::makeUnowned(copyText(text))));
+         break;
+      default:
+         // only the count of whitespace is stored
+         pieces.push_back(TriviaPiece::fromText(piece.getKind(), text));
+         break;
+      }
+   }
+}
+
+ParsedNode SyntaxTreeBuilder::makeToken(TokenKindType kind, const Token &token,
+                                        const ParsedTrivia &leadingTrivia,
+                                        const ParsedTrivia &trailingTrivia)
+{
+   ++m_nodeCount;
+   ParsedNode node;
+   if (isBuildingAst()) {
+      node = AstNode::makeToken(*m_astArena, kind, token.getRange());
+   } else {
+      // the trivia surround the raw text in the source buffer, the way
+      // ParsedTrivia::convertToSyntaxTrivia() expects them
+      StringRef text = token.getRawText();
+      SmallVector<TriviaPiece, 8> pieces;
+      appendTrivia(leadingTrivia, text.data() - leadingTrivia.getLength(), pieces);
+      size_t leadingCount = pieces.size();
+      appendTrivia(trailingTrivia, text.data() + text.size(), pieces);
+      ArrayRef<TriviaPiece> allPieces(pieces);
+      node = RawSyntax::make(kind, OwnedString::makeUnowned(copyText(text)),
+                             allPieces.slice(0, leadingCount), allPieces.slice(leadingCount),
+                             SourcePresence::Present, m_arena);
+   }
+   // the grammar never shifts END, the source file takes it from here
+   if (kind == TokenKindType::END) {
+      m_endToken = node;
+   }
+   // the nodes of number tokens only keep their text
+   const void *key = isBuildingAst() ? static_cast<const void *>(node.getAstNode())
+                                     : static_cast<const void *>(node.getSyntax().get());
+   if (kind == TokenKindType::T_LNUMBER && token.getValueType() == Token::ValueType::LongLong) {
+      m_integerValues[key] = token.getValue<std::int64_t>();
+   } else if (kind == TokenKindType::T_DNUMBER && token.getValueType() == Token::ValueType::Double) {
+      m_floatValues[key] = token.getValue<double>();
+   }
+   m_tokens.push_back(node);
+   return node;
+}
+
+ParsedNode SyntaxTreeBuilder::makeNode(AstNodeKind kind, ArrayRef<ParsedNode> layout)
+{
+   if (isBuildingAst()) {
+      ++m_nodeCount;
+      SmallVector<AstNode *, 16> children;
+      for (const ParsedNode &child : layout) {
+         children.push_back(child.getAstNode());
+      }
+      return AstNode::make(*m_astArena, kind, children);
+   }
+   SmallVector<RefCountPtr<RawSyntax>, 16> children;
+   for (const ParsedNode &child : layout) {
+      children.push_back(child.getSyntax());
+   }
+   return makeSyntax(kind, children);
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeRaw(SyntaxKind kind, ArrayRef<RefCountPtr<RawSyntax>> layout)
+{
+   ++m_nodeCount;
+   return RawSyntax::make(kind, layout, SourcePresence::Present, m_arena);
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeSyntax(AstNodeKind kind,
+                                                     ArrayRef<RefCountPtr<RawSyntax>> symbols)
+{
+   SyntaxKind syntaxKind = get_syntax_kind(kind);
+   RefCountPtr<RawSyntax> node;
+   switch (kind) {
+   case AstNodeKind::ExprStmt:
+      // expr ;
+      node = makeStatementItem(syntaxKind, {symbols[0]}, symbols[1]);
+      break;
+   case AstNodeKind::ReturnStmt:
+   case AstNodeKind::ThrowStmt:
+      // return optional_expr ;
+      node = makeStatementItem(syntaxKind, {symbols[0], symbols[1]}, symbols[2]);
+      break;
+   case AstNodeKind::BreakStmt:
+   case AstNodeKind::ContinueStmt: {
+      // the level is a number token, not an expression
+      RefCountPtr<RawSyntax> level = symbols[1];
+      if (level && level->kindOf(SyntaxKind::IntegerLiteralExpr)) {
+         level = level->getChild(0);
+      }
+      if (!level || level->isToken(TokenKindType::T_LNUMBER)) {
+         node = makeStatementItem(syntaxKind, {symbols[0], level}, symbols[2]);
+      }
+      break;
+   }
+   case AstNodeKind::FallthroughStmt:
+      node = makeStatementItem(syntaxKind, {symbols[0]}, symbols[1]);
+      break;
+   case AstNodeKind::WhileStmt: {
+      // while ( expr ) statement, the grammar has no labels
+      RefCountPtr<RawSyntax> condition = makeRaw(SyntaxKind::ConditionElement, {symbols[2], nullptr});
+      RefCountPtr<RawSyntax> conditions = makeRaw(SyntaxKind::ConditionElementList, {condition});
+      node = makeRaw(syntaxKind, {nullptr, nullptr, symbols[0], symbols[1], conditions, symbols[3],
+                                  symbols[4]});
+      break;
+   }
+   case AstNodeKind::DoWhileStmt:
+      // do statement while ( expr ) ;
+      node = makeStatementItem(syntaxKind, {nullptr, nullptr, symbols[0], symbols[1], symbols[2],
+                                            symbols[3], symbols[4], symbols[5]}, symbols[6]);
+      break;
+   case AstNodeKind::SwitchStmt: {
+      // switch ( expr ) { case_list }, a semicolon after the brace has no
+      // place in the layout
+      const RefCountPtr<RawSyntax> &block = symbols[4];
+      if (block->getNumChildren() == 3) {
+         node = makeRaw(syntaxKind, {nullptr, nullptr, symbols[0], symbols[1], symbols[2], symbols[3],
+                                     block->getChild(0), block->getChild(1), block->getChild(2)});
+      }
+      break;
+   }
+   case AstNodeKind::IfStmt:
+      node = makeIfStmt(symbols);
+      break;
+   case AstNodeKind::SwitchCaseList:
+      node = makeSwitchCaseList(symbols);
+      break;
+   case AstNodeKind::AssignExpr:
+   case AstNodeKind::CompoundAssignExpr:
+   case AstNodeKind::BinaryOperatorExpr: {
+      // the operands and the operator in source order
+      SyntaxKind operatorKind = kind == AstNodeKind::BinaryOperatorExpr ? SyntaxKind::BinaryOperatorExpr
+                                                                        : SyntaxKind::AssignmentExpr;
+      RefCountPtr<RawSyntax> operatorNode = makeRaw(operatorKind, {symbols[1]});
+      RefCountPtr<RawSyntax> elements = makeRaw(SyntaxKind::ExprList, {symbols[0], operatorNode, symbols[2]});
+      node = makeRaw(syntaxKind, {elements});
+      break;
+   }
+   case AstNodeKind::ShortTernaryExpr:
+      // expr ? : expr
+      node = makeRaw(syntaxKind, {symbols[0], symbols[1], nullptr, symbols[2], symbols[3]});
+      break;
+   case AstNodeKind::SpreadExpr:
+      // ... expr, only an argument is spread
+      node = makeRaw(syntaxKind, symbols);
+      break;
+   case AstNodeKind::ArgumentClause:
+      if (symbols.size() == 2) {
+         node = makeRaw(syntaxKind, {symbols[0], nullptr, symbols[1]});
+      } else if (!symbols[2]) {
+         node = makeRaw(syntaxKind, {symbols[0], symbols[1], symbols[3]});
+      } else if (symbols[1]->kindOf(SyntaxKind::ArgumentList)) {
+         // the trailing comma belongs to the last argument
+         SmallVector<RefCountPtr<RawSyntax>, 16> items(symbols[1]->getLayout().begin(),
+                                                       symbols[1]->getLayout().end());
+         items.back() = makeRaw(SyntaxKind::ArgumentListItem, {items.back()->getChild(0), symbols[2]});
+         node = makeRaw(syntaxKind, {symbols[0], makeRaw(SyntaxKind::ArgumentList, items), symbols[3]});
+      }
+      break;
+   case AstNodeKind::ArgumentList:
+      node = makeArgumentList(symbols);
+      break;
+   case AstNodeKind::ArrayExpr:
+      // array ( array_pair_list ) or [ array_pair_list ]
+      node = makeRaw(symbols.size() == 4 ? syntaxKind : SyntaxKind::SimplifiedArrayCreateExpr, symbols);
+      break;
+   case AstNodeKind::ArrayPairList:
+      node = makeArrayPairItemList(symbols);
+      break;
+   case AstNodeKind::ArrayPair:
+      if (symbols.size() == 3) {
+         // expr => expr
+         node = makeRaw(syntaxKind, {symbols[0], symbols[1], nullptr, symbols[2]});
+      } else if (symbols[0]->isToken(TokenKindType::T_ELLIPSIS)) {
+         node = makeRaw(SyntaxKind::ArrayUnpackPairItem, symbols);
+      } else if (symbols[0]->isToken(TokenKindType::T_AMPERSAND)) {
+         node = makeRaw(syntaxKind, {nullptr, nullptr, symbols[0], symbols[1]});
+      } else if (symbols[0]->isToken(TokenKindType::T_LIST)) {
+         node = makeRaw(SyntaxKind::ListRecursivePairItem, {nullptr, nullptr, symbols[0], symbols[1],
+                                                            symbols[2], symbols[3]});
+      } else if (symbols.size() == 4) {
+         // expr => & variable
+         node = makeRaw(syntaxKind, symbols);
+      } else {
+         // expr => list ( array_pair_list )
+         node = makeRaw(SyntaxKind::ListRecursivePairItem, symbols);
+      }
+      break;
+   case AstNodeKind::HeredocExpr:
+      if (symbols.size() == 2) {
+         node = makeRaw(syntaxKind, {symbols[0], nullptr, symbols[1]});
+      } else {
+         node = makeRaw(syntaxKind, symbols);
+      }
+      break;
+   case AstNodeKind::ArrayAccessExpr:
+      if (symbols[1]->isToken(TokenKindType::T_LEFT_BRACE)) {
+         // dereferencable { expr }
+         RefCountPtr<RawSyntax> offset = makeRaw(SyntaxKind::BraceDecoratedExprClause, symbols.slice(1));
+         node = makeRaw(SyntaxKind::BraceDecoratedArrayAccessExpr, {symbols[0], offset});
+      } else {
+         node = makeRaw(syntaxKind, symbols);
+      }
+      break;
+   case AstNodeKind::MethodCallExpr: {
+      // dereferencable -> property_name argument_list
+      RefCountPtr<RawSyntax> method = makeRaw(SyntaxKind::InstancePropertyExpr, symbols.slice(0, 3));
+      node = makeRaw(syntaxKind, {method, symbols[3]});
+      break;
+   }
+   case AstNodeKind::VariableExpr:
+      node = makeRaw(syntaxKind, {nullptr, symbols[0]});
+      break;
+   case AstNodeKind::VariableVariableExpr:
+      if (symbols.size() == 2) {
+         node = makeRaw(syntaxKind, symbols);
+      } else {
+         // $ { expr }
+         RefCountPtr<RawSyntax> name = makeRaw(SyntaxKind::BraceDecoratedExprClause, symbols.slice(1));
+         node = makeRaw(syntaxKind, {nullptr, makeRaw(SyntaxKind::BraceDecoratedVariableExpr,
+                                                      {symbols[0], name})});
+      }
+      break;
+   default:
+      // the symbols of the rule are the layout of its node
+      return makeRaw(syntaxKind, symbols);
+   }
+   if (!node) {
+      // the reduction does not fit the layout, its node keeps the symbols
+      node = makeRaw(get_unknown_kind(syntaxKind), symbols);
+   }
+   return node;
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeStatementItem(SyntaxKind kind,
+                                                            ArrayRef<RefCountPtr<RawSyntax>> layout,
+                                                            const RefCountPtr<RawSyntax> &semicolon)
+{
+   return makeRaw(SyntaxKind::CodeBlockItem, {makeRaw(kind, layout), semicolon});
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeIfStmt(ArrayRef<RefCountPtr<RawSyntax>> symbols)
+{
+   // if ( expr ) statement, an elseif clause of five symbols each and else
+   // statement last
+   assert(symbols.size() >= 5 && (symbols.size() % 5 == 0 || symbols.size() % 5 == 2) &&
+          "not the symbols of an if statement");
+   size_t elseStart = symbols.size() - symbols.size() % 5;
+   RefCountPtr<RawSyntax> clauseList;
+   if (elseStart > 5) {
+      SmallVector<RefCountPtr<RawSyntax>, 8> clauses;
+      for (size_t i = 5; i < elseStart; i += 5) {
+         clauses.push_back(makeRaw(SyntaxKind::ElseIfClause, symbols.slice(i, 5)));
+      }
+      clauseList = makeRaw(SyntaxKind::ElseIfList, clauses);
+   }
+   RefCountPtr<RawSyntax> elseKeyword;
+   RefCountPtr<RawSyntax> elseBody;
+   if (elseStart != symbols.size()) {
+      elseKeyword = symbols[elseStart];
+      elseBody = symbols[elseStart + 1];
+   }
+   return makeRaw(SyntaxKind::IfStmt, {nullptr, nullptr, symbols[0], symbols[1], symbols[2], symbols[3],
+                                       symbols[4], clauseList, elseKeyword, elseBody});
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeSwitchCaseList(ArrayRef<RefCountPtr<RawSyntax>> symbols)
+{
+   // case expr : inner_statement_list or default : inner_statement_list
+   SmallVector<RefCountPtr<RawSyntax>, 16> cases;
+   size_t i = 0;
+   while (i < symbols.size()) {
+      RefCountPtr<RawSyntax> label;
+      if (symbols[i]->isToken(TokenKindType::T_CASE)) {
+         label = makeRaw(SyntaxKind::SwitchCaseLabel, symbols.slice(i, 3));
+         i += 3;
+      } else {
+         label = makeRaw(SyntaxKind::SwitchDefaultLabel, symbols.slice(i, 2));
+         i += 2;
+      }
+      assert(i < symbols.size() && "case without statements");
+      cases.push_back(makeRaw(SyntaxKind::SwitchCase, {label, symbols[i]}));
+      ++i;
+   }
+   return makeRaw(SyntaxKind::SwitchCaseList, cases);
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeArgumentList(ArrayRef<RefCountPtr<RawSyntax>> symbols)
+{
+   // the arguments and the commas between them
+   SmallVector<RefCountPtr<RawSyntax>, 16> items;
+   for (size_t i = 0; i < symbols.size(); i += 2) {
+      RefCountPtr<RawSyntax> argument = symbols[i];
+      if (!argument->kindOf(SyntaxKind::Argument)) {
+         argument = makeRaw(SyntaxKind::Argument, {nullptr, argument});
+      }
+      RefCountPtr<RawSyntax> comma;
+      if (i + 1 < symbols.size()) {
+         comma = symbols[i + 1];
+      }
+      items.push_back(makeRaw(SyntaxKind::ArgumentListItem, {argument, comma}));
+   }
+   return makeRaw(SyntaxKind::ArgumentList, items);
+}
+
+RefCountPtr<RawSyntax> SyntaxTreeBuilder::makeArrayPairItemList(ArrayRef<RefCountPtr<RawSyntax>> symbols)
+{
+   // the pairs and the commas between them, a pair may be left out
+   SmallVector<RefCountPtr<RawSyntax>, 16> items;
+   for (size_t i = 0; i < symbols.size(); i += 2) {
+      RefCountPtr<RawSyntax> pair = symbols[i];
+      RefCountPtr<RawSyntax> comma;
+      if (i + 1 < symbols.size()) {
+         comma = symbols[i + 1];
+      }
+      if (!pair && !comma) {
+         // the empty pair after a trailing comma
+         continue;
+      }
+      if (pair && !pair->kindOf(SyntaxKind::ArrayKeyValuePairItem) &&
+          !pair->kindOf(SyntaxKind::ArrayUnpackPairItem) &&
+          !pair->kindOf(SyntaxKind::ListRecursivePairItem)) {
+         pair = makeRaw(SyntaxKind::ArrayKeyValuePairItem, {nullptr, nullptr, nullptr, pair});
+      }
+      items.push_back(makeRaw(SyntaxKind::ArrayPairItem, {pair, comma}));
+   }
+   return makeRaw(SyntaxKind::ArrayPairItemList, items);
+}
+
+std::optional<std::int64_t> SyntaxTreeBuilder::getIntegerValue(const RawSyntax *literal) const
+{
+   return find_number_value(m_integerValues, get_number_token(literal));
+}
+
+std::optional<std::int64_t> SyntaxTreeBuilder::getIntegerValue(const AstNode *literal) const
+{
+   return find_number_value(m_integerValues, get_number_token(literal));
+}
+
+std::optional<double> SyntaxTreeBuilder::getFloatValue(const RawSyntax *literal) const
+{
+   return find_number_value(m_floatValues, get_number_token(literal));
+}
+
+std::optional<double> SyntaxTreeBuilder::getFloatValue(const AstNode *literal) const
+{
+   return find_number_value(m_floatValues, get_number_token(literal));
+}
+
+ParsedNode SyntaxTreeBuilder::finishList(PendingSyntaxList list, AstNodeKind kind)
+{
+   assert(list.start + list.size <= m_listElements.size() && "list was already finished");
+   ArrayRef<ParsedNode> elements(m_listElements);
+   ParsedNode node = makeNode(kind, elements.slice(list.start, list.size));
+   m_listElements.resize(list.start);
+   return node;
+}
+
+void SyntaxTreeBuilder::recoverList(PendingSyntaxList &list, AstNodeKind kind,
+                                    ParsedTokenRange skipped)
+{
+   assert(list.start + list.size <= m_listElements.size() && "list was already finished");
+   assert(skipped.begin <= skipped.end && skipped.end <= m_tokens.size() && "not logged tokens");
+   m_listElements.resize(list.start + list.size);
+   ArrayRef<ParsedNode> tokens(m_tokens);
+   ParsedNode unknown = makeNode(kind, tokens.slice(skipped.begin, skipped.end - skipped.begin));
+   appendToList(list, {unknown});
+}
+
+void SyntaxTreeBuilder::finishSourceFile(PendingSyntaxList statements)
+{
+   ParsedNode statementList = finishList(statements, AstNodeKind::TopStmtList);
+   m_root = makeNode(AstNodeKind::SourceFile, {statementList, m_endToken});
+   // the log is only needed while parsing
+   m_tokens.clear();
+}
+
+ParsedTokenRange SyntaxTreeBuilder::getUnparsedTokens(std::uint32_t begin) const
+{
+   std::uint32_t end = getTokenCount();
+   // END is the source file's own child
+   if (m_endToken && end != 0) {
+      --end;
+   }
+   return {begin, std::max(begin, end)};
+}
+
+void SyntaxTreeBuilder::finishAbortedSourceFile()
+{
+   PendingSyntaxList statements = m_topStatements;
+   ParsedTokenRange unparsed = getUnparsedTokens(m_topStatementsEnd);
+   if (unparsed.begin != unparsed.end) {
+      recoverList(statements, AstNodeKind::UnknownStmt, unparsed);
+   } else {
+      m_listElements.resize(statements.start + statements.size);
+   }
+   finishSourceFile(statements);
+}
+
+ParsedNode SyntaxTreeBuilder::finishFunctionBody(PendingSyntaxList statements, std::uint32_t openBrace)
+{
+   // the function of a body skipped before was dropped by error recovery
+   if (m_skippedBody.isValid() && m_skippedBodyBrace != openBrace) {
+      m_skippedBody = CharSourceRange();
+   }
+   if (m_skippedBody.isInvalid()) {
+      return finishList(statements, AstNodeKind::InnerStmtList);
+   }
+   assert(statements.size == 0 && "statements of a skipped body");
+   ++m_nodeCount;
+   ParsedNode body = AstNode::makeSkipped(*m_astArena, AstNodeKind::SkippedStmtList, m_skippedBody);
+   m_skippedBody = CharSourceRange();
+   m_listElements.resize(statements.start);
+   return body;
+}
+
+void SyntaxTreeBuilder::startSkippedBody()
+{
+   assert(isBuildingAst() && "only an AST skips function bodies");
+   // the tree and its arena stay
+   m_endToken = nullptr;
+   m_listElements.clear();
+   m_tokens.clear();
+   m_skippedBody = CharSourceRange();
+   m_parsedBody = nullptr;
+}
+
+void SyntaxTreeBuilder::finishSkippedBody(PendingSyntaxList statements)
+{
+   m_parsedBody = finishList(statements, AstNodeKind::InnerStmtList);
+   m_tokens.clear();
+}
+
+void SyntaxTreeBuilder::finishAbortedSkippedBody()
+{
+   PendingSyntaxList statements;
+   ParsedTokenRange unparsed = getUnparsedTokens(0);
+   if (unparsed.begin != unparsed.end) {
+      recoverList(statements, AstNodeKind::UnknownStmt, unparsed);
+   } else {
+      m_listElements.clear();
+   }
+   finishSkippedBody(statements);
+}
+
+const AstNode *SyntaxTreeBuilder::attachSkippedBody(const AstNode *skipped)
+{
+   assert(skipped->getKind() == AstNodeKind::SkippedStmtList && "not a skipped body");
+   AstNode *statements = m_parsedBody.getAstNode();
+   // the builder made the node, the AST is only const for its users
+   const_cast<AstNode *>(skipped)->setSkippedChild(statements);
+   m_parsedBody = nullptr;
+   return statements;
+}
+
+} // polar::parser
@@ -10,6 +10,8 @@
 // Created by polarboy on 2019/07/09.
 
 #include "polarphp/parser/Token.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
 #include "polarphp/utils/RawOutStream.h"
 #include "polarphp/syntax/TokenKinds.h"
 
@@ -17,6 +19,23 @@ namespace polar::parser {
 
 using namespace polar::syntax;
 
+void Token::decodeStringValue() const
+{
+   assert(hasPendingEscapes());
+   StringRef raw = getRawStringValue();
+   std::optional<StringRef> decoded = m_valueArena->findDecodedValue(raw.data());
+   if (!decoded) {
+      // decoding never makes the value longer
+      char *dest = m_valueArena->allocate(raw.size());
+      size_t length = internal::decode_escape_sequences(raw.begin(), raw.end(), m_valueQuoteType, dest);
+      decoded = StringRef(dest, length);
+      m_valueArena->addDecodedValue(raw.data(), *decoded);
+   }
+   m_value.stringValue.data = decoded->data();
+   m_value.stringValue.length = decoded->size();
+   m_valueQuoteType = 0;
+}
+
 void Token::dump() const
 {
    dump(polar::utils::error_stream());
@@ -41,7 +60,7 @@ void Token::dump(RawOutStream &outStream) const
          if (m_kind == TokenKindType::T_VARIABLE){
             outStream << '$';
          }
-         outStream << getValue<std::string>() << "\n";
+         outStream << getStringValue() << "\n";
       } else if (m_kind == TokenKindType::T_LNUMBER) {
          outStream << "value: ";
          outStream << getValue<std::int64_t>() << "\n";
@@ -50,12 +69,12 @@ void Token::dump(RawOutStream &outStream) const
          outStream << getValue<double>() << "\n";
       } else if (m_kind == TokenKindType::T_CONSTANT_ENCAPSED_STRING ||
                  m_kind == TokenKindType::T_ENCAPSED_AND_WHITESPACE) {
-         const std::string &text = getValue<std::string>();
+         StringRef text = getStringValue();
          outStream << "length: " << text.size() << "\n";
          outStream << "value: " << text << "\n";
       } else if (m_kind == TokenKindType::T_ERROR && hasValue()) {
          outStream << "error: ";
-         outStream << getValue<std::string>() << "\n";
+         outStream << getStringValue() << "\n";
       }
    } else {
       outStream << "value: invalid lex value" << "\n";
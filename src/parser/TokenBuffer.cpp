@@ -0,0 +1,253 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/08.
+
+#include "polarphp/parser/TokenBuffer.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace polar::parser {
+
+void TokenBuffer::append(const Token &token)
+{
+   assert(m_kinds.size() < std::numeric_limits<std::uint32_t>::max() && "too many tokens");
+   std::uint32_t index = static_cast<std::uint32_t>(m_kinds.size());
+   StringRef text = token.getRawText();
+   std::uint32_t offset = 0;
+   if (text.data() != nullptr) {
+      assert(text.data() >= m_bufferText.data() &&
+             text.data() + text.size() <= m_bufferText.data() + m_bufferText.size() + 1 &&
+             "token is not in this buffer");
+      offset = static_cast<std::uint32_t>(text.data() - m_bufferText.data());
+   }
+   assert(static_cast<unsigned>(token.getKind()) <= std::numeric_limits<std::uint16_t>::max());
+   std::uint8_t flags = static_cast<std::uint8_t>(token.getFlags().getOpaqueValue());
+   assert((flags & ~TokenFlagsMask) == 0 && "TokenFlags grew into the storage bits");
+   m_kinds.push_back(static_cast<std::uint16_t>(token.getKind()));
+   m_offsets.push_back(offset);
+   m_lengths.push_back(static_cast<std::uint32_t>(text.size()));
+   m_flags.push_back(flags);
+   if (token.hasComment()) {
+      m_comments.push_back({index, token.getCommentLength()});
+   }
+   if (!token.hasValue()) {
+      return;
+   }
+   if (token.getValueType() == Token::ValueType::String) {
+      // most string values are the token text itself, or the text without
+      // the '$' of a variable or the quotes of a literal
+      StringRef value = token.getStringValue();
+      if (value == text) {
+         m_flags.back() |= StringValueIsText;
+         return;
+      }
+      if (text.size() >= 1 && value == text.drop_front(1)) {
+         m_flags.back() |= StringValueIsText | StringValueSkipsFirst;
+         return;
+      }
+      if (text.size() >= 2 && value == text.drop_front(1).drop_back(1)) {
+         m_flags.back() |= StringValueIsText | StringValueSkipsFirst | StringValueSkipsLast;
+         return;
+      }
+   }
+   ValueEntry entry;
+   entry.tokenIndex = index;
+   entry.type = token.getValueType();
+   switch (entry.type) {
+   case Token::ValueType::LongLong:
+      entry.longValue = token.getValue<std::int64_t>();
+      break;
+   case Token::ValueType::Double:
+      entry.doubleValue = token.getValue<double>();
+      break;
+   case Token::ValueType::String:
+   {
+      StringRef value = token.getStringValue();
+      entry.stringRange.offset = static_cast<std::uint32_t>(m_stringPool.size());
+      entry.stringRange.length = static_cast<std::uint32_t>(value.size());
+      m_stringPool.append(value.data(), value.size());
+      break;
+   }
+   case Token::ValueType::Unknown:
+      return;
+   }
+   m_values.push_back(entry);
+}
+
+void TokenBuffer::reserve(size_t tokenCount)
+{
+   m_kinds.reserve(tokenCount);
+   m_offsets.reserve(tokenCount);
+   m_lengths.reserve(tokenCount);
+   m_flags.reserve(tokenCount);
+}
+
+void TokenBuffer::clear()
+{
+   m_kinds.clear();
+   m_offsets.clear();
+   m_lengths.clear();
+   m_flags.clear();
+   m_values.clear();
+   m_stringPool.clear();
+   m_comments.clear();
+}
+
+unsigned TokenBuffer::getCommentLength(size_t index) const
+{
+   auto iter = std::lower_bound(m_comments.begin(), m_comments.end(), index,
+                                [](const CommentEntry &entry, size_t index) {
+      return entry.tokenIndex < index;
+   });
+   if (iter == m_comments.end() || iter->tokenIndex != index) {
+      return 0;
+   }
+   return iter->length;
+}
+
+const TokenBuffer::ValueEntry *TokenBuffer::findValue(size_t index) const
+{
+   auto iter = std::lower_bound(m_values.begin(), m_values.end(), index,
+                                [](const ValueEntry &entry, size_t index) {
+      return entry.tokenIndex < index;
+   });
+   if (iter == m_values.end() || iter->tokenIndex != index) {
+      return nullptr;
+   }
+   return &*iter;
+}
+
+Token::ValueType TokenBuffer::getValueType(size_t index) const
+{
+   if (m_flags[index] & StringValueIsText) {
+      return Token::ValueType::String;
+   }
+   const ValueEntry *entry = findValue(index);
+   return entry ? entry->type : Token::ValueType::Unknown;
+}
+
+std::int64_t TokenBuffer::getLongLongValue(size_t index) const
+{
+   const ValueEntry *entry = findValue(index);
+   assert(entry && entry->type == Token::ValueType::LongLong && "token has no integer value");
+   return entry->longValue;
+}
+
+double TokenBuffer::getDoubleValue(size_t index) const
+{
+   const ValueEntry *entry = findValue(index);
+   assert(entry && entry->type == Token::ValueType::Double && "token has no double value");
+   return entry->doubleValue;
+}
+
+StringRef TokenBuffer::getStringValue(size_t index) const
+{
+   std::uint8_t flags = m_flags[index];
+   if (flags & StringValueIsText) {
+      StringRef text = getText(index);
+      if (flags & StringValueSkipsFirst) {
+         text = text.drop_front(1);
+      }
+      if (flags & StringValueSkipsLast) {
+         text = text.drop_back(1);
+      }
+      return text;
+   }
+   const ValueEntry *entry = findValue(index);
+   assert(entry && entry->type == Token::ValueType::String && "token has no string value");
+   return StringRef(m_stringPool.data() + entry->stringRange.offset, entry->stringRange.length);
+}
+
+Token TokenBuffer::getToken(size_t index) const
+{
+   Token token(getKind(index), getText(index), getCommentLength(index));
+   token.setFlags(getFlags(index));
+   if (m_flags[index] & StringValueIsText) {
+      token.setValue(getStringValue(index));
+   } else if (const ValueEntry *entry = findValue(index)) {
+      switch (entry->type) {
+      case Token::ValueType::LongLong:
+         token.setValue(entry->longValue);
+         break;
+      case Token::ValueType::Double:
+         token.setValue(entry->doubleValue);
+         break;
+      case Token::ValueType::String:
+         token.setValue(getStringValue(index));
+         break;
+      case Token::ValueType::Unknown:
+         break;
+      }
+   }
+   return token;
+}
+
+size_t TokenBuffer::lowerBound(unsigned offset) const
+{
+   return std::lower_bound(m_offsets.begin(), m_offsets.end(), offset) - m_offsets.begin();
+}
+
+size_t TokenBuffer::lowerBound(SourceLoc loc) const
+{
+   const char *ptr = static_cast<const char *>(loc.getOpaquePointerValue());
+   if (ptr <= m_bufferText.data()) {
+      return 0;
+   }
+   return lowerBound(static_cast<unsigned>(ptr - m_bufferText.data()));
+}
+
+size_t TokenBuffer::getMemoryUsage() const
+{
+   return m_kinds.capacity() * sizeof(std::uint16_t) +
+         m_offsets.capacity() * sizeof(std::uint32_t) +
+         m_lengths.capacity() * sizeof(std::uint32_t) +
+         m_flags.capacity() * sizeof(std::uint8_t) +
+         m_values.capacity() * sizeof(ValueEntry) +
+         m_stringPool.capacity() +
+         m_comments.capacity() * sizeof(CommentEntry);
+}
+
+void TokenBuffer::shrinkToFit()
+{
+   m_kinds.shrink_to_fit();
+   m_offsets.shrink_to_fit();
+   m_lengths.shrink_to_fit();
+   m_flags.shrink_to_fit();
+   m_values.shrink_to_fit();
+   m_stringPool.shrink_to_fit();
+   m_comments.shrink_to_fit();
+}
+
+TokenBuffer tokenize_to_buffer(const LangOptions &langOpts,
+                               const SourceManager &sourceMgr, unsigned bufferId,
+                               unsigned offset, unsigned endOffset,
+                               DiagnosticEngine *diags,
+                               bool keepComments)
+{
+   TokenBuffer tokens(sourceMgr.getEntireTextForBuffer(bufferId));
+   tokenize(langOpts, sourceMgr, bufferId, offset, endOffset,
+            diags,
+            keepComments ? CommentRetentionMode::ReturnAsTokens
+                         : CommentRetentionMode::AttachToNextToken,
+            TriviaRetentionMode::WithoutTrivia,
+            [&](const Lexer &lexer, const Token &token, const ParsedTrivia &leadingTrivia,
+            const ParsedTrivia &trailingTrivia) {
+      if (token.isNot(TokenKindType::END)) {
+         tokens.append(token);
+      }
+   });
+   tokens.shrinkToFit();
+   return tokens;
+}
+
+} // polar::parser
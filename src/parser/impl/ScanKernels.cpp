@@ -0,0 +1,425 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/02.
+
+#include "polarphp/parser/internal/ScanKernels.h"
+#include "polarphp/utils/MathExtras.h"
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define POLAR_SCAN_HAS_SSE2 1
+#else
+# define POLAR_SCAN_HAS_SSE2 0
+#endif
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+# define POLAR_SCAN_HAS_AVX2 1
+#else
+# define POLAR_SCAN_HAS_AVX2 0
+#endif
+
+namespace polar::parser::internal {
+
+using polar::utils::count_trailing_zeros;
+using polar::utils::ZB_Undefined;
+
+namespace {
+
+std::atomic<bool> sg_vectorScanEnabled{true};
+
+/// Thin wrappers over the intrinsics so every kernel is written once and
+/// instantiated for each vector width we can use.
+#if POLAR_SCAN_HAS_SSE2
+struct Sse2Vector
+{
+   using VectorType = __m128i;
+   using MaskType = uint32_t;
+   static constexpr std::ptrdiff_t width = 16;
+
+   static VectorType load(const unsigned char *ptr)
+   {
+      return _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+   }
+
+   static VectorType splat(unsigned char ch)
+   {
+      return _mm_set1_epi8(static_cast<char>(ch));
+   }
+
+   static MaskType equal(VectorType lhs, VectorType rhs)
+   {
+      return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(lhs, rhs)));
+   }
+
+   /// bytes with the high bit set, i.e. the non ascii ones
+   static MaskType high(VectorType value)
+   {
+      return static_cast<uint32_t>(_mm_movemask_epi8(value));
+   }
+
+   static VectorType bitOr(VectorType lhs, VectorType rhs)
+   {
+      return _mm_or_si128(lhs, rhs);
+   }
+
+   static MaskType all()
+   {
+      return 0xFFFFu;
+   }
+};
+#endif
+
+#if POLAR_SCAN_HAS_AVX2
+struct Avx2Vector
+{
+   using VectorType = __m256i;
+   using MaskType = uint32_t;
+   static constexpr std::ptrdiff_t width = 32;
+
+   static VectorType load(const unsigned char *ptr)
+   {
+      return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(ptr));
+   }
+
+   static VectorType splat(unsigned char ch)
+   {
+      return _mm256_set1_epi8(static_cast<char>(ch));
+   }
+
+   static MaskType equal(VectorType lhs, VectorType rhs)
+   {
+      return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhs, rhs)));
+   }
+
+   static MaskType high(VectorType value)
+   {
+      return static_cast<uint32_t>(_mm256_movemask_epi8(value));
+   }
+
+   static VectorType bitOr(VectorType lhs, VectorType rhs)
+   {
+      return _mm256_or_si256(lhs, rhs);
+   }
+
+   static MaskType all()
+   {
+      return 0xFFFFFFFFu;
+   }
+};
+#endif
+
+template <typename V>
+const unsigned char *vector_skip_byte_run(const unsigned char *cur, const unsigned char *end,
+                                          unsigned char ch)
+{
+   const typename V::VectorType needle = V::splat(ch);
+   while (end - cur >= V::width) {
+      typename V::MaskType mask = ~V::equal(V::load(cur), needle) & V::all();
+      if (mask != 0) {
+         return cur + count_trailing_zeros(mask, ZB_Undefined);
+      }
+      cur += V::width;
+   }
+   return cur;
+}
+
+template <typename V>
+const unsigned char *vector_find_line_comment_stop(const unsigned char *cur, const unsigned char *end,
+                                                   bool stopAtNonAscii)
+{
+   const typename V::VectorType lf = V::splat('\n');
+   const typename V::VectorType cr = V::splat('\r');
+   const typename V::VectorType nul = V::splat(0);
+   while (end - cur >= V::width) {
+      typename V::VectorType chunk = V::load(cur);
+      typename V::MaskType mask = V::equal(chunk, lf) | V::equal(chunk, cr) | V::equal(chunk, nul);
+      if (stopAtNonAscii) {
+         mask |= V::high(chunk);
+      }
+      if (mask != 0) {
+         return cur + count_trailing_zeros(mask, ZB_Undefined);
+      }
+      cur += V::width;
+   }
+   return cur;
+}
+
+template <typename V>
+const unsigned char *vector_find_block_comment_stop(const unsigned char *cur, const unsigned char *end,
+                                                    bool stopAtNonAscii, bool &sawNewline)
+{
+   const typename V::VectorType slash = V::splat('/');
+   const typename V::VectorType nul = V::splat(0);
+   const typename V::VectorType lf = V::splat('\n');
+   const typename V::VectorType cr = V::splat('\r');
+   while (end - cur >= V::width) {
+      typename V::VectorType chunk = V::load(cur);
+      typename V::MaskType mask = V::equal(chunk, slash) | V::equal(chunk, nul);
+      if (stopAtNonAscii) {
+         mask |= V::high(chunk);
+      }
+      typename V::MaskType newlines = V::equal(chunk, lf) | V::equal(chunk, cr);
+      if (mask != 0) {
+         // only newlines in front of the stop byte belong to the skipped part
+         typename V::MaskType before = (mask & (0 - mask)) - 1;
+         if (newlines & before) {
+            sawNewline = true;
+         }
+         return cur + count_trailing_zeros(mask, ZB_Undefined);
+      }
+      if (newlines != 0) {
+         sawNewline = true;
+      }
+      cur += V::width;
+   }
+   return cur;
+}
+
+template <typename V>
+const unsigned char *vector_find_heredoc_body_stop(const unsigned char *cur, const unsigned char *end,
+                                                   bool interpolating)
+{
+   const typename V::VectorType lf = V::splat('\n');
+   const typename V::VectorType cr = V::splat('\r');
+   const typename V::VectorType dollar = V::splat('$');
+   const typename V::VectorType brace = V::splat('{');
+   const typename V::VectorType backslash = V::splat('\\');
+   while (end - cur >= V::width) {
+      typename V::VectorType chunk = V::load(cur);
+      typename V::MaskType mask = V::equal(chunk, lf) | V::equal(chunk, cr);
+      if (interpolating) {
+         mask |= V::equal(chunk, dollar) | V::equal(chunk, brace) | V::equal(chunk, backslash);
+      }
+      if (mask != 0) {
+         return cur + count_trailing_zeros(mask, ZB_Undefined);
+      }
+      cur += V::width;
+   }
+   return cur;
+}
+
+template <typename V>
+const unsigned char *vector_find_interpolated_string_stop(const unsigned char *cur, const unsigned char *end,
+                                                          unsigned char quote)
+{
+   const typename V::VectorType closing = V::splat(quote);
+   const typename V::VectorType dollar = V::splat('$');
+   const typename V::VectorType brace = V::splat('{');
+   const typename V::VectorType backslash = V::splat('\\');
+   while (end - cur >= V::width) {
+      typename V::VectorType chunk = V::load(cur);
+      typename V::MaskType mask = V::equal(chunk, closing) | V::equal(chunk, dollar) |
+            V::equal(chunk, brace) | V::equal(chunk, backslash);
+      if (mask != 0) {
+         return cur + count_trailing_zeros(mask, ZB_Undefined);
+      }
+      cur += V::width;
+   }
+   return cur;
+}
+
+template <typename V>
+const unsigned char *vector_find_non_ascii(const unsigned char *cur, const unsigned char *end)
+{
+   // ascii text is the common case, look at four vectors per round before
+   // finding the exact byte
+   while (end - cur >= 4 * V::width) {
+      typename V::VectorType chunk = V::bitOr(V::bitOr(V::load(cur), V::load(cur + V::width)),
+                                              V::bitOr(V::load(cur + 2 * V::width),
+                                                       V::load(cur + 3 * V::width)));
+      if (V::high(chunk) != 0) {
+         break;
+      }
+      cur += 4 * V::width;
+   }
+   while (end - cur >= V::width) {
+      typename V::MaskType mask = V::high(V::load(cur));
+      if (mask != 0) {
+         return cur + count_trailing_zeros(mask, ZB_Undefined);
+      }
+      cur += V::width;
+   }
+   return cur;
+}
+
+} // anonymous namespace
+
+void set_vector_scan_enabled(bool enabled)
+{
+   sg_vectorScanEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_vector_scan_enabled()
+{
+   return sg_vectorScanEnabled.load(std::memory_order_relaxed);
+}
+
+const unsigned char *skip_byte_run_scalar(const unsigned char *cur, const unsigned char *end,
+                                          unsigned char ch)
+{
+   while (cur < end && *cur == ch) {
+      ++cur;
+   }
+   return cur;
+}
+
+const unsigned char *skip_byte_run(const unsigned char *cur, const unsigned char *end,
+                                   unsigned char ch)
+{
+   if (!is_vector_scan_enabled()) {
+      return skip_byte_run_scalar(cur, end, ch);
+   }
+   // most runs in real code are short (a single separating space), don't pay
+   // for the vector setup until the run is known to be at least two bytes
+   if (cur == end || *cur != ch) {
+      return cur;
+   }
+#if POLAR_SCAN_HAS_AVX2
+   cur = vector_skip_byte_run<Avx2Vector>(cur, end, ch);
+#endif
+#if POLAR_SCAN_HAS_SSE2
+   cur = vector_skip_byte_run<Sse2Vector>(cur, end, ch);
+#endif
+   return skip_byte_run_scalar(cur, end, ch);
+}
+
+const unsigned char *find_line_comment_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                   bool stopAtNonAscii)
+{
+   for (; cur < end; ++cur) {
+      unsigned char c = *cur;
+      if (c == '\n' || c == '\r' || c == 0 || (stopAtNonAscii && c >= 0x80)) {
+         break;
+      }
+   }
+   return cur;
+}
+
+const unsigned char *find_line_comment_stop(const unsigned char *cur, const unsigned char *end,
+                                            bool stopAtNonAscii)
+{
+   if (is_vector_scan_enabled()) {
+#if POLAR_SCAN_HAS_AVX2
+      cur = vector_find_line_comment_stop<Avx2Vector>(cur, end, stopAtNonAscii);
+#endif
+#if POLAR_SCAN_HAS_SSE2
+      cur = vector_find_line_comment_stop<Sse2Vector>(cur, end, stopAtNonAscii);
+#endif
+   }
+   return find_line_comment_stop_scalar(cur, end, stopAtNonAscii);
+}
+
+const unsigned char *find_block_comment_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                    bool stopAtNonAscii, bool &sawNewline)
+{
+   for (; cur < end; ++cur) {
+      unsigned char c = *cur;
+      if (c == '/' || c == 0 || (stopAtNonAscii && c >= 0x80)) {
+         break;
+      }
+      if (c == '\n' || c == '\r') {
+         sawNewline = true;
+      }
+   }
+   return cur;
+}
+
+const unsigned char *find_block_comment_stop(const unsigned char *cur, const unsigned char *end,
+                                             bool stopAtNonAscii, bool &sawNewline)
+{
+   if (is_vector_scan_enabled()) {
+#if POLAR_SCAN_HAS_AVX2
+      cur = vector_find_block_comment_stop<Avx2Vector>(cur, end, stopAtNonAscii, sawNewline);
+#endif
+#if POLAR_SCAN_HAS_SSE2
+      cur = vector_find_block_comment_stop<Sse2Vector>(cur, end, stopAtNonAscii, sawNewline);
+#endif
+   }
+   return find_block_comment_stop_scalar(cur, end, stopAtNonAscii, sawNewline);
+}
+
+const unsigned char *find_heredoc_body_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                   bool interpolating)
+{
+   for (; cur < end; ++cur) {
+      unsigned char c = *cur;
+      if (c == '\n' || c == '\r' || (interpolating && (c == '$' || c == '{' || c == '\\'))) {
+         break;
+      }
+   }
+   return cur;
+}
+
+const unsigned char *find_heredoc_body_stop(const unsigned char *cur, const unsigned char *end,
+                                            bool interpolating)
+{
+   if (is_vector_scan_enabled()) {
+#if POLAR_SCAN_HAS_AVX2
+      cur = vector_find_heredoc_body_stop<Avx2Vector>(cur, end, interpolating);
+#endif
+#if POLAR_SCAN_HAS_SSE2
+      cur = vector_find_heredoc_body_stop<Sse2Vector>(cur, end, interpolating);
+#endif
+   }
+   return find_heredoc_body_stop_scalar(cur, end, interpolating);
+}
+
+const unsigned char *find_interpolated_string_stop_scalar(const unsigned char *cur, const unsigned char *end,
+                                                          unsigned char quote)
+{
+   for (; cur < end; ++cur) {
+      unsigned char c = *cur;
+      if (c == quote || c == '$' || c == '{' || c == '\\') {
+         break;
+      }
+   }
+   return cur;
+}
+
+const unsigned char *find_interpolated_string_stop(const unsigned char *cur, const unsigned char *end,
+                                                   unsigned char quote)
+{
+   if (is_vector_scan_enabled()) {
+#if POLAR_SCAN_HAS_AVX2
+      cur = vector_find_interpolated_string_stop<Avx2Vector>(cur, end, quote);
+#endif
+#if POLAR_SCAN_HAS_SSE2
+      cur = vector_find_interpolated_string_stop<Sse2Vector>(cur, end, quote);
+#endif
+   }
+   return find_interpolated_string_stop_scalar(cur, end, quote);
+}
+
+const unsigned char *find_non_ascii_scalar(const unsigned char *cur, const unsigned char *end)
+{
+   while (cur < end && *cur < 0x80) {
+      ++cur;
+   }
+   return cur;
+}
+
+const unsigned char *find_non_ascii(const unsigned char *cur, const unsigned char *end)
+{
+   if (is_vector_scan_enabled()) {
+#if POLAR_SCAN_HAS_AVX2
+      cur = vector_find_non_ascii<Avx2Vector>(cur, end);
+#endif
+#if POLAR_SCAN_HAS_SSE2
+      cur = vector_find_non_ascii<Sse2Vector>(cur, end);
+#endif
+   }
+   return find_non_ascii_scalar(cur, end);
+}
+
+} // polar::parser::internal
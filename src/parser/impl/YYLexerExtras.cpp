@@ -10,12 +10,16 @@
 // Created by polarboy on 2019/06/06.
 
 #include "polarphp/parser/internal/YYLexerExtras.h"
+#include "polarphp/parser/internal/IdentifierCharTables.h"
+#include "polarphp/parser/internal/ScanKernels.h"
 #include "polarphp/parser/internal/YYLexerDefs.h"
 #include "polarphp/basic/CharInfo.h"
 #include "polarphp/parser/Token.h"
 #include "polarphp/parser/Lexer.h"
 #include "polarphp/parser/Parser.h"
 
+#include <atomic>
+#include <cstring>
 #include <string>
 
 namespace polar::parser::internal {
@@ -26,12 +30,28 @@ using namespace polar::basic;
 
 int token_lex_wrapper(ParserSemantic *value, YYLocation *loc, Lexer *lexer, Parser *parser)
 {
-   Token token;
+   SyntaxTreeBuilder &builder = parser->m_treeBuilder;
+   if (parser->m_startingSkippedBody) {
+      // a marker without a node
+      parser->m_startingSkippedBody = false;
+      loc->begin = builder.getTokenCount();
+      loc->end = loc->begin;
+      return TokenKindType::T_FUNCTION_BODY_START;
+   }
    lexer->setSemanticValueContainer(value);
-   lexer->lex(token);
-   // setup values that parser need
-   parser->m_token = token;
-   return token.getKind();
+   // a lexer without trivia retention leaves them alone
+   parser->m_leadingTrivia.clear();
+   parser->m_trailingTrivia.clear();
+   TokenKindType kind = parser->lexToken();
+   // every token is shifted as its token node, the lexer's own semantic
+   // values are folded into the token text. Its location is its index in
+   // the builder's token log. The token is read where the lexer left it,
+   // the parser refers to it through peekToken() until the next one.
+   loc->begin = builder.getTokenCount();
+   loc->end = loc->begin + 1;
+   value->emplace<ParsedNode>(builder.makeToken(kind, parser->peekToken(), parser->m_leadingTrivia,
+                                                parser->m_trailingTrivia));
+   return kind;
 }
 
 size_t count_str_newline(const unsigned char *str, size_t length)
@@ -153,8 +173,17 @@ void diagnose_embedded_null(DiagnosticEngine *diags, const unsigned char *ptr)
 /// Advance \p m_yyCursor to the end of line or the end of file. Returns \c true
 /// if it stopped at the end of line, \c false if it stopped at the end of file.
 bool advance_to_end_of_line(const unsigned char *&m_yyCursor, const unsigned char *bufferEnd,
-                            const unsigned char *codeCompletionPtr, DiagnosticEngine *diags) {
+                            const unsigned char *codeCompletionPtr, DiagnosticEngine *diags,
+                            const unsigned char *validUtf8End) {
    while (1) {
+      // jump to the next byte we have to make a decision on, UTF-8 sequences
+      // only need a look when there is someone to diagnose them and they
+      // are not known to be valid
+      if (diags && validUtf8End != nullptr && m_yyCursor < validUtf8End) {
+         m_yyCursor = find_line_comment_stop(m_yyCursor, validUtf8End, false);
+      } else {
+         m_yyCursor = find_line_comment_stop(m_yyCursor, bufferEnd, diags != nullptr);
+      }
       switch (*m_yyCursor++) {
       case '\n':
       case '\r':
@@ -189,7 +218,8 @@ bool advance_to_end_of_line(const unsigned char *&m_yyCursor, const unsigned cha
 }
 
 bool skip_to_end_of_slash_star_comment(const unsigned char *&m_yyCursor, const unsigned char *bufferEnd,
-                                       const unsigned char *codeCompletionPtr, DiagnosticEngine *diags)
+                                       const unsigned char *codeCompletionPtr, DiagnosticEngine *diags,
+                                       const unsigned char *validUtf8End)
 {
    const unsigned char *startPtr = m_yyCursor - 1;
    assert(m_yyCursor[-1] == '/' && m_yyCursor[0] == '*' && "Not a /* comment");
@@ -200,30 +230,37 @@ bool skip_to_end_of_slash_star_comment(const unsigned char *&m_yyCursor, const u
    // /**/ comments can be nested, keep track of how deep we've gone.
    unsigned depth = 1;
    bool isMultiline = false;
+   // Every '/*' and '*/' contains a '/', so we only stop on slashes and look
+   // one byte back for the '*' of a close marker. A '*' in front of markerEnd
+   // already belongs to an open marker, so /*/ doesn't close itself.
+   const unsigned char *markerEnd = m_yyCursor;
 
    while (1) {
+      if (diags && validUtf8End != nullptr && m_yyCursor < validUtf8End) {
+         m_yyCursor = find_block_comment_stop(m_yyCursor, validUtf8End, false, isMultiline);
+      } else {
+         m_yyCursor = find_block_comment_stop(m_yyCursor, bufferEnd, diags != nullptr, isMultiline);
+      }
       switch (*m_yyCursor++) {
-      case '*':
-         // Check for a '*/'
-         if (*m_yyCursor == '/') {
-            ++m_yyCursor;
+      case '/':
+         if (m_yyCursor - 2 >= markerEnd && m_yyCursor[-2] == '*') {
+            // Found a '*/'
+            markerEnd = m_yyCursor;
             if (--depth == 0)
                return isMultiline;
-         }
-         break;
-      case '/':
-         // Check for a '/*'
-         if (*m_yyCursor == '*') {
+         } else if (*m_yyCursor == '*') {
+            // Found a '/*'
             ++m_yyCursor;
+            markerEnd = m_yyCursor;
             ++depth;
          }
          break;
-
       case '\n':
       case '\r':
+         // the kernel only stops on a newline at the end of the known valid
+         // UTF-8
          isMultiline = true;
          break;
-
       default:
          // If this is a "high" UTF-8 character, validate it.
          if (diags && (signed char)(m_yyCursor[-1]) < 0) {
@@ -267,85 +304,34 @@ bool skip_to_end_of_slash_star_comment(const unsigned char *&m_yyCursor, const u
 
 bool is_valid_identifier_continuation_code_point(uint32_t c)
 {
-   if (c < 0x80) {
-      return polar::basic::is_identifier_body(c, true);
-   }
-   // N1518: Recommendations for extended identifier characters for C and C++
-   // Proposed Annex X.1: Ranges of characters allowed
-   return c == 0x00A8 || c == 0x00AA || c == 0x00AD || c == 0x00AF
-         || (c >= 0x00B2 && c <= 0x00B5) || (c >= 0x00B7 && c <= 0x00BA)
-         || (c >= 0x00BC && c <= 0x00BE) || (c >= 0x00C0 && c <= 0x00D6)
-         || (c >= 0x00D8 && c <= 0x00F6) || (c >= 0x00F8 && c <= 0x00FF)
-
-         || (c >= 0x0100 && c <= 0x167F)
-         || (c >= 0x1681 && c <= 0x180D)
-         || (c >= 0x180F && c <= 0x1FFF)
-
-         || (c >= 0x200B && c <= 0x200D)
-         || (c >= 0x202A && c <= 0x202E)
-         || (c >= 0x203F && c <= 0x2040)
-         || c == 0x2054
-         || (c >= 0x2060 && c <= 0x206F)
-
-         || (c >= 0x2070 && c <= 0x218F)
-         || (c >= 0x2460 && c <= 0x24FF)
-         || (c >= 0x2776 && c <= 0x2793)
-         || (c >= 0x2C00 && c <= 0x2DFF)
-         || (c >= 0x2E80 && c <= 0x2FFF)
-
-         || (c >= 0x3004 && c <= 0x3007)
-         || (c >= 0x3021 && c <= 0x302F)
-         || (c >= 0x3031 && c <= 0x303F)
-
-         || (c >= 0x3040 && c <= 0xD7FF)
-
-         || (c >= 0xF900 && c <= 0xFD3D)
-         || (c >= 0xFD40 && c <= 0xFDCF)
-         || (c >= 0xFDF0 && c <= 0xFE44)
-         || (c >= 0xFE47 && c <= 0xFFF8)
-
-         || (c >= 0x10000 && c <= 0x1FFFD)
-         || (c >= 0x20000 && c <= 0x2FFFD)
-         || (c >= 0x30000 && c <= 0x3FFFD)
-         || (c >= 0x40000 && c <= 0x4FFFD)
-         || (c >= 0x50000 && c <= 0x5FFFD)
-         || (c >= 0x60000 && c <= 0x6FFFD)
-         || (c >= 0x70000 && c <= 0x7FFFD)
-         || (c >= 0x80000 && c <= 0x8FFFD)
-         || (c >= 0x90000 && c <= 0x9FFFD)
-         || (c >= 0xA0000 && c <= 0xAFFFD)
-         || (c >= 0xB0000 && c <= 0xBFFFD)
-         || (c >= 0xC0000 && c <= 0xCFFFD)
-         || (c >= 0xD0000 && c <= 0xDFFFD)
-         || (c >= 0xE0000 && c <= 0xEFFFD);
+   return scg_identifierContinuationTable.contains(c);
 }
 
 bool is_valid_identifier_start_code_point(uint32_t c)
 {
-   if (!is_valid_identifier_continuation_code_point(c)) {
-      return false;
-   }
+   return scg_identifierStartTable.contains(c);
+}
 
-   if (c < 0x80 && (is_digit(static_cast<unsigned char>(c)) || c == '$')) {
-      return false;
+uint32_t decode_valid_utf8_character_and_advance(const unsigned char *&ptr)
+{
+   unsigned char curByte = *ptr++;
+   if (curByte < 0x80) {
+      return curByte;
    }
-
-   // N1518: Recommendations for extended identifier characters for C and C++
-   // Proposed Annex X.2: Ranges of characters disallowed initially
-   if ((c >= 0x0300 && c <= 0x036F) ||
-       (c >= 0x1DC0 && c <= 0x1DFF) ||
-       (c >= 0x20D0 && c <= 0x20FF) ||
-       (c >= 0xFE20 && c <= 0xFE2F)) {
-      return false;
+   unsigned encodedBytes = count_leading_ones(curByte);
+   uint32_t c = (unsigned char)(curByte << encodedBytes) >> encodedBytes;
+   for (unsigned i = 1; i != encodedBytes; ++i) {
+      c = (c << 6) | (*ptr++ & 0x3F);
    }
-   return true;
+   return c;
 }
 
 bool advance_if(const unsigned char *&ptr, const unsigned char *end,
-                bool (*predicate)(uint32_t))
+                bool (*predicate)(uint32_t), const unsigned char *validUtf8End)
 {
    const unsigned char *next = ptr;
-   uint32_t c = validate_utf8_character_and_advance(next, end);
+   uint32_t c = is_in_valid_utf8(next, validUtf8End) ? decode_valid_utf8_character_and_advance(next)
+                                                     : validate_utf8_character_and_advance(next, end);
    if (c == ~0U) {
       return false;
    }
@@ -357,15 +343,17 @@ bool advance_if(const unsigned char *&ptr, const unsigned char *end,
 }
 
 bool advance_if_valid_start_of_identifier(const unsigned char *&ptr,
-                                          const unsigned char *end)
+                                          const unsigned char *end,
+                                          const unsigned char *validUtf8End)
 {
-   return advance_if(ptr, end, is_valid_identifier_start_code_point);
+   return advance_if(ptr, end, is_valid_identifier_start_code_point, validUtf8End);
 }
 
 bool advance_if_valid_continuation_of_identifier(const unsigned char *&ptr,
-                                                 const unsigned char *end)
+                                                 const unsigned char *end,
+                                                 const unsigned char *validUtf8End)
 {
-   return advance_if(ptr, end, is_valid_identifier_continuation_code_point);
+   return advance_if(ptr, end, is_valid_identifier_continuation_code_point, validUtf8End);
 }
 
 bool advance_if_valid_start_of_operator(const unsigned char *&ptr,
@@ -396,22 +384,33 @@ const char *next_newline(const char *str, const char *end, size_t &newlineLen)
    return nullptr;
 }
 
-bool strip_multiline_string_indentation(Lexer &lexer, std::string &str, int indentation, bool usingSpaces,
-                                        bool newlineAtStart, bool newlineAtEnd)
+bool strip_multiline_string_indentation(Lexer &lexer, const char *cursor, const char *end,
+                                        ArrayRef<const char *> lineEnds, char *dest, size_t &length,
+                                        int indentation, bool usingSpaces, bool newlineAtStart,
+                                        bool newlineAtEnd, bool decodeEscapes)
 {
-   const char *cursor = str.data();
-   const char *end = cursor + str.size();
-   char *copy = str.data();
+   char *copy = dest;
    int newLineCount = 0;
-   size_t newlineLen;
    const char *newLine;
+   const char *const *nextLineEnd = lineEnds.begin();
+   auto copyLine = [&copy, decodeEscapes](const char *from, size_t len) {
+      if (decodeEscapes) {
+         copy += decode_escape_sequences(from, from + len, 0, copy);
+      } else {
+         std::memmove(copy, from, len);
+         copy += len;
+      }
+   };
    if (!newlineAtStart) {
-      newLine = next_newline(cursor, end, newlineLen);
+      /// the first line continues a line that was already checked
+      newLine = nextLineEnd != lineEnds.end() ? *nextLineEnd++ : nullptr;
+      size_t len = newLine ? (newLine + 1 - cursor) : (end - cursor);
+      copyLine(cursor, len);
+      cursor += len;
       if (nullptr == newLine) {
+         length = copy - dest;
          return true;
       }
-      cursor = newLine + newlineLen;
-      copy = const_cast<char *>(newLine) + newlineLen;
       ++newLineCount;
    } else {
       newLine = cursor;
@@ -419,7 +418,8 @@ bool strip_multiline_string_indentation(Lexer &lexer, std::string &str, int inde
    // intentional
    while (cursor <= end && newLine) {
       int skip;
-      newLine = next_newline(cursor, end, newlineLen);
+      newLine = nextLineEnd != lineEnds.end() ? *nextLineEnd++ : nullptr;
+      size_t newlineLen = newLine ? 1 : 0;
       if (nullptr == newLine && newlineAtEnd) {
          newLine = end;
       }
@@ -445,12 +445,11 @@ bool strip_multiline_string_indentation(Lexer &lexer, std::string &str, int inde
          break;
       }
       size_t len = newLine ? (newLine - cursor + newlineLen) : (end - cursor);
-      std::memmove(copy, cursor, len);
+      copyLine(cursor, len);
       cursor += len;
-      copy += len;
       ++newLineCount;
    }
-   str.resize(copy - str.data());
+   length = copy - dest;
    return true;
 }
 
@@ -592,160 +591,158 @@ bool convert_double_quote_str_escape_sequences(std::string &filteredStr, char qu
    /// convert escape sequences
    auto fiter = filteredStr.begin();
    auto fendMark = filteredStr.end();
-   /// find first '\'
-   while (true) {
-      if (*fiter == '\\') {
-         break;
+   auto targetIter = fiter;
+   while (fiter != fendMark) {
+      /// the text between escapes is moved down in one piece
+      const char *run = &*fiter;
+      const char *slash = static_cast<const char *>(std::memchr(run, '\\', fendMark - fiter));
+      size_t runLength = slash ? slash - run : fendMark - fiter;
+      handle_newlines(lexer, reinterpret_cast<const unsigned char *>(run), runLength);
+      if (targetIter != fiter) {
+         std::memmove(&*targetIter, run, runLength);
       }
-      if (*iter == '\n' || (*fiter == '\r' && (*(fiter + 1) != '\n'))) {
-         lexer.incLineNumber();
+      targetIter += runLength;
+      fiter += runLength;
+      if (fiter == fendMark) {
+         break;
       }
       ++fiter;
       if (fiter == fendMark) {
-         return true;
+         *targetIter++ = '\\';
+         break;
       }
-   }
-   auto targetIter = fiter;
-   while (fiter != fendMark) {
-      if (*fiter == '\\') {
-         ++fiter;
-         if (fiter == fendMark) {
+      switch (*fiter) {
+      case 'n':
+         *targetIter++ = '\n';
+         break;
+      case 'r':
+         *targetIter++ = '\r';
+         break;
+      case 't':
+         *targetIter++ = '\t';
+         break;
+      case 'f':
+         *targetIter++ = '\f';
+         break;
+      case 'v':
+         *targetIter++ = '\v';
+         break;
+//      case 'e':
+//         *targetIter++ = '\e';
+//         break;
+      case '"':
+      case '`':
+         if (*fiter != quoteType) {
             *targetIter++ = '\\';
-            break;
-         }
-         switch (*fiter) {
-         case 'n':
-            *targetIter++ = '\n';
-            break;
-         case 'r':
-            *targetIter++ = '\r';
-            break;
-         case 't':
-            *targetIter++ = '\t';
-            break;
-         case 'f':
-            *targetIter++ = '\f';
-            break;
-         case 'v':
-            *targetIter++ = '\v';
-            break;
-//         case 'e':
-//            *targetIter++ = '\e';
-//            break;
-         case '"':
-         case '`':
-            if (*fiter != quoteType) {
-               *targetIter++ = '\\';
-               *targetIter++ = *fiter;
-               break;
-            }
-            [[fallthrough]];
-         case '\\':
-         case '$':
             *targetIter++ = *fiter;
             break;
-         case 'x':
-         case 'X':
+         }
+         [[fallthrough]];
+      case '\\':
+      case '$':
+         *targetIter++ = *fiter;
+         break;
+      case 'x':
+      case 'X':
+         if (is_hex_digit(*(fiter + 1))) {
+            char hexBuf[3] = { 0, 0, 0 };
+            hexBuf[0] = *(++fiter);
             if (is_hex_digit(*(fiter + 1))) {
-               char hexBuf[3] = { 0, 0, 0 };
-               hexBuf[0] = *(++fiter);
-               if (is_hex_digit(*(fiter + 1))) {
-                  hexBuf[1] = *(++fiter);
-               }
-               *targetIter++ = static_cast<char>(std::strtol(hexBuf, nullptr, 16));
-            } else {
-               *targetIter++ = '\\';
-               *targetIter++ = *fiter;
+               hexBuf[1] = *(++fiter);
             }
+            *targetIter++ = static_cast<char>(std::strtol(hexBuf, nullptr, 16));
+         } else {
+            *targetIter++ = '\\';
+            *targetIter++ = *fiter;
+         }
+         break;
+         /* UTF-8 codepoint escape, format: /\\u\{\x+\}/ */
+      case 'u':
+      {
+         /// cache where we started so we can parse after validating
+         auto start = fiter + 1;
+         size_t length = 0;
+         bool valid = true;
+         unsigned long codePoint;
+         if (*start != '{') {
+            /// we silently let this pass to avoid breaking code
+            /// with JSON in string literals (e.g. "\"\u202e\""
+            *targetIter++ = '\\';
+            *targetIter++ = 'u';
             break;
-            /* UTF-8 codepoint escape, format: /\\u\{\x+\}/ */
-         case 'u':
-         {
-            /// cache where we started so we can parse after validating
-            auto start = fiter + 1;
-            size_t length = 0;
-            bool valid = true;
-            unsigned long codePoint;
-            if (*start != '{') {
-               /// we silently let this pass to avoid breaking code
-               /// with JSON in string literals (e.g. "\"\u202e\""
-               *targetIter++ = '\\';
-               *targetIter++ = 'u';
-               break;
-            } else {
-               /// on the other hand, invalid \u{blah} errors
-               fiter += 2;
-               ++length;
-               while (*fiter != '}') {
-                  if (!is_hex_digit(*fiter)) {
-                     valid = false;
-                     break;
-                  } else {
-                     ++length;
-                  }
-               }
-               if (*fiter == '}') {
-                  valid = true;
+         } else {
+            /// on the other hand, invalid \u{blah} errors
+            fiter += 2;
+            ++length;
+            while (*fiter != '}') {
+               if (!is_hex_digit(*fiter)) {
+                  valid = false;
+                  break;
+               } else {
                   ++length;
                }
+               ++fiter;
             }
-            /* \u{} is invalid */
-            if (length <= 2) {
-               valid = false;
-            }
-            if (!valid) {
-               lexer.notifyLexicalException("Invalid UTF-8 codepoint escape sequence", 0);
-               return false;
-            }
-            errno = 0;
-            StringRef codePointStr(filteredStr.data() + (start - filteredStr.begin()), fiter - start);
-            codePoint = strtoul(codePointStr.getData(), nullptr, 16);
-            /// per RFC 3629, UTF-8 can only represent 21 bits
-            if (codePoint > 0x10FFFF || errno) {
-               lexer.notifyLexicalException("Invalid UTF-8 codepoint escape sequence: Codepoint too large", 0);
-               return false;
-            }
-            /// based on https://en.wikipedia.org/wiki/UTF-8#Sample_code
-            if (codePoint < 0x80) {
-               *targetIter++ = codePoint;
-            } else if (codePoint <= 0x7FF) {
-               *targetIter++ = (codePoint >> 6) + 0xC0;
-               *targetIter++ = (codePoint & 0x3F) + 0x80;
-            } else if (codePoint <= 0xFFFF) {
-               *targetIter++ = (codePoint >> 12) + 0xE0;
-               *targetIter++ = ((codePoint >> 6) & 0x3F) + 0x80;
-               *targetIter++ = (codePoint & 0x3F) + 0x80;
-            } else if (codePoint <= 0x10FFFF) {
-               *targetIter++ = (codePoint >> 18) + 0xF0;
-               *targetIter++ = ((codePoint >> 12) & 0x3F) + 0x80;
-               *targetIter++ = ((codePoint >> 6) & 0x3F) + 0x80;
-               *targetIter++ = (codePoint & 0x3F) + 0x80;
+            if (*fiter == '}') {
+               valid = true;
+               ++length;
             }
          }
-            break;
-         default:
-            /// check for an octal
-            if (POLAR_IS_OCT(*fiter)) {
-               char octalBuf[4] = { 0, 0, 0, 0 };
-               octalBuf[0] = *fiter;
+         /* \u{} is invalid */
+         if (length <= 2) {
+            valid = false;
+         }
+         if (!valid) {
+            lexer.notifyLexicalException("Invalid UTF-8 codepoint escape sequence", 0);
+            return false;
+         }
+         errno = 0;
+         /// the digits between the braces
+         StringRef codePointStr(filteredStr.data() + (start + 1 - filteredStr.begin()), fiter - start - 1);
+         codePoint = strtoul(codePointStr.getData(), nullptr, 16);
+         /// per RFC 3629, UTF-8 can only represent 21 bits
+         if (codePoint > 0x10FFFF || errno) {
+            lexer.notifyLexicalException("Invalid UTF-8 codepoint escape sequence: Codepoint too large", 0);
+            return false;
+         }
+         /// based on https://en.wikipedia.org/wiki/UTF-8#Sample_code
+         if (codePoint < 0x80) {
+            *targetIter++ = codePoint;
+         } else if (codePoint <= 0x7FF) {
+            *targetIter++ = (codePoint >> 6) + 0xC0;
+            *targetIter++ = (codePoint & 0x3F) + 0x80;
+         } else if (codePoint <= 0xFFFF) {
+            *targetIter++ = (codePoint >> 12) + 0xE0;
+            *targetIter++ = ((codePoint >> 6) & 0x3F) + 0x80;
+            *targetIter++ = (codePoint & 0x3F) + 0x80;
+         } else if (codePoint <= 0x10FFFF) {
+            *targetIter++ = (codePoint >> 18) + 0xF0;
+            *targetIter++ = ((codePoint >> 12) & 0x3F) + 0x80;
+            *targetIter++ = ((codePoint >> 6) & 0x3F) + 0x80;
+            *targetIter++ = (codePoint & 0x3F) + 0x80;
+         }
+      }
+         break;
+      default:
+         /// check for an octal
+         if (POLAR_IS_OCT(*fiter)) {
+            char octalBuf[4] = { 0, 0, 0, 0 };
+            octalBuf[0] = *fiter;
+            if (POLAR_IS_OCT(*(fiter + 1))) {
+               octalBuf[1] = *(++fiter);
                if (POLAR_IS_OCT(*(fiter + 1))) {
-                  octalBuf[1] = *(++fiter);
-                  if (POLAR_IS_OCT(*(fiter + 1))) {
-                     octalBuf[2] = *(++fiter);
-                  }
-               }
-               if (octalBuf[2] && (octalBuf[0] > '3')) {
-                  lexer.notifyLexicalException(0, "Octal escape sequence overflow \\%s is greater than \\377", octalBuf);
+                  octalBuf[2] = *(++fiter);
                }
-               *targetIter++ = static_cast<char>(std::strtol(octalBuf, nullptr, 8));
-            } else {
-               *targetIter++ = '\\';
-               *targetIter++ = *fiter;
             }
-            break;
+            if (octalBuf[2] && (octalBuf[0] > '3')) {
+               lexer.notifyLexicalException(0, "Octal escape sequence overflow \\%s is greater than \\377", octalBuf);
+            }
+            *targetIter++ = static_cast<char>(std::strtol(octalBuf, nullptr, 8));
+         } else {
+            *targetIter++ = '\\';
+            *targetIter++ = *fiter;
          }
-      } else {
-         *targetIter++ = *fiter;
+         break;
       }
       if (*fiter == '\n' || (*fiter == '\r' && (*(fiter + 1) != '\n'))) {
          lexer.incLineNumber();
@@ -758,6 +755,137 @@ bool convert_double_quote_str_escape_sequences(std::string &filteredStr, char qu
    return true;
 }
 
+namespace {
+std::atomic<bool> sg_lazyEscapeDecodingEnabled{true};
+} // anonymous namespace
+
+void set_lazy_escape_decoding_enabled(bool enabled)
+{
+   sg_lazyEscapeDecodingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool is_lazy_escape_decoding_enabled()
+{
+   return sg_lazyEscapeDecodingEnabled.load(std::memory_order_relaxed);
+}
+
+bool is_checked_escape(const char *iter, const char *endMark)
+{
+   if (*iter == 'u' && iter + 1 < endMark && iter[1] == '{') {
+      /// \u{} may be invalid, it has to be reported while lexing
+      return true;
+   }
+   /// octal overflow is reported while lexing too
+   return *iter > '3' && POLAR_IS_OCT(*iter) && iter + 2 < endMark &&
+         POLAR_IS_OCT(iter[1]) && POLAR_IS_OCT(iter[2]);
+}
+
+bool can_decode_escapes_lazily(const char *iter, const char *endMark)
+{
+   while ((iter = static_cast<const char *>(std::memchr(iter, '\\', endMark - iter))) != nullptr) {
+      if (++iter == endMark) {
+         return true;
+      }
+      if (is_checked_escape(iter, endMark)) {
+         return false;
+      }
+      /// skip the escaped char, so "\\u{" is not taken for a codepoint escape
+      ++iter;
+   }
+   return true;
+}
+
+size_t decode_escape_sequences(const char *iter, const char *endMark, char quoteType, char *dest)
+{
+   char *targetIter = dest;
+   while (iter < endMark) {
+      const char *slash = static_cast<const char *>(std::memchr(iter, '\\', endMark - iter));
+      if (!slash) {
+         slash = endMark;
+      }
+      std::memmove(targetIter, iter, slash - iter);
+      targetIter += slash - iter;
+      iter = slash;
+      if (iter == endMark) {
+         break;
+      }
+      if (++iter == endMark) {
+         *targetIter++ = '\\';
+         break;
+      }
+      if (quoteType == '\'') {
+         if (*iter != '\\' && *iter != '\'') {
+            *targetIter++ = '\\';
+         }
+         *targetIter++ = *iter++;
+         continue;
+      }
+      switch (*iter) {
+      case 'n':
+         *targetIter++ = '\n';
+         break;
+      case 'r':
+         *targetIter++ = '\r';
+         break;
+      case 't':
+         *targetIter++ = '\t';
+         break;
+      case 'f':
+         *targetIter++ = '\f';
+         break;
+      case 'v':
+         *targetIter++ = '\v';
+         break;
+      case '"':
+      case '`':
+         if (*iter != quoteType) {
+            *targetIter++ = '\\';
+            *targetIter++ = *iter;
+            break;
+         }
+         [[fallthrough]];
+      case '\\':
+      case '$':
+         *targetIter++ = *iter;
+         break;
+      case 'x':
+      case 'X':
+         if (iter + 1 < endMark && is_hex_digit(iter[1])) {
+            char hexBuf[3] = { 0, 0, 0 };
+            hexBuf[0] = *(++iter);
+            if (iter + 1 < endMark && is_hex_digit(iter[1])) {
+               hexBuf[1] = *(++iter);
+            }
+            *targetIter++ = static_cast<char>(std::strtol(hexBuf, nullptr, 16));
+         } else {
+            *targetIter++ = '\\';
+            *targetIter++ = *iter;
+         }
+         break;
+      default:
+         if (POLAR_IS_OCT(*iter)) {
+            char octalBuf[4] = { 0, 0, 0, 0 };
+            octalBuf[0] = *iter;
+            if (iter + 1 < endMark && POLAR_IS_OCT(iter[1])) {
+               octalBuf[1] = *(++iter);
+               if (iter + 1 < endMark && POLAR_IS_OCT(iter[1])) {
+                  octalBuf[2] = *(++iter);
+               }
+            }
+            *targetIter++ = static_cast<char>(std::strtol(octalBuf, nullptr, 8));
+         } else {
+            /// including \u without a brace, can_decode_escapes_lazily()
+            /// rejects \u{}
+            *targetIter++ = '\\';
+            *targetIter++ = *iter;
+         }
+         break;
+      }
+      ++iter;
+   }
+   return targetIter - dest;
+}
+
 } // polar::parser::internal
 
 namespace polar::parser {
@@ -10,13 +10,19 @@
 // Created by polarboy on 2019/06/06.
 
 #include "polarphp/parser/internal/YYParserDefs.h"
-#include <iostream>
+#include "polarphp/parser/Parser.h"
 
 namespace polar::parser::internal {
 
 void YYParser::error(const location_type &loc, const std::string &msg)
 {
-   std::cout << msg << std::endl;
+   // the lexer already said what is wrong with its error tokens
+   const Token &token = parser->peekToken();
+   if (token.is(TokenKindType::T_ERROR) && token.hasValue()) {
+      parser->reportSyntaxError(token.getValue<StringRef>());
+      return;
+   }
+   parser->reportSyntaxError(msg);
 }
 
 } // polar::parser::internal
@@ -49,7 +49,48 @@ void print_syntax_kind(SyntaxKind kind, RawOutStream &outStream,
 
 } // anonymous namespace
 
-unsigned RawSyntax::sm_nextFreeNodeId = 1;
+std::atomic<SyntaxNodeId> RawSyntax::sm_nextFreeNodeId{1};
+
+namespace {
+
+/// Node ids are handed out to each thread in blocks, a thread reserves a
+/// block with one atomic add and numbers its nodes from it without any
+/// synchronization.
+constexpr SyntaxNodeId scg_nodeIdBlockSize = 1024;
+
+struct NodeIdBlock
+{
+   SyntaxNodeId next = 0;
+   SyntaxNodeId end = 0;
+};
+
+thread_local NodeIdBlock sg_nodeIdBlock;
+
+} // anonymous namespace
+
+SyntaxNodeId RawSyntax::allocateNodeId()
+{
+   NodeIdBlock &block = sg_nodeIdBlock;
+   if (block.next == block.end) {
+      block.next = sm_nextFreeNodeId.fetch_add(scg_nodeIdBlockSize, std::memory_order_relaxed);
+      block.end = block.next + scg_nodeIdBlockSize;
+   }
+   return block.next++;
+}
+
+void RawSyntax::reserveNodeId(SyntaxNodeId nodeId)
+{
+   // no block reserved later may contain the id
+   SyntaxNodeId nextFree = sm_nextFreeNodeId.load(std::memory_order_relaxed);
+   while (nextFree <= nodeId &&
+          !sm_nextFreeNodeId.compare_exchange_weak(nextFree, nodeId + 1, std::memory_order_relaxed)) {
+   }
+   // neither may the rest of our own block
+   NodeIdBlock &block = sg_nodeIdBlock;
+   if (nodeId >= block.next && nodeId < block.end) {
+      block.next = nodeId + 1;
+   }
+}
 
 RawSyntax::RawSyntax(SyntaxKind kind, ArrayRef<RefCountPtr<RawSyntax>> layout,
                      SourcePresence presence, const RefCountPtr<SyntaxArena> &arena,
@@ -62,9 +103,9 @@ RawSyntax::RawSyntax(SyntaxKind kind, ArrayRef<RefCountPtr<RawSyntax>> layout,
 
    if (nodeId.has_value()) {
       this->m_nodeId = nodeId.value();
-      sm_nextFreeNodeId = std::max(this->m_nodeId + 1, sm_nextFreeNodeId);
+      reserveNodeId(this->m_nodeId);
    } else {
-      this->m_nodeId = sm_nextFreeNodeId++;
+      this->m_nodeId = allocateNodeId();
    }
    m_bits.common.kind = unsigned(kind);
    m_bits.common.presence = unsigned(presence);
@@ -88,9 +129,9 @@ RawSyntax::RawSyntax(TokenKindType tokenKind, OwnedString text,
 
    if (nodeId.has_value()) {
       this->m_nodeId = nodeId.value();
-      sm_nextFreeNodeId = std::max(this->m_nodeId + 1, sm_nextFreeNodeId);
+      reserveNodeId(this->m_nodeId);
    } else {
-      this->m_nodeId = sm_nextFreeNodeId++;
+      this->m_nodeId = allocateNodeId();
    }
    m_bits.common.kind = unsigned(SyntaxKind::Token);
    m_bits.common.presence = unsigned(presence);
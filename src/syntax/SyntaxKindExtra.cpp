@@ -12,56 +12,98 @@
 #include "polarphp/syntax/SyntaxKind.h"
 #include "polarphp/syntax/SyntaxNodes.h"
 
+#include <cstdint>
+#include <iterator>
 
-#define SYNTAX_TABLE_ENTRY(kind) {#kind , polar::as_integer<SyntaxKind>(SyntaxKind::kind), \
+#define SYNTAX_TABLE_ENTRY(kind) {SyntaxKind::kind, #kind, polar::as_integer<SyntaxKind>(SyntaxKind::kind), \
    kind##Syntax::CHILDREN_COUNT, kind##Syntax::REQUIRED_CHILDREN_COUNT}
 
 namespace polar::syntax {
 
-using SyntaxKindEntryType = std::tuple<std::string, std::uint32_t, std::uint32_t, std::uint32_t>;
+using polar::basic::StringLiteral;
 
-/// name - serialization_code - children_count - required_children_count
-static const std::map<SyntaxKind, SyntaxKindEntryType> scg_syntaxKindTable
+namespace {
+
+struct SyntaxKindEntry
 {
-   {SyntaxKind::Decl, SYNTAX_TABLE_ENTRY(Decl)},
-   {SyntaxKind::Expr, SYNTAX_TABLE_ENTRY(Expr)},
-   {SyntaxKind::Stmt, SYNTAX_TABLE_ENTRY(Stmt)},
-   {SyntaxKind::Token, SYNTAX_TABLE_ENTRY(Token)},
-   {SyntaxKind::Unknown, SYNTAX_TABLE_ENTRY(Unknown)},
-//   {SyntaxKind::CodeBlockItem, SYNTAX_TABLE_ENTRY(CodeBlockItem)},
-//   {SyntaxKind::CodeBlock, SYNTAX_TABLE_ENTRY(CodeBlock)},
-//   {SyntaxKind::TokenList, SYNTAX_TABLE_ENTRY(TokenList)},
-//   {SyntaxKind::NonEmptyTokenList, SYNTAX_TABLE_ENTRY(NonEmptyTokenList)},
-//   {SyntaxKind::CodeBlockItemList, SYNTAX_TABLE_ENTRY(CodeBlockItemList)}
+   SyntaxKind kind;
+   StringLiteral name;
+   std::uint32_t serializationCode;
+   std::uint32_t childrenCount;
+   std::uint32_t requiredChildrenCount;
 };
 
+constexpr SyntaxKindEntry scg_syntaxKindRecords[] =
+{
+   SYNTAX_TABLE_ENTRY(Decl),
+   SYNTAX_TABLE_ENTRY(Expr),
+   SYNTAX_TABLE_ENTRY(Stmt),
+   SYNTAX_TABLE_ENTRY(Token),
+   SYNTAX_TABLE_ENTRY(Unknown),
+//   SYNTAX_TABLE_ENTRY(CodeBlockItem),
+//   SYNTAX_TABLE_ENTRY(CodeBlock),
+//   SYNTAX_TABLE_ENTRY(TokenList),
+//   SYNTAX_TABLE_ENTRY(NonEmptyTokenList),
+//   SYNTAX_TABLE_ENTRY(CodeBlockItemList)
+};
+
+/// Dense map from a syntax kind to the position of its record in
+/// scg_syntaxKindRecords plus one, zero for kinds that have no record.
+struct SyntaxKindIndex
+{
+   std::uint8_t slots[polar::as_integer<SyntaxKind>(SyntaxKind::Unknown) + 1];
+};
+
+constexpr SyntaxKindIndex build_syntax_kind_index()
+{
+   static_assert(std::size(scg_syntaxKindRecords) < 0xFF, "too many syntax kind records for the index");
+   SyntaxKindIndex index{};
+   for (std::size_t i = 0; i < std::size(scg_syntaxKindRecords); ++i) {
+      index.slots[polar::as_integer<SyntaxKind>(scg_syntaxKindRecords[i].kind)] = static_cast<std::uint8_t>(i + 1);
+   }
+   return index;
+}
+
+constexpr SyntaxKindIndex scg_syntaxKindIndex = build_syntax_kind_index();
+
+const SyntaxKindEntry *find_syntax_kind_entry(SyntaxKind kind)
+{
+   std::uint8_t slot = scg_syntaxKindIndex.slots[polar::as_integer<SyntaxKind>(kind)];
+   if (slot == 0) {
+      return nullptr;
+   }
+   return &scg_syntaxKindRecords[slot - 1];
+}
+
+} // anonymous namespace
+
 StringRef retrieve_syntax_kind_text(SyntaxKind kind)
 {
-   auto iter = scg_syntaxKindTable.find(kind);
-   if (iter == scg_syntaxKindTable.end()) {
+   const SyntaxKindEntry *entry = find_syntax_kind_entry(kind);
+   if (entry == nullptr) {
       return StringRef();
    }
-   return std::get<0>(iter->second);
+   return entry->name;
 }
 
 int retrieve_syntax_kind_serialization_code(SyntaxKind kind)
 {
-   auto iter = scg_syntaxKindTable.find(kind);
-   if (iter == scg_syntaxKindTable.end()) {
+   const SyntaxKindEntry *entry = find_syntax_kind_entry(kind);
+   if (entry == nullptr) {
       return -1;
    }
-   return std::get<1>(iter->second);
+   return entry->serializationCode;
 }
 
 std::pair<std::uint32_t, std::uint32_t> retrieve_syntax_kind_child_count(SyntaxKind kind, bool &exist)
 {
-   auto iter = scg_syntaxKindTable.find(kind);
-   if (iter == scg_syntaxKindTable.end()) {
+   const SyntaxKindEntry *entry = find_syntax_kind_entry(kind);
+   if (entry == nullptr) {
       exist = false;
       return {-1, -1};
    }
    exist = true;
-   return {std::get<2>(iter->second), std::get<3>(iter->second)};
+   return {entry->childrenCount, entry->requiredChildrenCount};
 }
 
 } // polar::syntax
@@ -16,25 +16,21 @@ namespace polar::syntax {
 
 bool is_token_text_determined(TokenKindType kind)
 {
-   auto entry = find_token_desc_entry(kind);
-   if (entry == token_desc_map_end()) {
-      return false;
-   }
-   return true;
+   return find_token_desc_entry(kind) != nullptr;
 }
 
 StringRef get_token_text(TokenKindType kind)
 {
-   auto entry = find_token_desc_entry(kind);
-   assert(entry != token_desc_map_end() && "token kind cannot be determined");
-   return std::get<1>(entry->second);
+   const TokenDescItem *entry = find_token_desc_entry(kind);
+   assert(entry != nullptr && "token kind cannot be determined");
+   return entry->desc;
 }
 
 void dump_token_kind(RawOutStream &outStream, TokenKindType kind)
 {
-   auto entry = find_token_desc_entry(kind);
-   assert(entry != token_desc_map_end() && "token kind cannot be determined");
-   outStream << std::get<0>(entry->second);
+   const TokenDescItem *entry = find_token_desc_entry(kind);
+   assert(entry != nullptr && "token kind cannot be determined");
+   outStream << entry->name;
 }
 
 } // polar::syntax
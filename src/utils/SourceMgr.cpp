@@ -81,27 +81,30 @@ unsigned SourceMgr::findBufferContainingLoc(SMLocation loc) const
 }
 
 template <typename T>
-unsigned SourceMgr::SrcBuffer::getLineNumber(const char *ptr) const
+const std::vector<T> &SourceMgr::SrcBuffer::getOffsets() const
 {
-
    // Ensure m_offsetCache is allocated and populated with offsets of all the
    // '\n' bytes.
-   std::vector<T> *offsets = nullptr;
-   if (m_offsetCache.isNull()) {
-      offsets = new std::vector<T>();
-      m_offsetCache = offsets;
-      size_t size = m_buffer->getBufferSize();
-      assert(size <= std::numeric_limits<T>::max());
-      StringRef str = m_buffer->getBuffer();
-      for (size_t N = 0; N < size; ++N) {
-         if (str[N] == '\n') {
-            offsets->push_back(static_cast<T>(N));
-         }
+   if (!m_offsetCache.isNull()) {
+      return *m_offsetCache.get<std::vector<T> *>();
+   }
+   std::vector<T> *offsets = new std::vector<T>();
+   m_offsetCache = offsets;
+   size_t size = m_buffer->getBufferSize();
+   assert(size <= std::numeric_limits<T>::max());
+   StringRef str = m_buffer->getBuffer();
+   for (size_t N = 0; N < size; ++N) {
+      if (str[N] == '\n') {
+         offsets->push_back(static_cast<T>(N));
       }
-   } else {
-      offsets = m_offsetCache.get<std::vector<T> *>();
    }
+   return *offsets;
+}
 
+template <typename T>
+unsigned SourceMgr::SrcBuffer::getLineNumber(const char *ptr) const
+{
+   const std::vector<T> &offsets = getOffsets<T>();
    const char *bufStart = m_buffer->getBufferStart();
    assert(ptr >= bufStart && ptr <= m_buffer->getBufferEnd());
    ptrdiff_t ptrDiff = ptr - bufStart;
@@ -112,10 +115,41 @@ unsigned SourceMgr::SrcBuffer::getLineNumber(const char *ptr) const
    // ptrOffset, meaning the eol that _ends the line_ that ptrOffset is on
    // (including if ptrOffset refers to the eol itself). If there's no such
    // eol, returns end().
-   auto eol = std::lower_bound(offsets->begin(), offsets->end(), ptrOffset);
+   auto eol = std::lower_bound(offsets.begin(), offsets.end(), ptrOffset);
 
    // Lines count from 1, so add 1 to the distance from the 0th line.
-   return (1 + (eol - offsets->begin()));
+   return (1 + (eol - offsets.begin()));
+}
+
+template <typename T>
+const char *SourceMgr::SrcBuffer::getPointerForLineNumber(unsigned lineNo) const
+{
+   const std::vector<T> &offsets = getOffsets<T>();
+   // line N + 1 starts right after the eol of line N
+   if (lineNo == 0 || lineNo - 1 > offsets.size()) {
+      return nullptr;
+   }
+   const char *bufStart = m_buffer->getBufferStart();
+   return lineNo == 1 ? bufStart : bufStart + offsets[lineNo - 2] + 1;
+}
+
+void SourceMgr::SrcBuffer::setOffsets(std::vector<uint32_t> &&offsets) const
+{
+   if (!m_offsetCache.isNull()) {
+      return;
+   }
+   // keep the element type getLineAndColumn() picks for the buffer size
+   size_t size = m_buffer->getBufferSize();
+   assert(offsets.empty() || offsets.back() < size);
+   if (size <= std::numeric_limits<uint8_t>::max()) {
+      m_offsetCache = new std::vector<uint8_t>(offsets.begin(), offsets.end());
+   } else if (size <= std::numeric_limits<uint16_t>::max()) {
+      m_offsetCache = new std::vector<uint16_t>(offsets.begin(), offsets.end());
+   } else if (size <= std::numeric_limits<uint32_t>::max()) {
+      m_offsetCache = new std::vector<uint32_t>(std::move(offsets));
+   } else {
+      m_offsetCache = new std::vector<uint64_t>(offsets.begin(), offsets.end());
+   }
 }
 
 SourceMgr::SrcBuffer::SrcBuffer(SourceMgr::SrcBuffer &&other)
@@ -126,7 +160,7 @@ SourceMgr::SrcBuffer::SrcBuffer(SourceMgr::SrcBuffer &&other)
    other.m_offsetCache = nullptr;
 }
 
-SourceMgr::SrcBuffer::~SrcBuffer()
+void SourceMgr::SrcBuffer::clearOffsets() const
 {
    if (!m_offsetCache.isNull()) {
       if (m_offsetCache.is<std::vector<uint8_t>*>()) {
@@ -142,6 +176,11 @@ SourceMgr::SrcBuffer::~SrcBuffer()
    }
 }
 
+SourceMgr::SrcBuffer::~SrcBuffer()
+{
+   clearOffsets();
+}
+
 std::pair<unsigned, unsigned>
 SourceMgr::getLineAndColumn(SMLocation loc, unsigned bufferID) const
 {
@@ -171,6 +210,21 @@ SourceMgr::getLineAndColumn(SMLocation loc, unsigned bufferID) const
    return std::make_pair(lineNo, ptr-bufStart-newlineOffs);
 }
 
+const char *SourceMgr::getPointerForLineNumber(unsigned lineNo, unsigned bufferID) const
+{
+   auto &sb = getBufferInfo(bufferID);
+   size_t size = sb.m_buffer->getBufferSize();
+   if (size <= std::numeric_limits<uint8_t>::max()) {
+      return sb.getPointerForLineNumber<uint8_t>(lineNo);
+   } else if (size <= std::numeric_limits<uint16_t>::max()) {
+      return sb.getPointerForLineNumber<uint16_t>(lineNo);
+   } else if (size <= std::numeric_limits<uint32_t>::max()) {
+      return sb.getPointerForLineNumber<uint32_t>(lineNo);
+   } else {
+      return sb.getPointerForLineNumber<uint64_t>(lineNo);
+   }
+}
+
 void SourceMgr::printIncludeStack(SMLocation includeLoc, RawOutStream &outstream) const
 {
    if (includeLoc == SMLocation()) {
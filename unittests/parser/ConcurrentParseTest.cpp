@@ -0,0 +1,111 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "gtest/gtest.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Parser.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/syntax/RawSyntax.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using polar::kernel::LangOptions;
+using polar::parser::Parser;
+using polar::parser::SourceManager;
+using polar::syntax::RawSyntax;
+using polar::syntax::RefCountPtr;
+using polar::syntax::SourcePresence;
+using polar::syntax::SyntaxKind;
+using polar::syntax::SyntaxNodeId;
+
+namespace {
+
+void collect_node_ids(const RawSyntax *node, std::vector<SyntaxNodeId> &ids)
+{
+   ids.push_back(node->getId());
+   for (const RefCountPtr<RawSyntax> &child : node->getLayout()) {
+      if (child) {
+         collect_node_ids(child.get(), ids);
+      }
+   }
+}
+
+/// Parse \p fileCount generated files with one reused parser and keep
+/// the ids of all their nodes, the trees are released after each file.
+void parse_files(unsigned thread, unsigned fileCount, std::vector<SyntaxNodeId> &ids, bool &failed)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   std::vector<unsigned> bufferIds;
+   for (unsigned i = 0; i < fileCount; ++i) {
+      std::string index = std::to_string(thread) + "_" + std::to_string(i);
+      bufferIds.push_back(sourceMgr.addMemBufferCopy(
+                             "function f" + index + "($a, $b = [1, 2])\n"
+                             "{\n"
+                             "   // thread " + index + "\n"
+                             "   return $a ? \"value $b[0]\" : $b[1] + " + std::to_string(i) + ";\n"
+                             "}\n"
+                             "$r" + index + " = f" + index + "(true);\n"));
+   }
+   Parser parser(langOpts, bufferIds.front(), sourceMgr, nullptr);
+   for (unsigned bufferId : bufferIds) {
+      parser.reset(bufferId);
+      if (parser.parse() || !parser.getSyntaxTreeBuilder().getRoot()) {
+         failed = true;
+         return;
+      }
+      collect_node_ids(parser.getSyntaxTreeBuilder().getRoot().get(), ids);
+   }
+}
+
+} // anonymous namespace
+
+/// Build with -fsanitize=thread to check the parses share no state
+/// without synchronization.
+TEST(ConcurrentParseTest, testNodeIdsAreUnique)
+{
+   constexpr unsigned threadCount = 8;
+   constexpr unsigned fileCount = 200;
+   std::vector<std::vector<SyntaxNodeId>> ids(threadCount);
+   // not std::vector<bool>, every thread writes its own element
+   std::unique_ptr<bool[]> failed(new bool[threadCount]());
+   std::vector<std::thread> threads;
+   for (unsigned i = 0; i < threadCount; ++i) {
+      threads.emplace_back(parse_files, i, fileCount, std::ref(ids[i]), std::ref(failed[i]));
+   }
+   for (std::thread &thread : threads) {
+      thread.join();
+   }
+   std::vector<SyntaxNodeId> allIds;
+   for (unsigned i = 0; i < threadCount; ++i) {
+      ASSERT_FALSE(failed[i]);
+      ASSERT_FALSE(ids[i].empty());
+      allIds.insert(allIds.end(), ids[i].begin(), ids[i].end());
+   }
+   std::sort(allIds.begin(), allIds.end());
+   EXPECT_EQ(allIds.end(), std::adjacent_find(allIds.begin(), allIds.end()));
+}
+
+TEST(ConcurrentParseTest, testManualIdIsNotHandedOut)
+{
+   RefCountPtr<RawSyntax> first = RawSyntax::missing(SyntaxKind::Unknown);
+   SyntaxNodeId manualId = first->getId() + 5;
+   RefCountPtr<RawSyntax> manual = RawSyntax::make(SyntaxKind::Unknown, {}, SourcePresence::Present, manualId);
+   EXPECT_EQ(manualId, manual->getId());
+   for (int i = 0; i < 10; ++i) {
+      RefCountPtr<RawSyntax> node = RawSyntax::missing(SyntaxKind::Unknown);
+      EXPECT_NE(manualId, node->getId());
+   }
+}
@@ -0,0 +1,129 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "gtest/gtest.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/internal/IdentifierCharTables.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
+
+#include <cstdint>
+
+using polar::basic::StringRef;
+using polar::parser::Lexer;
+using polar::parser::internal::advance_if_valid_continuation_of_identifier;
+using polar::parser::internal::decode_valid_utf8_character_and_advance;
+using polar::parser::internal::is_in_valid_utf8;
+using polar::parser::internal::is_valid_identifier_continuation_code_point;
+using polar::parser::internal::is_valid_identifier_start_code_point;
+using polar::parser::internal::scg_identifierContinuationRanges;
+using polar::parser::internal::scg_identifierStartExcludedRanges;
+using polar::parser::internal::UnicodeCharRange;
+
+namespace {
+
+template <size_t N>
+bool is_in_ranges(const UnicodeCharRange (&ranges)[N], uint32_t c)
+{
+   for (const UnicodeCharRange &range : ranges) {
+      if (c >= range.m_lower && c <= range.m_upper) {
+         return true;
+      }
+   }
+   return false;
+}
+
+} // anonymous namespace
+
+TEST(IdentifierCharTablesTest, testTablesMatchRanges)
+{
+   // every code point, including the ones past the end of Unicode
+   for (uint32_t c = 0; c <= 0x110000; ++c) {
+      bool continuation = is_in_ranges(scg_identifierContinuationRanges, c);
+      bool start = continuation && !is_in_ranges(scg_identifierStartExcludedRanges, c);
+      ASSERT_EQ(continuation, is_valid_identifier_continuation_code_point(c)) << std::hex << c;
+      ASSERT_EQ(start, is_valid_identifier_start_code_point(c)) << std::hex << c;
+   }
+   EXPECT_FALSE(is_valid_identifier_continuation_code_point(~0U));
+}
+
+TEST(IdentifierCharTablesTest, testRangeBoundaries)
+{
+   EXPECT_TRUE(is_valid_identifier_start_code_point('a'));
+   EXPECT_TRUE(is_valid_identifier_start_code_point('_'));
+   EXPECT_FALSE(is_valid_identifier_start_code_point('1'));
+   EXPECT_FALSE(is_valid_identifier_start_code_point('$'));
+   EXPECT_TRUE(is_valid_identifier_continuation_code_point('1'));
+   EXPECT_TRUE(is_valid_identifier_continuation_code_point('$'));
+   EXPECT_FALSE(is_valid_identifier_continuation_code_point('-'));
+   EXPECT_FALSE(is_valid_identifier_continuation_code_point(0x00A9));
+   EXPECT_TRUE(is_valid_identifier_continuation_code_point(0x1680 - 1));
+   EXPECT_FALSE(is_valid_identifier_continuation_code_point(0x1680));
+   // combining marks continue an identifier but cannot start it
+   EXPECT_TRUE(is_valid_identifier_continuation_code_point(0x0301));
+   EXPECT_FALSE(is_valid_identifier_start_code_point(0x0301));
+   EXPECT_TRUE(is_valid_identifier_start_code_point(0x4E2D));
+   EXPECT_TRUE(is_valid_identifier_start_code_point(0xEFFFD));
+   EXPECT_FALSE(is_valid_identifier_start_code_point(0xEFFFE));
+}
+
+TEST(IdentifierCharTablesTest, testIsIdentifier)
+{
+   EXPECT_TRUE(Lexer::isIdentifier("\xE7\x94\xA8\xE6\x88\xB7"));
+   EXPECT_TRUE(Lexer::isIdentifier("caf\xC3\xA9_2"));
+   EXPECT_FALSE(Lexer::isIdentifier("2caf\xC3\xA9"));
+   EXPECT_FALSE(Lexer::isIdentifier("\xCC\x81" "abc"));
+   EXPECT_TRUE(Lexer::isIdentifier("abc\xCC\x81"));
+   EXPECT_FALSE(Lexer::isIdentifier("a\xC2\xA9"));
+}
+
+TEST(IdentifierCharTablesTest, testValidatedUtf8Shortcut)
+{
+   // every scalar value decodes the same with and without validation, and
+   // the predicates agree on it
+   for (uint32_t c = 0; c < 0x110000; ++c) {
+      if (c >= 0xD800 && c <= 0xDFFF) {
+         continue;
+      }
+      unsigned char bytes[5] = {};
+      unsigned length;
+      if (c < 0x80) {
+         bytes[0] = static_cast<unsigned char>(c);
+         length = 1;
+      } else if (c < 0x800) {
+         bytes[0] = static_cast<unsigned char>(0xC0 | (c >> 6));
+         bytes[1] = static_cast<unsigned char>(0x80 | (c & 0x3F));
+         length = 2;
+      } else if (c < 0x10000) {
+         bytes[0] = static_cast<unsigned char>(0xE0 | (c >> 12));
+         bytes[1] = static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F));
+         bytes[2] = static_cast<unsigned char>(0x80 | (c & 0x3F));
+         length = 3;
+      } else {
+         bytes[0] = static_cast<unsigned char>(0xF0 | (c >> 18));
+         bytes[1] = static_cast<unsigned char>(0x80 | ((c >> 12) & 0x3F));
+         bytes[2] = static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F));
+         bytes[3] = static_cast<unsigned char>(0x80 | (c & 0x3F));
+         length = 4;
+      }
+      const unsigned char *end = bytes + length;
+      const unsigned char *decoded = bytes;
+      ASSERT_EQ(c, decode_valid_utf8_character_and_advance(decoded)) << std::hex << c;
+      ASSERT_EQ(end, decoded) << std::hex << c;
+      const unsigned char *checked = bytes;
+      const unsigned char *shortcut = bytes;
+      ASSERT_EQ(advance_if_valid_continuation_of_identifier(checked, end),
+                advance_if_valid_continuation_of_identifier(shortcut, end, end)) << std::hex << c;
+      ASSERT_EQ(checked, shortcut) << std::hex << c;
+   }
+   // a continuation byte is never decoded as the start of a character
+   const unsigned char stray[] = {0x80, 0x41};
+   EXPECT_FALSE(is_in_valid_utf8(stray, stray + 2));
+}
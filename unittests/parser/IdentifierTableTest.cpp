@@ -0,0 +1,143 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "gtest/gtest.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/IdentifierTable.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/Token.h"
+
+#include <string>
+#include <vector>
+
+using polar::basic::IntrusiveRefCountPtr;
+using polar::kernel::LangOptions;
+using polar::syntax::TokenKindType;
+using polar::parser::IdentifierTable;
+using polar::parser::Lexer;
+using polar::parser::SourceManager;
+using polar::parser::SymbolId;
+using polar::parser::Token;
+
+TEST(IdentifierTableTest, testInternName)
+{
+   IdentifierTable table;
+   SymbolId strlen = table.internName("strlen");
+   EXPECT_NE(IdentifierTable::InvalidSymbolId, strlen);
+   EXPECT_EQ(strlen, table.getFoldedSymbol(strlen));
+   // the spelling is kept, the folded symbol is shared
+   SymbolId mixed = table.internName("StrLen");
+   EXPECT_NE(strlen, mixed);
+   EXPECT_EQ("StrLen", table.getSymbolText(mixed));
+   EXPECT_EQ(strlen, table.getFoldedSymbol(mixed));
+   EXPECT_EQ(strlen, table.getFoldedSymbol(table.internName("STRLEN")));
+   EXPECT_EQ(mixed, table.lookupName("StrLen"));
+   EXPECT_EQ(IdentifierTable::InvalidSymbolId, table.lookupName("strLEN"));
+   EXPECT_FALSE(table.isVariableSymbol(strlen));
+   // constants are case sensitive, so are their symbols
+   SymbolId constant = table.internName("E_ALL");
+   EXPECT_NE(constant, table.internName("e_all"));
+   EXPECT_EQ(table.lookupName("e_all"), table.getFoldedSymbol(constant));
+   // only ASCII is folded
+   SymbolId upper = table.internName("\xC3\x84pfel");
+   SymbolId lower = table.internName("\xC3\xA4pfel");
+   EXPECT_NE(upper, lower);
+   EXPECT_EQ(upper, table.getFoldedSymbol(upper));
+   EXPECT_EQ(IdentifierTable::InvalidSymbolId, table.lookupName("strtolower"));
+   EXPECT_EQ(7u, table.getSymbolCount());
+}
+
+TEST(IdentifierTableTest, testInternVariable)
+{
+   IdentifierTable table;
+   SymbolId name = table.internName("value");
+   SymbolId variable = table.internVariable("value");
+   EXPECT_NE(name, variable);
+   EXPECT_TRUE(table.isVariableSymbol(variable));
+   EXPECT_NE(variable, table.internVariable("Value"));
+   EXPECT_EQ(variable, table.lookupVariable("value"));
+   EXPECT_EQ(IdentifierTable::InvalidSymbolId, table.lookupVariable("VALUE"));
+   EXPECT_EQ("Value", table.getSymbolText(table.lookupVariable("Value")));
+}
+
+TEST(IdentifierTableTest, testSymbolIdsAreDense)
+{
+   IdentifierTable table;
+   std::vector<SymbolId> ids;
+   for (int i = 0; i < 10000; ++i) {
+      ids.push_back(table.internName("name" + std::to_string(i)));
+   }
+   for (int i = 0; i < 10000; ++i) {
+      ASSERT_EQ(SymbolId(i + 1), ids[i]);
+      // the spelling stays valid while the map grows
+      ASSERT_EQ("name" + std::to_string(i), table.getSymbolText(ids[i]).getStr());
+      ASSERT_EQ(ids[i], table.getFoldedSymbol(table.internName("NAME" + std::to_string(i))));
+   }
+}
+
+TEST(IdentifierTableTest, testLexerInternsNames)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(
+            "<?php\n"
+            "function Foo($value) { return foo($Value, \"${value}\"); }\n"
+            "FOO($value);\n");
+   IntrusiveRefCountPtr<IdentifierTable> table(new IdentifierTable);
+   Lexer lexer(langOpts, sourceMgr, bufferId, nullptr);
+   lexer.setIdentifierTable(table);
+   std::vector<Token> tokens;
+   Token token;
+   do {
+      lexer.lex(token);
+      tokens.push_back(token);
+   } while (token.isNot(TokenKindType::END));
+
+   SymbolId foo = table->lookupName("foo");
+   SymbolId upperFoo = table->lookupName("Foo");
+   SymbolId allUpperFoo = table->lookupName("FOO");
+   SymbolId value = table->lookupVariable("value");
+   SymbolId upperValue = table->lookupVariable("Value");
+   ASSERT_NE(IdentifierTable::InvalidSymbolId, foo);
+   ASSERT_NE(IdentifierTable::InvalidSymbolId, value);
+   ASSERT_NE(IdentifierTable::InvalidSymbolId, upperValue);
+   std::vector<SymbolId> names;
+   std::vector<SymbolId> variables;
+   for (const Token &token : tokens) {
+      if (token.is(TokenKindType::T_IDENTIFIER_STRING)) {
+         names.push_back(token.getSymbolId());
+      } else if (token.is(TokenKindType::T_VARIABLE) || token.is(TokenKindType::T_STRING_VARNAME)) {
+         variables.push_back(token.getSymbolId());
+      } else {
+         EXPECT_FALSE(token.hasSymbolId());
+      }
+   }
+   // every name keeps its spelling, they fold to the same symbol
+   EXPECT_EQ(std::vector<SymbolId>({upperFoo, foo, allUpperFoo}), names);
+   for (SymbolId name : names) {
+      EXPECT_EQ(foo, table->getFoldedSymbol(name));
+   }
+   EXPECT_EQ(std::vector<SymbolId>({value, upperValue, value, value}), variables);
+}
+
+TEST(IdentifierTableTest, testNoSymbolsWithoutTable)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy("<?php\nfoo($bar);\n");
+   Lexer lexer(langOpts, sourceMgr, bufferId, nullptr);
+   Token token;
+   do {
+      lexer.lex(token);
+      EXPECT_FALSE(token.hasSymbolId());
+   } while (token.isNot(TokenKindType::END));
+}
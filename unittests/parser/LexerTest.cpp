@@ -16,11 +16,15 @@
 #include "polarphp/parser/SourceMgr.h"
 #include "polarphp/parser/Lexer.h"
 #include "polarphp/parser/Token.h"
+#include "polarphp/parser/TokenValueArena.h"
+#include "polarphp/parser/internal/ScanKernels.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
 #include "polarphp/ast/DiagnosticConsumer.h"
 #include "polarphp/ast/DiagnosticEngine.h"
 #include "polarphp/utils/MemoryBuffer.h"
 
 #include <iostream>
+#include <random>
 #include <vector>
 #include <cstdlib>
 
@@ -39,7 +43,9 @@ using polar::parser::SourceLoc;
 using polar::parser::Lexer;
 using polar::parser::tokenize;
 using polar::parser::Token;
+using polar::parser::TokenValueArena;
 using polar::basic::StringRef;
+using polar::basic::IntrusiveRefCountPtr;
 using polar::basic::ArrayRef;
 
 using polar::parser::ParsedTrivia;
@@ -53,6 +59,7 @@ public:
    std::vector<Token> tokenizeAndKeepEOF(unsigned bufferId)
    {
       Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr);
+      lexer.setValueArena(valueArena);
       std::vector<Token> tokens;
       do {
          tokens.emplace_back();
@@ -76,6 +83,7 @@ public:
       {
          tokens.push_back(token);
       }, [&](Lexer &lexer) {
+         lexer.setValueArena(valueArena);
          lexer.setCheckHeredocIndentation(true);
          lexer.registerLexicalExceptionHandler([&](StringRef msg, int code){
             m_exceptionMsgs.push_back(msg.getStr());
@@ -86,6 +94,48 @@ public:
       return tokens;
    }
 
+   struct LexedTokenWithTrivia
+   {
+      Token token;
+      ParsedTrivia leadingTrivia;
+      ParsedTrivia trailingTrivia;
+   };
+
+   std::vector<LexedTokenWithTrivia> tokenizeWithTrivia(unsigned bufferId)
+   {
+      // tokenize() does not support trivia retention, drive the lexer directly
+      Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr,
+                  CommentRetentionMode::AttachToNextToken, TriviaRetentionMode::WithTrivia);
+      lexer.setValueArena(valueArena);
+      std::vector<LexedTokenWithTrivia> tokens;
+      do {
+         tokens.emplace_back();
+         LexedTokenWithTrivia &lexed = tokens.back();
+         lexer.lex(lexed.token, lexed.leadingTrivia, lexed.trailingTrivia);
+      } while (tokens.back().token.isNot(TokenKindType::END));
+      return tokens;
+   }
+
+   /// Lex \p bufferId once with the scalar and once with the vector trivia
+   /// scanners, both have to see the same tokens and the same trivia.
+   void checkVectorTriviaMatchesScalar(unsigned bufferId, StringRef source)
+   {
+      polar::parser::internal::set_vector_scan_enabled(false);
+      std::vector<LexedTokenWithTrivia> scalarTokens = tokenizeWithTrivia(bufferId);
+      polar::parser::internal::set_vector_scan_enabled(true);
+      std::vector<LexedTokenWithTrivia> vectorTokens = tokenizeWithTrivia(bufferId);
+      ASSERT_EQ(scalarTokens.size(), vectorTokens.size()) << source.getStr();
+      for (size_t i = 0; i < scalarTokens.size(); ++i) {
+         const LexedTokenWithTrivia &scalar = scalarTokens[i];
+         const LexedTokenWithTrivia &vector = vectorTokens[i];
+         EXPECT_EQ(scalar.token.getKind(), vector.token.getKind()) << "i = " << i;
+         EXPECT_EQ(scalar.token.getText(), vector.token.getText()) << "i = " << i;
+         EXPECT_EQ(scalar.token.isAtStartOfLine(), vector.token.isAtStartOfLine()) << "i = " << i;
+         EXPECT_TRUE(scalar.leadingTrivia == vector.leadingTrivia) << "i = " << i;
+         EXPECT_TRUE(scalar.trailingTrivia == vector.trailingTrivia) << "i = " << i;
+      }
+   }
+
    std::vector<Token> checkLex(StringRef source,
                                ArrayRef<TokenKindType> expectedTokens,
                                bool keepComments = false,
@@ -102,6 +152,8 @@ public:
       for (unsigned i = 0, e = expectedTokens.size(); i != e; ++i) {
          EXPECT_EQ(expectedTokens[i], tokens[i].getKind()) << "i = " << i;
       }
+      // every input of the lexer tests checks the vector trivia scanners too
+      checkVectorTriviaMatchesScalar(bufId, source);
       return tokens;
    }
 
@@ -124,6 +176,8 @@ public:
 
    LangOptions langOpts;
    SourceManager sourceMgr;
+   /// keeps the string values of the lexed tokens alive
+   IntrusiveRefCountPtr<TokenValueArena> valueArena{new TokenValueArena};
    std::vector<std::string> m_exceptionMsgs;
 };
 
@@ -1486,3 +1540,456 @@ TEST_F(LexerTest, testLexHereDoc)
       ASSERT_EQ(token5.getValue<std::string>(), "");
    }
 }
+
+TEST_F(LexerTest, testVectorizedTriviaMatchesScalar)
+{
+   // checkLex() compares the scalar and vector trivia scanners on the inputs
+   // of all the other tests, these are runs that straddle and exceed the 16
+   // and 32 byte vector widths
+   for (size_t width : {15, 16, 17, 31, 32, 33, 64, 100}) {
+      std::string indent(width, ' ');
+      std::string tabs(width, '\t');
+      std::string newlines(width, '\n');
+      for (const std::string &source : {indent + "$a = 1;" + newlines + tabs + "$b = 2;" + indent,
+                                        newlines + indent + "/* x */" + tabs + "\n" + indent}) {
+         checkVectorTriviaMatchesScalar(sourceMgr.addMemBufferCopy(source), source);
+      }
+   }
+   {
+      // the line breaks and spaces no test input has
+      std::string source = "  \t\t  /* block */ $a   // line\n\n\n  $b\r\n\r\n\t$c\v\f;";
+      checkVectorTriviaMatchesScalar(sourceMgr.addMemBufferCopy(source), source);
+   }
+   // a whitespace run is reported as one squashed piece
+   {
+      unsigned bufferId = sourceMgr.addMemBufferCopy(std::string(40, ' ') + "$a");
+      std::vector<LexedTokenWithTrivia> tokens = tokenizeWithTrivia(bufferId);
+      ASSERT_FALSE(tokens.empty());
+      ASSERT_EQ(tokens[0].leadingTrivia.size(), 1u);
+      ASSERT_EQ(tokens[0].leadingTrivia.pieces[0].getKind(), TriviaKind::Space);
+      ASSERT_EQ(tokens[0].leadingTrivia.pieces[0].getLength(), 40u);
+   }
+}
+
+TEST_F(LexerTest, testStringValuesReferenceSource)
+{
+   const char *source = R"( $name 'plain text' 'it\'s' foo "tab\t" )";
+   std::vector<TokenKindType> expectedTokens{
+      TokenKindType::T_VARIABLE, TokenKindType::T_CONSTANT_ENCAPSED_STRING,
+      TokenKindType::T_CONSTANT_ENCAPSED_STRING, TokenKindType::T_IDENTIFIER_STRING,
+      TokenKindType::T_DOUBLE_QUOTE, TokenKindType::T_CONSTANT_ENCAPSED_STRING,
+      TokenKindType::T_DOUBLE_QUOTE
+   };
+   size_t arenaMemory = valueArena->getTotalMemory();
+   std::vector<Token> tokens = checkLex(source, expectedTokens, /*KeepComments=*/false);
+   ASSERT_EQ(tokens.size(), expectedTokens.size());
+   // values without escapes are slices of the token text
+   for (size_t i : {0, 1, 3}) {
+      StringRef text = tokens[i].getText();
+      StringRef value = tokens[i].getStringValue();
+      EXPECT_TRUE(value.data() >= text.data() && value.end() <= text.end()) << "i = " << i;
+   }
+   EXPECT_EQ(tokens[0].getStringValue(), "name");
+   EXPECT_EQ(tokens[1].getStringValue(), "plain text");
+   EXPECT_EQ(tokens[3].getStringValue(), "foo");
+   // decoded values live in the value arena
+   EXPECT_EQ(tokens[2].getStringValue(), "it's");
+   EXPECT_EQ(tokens[5].getStringValue(), "tab\t");
+   EXPECT_GT(valueArena->getTotalMemory(), arenaMemory);
+   Token copy = tokens[2];
+   EXPECT_EQ(copy.getStringValue().data(), tokens[2].getStringValue().data());
+}
+
+TEST_F(LexerTest, testHeredocValuesReferenceSource)
+{
+   std::vector<TokenKindType> expectedTokens {
+      TokenKindType::T_START_HEREDOC, TokenKindType::T_ENCAPSED_AND_WHITESPACE,
+            TokenKindType::T_END_HEREDOC, TokenKindType::T_SEMICOLON,
+   };
+   {
+      // no indentation and no escapes, the value is a slice of the body
+      size_t arenaMemory = valueArena->getTotalMemory();
+      std::vector<Token> tokens = checkLex("<<<EOT\nplain\n  body\nEOT;\n", expectedTokens);
+      ASSERT_EQ(tokens.size(), 4u);
+      StringRef text = tokens[1].getText();
+      StringRef value = tokens[1].getStringValue();
+      EXPECT_TRUE(value.data() >= text.data() && value.end() <= text.end());
+      EXPECT_EQ(value, "plain\n  body");
+      EXPECT_EQ(valueArena->getTotalMemory(), arenaMemory);
+   }
+   {
+      // escapes without indentation are decoded straight out of the body
+      std::vector<Token> tokens = checkLex("<<<EOT\ntab\\there\nEOT;\n", expectedTokens);
+      ASSERT_EQ(tokens.size(), 4u);
+      EXPECT_EQ(tokens[1].getStringValue(), "tab\there");
+   }
+   {
+      std::vector<Token> tokens = checkLex("<<<EOT\n  tab\\there\n    body\n  EOT;\n", expectedTokens);
+      ASSERT_EQ(tokens.size(), 4u);
+      EXPECT_EQ(tokens[1].getStringValue(), "tab\there\n  body");
+   }
+}
+
+TEST_F(LexerTest, testHeredocBodyCountsLines)
+{
+   // the body scan counts the lines, whether the value is made or not the
+   // lexer is on the same line as without the heredoc afterwards
+   std::vector<std::string> sources = {
+      "$a = <<<EOT\n  one\\t\r\n\n  two {$b}\r  three\n  EOT;\n$c;",
+      "$a = <<<'EOT'\n  one\r\n\n  two\r  three\n  EOT;\n$c;",
+      "$a = <<<EOT\n  \\u{41}\r\n\n  {$b}\\u{1F600}\r  three\n  EOT;\n$c;",
+      "$a = <<<EOT\none\r\n\ntwo $b\rthree\\n\nEOT;\n$c;",
+   };
+   auto lineOfC = [this](unsigned bufferId, bool checkIndentation) {
+      Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr);
+      lexer.setValueArena(valueArena);
+      lexer.setCheckHeredocIndentation(checkIndentation);
+      Token token;
+      do {
+         lexer.lex(token);
+      } while (token.isNot(TokenKindType::END) && token.getText() != "$c");
+      EXPECT_TRUE(token.is(TokenKindType::T_VARIABLE));
+      return lexer.getLineNumber();
+   };
+   int expected = lineOfC(sourceMgr.addMemBufferCopy("$a = 1;\n\n\n\n\n\n$c;"), false);
+   for (const std::string &source : sources) {
+      unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+      EXPECT_EQ(expected, lineOfC(bufferId, false)) << source;
+      EXPECT_EQ(expected, lineOfC(bufferId, true)) << source;
+   }
+   {
+      // the stripped lines are the lines the scan found, a lone '\r' does
+      // not end one
+      std::vector<TokenKindType> expectedTokens {
+         TokenKindType::T_START_HEREDOC, TokenKindType::T_ENCAPSED_AND_WHITESPACE,
+               TokenKindType::T_END_HEREDOC, TokenKindType::T_SEMICOLON,
+      };
+      std::vector<Token> tokens = checkLex("<<<EOT\n  a\\tb\n\n  c\r  d\n    e\n  EOT;\n", expectedTokens);
+      ASSERT_EQ(tokens.size(), 4u);
+      EXPECT_EQ(tokens[1].getStringValue(), "a\tb\n\nc\r  d\n  e");
+   }
+}
+
+TEST_F(LexerTest, testTokenValuesOutliveLexer)
+{
+   // no value arena is passed, the tokens keep the one of the lexer alive
+   const char *source = R"( "\u{41}b" 'it\'s' )";
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId);
+   ASSERT_EQ(tokens.size(), 4u);
+   EXPECT_EQ(tokens[1].getStringValue(), "Ab");
+   EXPECT_EQ(tokens[3].getStringValue(), "it's");
+   Token token = Lexer::getTokenAtLocation(sourceMgr, tokens[3].getLoc());
+   ASSERT_TRUE(token.is(TokenKindType::T_CONSTANT_ENCAPSED_STRING));
+   EXPECT_EQ(token.getStringValue(), "it's");
+}
+
+TEST_F(LexerTest, testTokenCopiesShareDecodedValue)
+{
+   const char *source = R"( 'it\'s' )";
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+   ASSERT_EQ(tokens.size(), 1u);
+   ASSERT_TRUE(tokens[0].hasPendingEscapes());
+   // copied before either of them is decoded
+   Token copy = tokens[0];
+   StringRef value = tokens[0].getStringValue();
+   EXPECT_EQ(copy.getStringValue(), "it's");
+   EXPECT_EQ(copy.getStringValue().data(), value.data());
+}
+
+TEST_F(LexerTest, testResetKeepsHeldTokenValues)
+{
+   unsigned bufferId = sourceMgr.addMemBufferCopy(R"( "\u{41}b" )");
+   Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr);
+   TokenValueArena *arena = lexer.getValueArena().get();
+   Token token;
+   lexer.lex(token);
+   lexer.lex(token);
+   ASSERT_TRUE(token.is(TokenKindType::T_CONSTANT_ENCAPSED_STRING));
+   // the held token keeps its value, the lexer gets another arena
+   lexer.reset(bufferId);
+   EXPECT_NE(lexer.getValueArena().get(), arena);
+   EXPECT_EQ(token.getStringValue(), "Ab");
+   // nothing holds on to the values of the second arena
+   arena = lexer.getValueArena().get();
+   token = Token();
+   do {
+      lexer.lex(token);
+   } while (token.isNot(TokenKindType::END));
+   lexer.reset(bufferId);
+   EXPECT_EQ(lexer.getValueArena().get(), arena);
+}
+
+TEST_F(LexerTest, testLazyEscapeDecodingMatchesEager)
+{
+   // \u{} escapes are always decoded while lexing, so they are left out
+   const char *singlePieces[] = {
+      "plain", " ", "\\'", "\\\\", "\\n", "\n", "\r\n", "\\x41", "\"", "$name"
+   };
+   const char *doublePieces[] = {
+      "plain", " ", "\\n", "\\t", "\\r", "\\v", "\\f", "\\e", "\\\\", "\\$", "\\\"",
+      "\\`", "\\x41", "\\X4", "\\xg", "\\101", "\\7", "\\0", "\\400", "\\u0041",
+      "'", "\n", "$ ", "$1"
+   };
+   std::mt19937 rng(20190710);
+   std::string source;
+   for (int i = 0; i < 200; ++i) {
+      std::string single;
+      std::string doubleQuoted;
+      std::string backquoted;
+      int count = rng() % 6;
+      for (int j = 0; j < count; ++j) {
+         single += singlePieces[rng() % std::size(singlePieces)];
+         doubleQuoted += doublePieces[rng() % std::size(doublePieces)];
+         std::string piece = doublePieces[rng() % std::size(doublePieces)];
+         backquoted += piece == "\\\"" ? "\\`" : piece;
+      }
+      source += "'" + single + "' \"" + doubleQuoted + "\" `" + backquoted + "`\n";
+   }
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   polar::parser::internal::set_lazy_escape_decoding_enabled(false);
+   std::vector<Token> eagerTokens = tokenizeWithLexer(langOpts, sourceMgr, bufferId, false);
+   polar::parser::internal::set_lazy_escape_decoding_enabled(true);
+   std::vector<Token> lazyTokens = tokenizeWithLexer(langOpts, sourceMgr, bufferId, false);
+   ASSERT_EQ(eagerTokens.size(), lazyTokens.size());
+   size_t pendingCount = 0;
+   for (size_t i = 0; i < eagerTokens.size(); ++i) {
+      const Token &eager = eagerTokens[i];
+      const Token &lazy = lazyTokens[i];
+      ASSERT_EQ(eager.getKind(), lazy.getKind()) << "i = " << i;
+      ASSERT_EQ(eager.getText(), lazy.getText()) << "i = " << i;
+      ASSERT_EQ(eager.getValueType(), lazy.getValueType()) << "i = " << i;
+      if (eager.getValueType() != Token::ValueType::String) {
+         continue;
+      }
+      EXPECT_FALSE(eager.hasPendingEscapes());
+      if (lazy.hasPendingEscapes()) {
+         ++pendingCount;
+         StringRef raw = lazy.getRawStringValue();
+         EXPECT_TRUE(raw.data() >= lazy.getText().data() && raw.end() <= lazy.getText().end());
+      }
+      EXPECT_EQ(eager.getValue<std::string>(), lazy.getValue<std::string>()) << "i = " << i;
+      EXPECT_FALSE(lazy.hasPendingEscapes());
+   }
+   EXPECT_GT(pendingCount, 0u);
+}
+
+TEST_F(LexerTest, testCheckpointRestoresScanningState)
+{
+   // checkpoints inside of interpolations, nested braces and heredocs, where
+   // a LexerState can not restart from
+   const char *source =
+         "<?php\n"
+         "function foo() { if ($a) { $s = \"x {$a[1]} y ${b} z\"; } }\n"
+         "$h = <<<EOT\n"
+         "  head {$obj->prop} tail\n"
+         "  EOT;\n"
+         "$c = `ls $dir`; $n = <<<'N'\n"
+         "raw $x\n"
+         "N;\n";
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   std::vector<Token> expected = tokenizeAndKeepEOF(bufferId);
+   for (size_t start = 0; start < expected.size(); ++start) {
+      Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr);
+      lexer.setValueArena(valueArena);
+      Token token;
+      for (size_t i = 0; i < start; ++i) {
+         lexer.lex(token);
+      }
+      polar::parser::LexerCheckpoint checkpoint = lexer.getCheckpoint();
+      ASSERT_TRUE(checkpoint.isValid());
+      // restoring the same checkpoint twice has to give the same tokens
+      for (int round = 0; round < 2; ++round) {
+         lexer.restoreCheckpoint(checkpoint);
+         for (size_t i = start; i < expected.size(); ++i) {
+            lexer.lex(token);
+            ASSERT_EQ(expected[i].getKind(), token.getKind()) << "start = " << start << ", i = " << i;
+            ASSERT_EQ(expected[i].getText(), token.getText()) << "start = " << start << ", i = " << i;
+            ASSERT_EQ(expected[i].getValueType(), token.getValueType()) << "start = " << start << ", i = " << i;
+         }
+      }
+   }
+}
+
+TEST_F(LexerTest, testHeredocBodyScalarAndVectorAgree)
+{
+   // bodies long enough for the vector loops, with the stop bytes close to
+   // and across the 16 and 32 byte boundaries
+   std::string filler(40, 'x');
+   std::vector<std::string> sources = {
+      "<<<EOT\n    line1\n      line2\n    EOT;\n",
+      "<<<EOT\n\t" + filler + " $a " + filler + "\n\t" + filler + "\\n\\t{$b->c}\n\tEOT;\n",
+      "<<<EOT\n  " + filler + filler + "${name}\\x41\\u{1F600}\\101" + filler + "\n  EOT;\n",
+      "<<<'EOT'\n   " + filler + " $a {$b} \\n\n     " + filler + "\n   EOT;\n",
+      "<<<EOT\n" + filler + "\r\n" + filler + "\\\\" + filler + "\nEOT;\n",
+      "<<<EOT\n" + filler + " {$a[<<<IN\n    nested " + filler + "\n    IN]}\n" + filler + "\nEOT;\n"
+   };
+   {
+      std::vector<TokenKindType> expectedTokens {
+         TokenKindType::T_START_HEREDOC, TokenKindType::T_ENCAPSED_AND_WHITESPACE,
+               TokenKindType::T_END_HEREDOC, TokenKindType::T_SEMICOLON,
+      };
+      std::vector<Token> tokens = checkLex(sources[0], expectedTokens, /*KeepComments=*/false);
+      ASSERT_EQ(tokens.size(), 4u);
+      EXPECT_EQ(tokens[1].getValue<std::string>(), "line1\n  line2");
+   }
+   for (const std::string &source : sources) {
+      unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+      polar::parser::internal::set_vector_scan_enabled(false);
+      std::vector<Token> scalarTokens = tokenizeWithLexer(langOpts, sourceMgr, bufferId, false);
+      polar::parser::internal::set_vector_scan_enabled(true);
+      std::vector<Token> vectorTokens = tokenizeWithLexer(langOpts, sourceMgr, bufferId, false);
+      ASSERT_EQ(scalarTokens.size(), vectorTokens.size()) << source;
+      for (size_t i = 0; i < scalarTokens.size(); ++i) {
+         const Token &scalar = scalarTokens[i];
+         const Token &vector = vectorTokens[i];
+         ASSERT_EQ(scalar.getKind(), vector.getKind()) << "i = " << i;
+         ASSERT_EQ(scalar.getText(), vector.getText()) << "i = " << i;
+         ASSERT_EQ(scalar.getValueType(), vector.getValueType()) << "i = " << i;
+         if (scalar.getValueType() == Token::ValueType::String) {
+            EXPECT_EQ(scalar.getValue<std::string>(), vector.getValue<std::string>()) << "i = " << i;
+         }
+      }
+   }
+}
+
+TEST_F(LexerTest, testInterpolatedStringScalarAndVectorAgree)
+{
+   // bodies long enough for the vector loops, with interpolations, escapes
+   // and the closing quote close to and across the 16 and 32 byte boundaries
+   std::string filler(40, 'x');
+   std::vector<std::string> sources = {
+      "\"" + filler + " $a " + filler + "{$b->c}" + filler + "\";\n",
+      "\"" + filler + filler + "${name}\\x41\\u{1F600}\\101" + filler + "\\\"\";\n",
+      "\"" + filler + "$ {" + filler + "\\\\\\$" + filler + "\\n\n" + filler + "\";\n",
+      "`" + filler + " $dir " + filler + "\\`{$cmd}" + filler + "\\\"`;\n",
+      "\"" + filler + "\r\n" + filler + "$1 {$a[\"" + filler + "\"]}" + filler + "\";\n"
+   };
+   for (bool lazy : {false, true}) {
+      polar::parser::internal::set_lazy_escape_decoding_enabled(lazy);
+      for (const std::string &source : sources) {
+         unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+         polar::parser::internal::set_vector_scan_enabled(false);
+         std::vector<Token> scalarTokens = tokenizeWithLexer(langOpts, sourceMgr, bufferId, false);
+         polar::parser::internal::set_vector_scan_enabled(true);
+         std::vector<Token> vectorTokens = tokenizeWithLexer(langOpts, sourceMgr, bufferId, false);
+         ASSERT_EQ(scalarTokens.size(), vectorTokens.size()) << source;
+         for (size_t i = 0; i < scalarTokens.size(); ++i) {
+            const Token &scalar = scalarTokens[i];
+            const Token &vector = vectorTokens[i];
+            ASSERT_EQ(scalar.getKind(), vector.getKind()) << "i = " << i;
+            ASSERT_EQ(scalar.getText(), vector.getText()) << "i = " << i;
+            ASSERT_EQ(scalar.getValueType(), vector.getValueType()) << "i = " << i;
+            if (scalar.getValueType() == Token::ValueType::String) {
+               EXPECT_EQ(scalar.getValue<std::string>(), vector.getValue<std::string>()) << "i = " << i;
+            }
+         }
+      }
+   }
+   polar::parser::internal::set_lazy_escape_decoding_enabled(true);
+   {
+      // the eager path moves the text between escapes in one piece
+      std::vector<TokenKindType> expectedTokens {
+         TokenKindType::T_DOUBLE_QUOTE, TokenKindType::T_CONSTANT_ENCAPSED_STRING,
+               TokenKindType::T_DOUBLE_QUOTE, TokenKindType::T_SEMICOLON
+      };
+      std::vector<Token> tokens = checkLex("\"" + filler + "\\u{41}\\t" + filler + "\\\\\";",
+                                           expectedTokens, /*KeepComments=*/false);
+      ASSERT_EQ(tokens.size(), 4u);
+      EXPECT_EQ(tokens[1].getValue<std::string>(), filler + "A\t" + filler + "\\");
+   }
+}
+
+TEST_F(LexerTest, testValidUtf8End)
+{
+   std::string source = "<?php\n$a = 'abc'; // caf\xC3\xA9\n$b = \"x\xFFy\"; $c = '\xE2\x82\xAC';\n";
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   const unsigned char *start = reinterpret_cast<const unsigned char *>(
+            sourceMgr.getEntireTextForBuffer(bufferId).data());
+   const unsigned char *end = start + source.size();
+   size_t invalid = source.find('\xFF');
+   size_t euro = source.find('\xE2');
+   Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr);
+   EXPECT_EQ(lexer.getValidUtf8End(), start + invalid);
+   // once the cursor is past the invalid sequence the rest is valid
+   Token token;
+   unsigned stringCount = 0;
+   while (stringCount < 2) {
+      lexer.lex(token);
+      ASSERT_TRUE(token.isNot(TokenKindType::END));
+      if (token.is(TokenKindType::T_CONSTANT_ENCAPSED_STRING)) {
+         ++stringCount;
+      }
+   }
+   EXPECT_EQ(lexer.getValidUtf8End(), end);
+   // a lexer for a part of the buffer only validates its own range
+   Lexer subLexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr, CommentRetentionMode::None,
+                  TriviaRetentionMode::WithoutTrivia, euro + 3, source.size());
+   EXPECT_EQ(subLexer.getValidUtf8End(), end);
+}
+
+TEST_F(LexerTest, testLineOffsetsHandedToSourceManager)
+{
+   std::string source = "<?php\n$a = 1; // one\r\n/* two\nthree */ $b = <<<EOT\n  four\n  EOT;\n"
+                        "$c = \"five\n$a six\";\r\r\n\n$d = 'seven\n';";
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   EXPECT_FALSE(sourceMgr.hasLineOffsets(bufferId));
+   // a lexer over a part of the buffer does not record them
+   Lexer subLexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr, CommentRetentionMode::None,
+                  TriviaRetentionMode::WithoutTrivia, 6, source.size());
+   Token token;
+   do {
+      subLexer.lex(token);
+   } while (token.isNot(TokenKindType::END));
+   EXPECT_FALSE(sourceMgr.hasLineOffsets(bufferId));
+   // neither does one that was not asked to
+   std::vector<Token> tokens = tokenizeAndKeepEOF(bufferId);
+   EXPECT_FALSE(sourceMgr.hasLineOffsets(bufferId));
+   Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr);
+   lexer.setValueArena(valueArena);
+   lexer.setRecordLineOffsets(true);
+   do {
+      lexer.lex(token);
+   } while (token.isNot(TokenKindType::END));
+   ASSERT_TRUE(sourceMgr.hasLineOffsets(bufferId));
+   // the same lookups on a buffer whose offsets are found by a scan
+   SourceManager otherSourceMgr;
+   unsigned otherBufferId = otherSourceMgr.addMemBufferCopy(source);
+   SourceLoc start = sourceMgr.getLocForBufferStart(bufferId);
+   SourceLoc otherStart = otherSourceMgr.getLocForBufferStart(otherBufferId);
+   for (unsigned offset = 0; offset <= source.size(); ++offset) {
+      EXPECT_EQ(otherSourceMgr.getLineAndColumn(otherStart.getAdvancedLoc(offset), otherBufferId),
+                sourceMgr.getLineAndColumn(start.getAdvancedLoc(offset), bufferId)) << "offset = " << offset;
+   }
+   for (unsigned line = 1; line <= 13; ++line) {
+      for (unsigned col = 1; col <= 12; ++col) {
+         EXPECT_EQ(otherSourceMgr.resolveFromLineCol(otherBufferId, line, col),
+                   sourceMgr.resolveFromLineCol(bufferId, line, col)) << line << ":" << col;
+      }
+   }
+}
+
+TEST_F(LexerTest, testLexInPlaceSwapsTrivia)
+{
+   // more pieces than a trivia keeps inline, then fewer, then none
+   const char *source = "// one\n  /* two */\n  $a = 1;   // three\n/** four */ $b\n=2;";
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   std::vector<LexedTokenWithTrivia> expected = tokenizeWithTrivia(bufferId);
+   Lexer lexer(langOpts, sourceMgr, bufferId, /*Diags=*/nullptr,
+               CommentRetentionMode::AttachToNextToken, TriviaRetentionMode::WithTrivia);
+   lexer.setValueArena(valueArena);
+   // the same two vectors for every token, the way the parser lexes
+   ParsedTrivia leadingTrivia;
+   ParsedTrivia trailingTrivia;
+   for (size_t i = 0; i < expected.size(); ++i) {
+      const Token &token = lexer.lexInPlace(leadingTrivia, trailingTrivia);
+      ASSERT_EQ(&token, &lexer.peekNextToken());
+      ASSERT_EQ(expected[i].token.getKind(), token.getKind()) << "i = " << i;
+      ASSERT_EQ(expected[i].token.getText(), token.getText()) << "i = " << i;
+      EXPECT_TRUE(expected[i].leadingTrivia == leadingTrivia) << "i = " << i;
+      EXPECT_TRUE(expected[i].trailingTrivia == trailingTrivia) << "i = " << i;
+   }
+   EXPECT_TRUE(lexer.peekNextToken().is(TokenKindType::END));
+   EXPECT_GT(expected.front().leadingTrivia.size(), 3u);
+}
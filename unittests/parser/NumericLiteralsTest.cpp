@@ -0,0 +1,236 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "gtest/gtest.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/Token.h"
+#include "polarphp/parser/internal/NumericLiterals.h"
+#include "polarphp/utils/MathExtras.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using polar::kernel::LangOptions;
+using polar::syntax::TokenKindType;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::tokenize;
+using polar::parser::internal::DecimalDigits;
+using polar::parser::internal::parse_decimal_digits;
+using polar::parser::internal::decimal_literal_to_double;
+using polar::parser::internal::parse_radix_digits;
+
+namespace {
+
+/// What the lexer used to produce for a numeric literal, with the C library
+/// conversions on a NUL terminated copy of the text.
+struct ReferenceNumber
+{
+   TokenKindType kind;
+   std::int64_t lvalue = 0;
+   double dvalue = 0;
+   bool needCorrectOverflow = false;
+   bool invalid = false;
+};
+
+ReferenceNumber reference_lex_number(const std::string &text, bool afterMinus)
+{
+   ReferenceNumber result;
+   const char *str = text.c_str();
+   char *end = nullptr;
+   if (text.size() > 2 && (text[1] == 'b' || text[1] == 'x')) {
+      bool binary = text[1] == 'b';
+      size_t first = text.find_first_not_of('0', 2);
+      size_t length = first == std::string::npos ? 0 : text.size() - first;
+      if (binary ? length < 64 : (length < 16 || (length == 16 && text[first] <= '7'))) {
+         result.kind = TokenKindType::T_LNUMBER;
+         result.lvalue = std::strtoll(str + 2, nullptr, binary ? 2 : 16);
+      } else {
+         result.kind = TokenKindType::T_DNUMBER;
+         result.dvalue = binary ? polar::utils::bstr_to_double(str, nullptr)
+                                : polar::utils::hexstr_to_double(str, nullptr);
+         result.needCorrectOverflow = !binary && afterMinus && text.substr(first) == "8000000000000000";
+      }
+      return result;
+   }
+   if (text.find_first_of(".eE") != std::string::npos) {
+      result.kind = TokenKindType::T_DNUMBER;
+      result.dvalue = std::strtod(str, nullptr);
+      return result;
+   }
+   bool octal = text[0] == '0';
+   errno = 0;
+   result.lvalue = std::strtoll(str, &end, octal ? 8 : 10);
+   if (errno == ERANGE) {
+      result.kind = TokenKindType::T_DNUMBER;
+      result.dvalue = octal ? polar::utils::octstr_to_double(str, nullptr) : std::strtod(str, nullptr);
+      result.invalid = *end != '\0';
+      std::string digits = text.substr(std::min(text.find_first_not_of('0'), text.size()));
+      result.needCorrectOverflow = afterMinus && !result.invalid &&
+            digits == (octal ? "1000000000000000000000" : "9223372036854775808");
+      return result;
+   }
+   result.kind = TokenKindType::T_LNUMBER;
+   result.invalid = *end != '\0';
+   return result;
+}
+
+std::string random_digits(std::mt19937 &rng, size_t count, unsigned radix)
+{
+   std::string digits;
+   for (size_t i = 0; i < count; ++i) {
+      digits += "0123456789abcdef"[rng() % radix];
+   }
+   return digits;
+}
+
+/// Numeric literals in every form the lexer rules accept, with runs of
+/// zeros and nines and lengths around the int64 and double limits.
+std::string random_literal(std::mt19937 &rng)
+{
+   switch (rng() % 6) {
+   case 0:
+      return std::to_string(1 + rng() % 9) + random_digits(rng, rng() % 24, 10);
+   case 1: {
+      std::string digits = "0" + std::string(rng() % 3, '0') + random_digits(rng, 1 + rng() % 24, 8);
+      if (rng() % 8 == 0) {
+         digits[1 + rng() % (digits.size() - 1)] = '8' + rng() % 2;
+      }
+      return digits;
+   }
+   case 2:
+      return "0x" + std::string(rng() % 3, '0') + random_digits(rng, 1 + rng() % 18, 16);
+   case 3:
+      return "0b" + std::string(rng() % 3, '0') + random_digits(rng, 1 + rng() % 66, 2);
+   case 4:
+      return std::string(rng() % 2, '9') + std::string(rng() % 20, rng() % 2 ? '0' : '9') + "1";
+   default: {
+      std::string text = random_digits(rng, rng() % 22, 10) + "." + random_digits(rng, rng() % 22, 10);
+      if (text.size() == 1) {
+         text += "5";
+      }
+      if (rng() % 2) {
+         const char *signs[] = {"", "+", "-"};
+         text += std::string(rng() % 2 ? "e" : "E") + signs[rng() % 3] + std::to_string(rng() % 340);
+      }
+      return text;
+   }
+   }
+}
+
+bool same_double(double lhs, double rhs)
+{
+   return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+}
+
+} // anonymous namespace
+
+TEST(NumericLiteralsTest, testDecimalDoublesMatchStrtod)
+{
+   std::vector<std::string> texts = {
+      "0.0", "0.1", "1e23", "9007199254740993", "9007199254740992.5", "5e-324", "2.4703282292062327e-324",
+      "2.4703282292062328e-324", "2.2250738585072011e-308", "2.2250738585072014e-308",
+      "1.7976931348623157e308", "1.7976931348623159e308", "1e400", "1e-400", "7.2057594037927933e16",
+      "18446744073709551615", "18446744073709551616", "123456789012345678901234567890e-20",
+      "0.000000000000000000000000000000000001", "100000000000000000000000000000000000000e-38",
+      "4.9406564584124654417656879286822137236505980e-324"
+   };
+   std::mt19937 rng(20190713);
+   for (int i = 0; i < 200000; ++i) {
+      std::string text = random_literal(rng);
+      if (text.find('.') != std::string::npos || (text[0] != '0' && text.find('x') == std::string::npos)) {
+         texts.push_back(text);
+      }
+   }
+   for (const std::string &text : texts) {
+      const unsigned char *begin = reinterpret_cast<const unsigned char *>(text.data());
+      DecimalDigits digits;
+      parse_decimal_digits(begin, begin + text.size(), digits);
+      double value = decimal_literal_to_double(begin, begin + text.size(), digits);
+      ASSERT_TRUE(same_double(std::strtod(text.c_str(), nullptr), value)) << text;
+   }
+}
+
+TEST(NumericLiteralsTest, testRadixDigitsMatchStrtoull)
+{
+   std::mt19937 rng(20190713);
+   for (int i = 0; i < 100000; ++i) {
+      unsigned log2Radix = (rng() % 3 == 0) ? 1 : (rng() % 2 ? 3 : 4);
+      std::string text = random_digits(rng, 1 + rng() % 70, 1u << log2Radix);
+      if (log2Radix == 3 && rng() % 8 == 0) {
+         text[rng() % text.size()] = '8' + rng() % 2;
+      }
+      const unsigned char *begin = reinterpret_cast<const unsigned char *>(text.data());
+      std::uint64_t value = 0;
+      bool overflow = false;
+      bool valid = parse_radix_digits(begin, begin + text.size(), log2Radix, value, overflow);
+      char *end = nullptr;
+      errno = 0;
+      unsigned long long expected = std::strtoull(text.c_str(), &end, 1 << log2Radix);
+      ASSERT_EQ(*end == '\0', valid) << text;
+      ASSERT_EQ(errno == ERANGE, overflow) << text;
+      if (!overflow) {
+         ASSERT_EQ(expected, value) << text;
+      }
+   }
+}
+
+TEST(NumericLiteralsTest, testLexerMatchesReference)
+{
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   std::vector<std::string> literals = {
+      "0", "00", "019", "0777", "9223372036854775807", "9223372036854775808", "01000000000000000000000",
+      "0777777777777777777777", "0x7FFFFFFFFFFFFFFF", "0x8000000000000000", "0x00008000000000000000",
+      "0b111111111111111111111111111111111111111111111111111111111111111",
+      "0b1000000000000000000000000000000000000000000000000000000000000000", "1.5", ".5", "5.", "1e5"
+   };
+   std::mt19937 rng(20190713);
+   for (int i = 0; i < 20000; ++i) {
+      literals.push_back(random_literal(rng));
+   }
+   std::string source;
+   std::vector<bool> afterMinus;
+   for (const std::string &literal : literals) {
+      afterMinus.push_back(rng() % 2);
+      source += afterMinus.back() ? "$a = -" + literal + ";\n" : "$a = " + literal + ";\n";
+   }
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false);
+   size_t index = 0;
+   for (const Token &token : tokens) {
+      if (token.isNot(TokenKindType::T_LNUMBER) && token.isNot(TokenKindType::T_DNUMBER)) {
+         continue;
+      }
+      ASSERT_LT(index, literals.size());
+      const std::string &literal = literals[index];
+      ASSERT_EQ(literal, token.getText().getStr());
+      ReferenceNumber expected = reference_lex_number(literal, afterMinus[index]);
+      ++index;
+      ASSERT_EQ(expected.kind, token.getKind()) << literal;
+      EXPECT_EQ(expected.needCorrectOverflow, token.isNeedCorrectLNumberOverflow()) << literal;
+      if (expected.kind == TokenKindType::T_LNUMBER) {
+         ASSERT_EQ(expected.invalid, token.isInvalidLexValue()) << literal;
+         if (!expected.invalid) {
+            EXPECT_EQ(expected.lvalue, token.getValue<std::int64_t>()) << literal;
+         }
+      } else {
+         EXPECT_TRUE(same_double(expected.dvalue, token.getValue<double>())) << literal;
+      }
+   }
+   EXPECT_EQ(literals.size(), index);
+}
@@ -0,0 +1,151 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/11.
+
+#include "gtest/gtest.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/Token.h"
+#include "polarphp/parser/TokenValueArena.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using polar::kernel::LangOptions;
+using polar::syntax::TokenKindType;
+using polar::parser::SourceManager;
+using polar::parser::Token;
+using polar::parser::TokenValueArena;
+using polar::parser::tokenize;
+using polar::parser::tokenize_in_parallel;
+using polar::basic::IntrusiveRefCountPtr;
+
+class ParallelTokenizeTest : public ::testing::Test
+{
+public:
+   /// Top level code mixed with literals, comments and heredocs that have
+   /// lines looking like statement starts, so some chunk boundaries land
+   /// inside of them.
+   std::string getRandomSource(unsigned seed, int count) const
+   {
+      const char *pieces[] = {
+         "function foo@($a, $b = @)\n{\n    return $a + $b;\n}\n",
+         "class Bar@\n{\n    public $x = 'value';\n    public function get() { return $this->x; }\n}\n",
+         "$s@ = 'multi\nline string\nfunction inside()\n$notVar';\n",
+         "$d@ = \"double $x\ninterpolated {$y[1]}\nclass Fake\n\";\n",
+         "/*\nfunction commented()\n{\n}\n*/\n",
+         "$h@ = <<<EOT\nheredoc $x body\nfunction fake()\nEOT;\n",
+         "$n@ = <<<'EOT'\nnowdoc body\n$x\nEOT;\n",
+         "$m@ = `ls\n$dir`;\n",
+         "// line comment\n",
+         "$x@ = -0x8000000000000000;\n",
+         "if ($a) {\n    echo \"a\\n\", 'it\\'s';\n}\n",
+         "\n\n   \n"
+      };
+      std::mt19937 rng(seed);
+      std::string source;
+      for (int i = 0; i < count; ++i) {
+         std::string piece = pieces[rng() % std::size(pieces)];
+         std::string index = std::to_string(i);
+         for (size_t pos = piece.find('@'); pos != std::string::npos; pos = piece.find('@', pos)) {
+            piece.replace(pos, 1, index);
+         }
+         source += piece;
+      }
+      return source;
+   }
+
+   void checkSameTokens(const std::vector<Token> &expected, const std::vector<Token> &actual)
+   {
+      ASSERT_EQ(expected.size(), actual.size());
+      for (size_t i = 0; i < expected.size(); ++i) {
+         const Token &lhs = expected[i];
+         const Token &rhs = actual[i];
+         ASSERT_EQ(lhs.getKind(), rhs.getKind()) << "i = " << i;
+         ASSERT_TRUE(lhs.getLoc() == rhs.getLoc()) << "i = " << i;
+         ASSERT_EQ(lhs.getText(), rhs.getText()) << "i = " << i;
+         ASSERT_TRUE(lhs.getFlags() == rhs.getFlags()) << "i = " << i;
+         ASSERT_EQ(lhs.getCommentLength(), rhs.getCommentLength()) << "i = " << i;
+         ASSERT_EQ(lhs.getValueType(), rhs.getValueType()) << "i = " << i;
+         switch (lhs.getValueType()) {
+         case Token::ValueType::LongLong:
+            EXPECT_EQ(lhs.getValue<std::int64_t>(), rhs.getValue<std::int64_t>()) << "i = " << i;
+            break;
+         case Token::ValueType::Double:
+            EXPECT_EQ(lhs.getValue<double>(), rhs.getValue<double>()) << "i = " << i;
+            break;
+         case Token::ValueType::String:
+            EXPECT_EQ(lhs.getValue<std::string>(), rhs.getValue<std::string>()) << "i = " << i;
+            break;
+         case Token::ValueType::Unknown:
+            break;
+         }
+      }
+   }
+
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+};
+
+TEST_F(ParallelTokenizeTest, testSameTokensAsSerial)
+{
+   for (unsigned seed : {1u, 2u, 3u, 4u}) {
+      unsigned bufferId = sourceMgr.addMemBufferCopy(getRandomSource(seed, 2000));
+      IntrusiveRefCountPtr<TokenValueArena> serialArena(new TokenValueArena);
+      std::vector<Token> serial = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, serialArena);
+      // small chunks put plenty of boundaries inside strings, comments
+      // and heredocs
+      for (size_t chunkSize : {64, 512, 4096}) {
+         IntrusiveRefCountPtr<TokenValueArena> parallelArena(new TokenValueArena);
+         std::vector<Token> parallel = tokenize_in_parallel(langOpts, sourceMgr, bufferId,
+                                                            parallelArena, chunkSize);
+         checkSameTokens(serial, parallel);
+      }
+   }
+}
+
+TEST_F(ParallelTokenizeTest, testSmallBufferIsLexedSerially)
+{
+   unsigned bufferId = sourceMgr.addMemBufferCopy(getRandomSource(5, 10));
+   IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+   std::vector<Token> serial = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+   std::vector<Token> parallel = tokenize_in_parallel(langOpts, sourceMgr, bufferId, valueArena);
+   checkSameTokens(serial, parallel);
+}
+
+TEST_F(ParallelTokenizeTest, testUnterminatedConstructs)
+{
+   // the lexer of the chunk with the unterminated comment or heredoc never
+   // gets back to a safe restart point and has to lex the rest on its own
+   std::string sources[] = {
+      getRandomSource(6, 500) + "/* unterminated\n" + getRandomSource(7, 500),
+      getRandomSource(8, 500) + "$h = <<<EOT\nunterminated\n" + getRandomSource(9, 500),
+      getRandomSource(10, 500) + "$s = 'unterminated\n" + getRandomSource(11, 500)
+   };
+   for (const std::string &source : sources) {
+      unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+      IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+      std::vector<Token> serial = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+      std::vector<Token> parallel = tokenize_in_parallel(langOpts, sourceMgr, bufferId, valueArena, 256);
+      checkSameTokens(serial, parallel);
+   }
+}
+
+TEST_F(ParallelTokenizeTest, testValuesOutliveChunkLexers)
+{
+   unsigned bufferId = sourceMgr.addMemBufferCopy(getRandomSource(12, 2000));
+   IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+   std::vector<Token> serial = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+   // no arena to adopt the ones of the chunks, the tokens keep them alive
+   std::vector<Token> parallel = tokenize_in_parallel(langOpts, sourceMgr, bufferId, nullptr, 256);
+   checkSameTokens(serial, parallel);
+}
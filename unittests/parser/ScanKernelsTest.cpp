@@ -0,0 +1,293 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/04.
+
+#include "gtest/gtest.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/internal/ScanKernels.h"
+#include "polarphp/parser/internal/YYLexerExtras.h"
+#include "polarphp/ast/DiagnosticEngine.h"
+
+#include <random>
+#include <string>
+
+using polar::parser::SourceManager;
+using polar::ast::DiagnosticEngine;
+using polar::parser::internal::advance_to_end_of_line;
+using polar::parser::internal::find_heredoc_body_stop;
+using polar::parser::internal::find_non_ascii;
+using polar::parser::internal::find_non_ascii_scalar;
+using polar::parser::internal::find_heredoc_body_stop_scalar;
+using polar::parser::internal::find_interpolated_string_stop;
+using polar::parser::internal::find_interpolated_string_stop_scalar;
+using polar::parser::internal::skip_to_end_of_slash_star_comment;
+using polar::parser::internal::set_vector_scan_enabled;
+using polar::parser::internal::skip_byte_run;
+using polar::parser::internal::skip_byte_run_scalar;
+
+namespace {
+
+/// The byte at a time scanners the kernels replaced, kept here as the
+/// reference the vectorized versions are checked against.
+bool reference_advance_to_end_of_line(const unsigned char *&cur, const unsigned char *bufferEnd,
+                                      bool validateUtf8)
+{
+   while (1) {
+      switch (*cur++) {
+      case '\n':
+      case '\r':
+         --cur;
+         return true;
+      default:
+         if (validateUtf8 && (signed char)(cur[-1]) < 0) {
+            --cur;
+            polar::parser::validate_utf8_character_and_advance(cur, bufferEnd);
+         }
+         break;
+      case 0:
+         if (cur - 1 != bufferEnd) {
+            continue;
+         }
+         --cur;
+         return false;
+      }
+   }
+}
+
+bool reference_skip_to_end_of_slash_star_comment(const unsigned char *&cur, const unsigned char *bufferEnd,
+                                                 bool validateUtf8)
+{
+   ++cur;
+   unsigned depth = 1;
+   bool isMultiline = false;
+   while (1) {
+      switch (*cur++) {
+      case '*':
+         if (*cur == '/') {
+            ++cur;
+            if (--depth == 0)
+               return isMultiline;
+         }
+         break;
+      case '/':
+         if (*cur == '*') {
+            ++cur;
+            ++depth;
+         }
+         break;
+      case '\n':
+      case '\r':
+         isMultiline = true;
+         break;
+      default:
+         if (validateUtf8 && (signed char)(cur[-1]) < 0) {
+            --cur;
+            polar::parser::validate_utf8_character_and_advance(cur, bufferEnd);
+         }
+         break;
+      case 0:
+         if (cur - 1 != bufferEnd) {
+            continue;
+         }
+         --cur;
+         return isMultiline;
+      }
+   }
+}
+
+/// Random comment bodies built from the bytes the scanners care about, with
+/// long plain stretches so the vector loops get exercised too.
+std::string random_comment_body(std::mt19937 &rng)
+{
+   static const std::string pieces[] = {
+      "*", "/", "*/", "/*", "\n", "\r\n", " ", "\t", "?>", std::string("\0", 1),
+      "\xC3\xA9", "\xE2\x82\xAC", "\xFF", "\x80", "@param int $a",
+      "                                        ",
+      "abcdefghijklmnopqrstuvwxyz0123456789abcdefghijklmnopqrstuvwxyz"
+   };
+   std::string body;
+   size_t count = rng() % 40;
+   for (size_t i = 0; i < count; ++i) {
+      body += pieces[rng() % (sizeof(pieces) / sizeof(pieces[0]))];
+   }
+   return body;
+}
+
+/// The first invalid UTF-8 sequence, found by walking every non-ASCII run
+/// the way the lexer does when it is initialized.
+const unsigned char *find_first_invalid_utf8(const unsigned char *cur, const unsigned char *end)
+{
+   while (cur < end) {
+      if (*cur < 0x80) {
+         ++cur;
+         continue;
+      }
+      const unsigned char *charStart = cur;
+      if (polar::parser::validate_utf8_character_and_advance(cur, end) == ~0U) {
+         return charStart;
+      }
+   }
+   return end;
+}
+
+} // anonymous namespace
+
+class ScanKernelsTest : public ::testing::Test
+{
+public:
+   void TearDown()
+   {
+      set_vector_scan_enabled(true);
+   }
+
+   SourceManager sourceMgr;
+};
+
+TEST_F(ScanKernelsTest, testSkipByteRun)
+{
+   std::mt19937 rng(20190704);
+   for (int i = 0; i < 20000; ++i) {
+      std::string data(rng() % 100, ' ');
+      for (char &c : data) {
+         if (rng() % 16 == 0) {
+            c = "\t\n x"[rng() % 4];
+         }
+      }
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(data.data());
+      const unsigned char *end = start + data.size();
+      for (unsigned char ch : {' ', '\t', '\n'}) {
+         ASSERT_EQ(skip_byte_run(start, end, ch), skip_byte_run_scalar(start, end, ch)) << data;
+      }
+   }
+}
+
+TEST_F(ScanKernelsTest, testAdvanceToEndOfLine)
+{
+   DiagnosticEngine diags(sourceMgr);
+   std::mt19937 rng(42);
+   for (int i = 0; i < 20000; ++i) {
+      std::string source = "//" + random_comment_body(rng);
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(source.c_str());
+      const unsigned char *end = start + source.size();
+      for (bool withDiags : {false, true}) {
+         for (bool vector : {false, true}) {
+            set_vector_scan_enabled(vector);
+            const unsigned char *expectedCur = start + 2;
+            bool expected = reference_advance_to_end_of_line(expectedCur, end, withDiags);
+            const unsigned char *cur = start + 2;
+            bool result = advance_to_end_of_line(cur, end, nullptr, withDiags ? &diags : nullptr);
+            ASSERT_EQ(expected, result);
+            ASSERT_EQ(expectedCur - start, cur - start);
+            // UTF-8 known to be valid is skipped without decoding
+            cur = start + 2;
+            result = advance_to_end_of_line(cur, end, nullptr, withDiags ? &diags : nullptr,
+                                            find_first_invalid_utf8(start, end));
+            ASSERT_EQ(expected, result);
+            ASSERT_EQ(expectedCur - start, cur - start);
+         }
+      }
+   }
+}
+
+TEST_F(ScanKernelsTest, testSkipToEndOfSlashStarComment)
+{
+   DiagnosticEngine diags(sourceMgr);
+   std::mt19937 rng(7);
+   for (int i = 0; i < 20000; ++i) {
+      std::string source = "/*" + random_comment_body(rng);
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(source.c_str());
+      const unsigned char *end = start + source.size();
+      for (bool withDiags : {false, true}) {
+         for (bool vector : {false, true}) {
+            set_vector_scan_enabled(vector);
+            const unsigned char *expectedCur = start + 1;
+            bool expected = reference_skip_to_end_of_slash_star_comment(expectedCur, end, withDiags);
+            const unsigned char *cur = start + 1;
+            bool result = skip_to_end_of_slash_star_comment(cur, end, nullptr, withDiags ? &diags : nullptr);
+            ASSERT_EQ(expected, result) << source;
+            ASSERT_EQ(expectedCur - start, cur - start) << source;
+            cur = start + 1;
+            result = skip_to_end_of_slash_star_comment(cur, end, nullptr, withDiags ? &diags : nullptr,
+                                                       find_first_invalid_utf8(start, end));
+            ASSERT_EQ(expected, result) << source;
+            ASSERT_EQ(expectedCur - start, cur - start) << source;
+         }
+      }
+   }
+   // a close tag and the code completion marker don't end a comment
+   {
+      std::string source("/* ?> \0 */ $a", 13);
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(source.c_str());
+      const unsigned char *cur = start + 1;
+      skip_to_end_of_slash_star_comment(cur, start + source.size(), start + 6, &diags);
+      ASSERT_EQ(cur - start, 10);
+   }
+}
+
+TEST_F(ScanKernelsTest, testFindHeredocBodyStop)
+{
+   std::mt19937 rng(20190712);
+   for (int i = 0; i < 20000; ++i) {
+      std::string data(rng() % 120, 'a');
+      for (char &c : data) {
+         if (rng() % 24 == 0) {
+            c = "\n\r${}\\ \t\x80"[rng() % 10];
+         }
+      }
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(data.data());
+      const unsigned char *end = start + data.size();
+      for (bool interpolating : {false, true}) {
+         for (const unsigned char *cur = start; cur < end; cur += 1 + rng() % 16) {
+            ASSERT_EQ(find_heredoc_body_stop(cur, end, interpolating) - start,
+                      find_heredoc_body_stop_scalar(cur, end, interpolating) - start) << data;
+         }
+      }
+   }
+}
+
+TEST_F(ScanKernelsTest, testFindInterpolatedStringStop)
+{
+   std::mt19937 rng(20190713);
+   for (int i = 0; i < 20000; ++i) {
+      std::string data(rng() % 120, 'a');
+      for (char &c : data) {
+         if (rng() % 24 == 0) {
+            c = "\"`${}\\\n \x80"[rng() % 9];
+         }
+      }
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(data.data());
+      const unsigned char *end = start + data.size();
+      for (unsigned char quote : {'"', '`'}) {
+         for (const unsigned char *cur = start; cur < end; cur += 1 + rng() % 16) {
+            ASSERT_EQ(find_interpolated_string_stop(cur, end, quote) - start,
+                      find_interpolated_string_stop_scalar(cur, end, quote) - start) << data;
+         }
+      }
+   }
+}
+
+TEST_F(ScanKernelsTest, testFindNonAscii)
+{
+   std::mt19937 rng(20190713);
+   for (int i = 0; i < 20000; ++i) {
+      std::string data(rng() % 300, 'a');
+      for (char &c : data) {
+         if (rng() % 128 == 0) {
+            c = "\x80\xC3\xFF\x7F"[rng() % 4];
+         }
+      }
+      const unsigned char *start = reinterpret_cast<const unsigned char *>(data.data());
+      const unsigned char *end = start + data.size();
+      for (const unsigned char *cur = start; cur < end; cur += 1 + rng() % 64) {
+         ASSERT_EQ(find_non_ascii(cur, end) - start, find_non_ascii_scalar(cur, end) - start) << data;
+      }
+   }
+}
@@ -0,0 +1,180 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "gtest/gtest.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/StreamingSource.h"
+#include "polarphp/parser/Token.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using polar::basic::StringRef;
+using polar::kernel::LangOptions;
+using polar::syntax::TokenKindType;
+using polar::parser::CommentRetentionMode;
+using polar::parser::Lexer;
+using polar::parser::SourceLoc;
+using polar::parser::SourceManager;
+using polar::parser::StreamingSource;
+using polar::parser::Token;
+using polar::parser::TriviaRetentionMode;
+using polar::parser::tokenize;
+
+class StreamingSourceTest : public ::testing::Test
+{
+public:
+   /// A reader over \p input that hands out at most a few bytes per call,
+   /// like a pipe does.
+   StreamingSource::ReadFunc getReader(const std::string &input, unsigned seed)
+   {
+      return [&input, pos = size_t(0), rng = std::mt19937(seed)](char *dest, size_t size) mutable {
+         size_t count = std::min({size, input.size() - pos, size_t(1 + rng() % 40)});
+         std::memcpy(dest, input.data() + pos, count);
+         pos += count;
+         return count;
+      };
+   }
+
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+};
+
+TEST_F(StreamingSourceTest, testReadLines)
+{
+   std::vector<std::string> lines;
+   std::mt19937 rng(20190713);
+   for (int i = 0; i < 2000; ++i) {
+      // mostly short lines, some of them longer than the window
+      std::string line(rng() % 8 == 0 ? rng() % 300 : rng() % 20, 'x');
+      for (char &c : line) {
+         c = static_cast<char>('a' + rng() % 26);
+      }
+      lines.push_back(line);
+   }
+   for (const char *newline : {"\n", "\r\n"}) {
+      for (bool trailingNewline : {false, true}) {
+         std::string input;
+         for (size_t i = 0; i < lines.size(); ++i) {
+            input += lines[i];
+            if (i + 1 < lines.size() || trailingNewline) {
+               input += newline;
+            }
+         }
+         StreamingSource source(sourceMgr, getReader(input, 1), 64);
+         for (size_t i = 0; i < lines.size(); ++i) {
+            ASSERT_TRUE(source.readLine()) << "i = " << i;
+            ASSERT_EQ(source.getLine(), lines[i]) << "i = " << i;
+            ASSERT_EQ(source.getLineNumber(), i + 1);
+            // the line is NUL terminated in place
+            StringRef text = sourceMgr.getEntireTextForBuffer(source.getBufferId());
+            ASSERT_EQ(text.data()[source.getLineEndOffset()], '\0');
+         }
+         ASSERT_FALSE(source.readLine());
+         ASSERT_FALSE(source.readLine());
+         // the window only grows for the longest line
+         EXPECT_LE(source.getWindowSize(), 512u);
+      }
+   }
+}
+
+TEST_F(StreamingSourceTest, testEmptyInput)
+{
+   std::string input;
+   StreamingSource source(sourceMgr, getReader(input, 2));
+   ASSERT_FALSE(source.readLine());
+}
+
+TEST_F(StreamingSourceTest, testLexLinesInPlace)
+{
+   const char *lines[] = {
+      "$count = $count + strlen($argn); // running total",
+      "echo \"line $argn\\n\";",
+      "",
+      "if ($a > 0x1F) { $b[] = 'x'; } /* done */",
+      "$x = <<<EOT",
+   };
+   std::string input;
+   for (const char *line : lines) {
+      input += line;
+      input += "\n";
+   }
+   StreamingSource source(sourceMgr, getReader(input, 3), 32);
+   unsigned bufferId = source.getBufferId();
+   unsigned lineNumber = 0;
+   for (const char *line : lines) {
+      ++lineNumber;
+      ASSERT_TRUE(source.readLine());
+      // what lexing a copy of the line gives
+      unsigned copyId = sourceMgr.addMemBufferCopy(line);
+      std::vector<Token> expected = tokenize(langOpts, sourceMgr, copyId, 0, 0, nullptr, false);
+      Lexer lexer(langOpts, source, nullptr);
+      std::vector<Token> tokens;
+      Token token;
+      do {
+         lexer.lex(token);
+         tokens.push_back(token);
+      } while (token.isNot(TokenKindType::END));
+      tokens.pop_back();
+      ASSERT_EQ(expected.size(), tokens.size()) << line;
+      for (size_t i = 0; i < expected.size(); ++i) {
+         EXPECT_EQ(expected[i].getKind(), tokens[i].getKind()) << line;
+         EXPECT_EQ(expected[i].getText(), tokens[i].getText()) << line;
+         // the line and column in the input, not in the window
+         unsigned column = sourceMgr.getLocOffsetInBuffer(expected[i].getLoc(), copyId) + 1;
+         EXPECT_EQ(std::make_pair(lineNumber, column), source.getLineAndColumn(tokens[i].getLoc())) << line;
+      }
+   }
+   ASSERT_FALSE(source.readLine());
+   // no buffer was registered for the lines
+   EXPECT_EQ(bufferId, source.getBufferId());
+}
+
+TEST_F(StreamingSourceTest, testWindowGrowthKeepsBuffer)
+{
+   std::string input = "short\n" + std::string(1000, 'x') + "\nshort again\n";
+   StreamingSource source(sourceMgr, getReader(input, 4), 16);
+   unsigned bufferId = source.getBufferId();
+   unsigned bufferCount = sourceMgr.getBasicSourceMgr().getNumBuffers();
+   while (source.readLine()) {
+      EXPECT_EQ(bufferId, source.getBufferId());
+      StringRef text = sourceMgr.getEntireTextForBuffer(bufferId);
+      EXPECT_EQ(source.getWindowSize(), text.size());
+      EXPECT_EQ(source.getLine(), text.substr(source.getLineOffset(),
+                                              source.getLineEndOffset() - source.getLineOffset()));
+   }
+   EXPECT_GE(source.getWindowSize(), 1000u);
+   // the window was reallocated, no buffer was registered for it
+   EXPECT_EQ(bufferCount, sourceMgr.getBasicSourceMgr().getNumBuffers());
+}
+
+TEST_F(StreamingSourceTest, testLineLookupsFollowTheWindow)
+{
+   std::string input;
+   for (int i = 0; i < 200; ++i) {
+      input += "$line" + std::to_string(i) + " = " + std::to_string(i * 7) + ";\n";
+   }
+   StreamingSource source(sourceMgr, getReader(input, 5), 48);
+   unsigned bufferId = source.getBufferId();
+   while (source.readLine()) {
+      // the line ends consumed lines had are NULs now, the lookup counts
+      // the ones in the window as it is
+      StringRef text = sourceMgr.getEntireTextForBuffer(bufferId);
+      unsigned expectedLine = 1 + text.substr(0, source.getLineOffset()).count('\n');
+      SourceLoc loc = sourceMgr.getLocForOffset(bufferId, source.getLineOffset());
+      ASSERT_EQ(expectedLine, sourceMgr.getLineNumber(loc, bufferId)) << source.getLineNumber();
+   }
+}
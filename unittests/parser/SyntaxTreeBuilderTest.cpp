@@ -0,0 +1,534 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/13.
+
+#include "gtest/gtest.h"
+#include "polarphp/ast/AstNodes.h"
+#include "polarphp/basic/adt/SmallString.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/Parser.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/SyntaxTreeBuilder.h"
+#include "polarphp/syntax/Syntax.h"
+#include "polarphp/utils/RawOutStream.h"
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using polar::ast::ArrayAccessExpr;
+using polar::ast::AstNode;
+using polar::ast::AstNodeKind;
+using polar::ast::BinaryOperatorExpr;
+using polar::ast::ClassDecl;
+using polar::ast::CodeBlock;
+using polar::ast::ExprStmt;
+using polar::ast::ForeachStmt;
+using polar::ast::FunctionDecl;
+using polar::ast::IfStmt;
+using polar::ast::JumpStmt;
+using polar::ast::MethodCallExpr;
+using polar::ast::MethodDecl;
+using polar::ast::ParameterDecl;
+using polar::ast::TernaryExpr;
+using polar::ast::WhileStmt;
+using polar::ast::get_ast_node_as;
+using polar::basic::SmallString;
+using polar::basic::StringRef;
+using polar::kernel::LangOptions;
+using polar::parser::ParsedNode;
+using polar::parser::Parser;
+using polar::parser::PendingSyntaxList;
+using polar::parser::SourceManager;
+using polar::parser::SyntaxTreeBuilder;
+using polar::parser::TriviaRetentionMode;
+using polar::syntax::RawSyntax;
+using polar::syntax::RefCountPtr;
+using polar::syntax::SyntaxKind;
+using polar::syntax::SyntaxPrintOptions;
+using polar::syntax::TokenKindType;
+using polar::utils::RawSvectorOutStream;
+
+namespace {
+
+std::string print_raw(const RefCountPtr<RawSyntax> &raw)
+{
+   SmallString<256> scratch;
+   RawSvectorOutStream outStream(scratch);
+   raw->print(outStream, SyntaxPrintOptions());
+   return outStream.getStr().getStr();
+}
+
+} // anonymous namespace
+
+TEST(SyntaxTreeBuilderTest, testNestedLists)
+{
+   SyntaxTreeBuilder builder;
+   builder.startTree();
+   ParsedNode leaf = builder.makeNode(AstNodeKind::Name, {nullptr});
+   PendingSyntaxList outer = builder.beginList({leaf});
+   PendingSyntaxList inner = builder.beginList({leaf, leaf});
+   builder.appendToList(inner, {leaf});
+   RefCountPtr<RawSyntax> innerNode = builder.finishList(inner, AstNodeKind::InnerStmtList).getSyntax();
+   builder.appendToList(outer, {innerNode, nullptr});
+   RefCountPtr<RawSyntax> outerNode = builder.finishList(outer, AstNodeKind::TopStmtList).getSyntax();
+   ASSERT_EQ(3u, innerNode->getNumChildren());
+   ASSERT_EQ(3u, outerNode->getNumChildren());
+   EXPECT_EQ(SyntaxKind::Unknown, outerNode->getChild(0)->getKind());
+   EXPECT_EQ(SyntaxKind::InnerStmtList, outerNode->getChild(1)->getKind());
+   EXPECT_FALSE(outerNode->getChild(2));
+   EXPECT_EQ(3u, builder.getNodeCount());
+   EXPECT_GT(builder.getAllocatedBytes(), 0u);
+   // the element stack is empty again
+   EXPECT_EQ(0u, builder.beginList().start);
+}
+
+TEST(SyntaxTreeBuilderTest, testParseRoundTrip)
+{
+   std::string source = "$name = 'polar' . \"php\"; // the name\n"
+                        "if ($name) {\n"
+                        "   /* block */ echo $name, PHP_EOL;\n"
+                        "} else {\n"
+                        "   $count = -1 + 2 * 3;\n"
+                        "}\n"
+                        "function greet(string $who = \"world\") { return \"hello {$who}\"; }\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr);
+   ASSERT_FALSE(parser.parse());
+   const SyntaxTreeBuilder &builder = parser.getSyntaxTreeBuilder();
+   RefCountPtr<RawSyntax> root = builder.getRoot();
+   ASSERT_TRUE(root);
+   EXPECT_EQ(SyntaxKind::SourceFile, root->getKind());
+   ASSERT_EQ(2u, root->getNumChildren());
+   EXPECT_EQ(SyntaxKind::TopStmtList, root->getChild(0)->getKind());
+   EXPECT_EQ(3u, root->getChild(0)->getNumChildren());
+   EXPECT_EQ(source, print_raw(root));
+   EXPECT_GT(builder.getNodeCount(), 50u);
+   EXPECT_GT(builder.getAllocatedBytes(), builder.getNodeCount() * sizeof(RawSyntax));
+   EXPECT_EQ(root, parser.getSyntaxTree()->getRaw());
+}
+
+TEST(SyntaxTreeBuilderTest, testTypedSyntaxNodes)
+{
+   std::string source = "$total = 42 + 1.5;\n"
+                        "while ($total) { break 2; }\n"
+                        "if ($a) {} elseif ($b) {} else {}\n"
+                        "switch ($a) { case 1: default: }\n"
+                        "return sum($a, ...$b,);\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr);
+   ASSERT_FALSE(parser.parse());
+   const SyntaxTreeBuilder &builder = parser.getSyntaxTreeBuilder();
+   RefCountPtr<RawSyntax> root = builder.getRoot();
+   ASSERT_TRUE(root);
+   EXPECT_EQ(source, print_raw(root));
+   RefCountPtr<RawSyntax> statements = root->getChild(0);
+   ASSERT_EQ(5u, statements->getNumChildren());
+
+   // the statement is the item of a CodeBlockItem with its semicolon
+   RefCountPtr<RawSyntax> item = statements->getChild(0);
+   ASSERT_EQ(SyntaxKind::CodeBlockItem, item->getKind());
+   EXPECT_TRUE(item->getChild(1)->isToken(TokenKindType::T_SEMICOLON));
+   ASSERT_EQ(SyntaxKind::ExpressionStmt, item->getChild(0)->getKind());
+   RefCountPtr<RawSyntax> assign = item->getChild(0)->getChild(0);
+   ASSERT_EQ(SyntaxKind::SequenceExpr, assign->getKind());
+   RefCountPtr<RawSyntax> elements = assign->getChild(0);
+   ASSERT_EQ(3u, elements->getNumChildren());
+   EXPECT_EQ(SyntaxKind::SimpleVariableExpr, elements->getChild(0)->getKind());
+   EXPECT_EQ(SyntaxKind::AssignmentExpr, elements->getChild(1)->getKind());
+   RefCountPtr<RawSyntax> sum = elements->getChild(2)->getChild(0);
+   ASSERT_EQ(SyntaxKind::ExprList, sum->getKind());
+   EXPECT_EQ(SyntaxKind::BinaryOperatorExpr, sum->getChild(1)->getKind());
+   RefCountPtr<RawSyntax> integer = sum->getChild(0);
+   RefCountPtr<RawSyntax> real = sum->getChild(2);
+   ASSERT_EQ(SyntaxKind::IntegerLiteralExpr, integer->getKind());
+   ASSERT_EQ(SyntaxKind::FloatLiteralExpr, real->getKind());
+   // the values the lexer read are kept for the literals and their tokens
+   std::optional<std::int64_t> integerValue = builder.getIntegerValue(integer.get());
+   ASSERT_TRUE(integerValue);
+   EXPECT_EQ(42, *integerValue);
+   EXPECT_EQ(integerValue, builder.getIntegerValue(integer->getChild(0).get()));
+   std::optional<double> realValue = builder.getFloatValue(real.get());
+   ASSERT_TRUE(realValue);
+   EXPECT_EQ(1.5, *realValue);
+   EXPECT_FALSE(builder.getIntegerValue(real.get()));
+   EXPECT_FALSE(builder.getFloatValue(assign.get()));
+
+   RefCountPtr<RawSyntax> whileStmt = statements->getChild(1);
+   ASSERT_EQ(SyntaxKind::WhileStmt, whileStmt->getKind());
+   EXPECT_EQ(SyntaxKind::ConditionElementList, whileStmt->getChild(4)->getKind());
+   RefCountPtr<RawSyntax> body = whileStmt->getChild(6);
+   ASSERT_EQ(SyntaxKind::CodeBlock, body->getKind());
+   RefCountPtr<RawSyntax> breakStmt = body->getChild(1)->getChild(0)->getChild(0);
+   ASSERT_EQ(SyntaxKind::BreakStmt, breakStmt->getKind());
+   EXPECT_TRUE(breakStmt->getChild(1)->isToken(TokenKindType::T_LNUMBER));
+
+   RefCountPtr<RawSyntax> ifStmt = statements->getChild(2);
+   ASSERT_EQ(SyntaxKind::IfStmt, ifStmt->getKind());
+   ASSERT_EQ(SyntaxKind::ElseIfList, ifStmt->getChild(7)->getKind());
+   EXPECT_EQ(1u, ifStmt->getChild(7)->getNumChildren());
+   EXPECT_TRUE(ifStmt->getChild(8)->isToken(TokenKindType::T_ELSE));
+
+   RefCountPtr<RawSyntax> switchStmt = statements->getChild(3);
+   ASSERT_EQ(SyntaxKind::SwitchStmt, switchStmt->getKind());
+   RefCountPtr<RawSyntax> cases = switchStmt->getChild(7);
+   ASSERT_EQ(SyntaxKind::SwitchCaseList, cases->getKind());
+   ASSERT_EQ(2u, cases->getNumChildren());
+   EXPECT_EQ(SyntaxKind::SwitchCaseLabel, cases->getChild(0)->getChild(0)->getKind());
+   EXPECT_EQ(SyntaxKind::SwitchDefaultLabel, cases->getChild(1)->getChild(0)->getKind());
+
+   RefCountPtr<RawSyntax> returnStmt = statements->getChild(4)->getChild(0);
+   ASSERT_EQ(SyntaxKind::ReturnStmt, returnStmt->getKind());
+   RefCountPtr<RawSyntax> call = returnStmt->getChild(1);
+   ASSERT_EQ(SyntaxKind::SimpleFunctionCallExpr, call->getKind());
+   ASSERT_EQ(SyntaxKind::ArgumentListClause, call->getChild(1)->getKind());
+   RefCountPtr<RawSyntax> arguments = call->getChild(1)->getChild(1);
+   ASSERT_EQ(SyntaxKind::ArgumentList, arguments->getKind());
+   ASSERT_EQ(2u, arguments->getNumChildren());
+   // the trailing comma belongs to the last argument
+   RefCountPtr<RawSyntax> spread = arguments->getChild(1);
+   ASSERT_EQ(SyntaxKind::ArgumentListItem, spread->getKind());
+   EXPECT_TRUE(spread->getChild(1)->isToken(TokenKindType::T_COMMA));
+   ASSERT_EQ(SyntaxKind::Argument, spread->getChild(0)->getKind());
+   EXPECT_TRUE(spread->getChild(0)->getChild(0)->isToken(TokenKindType::T_ELLIPSIS));
+}
+
+TEST(SyntaxTreeBuilderTest, testParserReset)
+{
+   std::string first = "$a = [1, 2, 3];\n";
+   std::string second = "function f($b) { return \"text $b\"; }\n";
+   std::string third = "echo 'third';\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned firstId = sourceMgr.addMemBufferCopy(first);
+   unsigned secondId = sourceMgr.addMemBufferCopy(second);
+   unsigned thirdId = sourceMgr.addMemBufferCopy(third);
+   Parser parser(langOpts, firstId, sourceMgr, nullptr);
+   ASSERT_FALSE(parser.parse());
+   // a tree that is held on to survives the next parse
+   RefCountPtr<RawSyntax> firstRoot = parser.getSyntaxTreeBuilder().getRoot();
+   parser.reset(secondId);
+   ASSERT_FALSE(parser.parse());
+   EXPECT_EQ(second, print_raw(parser.getSyntaxTreeBuilder().getRoot()));
+   EXPECT_EQ(first, print_raw(firstRoot));
+   // nothing refers to the second tree, its arena is reused
+   const void *secondArena = parser.getSyntaxTreeBuilder().getArena().get();
+   parser.reset(thirdId);
+   ASSERT_FALSE(parser.parse());
+   EXPECT_EQ(third, print_raw(parser.getSyntaxTreeBuilder().getRoot()));
+   EXPECT_EQ(secondArena, parser.getSyntaxTreeBuilder().getArena().get());
+   // the same buffer again
+   parser.reset(firstId);
+   ASSERT_FALSE(parser.parse());
+   EXPECT_EQ(first, print_raw(parser.getSyntaxTreeBuilder().getRoot()));
+}
+
+TEST(SyntaxTreeBuilderTest, testAstParse)
+{
+   std::string source = "// leading comment\n"
+                        "$total = $a + 2 * $b;\n"
+                        "if ($total > 10) { echo \"big $total\"; }\n"
+                        "function twice(int $x): int { return $x * 2; }\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr, TriviaRetentionMode::WithoutTrivia);
+   ASSERT_FALSE(parser.parse());
+   const SyntaxTreeBuilder &builder = parser.getSyntaxTreeBuilder();
+   EXPECT_TRUE(builder.isBuildingAst());
+   EXPECT_FALSE(builder.getRoot());
+   EXPECT_FALSE(parser.getSyntaxTree());
+   const AstNode *root = builder.getAstRoot();
+   ASSERT_TRUE(root);
+   EXPECT_EQ(AstNodeKind::SourceFile, root->getKind());
+   const AstNode *statements = root->getChild(0);
+   EXPECT_EQ(AstNodeKind::TopStmtList, statements->getKind());
+   ASSERT_EQ(3u, statements->getNumChildren());
+   const AstNode *exprStmt = statements->getChild(0);
+   EXPECT_EQ(AstNodeKind::ExprStmt, exprStmt->getKind());
+   // the comment is not part of the statement's range
+   EXPECT_EQ("$total = $a + 2 * $b;", exprStmt->getText());
+   const AstNode *assign = exprStmt->getChild(0);
+   EXPECT_EQ(AstNodeKind::AssignExpr, assign->getKind());
+   const AstNode *sum = assign->getChild(2);
+   EXPECT_EQ(AstNodeKind::BinaryOperatorExpr, sum->getKind());
+   EXPECT_EQ("$a + 2 * $b", sum->getText());
+   ASSERT_TRUE(sum->getChild(1)->isToken());
+   EXPECT_EQ("+", sum->getChild(1)->getText());
+   std::optional<std::int64_t> factor = builder.getIntegerValue(sum->getChild(2)->getChild(0));
+   ASSERT_TRUE(factor);
+   EXPECT_EQ(2, *factor);
+   EXPECT_EQ(AstNodeKind::IfStmt, statements->getChild(1)->getKind());
+   EXPECT_EQ(AstNodeKind::FunctionDecl, statements->getChild(2)->getKind());
+   EXPECT_EQ("function twice(int $x): int { return $x * 2; }", statements->getChild(2)->getText());
+   EXPECT_GT(builder.getNodeCount(), 30u);
+   EXPECT_LT(builder.getAllocatedBytes(), builder.getNodeCount() * sizeof(RawSyntax));
+}
+
+TEST(SyntaxTreeBuilderTest, testAstNodeViews)
+{
+   std::string source = "if ($a) { echo 1; } elseif ($b) { echo 2; } else { echo 3; }\n"
+                        "foreach ($items as $key => $value) { $sum += $value; }\n"
+                        "function &pick(array $list, $index = 0) { return $list[$index] ?: null; }\n"
+                        "final class Box extends Base { public function get() { return $this->value(); } }\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr, TriviaRetentionMode::WithoutTrivia);
+   ASSERT_FALSE(parser.parse());
+   const AstNode *statements = parser.getSyntaxTreeBuilder().getAstRoot()->getChild(0);
+   ASSERT_EQ(4u, statements->getNumChildren());
+
+   EXPECT_FALSE(get_ast_node_as<WhileStmt>(statements->getChild(0)));
+   std::optional<IfStmt> ifStmt = get_ast_node_as<IfStmt>(statements->getChild(0));
+   ASSERT_TRUE(ifStmt);
+   EXPECT_EQ("$a", ifStmt->getCondition()->getText());
+   EXPECT_EQ(AstNodeKind::CodeBlock, ifStmt->getBody()->getKind());
+   ASSERT_EQ(1u, ifStmt->getNumElseIfClauses());
+   EXPECT_EQ("$b", ifStmt->getElseIfCondition(0)->getText());
+   EXPECT_EQ("{ echo 2; }", ifStmt->getElseIfBody(0)->getText());
+   ASSERT_TRUE(ifStmt->hasElse());
+   EXPECT_EQ("{ echo 3; }", ifStmt->getElseBody()->getText());
+
+   ForeachStmt foreachStmt(statements->getChild(1));
+   EXPECT_EQ("$items", foreachStmt.getIterable()->getText());
+   ASSERT_TRUE(foreachStmt.getKey());
+   EXPECT_EQ("$key", foreachStmt.getKey()->getText());
+   EXPECT_EQ("$value", foreachStmt.getValue()->getText());
+   const AstNode *loopStatements = CodeBlock(foreachStmt.getBody()).getStatements();
+   ASSERT_EQ(1u, loopStatements->getNumChildren());
+   BinaryOperatorExpr addition(ExprStmt(loopStatements->getChild(0)).getExpr());
+   EXPECT_EQ(AstNodeKind::CompoundAssignExpr, addition.getKind());
+   EXPECT_EQ(TokenKindType::T_PLUS_EQUAL, addition.getOperator());
+   EXPECT_EQ("$sum", addition.getLeftOperand()->getText());
+
+   FunctionDecl function(statements->getChild(2));
+   EXPECT_TRUE(function.returnsReference());
+   EXPECT_EQ("pick", function.getName()->getText());
+   EXPECT_FALSE(function.getReturnType());
+   const AstNode *parameters = function.getParameters();
+   ASSERT_EQ(3u, parameters->getNumChildren());
+   ParameterDecl listParameter(parameters->getChild(0));
+   EXPECT_EQ("array", listParameter.getType()->getText());
+   EXPECT_EQ("$list", listParameter.getVariable()->getText());
+   EXPECT_FALSE(listParameter.getDefaultValue());
+   ParameterDecl indexParameter(parameters->getChild(2));
+   EXPECT_FALSE(indexParameter.getType());
+   EXPECT_FALSE(indexParameter.isVariadic());
+   EXPECT_EQ("0", indexParameter.getDefaultValue()->getText());
+   const AstNode *body = function.getStatements();
+   ASSERT_EQ(1u, body->getNumChildren());
+   std::optional<JumpStmt> returnStmt = get_ast_node_as<JumpStmt>(body->getChild(0));
+   ASSERT_TRUE(returnStmt);
+   std::optional<TernaryExpr> ternary = get_ast_node_as<TernaryExpr>(returnStmt->getValue());
+   ASSERT_TRUE(ternary);
+   EXPECT_FALSE(ternary->getTrueExpr());
+   EXPECT_EQ("null", ternary->getFalseExpr()->getText());
+   EXPECT_EQ("$index", ArrayAccessExpr(ternary->getCondition()).getOffset()->getText());
+
+   ClassDecl classDecl(statements->getChild(3));
+   EXPECT_EQ("final", classDecl.getModifiers()->getText());
+   EXPECT_EQ("Box", classDecl.getName()->getText());
+   EXPECT_EQ("extends Base", classDecl.getExtends()->getText());
+   EXPECT_FALSE(classDecl.getImplements());
+   ASSERT_EQ(1u, classDecl.getMembers()->getNumChildren());
+   MethodDecl method(classDecl.getMembers()->getChild(0));
+   EXPECT_EQ("public", method.getModifiers()->getText());
+   EXPECT_EQ("get", method.getName()->getText());
+   const AstNode *methodStatements = CodeBlock(method.getBody()).getStatements();
+   MethodCallExpr call(JumpStmt(methodStatements->getChild(0)).getValue());
+   EXPECT_EQ("$this", call.getObject()->getText());
+   EXPECT_EQ("value", call.getName()->getText());
+   EXPECT_EQ("()", call.getArguments()->getText());
+}
+
+TEST(SyntaxTreeBuilderTest, testErrorRecovery)
+{
+   std::string source = "$a = 1;\n"
+                        "$b = ;\n"
+                        "echo $a;\n"
+                        "function f() { $c = * 2; return $c; }\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr);
+   std::vector<unsigned> errorLines;
+   parser.registerSyntaxErrorHandler([&errorLines](StringRef, unsigned line, unsigned) {
+      errorLines.push_back(line);
+   });
+   EXPECT_TRUE(parser.parse());
+   ASSERT_EQ(2u, errorLines.size());
+   EXPECT_EQ(2u, errorLines[0]);
+   EXPECT_EQ(4u, errorLines[1]);
+   // the skipped tokens are unknown statements, nothing is lost
+   RefCountPtr<RawSyntax> root = parser.getSyntaxTreeBuilder().getRoot();
+   ASSERT_TRUE(root);
+   EXPECT_EQ(source, print_raw(root));
+   RefCountPtr<RawSyntax> statements = root->getChild(0);
+   ASSERT_EQ(4u, statements->getNumChildren());
+   EXPECT_EQ(SyntaxKind::UnknownStmt, statements->getChild(1)->getKind());
+   // $b, = and ;
+   EXPECT_EQ(3u, statements->getChild(1)->getNumChildren());
+   EXPECT_TRUE(parser.getSyntaxTree());
+}
+
+TEST(SyntaxTreeBuilderTest, testTruncatedInput)
+{
+   std::string source = "echo 1;\n"
+                        "function f() {\n"
+                        "   $x = [1, 2";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr, TriviaRetentionMode::WithoutTrivia);
+   unsigned errorCount = 0;
+   parser.registerSyntaxErrorHandler([&errorCount](StringRef, unsigned, unsigned) {
+      ++errorCount;
+   });
+   EXPECT_TRUE(parser.parse());
+   EXPECT_EQ(1u, errorCount);
+   // the parser gave up at the end, the rest after the complete statements
+   // is one unknown statement
+   const AstNode *root = parser.getSyntaxTreeBuilder().getAstRoot();
+   ASSERT_TRUE(root);
+   const AstNode *statements = root->getChild(0);
+   ASSERT_EQ(2u, statements->getNumChildren());
+   EXPECT_EQ(AstNodeKind::EchoStmt, statements->getChild(0)->getKind());
+   EXPECT_EQ(AstNodeKind::UnknownStmt, statements->getChild(1)->getKind());
+   EXPECT_EQ("function f() {\n   $x = [1, 2", statements->getChild(1)->getText());
+}
+
+TEST(SyntaxTreeBuilderTest, testSkipFunctionBodies)
+{
+   std::string source = "use function Util\\format;\n"
+                        "function outer($a = [1, 2]): ?array { $b = \"x{$a[0]} ${a}\"; return [function () use ($a) { return $a; }]; }\n"
+                        "abstract class Shape { abstract function area(); public function name(): string { if (1) { return 'shape'; } } }\n"
+                        "$empty = function () {};\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr, TriviaRetentionMode::WithoutTrivia);
+   parser.setSkipFunctionBodies(true);
+   ASSERT_FALSE(parser.parse());
+   const AstNode *root = parser.getSyntaxTreeBuilder().getAstRoot();
+   ASSERT_TRUE(root);
+   std::vector<const AstNode *> skipped;
+   std::function<void(const AstNode *)> collect = [&](const AstNode *node) {
+      if (!node) {
+         return;
+      }
+      if (node->getKind() == AstNodeKind::SkippedStmtList) {
+         skipped.push_back(node);
+         return;
+      }
+      for (const AstNode *child : node->getChildren()) {
+         collect(child);
+      }
+   };
+   collect(root);
+   // the empty closure body has nothing to skip
+   ASSERT_EQ(2u, skipped.size());
+   EXPECT_EQ("$b = \"x{$a[0]} ${a}\"; return [function () use ($a) { return $a; }];",
+             skipped[0]->getText());
+   EXPECT_EQ("if (1) { return 'shape'; }", skipped[1]->getText());
+   EXPECT_FALSE(skipped[0]->getChild(0));
+   // parsed on first access, nested closures included
+   const AstNode *statements = parser.parseSkippedBody(skipped[0]);
+   ASSERT_TRUE(statements);
+   EXPECT_EQ(AstNodeKind::InnerStmtList, statements->getKind());
+   ASSERT_EQ(2u, statements->getNumChildren());
+   EXPECT_EQ(AstNodeKind::ExprStmt, statements->getChild(0)->getKind());
+   EXPECT_EQ(AstNodeKind::ReturnStmt, statements->getChild(1)->getKind());
+   EXPECT_EQ(statements, skipped[0]->getChild(0));
+   EXPECT_EQ(statements, parser.parseSkippedBody(skipped[0]));
+   const AstNode *methodStatements = parser.parseSkippedBody(skipped[1]);
+   ASSERT_TRUE(methodStatements);
+   ASSERT_EQ(1u, methodStatements->getNumChildren());
+   EXPECT_EQ(AstNodeKind::IfStmt, methodStatements->getChild(0)->getKind());
+   // the bodies of another parser are not found
+   Parser other(langOpts, sourceMgr.addMemBufferCopy("function f() { return 1; }\n"), sourceMgr,
+                nullptr, TriviaRetentionMode::WithoutTrivia);
+   other.setSkipFunctionBodies(true);
+   ASSERT_FALSE(other.parse());
+   EXPECT_FALSE(other.parseSkippedBody(skipped[1]));
+}
+
+TEST(SyntaxTreeBuilderTest, testSkippedBodyOfRecoveredFunction)
+{
+   // error recovery throws f away after its body was skipped, the body of
+   // g is not skipped and must not get the one of f
+   std::string source = "function f($a $b) { return 1; } $x = 1; function g() {}\n";
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+   unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+   Parser parser(langOpts, bufferId, sourceMgr, nullptr, TriviaRetentionMode::WithoutTrivia);
+   parser.registerSyntaxErrorHandler([](StringRef, unsigned, unsigned) {});
+   parser.setSkipFunctionBodies(true);
+   EXPECT_TRUE(parser.parse());
+   const AstNode *root = parser.getSyntaxTreeBuilder().getAstRoot();
+   ASSERT_TRUE(root);
+   size_t skippedCount = 0;
+   std::function<void(const AstNode *)> collect = [&](const AstNode *node) {
+      if (!node) {
+         return;
+      }
+      if (node->getKind() == AstNodeKind::SkippedStmtList) {
+         ++skippedCount;
+      }
+      for (const AstNode *child : node->getChildren()) {
+         collect(child);
+      }
+   };
+   collect(root);
+   EXPECT_EQ(0u, skippedCount);
+}
+
+TEST(SyntaxTreeBuilderTest, testUnterminatedSkippedBody)
+{
+   // the tokens of an unterminated body reach the grammar, the parse has
+   // to fail the same way as one that skips nothing
+   std::string source = "function f() {\n   $a = 1;\n   $b = [1,\n";
+   LangOptions langOpts;
+   using ErrorList = std::vector<std::tuple<std::string, unsigned, unsigned>>;
+   auto parse = [&](bool skipBodies, ErrorList &errors) {
+      SourceManager sourceMgr;
+      unsigned bufferId = sourceMgr.addMemBufferCopy(source);
+      Parser parser(langOpts, bufferId, sourceMgr, nullptr, TriviaRetentionMode::WithoutTrivia);
+      parser.registerSyntaxErrorHandler([&errors](StringRef msg, unsigned line, unsigned column) {
+         errors.emplace_back(msg.getStr(), line, column);
+      });
+      parser.setSkipFunctionBodies(skipBodies);
+      EXPECT_TRUE(parser.parse());
+      const AstNode *root = parser.getSyntaxTreeBuilder().getAstRoot();
+      ASSERT_TRUE(root);
+      std::function<void(const AstNode *)> check = [&](const AstNode *node) {
+         if (!node) {
+            return;
+         }
+         EXPECT_NE(AstNodeKind::SkippedStmtList, node->getKind());
+         for (const AstNode *child : node->getChildren()) {
+            check(child);
+         }
+      };
+      check(root);
+   };
+   ErrorList skippingErrors;
+   ErrorList parsingErrors;
+   parse(true, skippingErrors);
+   parse(false, parsingErrors);
+   ASSERT_FALSE(parsingErrors.empty());
+   EXPECT_EQ(parsingErrors, skippingErrors);
+}
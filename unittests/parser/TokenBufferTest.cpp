@@ -0,0 +1,129 @@
+// This source file is part of the polarphp.org open source project
+//
+// Copyright (c) 2017 - 2019 polarphp software foundation
+// Copyright (c) 2017 - 2019 zzu_softboy <zzu_softboy@163.com>
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See https://polarphp.org/LICENSE.txt for license information
+// See https://polarphp.org/CONTRIBUTORS.txt for the list of polarphp project authors
+//
+// Created by polarboy on 2019/07/08.
+
+#include "gtest/gtest.h"
+#include "polarphp/kernel/LangOptions.h"
+#include "polarphp/parser/SourceMgr.h"
+#include "polarphp/parser/Lexer.h"
+#include "polarphp/parser/Token.h"
+#include "polarphp/parser/TokenBuffer.h"
+#include "polarphp/parser/TokenValueArena.h"
+
+#include <string>
+#include <vector>
+
+using polar::kernel::LangOptions;
+using polar::syntax::TokenKindType;
+using polar::parser::SourceManager;
+using polar::parser::SourceLoc;
+using polar::parser::Token;
+using polar::parser::TokenBuffer;
+using polar::parser::TokenValueArena;
+using polar::basic::IntrusiveRefCountPtr;
+using polar::parser::tokenize;
+using polar::parser::tokenize_to_buffer;
+using polar::parser::token_lower_bound;
+
+class TokenBufferTest : public ::testing::Test
+{
+public:
+   std::string getLargeSource() const
+   {
+      std::string source;
+      for (int i = 0; i < 500; ++i) {
+         std::string index = std::to_string(i);
+         source += "/** docblock " + index + " */\n"
+                   "function foo" + index + "($a, $b = " + index + ")\n"
+                   "{\n"
+                   "   $name = 'polarphp " + index + "';\n"
+                   "   $ratio = " + index + ".5 * 0x1F;\n"
+                   "   return $a + $b; // done\n"
+                   "}\n";
+      }
+      return source;
+   }
+
+   void checkSameTokens(const std::vector<Token> &tokens, const TokenBuffer &buffer)
+   {
+      ASSERT_EQ(tokens.size(), buffer.size());
+      for (size_t i = 0; i < tokens.size(); ++i) {
+         const Token &expected = tokens[i];
+         EXPECT_EQ(expected.getKind(), buffer.getKind(i)) << "i = " << i;
+         EXPECT_EQ(expected.getRawText(), buffer.getText(i)) << "i = " << i;
+         EXPECT_TRUE(expected.getLoc() == buffer.getLoc(i)) << "i = " << i;
+         EXPECT_TRUE(expected.getFlags() == buffer.getFlags(i)) << "i = " << i;
+         EXPECT_EQ(expected.getCommentLength(), buffer.getCommentLength(i)) << "i = " << i;
+         ASSERT_EQ(expected.hasValue(), buffer.hasValue(i)) << "i = " << i;
+         if (!expected.hasValue()) {
+            continue;
+         }
+         ASSERT_EQ(expected.getValueType(), buffer.getValueType(i)) << "i = " << i;
+         switch (expected.getValueType()) {
+         case Token::ValueType::LongLong:
+            EXPECT_EQ(expected.getValue<std::int64_t>(), buffer.getLongLongValue(i));
+            break;
+         case Token::ValueType::Double:
+            EXPECT_EQ(expected.getValue<double>(), buffer.getDoubleValue(i));
+            break;
+         case Token::ValueType::String:
+            EXPECT_EQ(expected.getValue<std::string>(), buffer.getStringValue(i).getStr());
+            break;
+         case Token::ValueType::Unknown:
+            break;
+         }
+         Token rebuilt = buffer.getToken(i);
+         EXPECT_EQ(expected.getKind(), rebuilt.getKind());
+         EXPECT_EQ(expected.getRawText(), rebuilt.getRawText());
+         EXPECT_EQ(expected.getValueType(), rebuilt.getValueType());
+      }
+   }
+
+   LangOptions langOpts;
+   SourceManager sourceMgr;
+};
+
+TEST_F(TokenBufferTest, testSameTokensAsTokenize)
+{
+   unsigned bufferId = sourceMgr.addMemBufferCopy(getLargeSource());
+   IntrusiveRefCountPtr<TokenValueArena> valueArena(new TokenValueArena);
+   std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false, valueArena);
+   TokenBuffer buffer = tokenize_to_buffer(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false);
+   checkSameTokens(tokens, buffer);
+}
+
+TEST_F(TokenBufferTest, testLowerBound)
+{
+   unsigned bufferId = sourceMgr.addMemBufferCopy(getLargeSource());
+   std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false);
+   TokenBuffer buffer = tokenize_to_buffer(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false);
+   ASSERT_EQ(tokens.size(), buffer.size());
+   SourceLoc bufferStart = sourceMgr.getLocForBufferStart(bufferId);
+   unsigned length = buffer.getBufferText().size();
+   for (unsigned offset = 0; offset <= length; offset += 7) {
+      SourceLoc loc = bufferStart.getAdvancedLoc(offset);
+      size_t expected = token_lower_bound(tokens, loc) - tokens.begin();
+      ASSERT_EQ(expected, buffer.lowerBound(loc)) << "offset = " << offset;
+      ASSERT_EQ(expected, buffer.lowerBound(offset)) << "offset = " << offset;
+   }
+}
+
+TEST_F(TokenBufferTest, testMemoryPerToken)
+{
+   unsigned bufferId = sourceMgr.addMemBufferCopy(getLargeSource());
+   std::vector<Token> tokens = tokenize(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false);
+   TokenBuffer buffer = tokenize_to_buffer(langOpts, sourceMgr, bufferId, 0, 0, nullptr, false);
+   // only count the vector slots, string values that live in the lexer value
+   // arena would make the vector<Token> side even larger
+   size_t vectorBytes = tokens.size() * sizeof(Token);
+   size_t bufferBytes = buffer.getMemoryUsage();
+   ASSERT_GE(vectorBytes, bufferBytes * 3)
+         << "vector<Token>: " << vectorBytes << " bytes, TokenBuffer: " << bufferBytes << " bytes";
+}
@@ -547,4 +547,35 @@ TEST_F(SourceMgrTest, testFixitForTab)
              output);
 }
 
+TEST_F(SourceMgrTest, testSetLineOffsets)
+{
+   // large enough for 16 bit offsets
+   std::string text;
+   std::vector<uint32_t> offsets;
+   for (int i = 0; i < 100; ++i) {
+      text += "line " + std::to_string(i);
+      offsets.push_back(text.size());
+      text += "\n";
+   }
+   setMainBuffer(text, "file.in");
+   EXPECT_FALSE(SM.hasLineOffsets(mainBufferID));
+   SM.setLineOffsets(mainBufferID, std::move(offsets));
+   ASSERT_TRUE(SM.hasLineOffsets(mainBufferID));
+   EXPECT_EQ(std::make_pair(1u, 1u), SM.getLineAndColumn(getLoc(0), mainBufferID));
+   EXPECT_EQ(std::make_pair(2u, 3u), SM.getLineAndColumn(getLoc(text.find("line 1") + 2), mainBufferID));
+   EXPECT_EQ(std::make_pair(100u, 7u), SM.getLineAndColumn(getLoc(text.find("line 99") + 6), mainBufferID));
+}
+
+TEST_F(SourceMgrTest, testGetPointerForLineNumber)
+{
+   setMainBuffer("aaa\nbbb\n\nccc", "file.in");
+   const char *start = SM.getMemoryBuffer(mainBufferID)->getBufferStart();
+   EXPECT_EQ(nullptr, SM.getPointerForLineNumber(0, mainBufferID));
+   EXPECT_EQ(start, SM.getPointerForLineNumber(1, mainBufferID));
+   EXPECT_EQ(start + 4, SM.getPointerForLineNumber(2, mainBufferID));
+   EXPECT_EQ(start + 8, SM.getPointerForLineNumber(3, mainBufferID));
+   EXPECT_EQ(start + 9, SM.getPointerForLineNumber(4, mainBufferID));
+   EXPECT_EQ(nullptr, SM.getPointerForLineNumber(5, mainBufferID));
+}
+
 } // anonymous namespace